@@ -0,0 +1,80 @@
+/**
+ * @file AABBoxSoA.hpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KFL, a subproject of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#ifndef _KFL_AABBOXSOA_HPP
+#define _KFL_AABBOXSOA_HPP
+
+#pragma once
+
+#include <KFL/PreDeclare.hpp>
+#include <KFL/Math.hpp>
+
+#include <array>
+#include <vector>
+
+namespace KlayGE
+{
+	// A list of AABBs stored as structure of arrays. Each component lives in its own array padded to a multiple of 4,
+	// so a frustum can be tested against 4 boxes per iteration.
+	class AABBoxSoA final
+	{
+	public:
+		AABBoxSoA() noexcept;
+
+		size_t size() const noexcept
+		{
+			return size_;
+		}
+		bool empty() const noexcept
+		{
+			return 0 == size_;
+		}
+
+		void clear() noexcept;
+		void reserve(size_t size);
+		void resize(size_t size);
+		void push_back(AABBox const & aabb);
+		void pop_back() noexcept;
+
+		void Box(size_t index, AABBox const & aabb) noexcept;
+		AABBox Box(size_t index) const noexcept;
+
+		// Tests boxes [first, first + num) against the frustum. Same results as Frustum::Intersect on each box.
+		void Intersect(Frustum const & frustum, size_t first, size_t num, BoundOverlap* results) const noexcept;
+
+	private:
+		size_t size_;
+
+		// min x, min y, min z, max x, max y, max z
+		std::array<std::vector<float>, 6> comps_;
+	};
+}
+
+#endif			// _KFL_AABBOXSOA_HPP
@@ -121,6 +121,7 @@
 
 	#define KLAYGE_ATTRIBUTE_NORETURN __attribute__((noreturn))
 	#define KLAYGE_BUILTIN_UNREACHABLE __builtin_unreachable()
+	#define KLAYGE_FORCEINLINE inline __attribute__((always_inline))
 #elif defined(__GNUC__)
 	// GNU C++
 
@@ -179,6 +180,7 @@
 
 	#define KLAYGE_ATTRIBUTE_NORETURN __attribute__((noreturn))
 	#define KLAYGE_BUILTIN_UNREACHABLE __builtin_unreachable()
+	#define KLAYGE_FORCEINLINE inline __attribute__((always_inline))
 #elif defined(_MSC_VER)
 	// MSVC
 
@@ -224,6 +226,7 @@
 
 	#define KLAYGE_ATTRIBUTE_NORETURN __declspec(noreturn)
 	#define KLAYGE_BUILTIN_UNREACHABLE __assume(false)
+	#define KLAYGE_FORCEINLINE __forceinline
 #else
 	#error "Unknown compiler. Please install vc, g++, or clang."
 #endif
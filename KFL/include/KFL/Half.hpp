@@ -104,6 +104,9 @@ namespace KlayGE
 		// returns a NAN with the bit pattern 0111110111111111
 		static half s_nan() noexcept;
 
+		// returns the half with the given bit pattern
+		static half from_bits(uint16_t bits) noexcept;
+
 
 		// ֵ
 		half const & operator+=(half const & rhs) noexcept;
@@ -34,6 +34,7 @@
 #pragma once
 
 #include <KFL/PreDeclare.hpp>
+#include <KFL/ArrayRef.hpp>
 #include <KFL/CXX17/string_view.hpp>
 #include <istream>
 #include <vector>
@@ -54,6 +55,13 @@ namespace KlayGE
 			: res_name_(name), timestamp_(timestamp), istream_(is), streambuf_(streambuf)
 		{
 		}
+		// mapped_data is the whole content of the resource. It has to be kept alive by streambuf.
+		ResIdentifier(std::string_view name, uint64_t timestamp,
+				std::shared_ptr<std::istream> const & is, std::shared_ptr<std::streambuf> const & streambuf,
+				ArrayRef<uint8_t> mapped_data)
+			: res_name_(name), timestamp_(timestamp), istream_(is), streambuf_(streambuf), mapped_data_(mapped_data)
+		{
+		}
 
 		void ResName(std::string_view name)
 		{
@@ -113,11 +121,19 @@ namespace KlayGE
 			return *istream_;
 		}
 
+		// A contiguous view of the whole resource, or empty if it's not backed by memory. The view doesn't depend
+		// on the stream position, and reading from it doesn't move the stream.
+		ArrayRef<uint8_t> MappedData() const
+		{
+			return mapped_data_;
+		}
+
 	private:
 		std::string res_name_;
 		uint64_t timestamp_;
 		std::shared_ptr<std::istream> istream_;
 		std::shared_ptr<std::streambuf> streambuf_;
+		ArrayRef<uint8_t> mapped_data_;
 	};
 }
 
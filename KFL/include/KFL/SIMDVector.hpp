@@ -33,12 +33,15 @@
 
 #pragma once
 
+#include <array>
 #include <boost/operators.hpp>
 
 namespace KlayGE
 {
 #if defined(SIMD_MATH_SSE)
 	typedef __m128 V4TYPE;
+#elif defined(SIMD_MATH_NEON)
+	typedef float32x4_t V4TYPE;
 #else
 	typedef std::array<float, 4> V4TYPE;
 #endif
@@ -56,14 +59,21 @@ namespace KlayGE
 		SIMDVectorF4()
 		{
 		}
-		SIMDVectorF4(SIMDVectorF4 const & rhs);
+		SIMDVectorF4(SIMDVectorF4 const & rhs)
+			: vec_(rhs.vec_)
+		{
+		}
 
 		static size_t size()
 		{
 			return 4;
 		}
 
-		static SIMDVectorF4 const & Zero();
+		static SIMDVectorF4 const & Zero()
+		{
+			static SIMDVectorF4 const zero = SIMDMathLib::SetVector(0.0f);
+			return zero;
+		}
 
 		V4TYPE& Vec()
 		{
@@ -74,21 +84,65 @@ namespace KlayGE
 			return vec_;
 		}
 
-		SIMDVectorF4 const & operator+=(SIMDVectorF4 const & rhs);
-		SIMDVectorF4 const & operator+=(float rhs);
-		SIMDVectorF4 const & operator-=(SIMDVectorF4 const & rhs);
-		SIMDVectorF4 const & operator-=(float rhs);
-		SIMDVectorF4 const & operator*=(SIMDVectorF4 const & rhs);
-		SIMDVectorF4 const & operator*=(float rhs);
-		SIMDVectorF4 const & operator/=(SIMDVectorF4 const & rhs);
-		SIMDVectorF4 const & operator/=(float rhs);
+		SIMDVectorF4 const & operator+=(SIMDVectorF4 const & rhs)
+		{
+			*this = SIMDMathLib::Add(*this, rhs);
+			return *this;
+		}
+		SIMDVectorF4 const & operator+=(float rhs)
+		{
+			*this = SIMDMathLib::Add(*this, SIMDMathLib::SetVector(rhs));
+			return *this;
+		}
+		SIMDVectorF4 const & operator-=(SIMDVectorF4 const & rhs)
+		{
+			*this = SIMDMathLib::Substract(*this, rhs);
+			return *this;
+		}
+		SIMDVectorF4 const & operator-=(float rhs)
+		{
+			*this = SIMDMathLib::Substract(*this, SIMDMathLib::SetVector(rhs));
+			return *this;
+		}
+		SIMDVectorF4 const & operator*=(SIMDVectorF4 const & rhs)
+		{
+			*this = SIMDMathLib::Multiply(*this, rhs);
+			return *this;
+		}
+		SIMDVectorF4 const & operator*=(float rhs)
+		{
+			*this = SIMDMathLib::Multiply(*this, SIMDMathLib::SetVector(rhs));
+			return *this;
+		}
+		SIMDVectorF4 const & operator/=(SIMDVectorF4 const & rhs)
+		{
+			*this = SIMDMathLib::Divide(*this, rhs);
+			return *this;
+		}
+		SIMDVectorF4 const & operator/=(float rhs)
+		{
+			return this->operator*=(1.0f / rhs);
+		}
 
-		SIMDVectorF4& operator=(SIMDVectorF4 const & rhs);
+		SIMDVectorF4& operator=(SIMDVectorF4 const & rhs)
+		{
+			vec_ = rhs.vec_;
+			return *this;
+		}
 
-		SIMDVectorF4 const operator+() const;
-		SIMDVectorF4 const operator-() const;
+		SIMDVectorF4 const operator+() const
+		{
+			return *this;
+		}
+		SIMDVectorF4 const operator-() const
+		{
+			return SIMDMathLib::Negative(*this);
+		}
 
-		void swap(SIMDVectorF4& rhs);
+		void swap(SIMDVectorF4& rhs)
+		{
+			std::swap(vec_, rhs.vec_);
+		}
 
 	private:
 		V4TYPE vec_;
@@ -98,6 +152,116 @@ namespace KlayGE
 	{
 		lhs.swap(rhs);
 	}
+
+
+#if defined(SIMD_MATH_AVX2)
+	typedef __m256 V8TYPE;
+#else
+	typedef std::array<SIMDVectorF4, 2> V8TYPE;
+#endif
+
+	// 8 floats in one register with AVX2, a pair of SIMDVectorF4 otherwise. Meant for structure of arrays data,
+	// such as the x, y, z of 8 points, so one operation processes 8 elements.
+	class SIMDVectorF8 final : boost::addable<SIMDVectorF8,
+								boost::subtractable<SIMDVectorF8,
+								boost::multipliable<SIMDVectorF8,
+								boost::dividable<SIMDVectorF8,
+								boost::dividable2<SIMDVectorF8, float,
+								boost::multipliable2<SIMDVectorF8, float,
+								boost::addable2<SIMDVectorF8, float,
+								boost::subtractable2<SIMDVectorF8, float>>>>>>>>
+	{
+	public:
+		SIMDVectorF8()
+		{
+		}
+		SIMDVectorF8(SIMDVectorF8 const & rhs)
+			: vec_(rhs.vec_)
+		{
+		}
+
+		static size_t size()
+		{
+			return 8;
+		}
+
+		V8TYPE& Vec()
+		{
+			return vec_;
+		}
+		V8TYPE const & Vec() const
+		{
+			return vec_;
+		}
+
+		SIMDVectorF8 const & operator+=(SIMDVectorF8 const & rhs)
+		{
+			*this = SIMDMathLib::Add(*this, rhs);
+			return *this;
+		}
+		SIMDVectorF8 const & operator+=(float rhs)
+		{
+			*this = SIMDMathLib::Add(*this, SIMDMathLib::SetVector8(rhs));
+			return *this;
+		}
+		SIMDVectorF8 const & operator-=(SIMDVectorF8 const & rhs)
+		{
+			*this = SIMDMathLib::Substract(*this, rhs);
+			return *this;
+		}
+		SIMDVectorF8 const & operator-=(float rhs)
+		{
+			*this = SIMDMathLib::Substract(*this, SIMDMathLib::SetVector8(rhs));
+			return *this;
+		}
+		SIMDVectorF8 const & operator*=(SIMDVectorF8 const & rhs)
+		{
+			*this = SIMDMathLib::Multiply(*this, rhs);
+			return *this;
+		}
+		SIMDVectorF8 const & operator*=(float rhs)
+		{
+			*this = SIMDMathLib::Multiply(*this, SIMDMathLib::SetVector8(rhs));
+			return *this;
+		}
+		SIMDVectorF8 const & operator/=(SIMDVectorF8 const & rhs)
+		{
+			*this = SIMDMathLib::Divide(*this, rhs);
+			return *this;
+		}
+		SIMDVectorF8 const & operator/=(float rhs)
+		{
+			return this->operator*=(1.0f / rhs);
+		}
+
+		SIMDVectorF8& operator=(SIMDVectorF8 const & rhs)
+		{
+			vec_ = rhs.vec_;
+			return *this;
+		}
+
+		SIMDVectorF8 const operator+() const
+		{
+			return *this;
+		}
+		SIMDVectorF8 const operator-() const
+		{
+			return SIMDMathLib::Negative(*this);
+		}
+
+		void swap(SIMDVectorF8& rhs)
+		{
+			std::swap(vec_, rhs.vec_);
+		}
+
+	private:
+		V8TYPE vec_;
+	};
+
+	inline void swap(SIMDVectorF8& lhs, SIMDVectorF8& rhs)
+	{
+		lhs.swap(rhs);
+	}
 }
 
 #endif			// _KFL_SIMDVECTOR_HPP
@@ -0,0 +1,154 @@
+/**
+ * @file MappedFile.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KFL, a subproject of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#include <KFL/KFL.hpp>
+
+#if defined(KLAYGE_PLATFORM_WINDOWS)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <KFL/MappedFile.hpp>
+
+namespace KlayGE
+{
+	MappedFile::MappedFile()
+		: data_(nullptr), size_(0)
+#ifdef KLAYGE_PLATFORM_WINDOWS
+			, file_handle_(INVALID_HANDLE_VALUE), mapping_handle_(nullptr)
+#endif
+	{
+	}
+
+	MappedFile::~MappedFile()
+	{
+		this->Close();
+	}
+
+	bool MappedFile::Open(std::string const & file_name)
+	{
+		this->Close();
+
+#if defined(KLAYGE_PLATFORM_WINDOWS_DESKTOP)
+		// Tools replace files they have just read, so writing and deleting are shared as well
+		file_handle_ = ::CreateFileA(file_name.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+			nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file_handle_ == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		LARGE_INTEGER file_size;
+		if (!::GetFileSizeEx(file_handle_, &file_size) || (file_size.QuadPart == 0))
+		{
+			this->Close();
+			return false;
+		}
+
+		mapping_handle_ = ::CreateFileMappingA(file_handle_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping_handle_ == nullptr)
+		{
+			this->Close();
+			return false;
+		}
+
+		data_ = ::MapViewOfFile(mapping_handle_, FILE_MAP_READ, 0, 0, 0);
+		if (data_ == nullptr)
+		{
+			this->Close();
+			return false;
+		}
+		size_ = static_cast<size_t>(file_size.QuadPart);
+#elif defined(KLAYGE_PLATFORM_WINDOWS_STORE)
+		// Mapping is not available for packaged files, callers fall back to streams
+		KFL_UNUSED(file_name);
+		return false;
+#else
+		int const fd = ::open(file_name.c_str(), O_RDONLY);
+		if (fd < 0)
+		{
+			return false;
+		}
+
+		struct stat file_stat;
+		if ((::fstat(fd, &file_stat) != 0) || (file_stat.st_size <= 0))
+		{
+			::close(fd);
+			return false;
+		}
+
+		size_t const file_size = static_cast<size_t>(file_stat.st_size);
+		void* p = ::mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		// The mapping keeps its own reference to the file
+		::close(fd);
+		if (p == MAP_FAILED)
+		{
+			return false;
+		}
+
+		data_ = p;
+		size_ = file_size;
+#endif
+
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+#ifdef KLAYGE_PLATFORM_WINDOWS
+		if (data_ != nullptr)
+		{
+			::UnmapViewOfFile(data_);
+		}
+		if (mapping_handle_ != nullptr)
+		{
+			::CloseHandle(mapping_handle_);
+			mapping_handle_ = nullptr;
+		}
+		if (file_handle_ != INVALID_HANDLE_VALUE)
+		{
+			::CloseHandle(file_handle_);
+			file_handle_ = INVALID_HANDLE_VALUE;
+		}
+#else
+		if (data_ != nullptr)
+		{
+			::munmap(data_, size_);
+		}
+#endif
+
+		data_ = nullptr;
+		size_ = 0;
+	}
+}
@@ -0,0 +1,263 @@
+/**
+ * @file AABBoxSoA.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KFL, a subproject of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#include <KFL/KFL.hpp>
+#include <KFL/AABBox.hpp>
+#include <KFL/Frustum.hpp>
+#include <KFL/Plane.hpp>
+
+#if defined(KLAYGE_SSE_SUPPORT)
+#include <xmmintrin.h>
+#elif defined(KLAYGE_NEON_SUPPORT)
+#include <arm_neon.h>
+#endif
+
+#include <KFL/AABBoxSoA.hpp>
+
+namespace
+{
+	size_t PaddedSize(size_t size)
+	{
+		return (size + 3) & ~static_cast<size_t>(3);
+	}
+
+	KlayGE::BoundOverlap LaneOverlap(uint32_t out_mask, uint32_t partial_mask, uint32_t lane)
+	{
+		if (out_mask & (1UL << lane))
+		{
+			return KlayGE::BO_No;
+		}
+		else
+		{
+			return (partial_mask & (1UL << lane)) ? KlayGE::BO_Partial : KlayGE::BO_Yes;
+		}
+	}
+}
+
+namespace KlayGE
+{
+	AABBoxSoA::AABBoxSoA() noexcept
+		: size_(0)
+	{
+	}
+
+	void AABBoxSoA::clear() noexcept
+	{
+		size_ = 0;
+		for (auto& comp : comps_)
+		{
+			comp.clear();
+		}
+	}
+
+	void AABBoxSoA::reserve(size_t size)
+	{
+		for (auto& comp : comps_)
+		{
+			comp.reserve(PaddedSize(size));
+		}
+	}
+
+	void AABBoxSoA::resize(size_t size)
+	{
+		size_ = size;
+		for (auto& comp : comps_)
+		{
+			comp.resize(PaddedSize(size), 0.0f);
+		}
+	}
+
+	void AABBoxSoA::push_back(AABBox const & aabb)
+	{
+		++ size_;
+		if (comps_[0].size() < size_)
+		{
+			for (auto& comp : comps_)
+			{
+				comp.resize(PaddedSize(size_), 0.0f);
+			}
+		}
+		this->Box(size_ - 1, aabb);
+	}
+
+	void AABBoxSoA::pop_back() noexcept
+	{
+		BOOST_ASSERT(size_ > 0);
+		-- size_;
+	}
+
+	void AABBoxSoA::Box(size_t index, AABBox const & aabb) noexcept
+	{
+		BOOST_ASSERT(index < size_);
+
+		comps_[0][index] = aabb.Min().x();
+		comps_[1][index] = aabb.Min().y();
+		comps_[2][index] = aabb.Min().z();
+		comps_[3][index] = aabb.Max().x();
+		comps_[4][index] = aabb.Max().y();
+		comps_[5][index] = aabb.Max().z();
+	}
+
+	AABBox AABBoxSoA::Box(size_t index) const noexcept
+	{
+		BOOST_ASSERT(index < size_);
+
+		return AABBox(float3(comps_[0][index], comps_[1][index], comps_[2][index]),
+			float3(comps_[3][index], comps_[4][index], comps_[5][index]));
+	}
+
+	void AABBoxSoA::Intersect(Frustum const & frustum, size_t first, size_t num, BoundOverlap* results) const noexcept
+	{
+		BOOST_ASSERT(first + num <= size_);
+
+		// For each plane, v0 is the corner farthest along the normal, v1 is diagonally opposed to v0. Since the
+		// choice only depends on the plane, it's made once per array instead of once per box.
+		float const * v0[6][3];
+		float const * v1[6][3];
+		for (int p = 0; p < 6; ++ p)
+		{
+			Plane const & plane = frustum.FrustumPlane(p);
+			for (int c = 0; c < 3; ++ c)
+			{
+				bool const neg = plane[c] < 0;
+				v0[p][c] = comps_[neg ? c : c + 3].data();
+				v1[p][c] = comps_[neg ? c + 3 : c].data();
+			}
+		}
+
+		size_t const padded_size = comps_[0].size();
+		size_t i = 0;
+
+#if defined(KLAYGE_SSE_SUPPORT)
+		__m128 planes[6][4];
+		for (int p = 0; p < 6; ++ p)
+		{
+			Plane const & plane = frustum.FrustumPlane(p);
+			for (int c = 0; c < 4; ++ c)
+			{
+				planes[p][c] = _mm_set1_ps(plane[c]);
+			}
+		}
+
+		__m128 const zero = _mm_setzero_ps();
+		for (; (i < num) && (first + i + 4 <= padded_size); i += 4)
+		{
+			size_t const base = first + i;
+
+			__m128 out = zero;
+			__m128 partial = zero;
+			for (int p = 0; p < 6; ++ p)
+			{
+				// Same operation order as MathLib::dot_coord, so the results match the scalar path exactly
+				__m128 d0 = _mm_add_ps(_mm_mul_ps(planes[p][0], _mm_loadu_ps(v0[p][0] + base)),
+					_mm_mul_ps(planes[p][1], _mm_loadu_ps(v0[p][1] + base)));
+				d0 = _mm_add_ps(_mm_add_ps(d0, _mm_mul_ps(planes[p][2], _mm_loadu_ps(v0[p][2] + base))), planes[p][3]);
+				__m128 d1 = _mm_add_ps(_mm_mul_ps(planes[p][0], _mm_loadu_ps(v1[p][0] + base)),
+					_mm_mul_ps(planes[p][1], _mm_loadu_ps(v1[p][1] + base)));
+				d1 = _mm_add_ps(_mm_add_ps(d1, _mm_mul_ps(planes[p][2], _mm_loadu_ps(v1[p][2] + base))), planes[p][3]);
+
+				out = _mm_or_ps(out, _mm_cmplt_ps(d0, zero));
+				partial = _mm_or_ps(partial, _mm_cmplt_ps(d1, zero));
+			}
+
+			uint32_t const out_mask = _mm_movemask_ps(out);
+			uint32_t const partial_mask = _mm_movemask_ps(partial);
+			uint32_t const lanes = static_cast<uint32_t>(std::min<size_t>(num - i, 4));
+			for (uint32_t lane = 0; lane < lanes; ++ lane)
+			{
+				results[i + lane] = LaneOverlap(out_mask, partial_mask, lane);
+			}
+		}
+#elif defined(KLAYGE_NEON_SUPPORT)
+		float32x4_t planes[6][4];
+		for (int p = 0; p < 6; ++ p)
+		{
+			Plane const & plane = frustum.FrustumPlane(p);
+			for (int c = 0; c < 4; ++ c)
+			{
+				planes[p][c] = vdupq_n_f32(plane[c]);
+			}
+		}
+
+		float32x4_t const zero = vdupq_n_f32(0);
+		uint32x4_t const lane_bits = { 1, 2, 4, 8 };
+		for (; (i < num) && (first + i + 4 <= padded_size); i += 4)
+		{
+			size_t const base = first + i;
+
+			uint32x4_t out = vdupq_n_u32(0);
+			uint32x4_t partial = vdupq_n_u32(0);
+			for (int p = 0; p < 6; ++ p)
+			{
+				// Same operation order as MathLib::dot_coord, so the results match the scalar path exactly
+				float32x4_t d0 = vaddq_f32(vmulq_f32(planes[p][0], vld1q_f32(v0[p][0] + base)),
+					vmulq_f32(planes[p][1], vld1q_f32(v0[p][1] + base)));
+				d0 = vaddq_f32(vaddq_f32(d0, vmulq_f32(planes[p][2], vld1q_f32(v0[p][2] + base))), planes[p][3]);
+				float32x4_t d1 = vaddq_f32(vmulq_f32(planes[p][0], vld1q_f32(v1[p][0] + base)),
+					vmulq_f32(planes[p][1], vld1q_f32(v1[p][1] + base)));
+				d1 = vaddq_f32(vaddq_f32(d1, vmulq_f32(planes[p][2], vld1q_f32(v1[p][2] + base))), planes[p][3]);
+
+				out = vorrq_u32(out, vcltq_f32(d0, zero));
+				partial = vorrq_u32(partial, vcltq_f32(d1, zero));
+			}
+
+			uint32x4_t const out_bits = vandq_u32(out, lane_bits);
+			uint32x4_t const partial_bits = vandq_u32(partial, lane_bits);
+			uint32_t const out_mask = vgetq_lane_u32(out_bits, 0) | vgetq_lane_u32(out_bits, 1)
+				| vgetq_lane_u32(out_bits, 2) | vgetq_lane_u32(out_bits, 3);
+			uint32_t const partial_mask = vgetq_lane_u32(partial_bits, 0) | vgetq_lane_u32(partial_bits, 1)
+				| vgetq_lane_u32(partial_bits, 2) | vgetq_lane_u32(partial_bits, 3);
+			uint32_t const lanes = static_cast<uint32_t>(std::min<size_t>(num - i, 4));
+			for (uint32_t lane = 0; lane < lanes; ++ lane)
+			{
+				results[i + lane] = LaneOverlap(out_mask, partial_mask, lane);
+			}
+		}
+#else
+		KFL_UNUSED(padded_size);
+#endif
+
+		for (; i < num; ++ i)
+		{
+			size_t const index = first + i;
+			bool out = false;
+			bool partial = false;
+			for (int p = 0; p < 6; ++ p)
+			{
+				Plane const & plane = frustum.FrustumPlane(p);
+				float const d0 = plane.a() * v0[p][0][index] + plane.b() * v0[p][1][index] + plane.c() * v0[p][2][index] + plane.d();
+				float const d1 = plane.a() * v1[p][0][index] + plane.b() * v1[p][1][index] + plane.c() * v1[p][2][index] + plane.d();
+				out |= (d0 < 0);
+				partial |= (d1 < 0);
+			}
+			results[i] = out ? BO_No : (partial ? BO_Partial : BO_Yes);
+		}
+	}
+}
@@ -169,6 +169,13 @@ namespace KlayGE
 		return h;
 	}
 
+	half half::from_bits(uint16_t bits) noexcept
+	{
+		half h;
+		h.value_ = bits;
+		return h;
+	}
+
 
 	half const & half::operator+=(half const & rhs) noexcept
 	{
@@ -31,803 +31,134 @@
 #include <KFL/KFL.hpp>
 #include <KFL/SIMDMath.hpp>
 
-#ifdef SIMD_MATH_SSE
-	#include <emmintrin.h>
-#endif
-
-namespace KlayGE
-{
-	namespace SIMDMathLib
-	{
-		// General Vector
-		///////////////////////////////////////////////////////////////////////////////
-		SIMDVectorF4 Add(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			ret.Vec() = _mm_add_ps(lhs.Vec(), rhs.Vec());
-#else
-			for (int i = 0; i < 4; ++ i)
-			{
-				ret.Vec()[i] = lhs.Vec()[i] + rhs.Vec()[i];
-			}
-#endif
-			return ret;
-		}
-
-		SIMDVectorF4 Substract(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			ret.Vec() = _mm_sub_ps(lhs.Vec(), rhs.Vec());
-#else
-			for (int i = 0; i < 4; ++ i)
-			{
-				ret.Vec()[i] = lhs.Vec()[i] - rhs.Vec()[i];
-			}
-#endif
-			return ret;
-		}
-
-		SIMDVectorF4 Multiply(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			ret.Vec() = _mm_mul_ps(lhs.Vec(), rhs.Vec());
-#else
-			for (int i = 0; i < 4; ++ i)
-			{
-				ret.Vec()[i] = lhs.Vec()[i] * rhs.Vec()[i];
-			}
-#endif
-			return ret;
-		}
-
-		SIMDVectorF4 Divide(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			ret.Vec() = _mm_div_ps(lhs.Vec(), rhs.Vec());
-#else
-			for (int i = 0; i < 4; ++ i)
-			{
-				ret.Vec()[i] = lhs.Vec()[i] / rhs.Vec()[i];
-			}
-#endif
-			return ret;
-		}
-
-		SIMDVectorF4 Negative(SIMDVectorF4 const & rhs)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			ret.Vec() = _mm_sub_ps(_mm_setzero_ps(), rhs.Vec());
-#else
-			for (int i = 0; i < 4; ++ i)
-			{
-				ret.Vec()[i] = -rhs.Vec()[i];
-			}
-#endif
-			return ret;
-		}
-
-		SIMDVectorF4 BaryCentric(SIMDVectorF4 const & v1, SIMDVectorF4 const & v2, SIMDVectorF4 const & v3,
-			float f, float g)
-		{
-			return (1 - f - g) * v1 + f * v2 + g * v3;
-		}
-
-		SIMDVectorF4 CatmullRom(SIMDVectorF4 const & v0, SIMDVectorF4 const & v1,
-			SIMDVectorF4 const & v2, SIMDVectorF4 const & v3, float s)
-		{
-			float const s2 = s * s;
-			float const s3 = s2 * s;
-			return ((-s3 + 2 * s2 - s) * v0 + (3 * s3 - 5 * s2 + 2) * v1
-				+ (-3 * s3 + 4 * s2 + s) * v2 + (s3 - s2) * v3) * 0.5f;
-		}
-
-		SIMDVectorF4 CubicBezier(SIMDVectorF4 const & v0, SIMDVectorF4 const & v1,
-			SIMDVectorF4 const & v2, SIMDVectorF4 const & v3, float s)
-		{
-			// From http://en.wikipedia.org/wiki/B%C3%A9zier_curve
-
-			float const s2 = s * s;
-			float const s3 = s2 * s;
-			return ((-s3 + 3 * s2 - 3 * s + 1) * v0 + (3 * s3 - 6 * s2 + 3 * s) * v1
-				+ (-3 * s3 + 3 * s2) * v2 + s3 * v3);
-		}
-
-		SIMDVectorF4 CubicBSpline(SIMDVectorF4 const & v0, SIMDVectorF4 const & v1,
-			SIMDVectorF4 const & v2, SIMDVectorF4 const & v3, float s)
-		{
-			// From http://en.wikipedia.org/wiki/B-spline
-
-			float const s2 = s * s;
-			float const s3 = s2 * s;
-			return ((-s3 + 3 * s2 - 3 * s + 1) * v0 + (3 * s3 - 6 * s2 + 4) * v1
-				+ (-3 * s3 + 3 * s2 + 3 * s + 1) * v2 + s3 * v3) / 6;
-		}
-
-		SIMDVectorF4 Hermite(SIMDVectorF4 const & v1, SIMDVectorF4 const & t1,
-			SIMDVectorF4 const & v2, SIMDVectorF4 const & t2, float s)
-		{
-			float const s2 = s * s;
-			float const s3 = s2 * s;
-			float const h1 = 2 * s3 - 3 * s2 + 1;
-			float const h2 = s3 - 2 * s2 + s;
-			float const h3 = -2 * s3 + 3 * s2;
-			float const h4 = s3 - s2;
-			return h1 * v1 + h2 * t1 + h3 * v2 + h4 * t2;
-		}
-
-		SIMDVectorF4 Lerp(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs, float s)
-		{
-			return lhs + (rhs - lhs) * s;
-		}
-
-		SIMDVectorF4 Abs(SIMDVectorF4 const & x)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			__m128 res = x.Vec();
-			__m128 data_temp = _mm_sub_ps(_mm_setzero_ps(), res);
-			ret.Vec() = _mm_max_ps(data_temp, res);
-#else
-			for (int i = 0; i < 4; ++ i)
-			{
-				ret.Vec()[i] = MathLib::abs(x.Vec()[i]);
-			}
-#endif
-			return ret;
-		}
-
-		SIMDVectorF4 Sgn(SIMDVectorF4 const & x)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			__m128 const zero = _mm_setzero_ps();
-
-			__m128 res1 = _mm_cmplt_ps(x.Vec(), zero);
-			res1 = _mm_cvtepi32_ps(_mm_castps_si128(res1));
-			__m128 res2 = _mm_cmpgt_ps(x.Vec(), zero);
-			res2 = _mm_cvtepi32_ps(_mm_castps_si128(res2));
-			res2 = _mm_sub_ps(zero, res2);
-			ret.Vec() = _mm_add_ps(res1,res2);
-#else
-			for (int i = 0; i < 4; ++ i)
-			{
-				ret.Vec()[i] = MathLib::sgn(x.Vec()[i]);
-			}
-#endif
-			return ret;
-		}
-
-		SIMDVectorF4 Sqr(SIMDVectorF4 const & x)
-		{
-			return x * x;
-		}
-
-		SIMDVectorF4 Cube(SIMDVectorF4 const & x)
-		{
-			return Sqr(x) * x;
-		}
-
-		SIMDVectorF4 LoadVector1(float v)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			ret.Vec() = _mm_load_ss(&v);
-#else
-			ret.Vec()[0] = v;
-			for (int i = 1; i < 4; ++ i)
-			{
-				ret.Vec()[i] = 0;
-			}
-#endif
-			return ret;
-		}
-
-		SIMDVectorF4 LoadVector2(float2 const & v)
-		{
-			return LoadVector2(&v[0]);
-		}
-
-		SIMDVectorF4 LoadVector3(float3 const & v)
-		{
-			return LoadVector3(&v[0]);
-		}
-
-		SIMDVectorF4 LoadVector4(float4 const & v)
-		{
-			return LoadVector4(&v[0]);
-		}
-
-		SIMDVectorF4 LoadVector2(float const * v)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			__m128 x = _mm_load_ss(&v[0]);
-			__m128 y = _mm_load_ss(&v[1]);
-			ret.Vec() = _mm_unpacklo_ps(x, y);
-#else
-			for (int i = 0; i < 2; ++ i)
-			{
-				ret.Vec()[i] = v[i];
-			}
-			for (int i = 2; i < 4; ++ i)
-			{
-				ret.Vec()[i] = 0;
-			}
-#endif
-			return ret;
-		}
-
-		SIMDVectorF4 LoadVector3(float const * v)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			__m128 x = _mm_load_ss(&v[0]);
-			__m128 y = _mm_load_ss(&v[1]);
-			__m128 z = _mm_load_ss(&v[2]);
-			__m128 xy = _mm_unpacklo_ps(x, y);
-			ret.Vec() = _mm_movelh_ps(xy, z);
-#else
-			for (int i = 0; i < 3; ++ i)
-			{
-				ret.Vec()[i] = v[i];
-			}
-			for (int i = 3; i < 4; ++ i)
-			{
-				ret.Vec()[i] = 0;
-			}
-#endif
-			return ret;
-		}
-
-		SIMDVectorF4 LoadVector4(float const * v)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			ret.Vec() = _mm_load_ps(&v[0]);
-#else
-			for (int i = 0; i < 4; ++i)
-			{
-				ret.Vec()[i] = v[i];
-			}
-#endif
-			return ret;
-		}
-
-		void StoreVector1(float& fs, SIMDVectorF4 const & v)
-		{
-#if defined(SIMD_MATH_SSE)
-			_mm_store_ss(&fs, v.Vec());
-#else
-			fs = v.Vec()[0];
-#endif
-		}
-
-		void StoreVector2(float2& fs, SIMDVectorF4 const & v)
-		{
-#if defined(SIMD_MATH_SSE)
-			__m128 x = v.Vec();
-			__m128 y = _mm_shuffle_ps(x, x, _MM_SHUFFLE(1, 1, 1, 1));
-			_mm_store_ss(&fs[0], x);
-			_mm_store_ss(&fs[1], y);
-#else
-			for (int i = 0; i < 2; ++ i)
-			{
-				fs[i] = v.Vec()[i];
-			}
-#endif
-		}
-
-		void StoreVector3(float3& fs, SIMDVectorF4 const & v)
-		{
-#if defined(SIMD_MATH_SSE)
-			__m128 x = v.Vec();
-			__m128 y = _mm_shuffle_ps(x, x, _MM_SHUFFLE(1, 1, 1, 1));
-			__m128 z = _mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 2, 2, 2));
-			_mm_store_ss(&fs[0], x);
-			_mm_store_ss(&fs[1], y);
-			_mm_store_ss(&fs[2], z);
-#else
-			for (int i = 0; i < 3; ++ i)
-			{
-				fs[i] = v.Vec()[i];
-			}
-#endif
-		}
-
-		void StoreVector4(float4& fs, SIMDVectorF4 const & v)
-		{
-#if defined(SIMD_MATH_SSE)
-			_mm_store_ps(&fs[0], v.Vec());
-#else
-			for (int i = 0; i < 4; ++ i)
-			{
-				fs[i] = v.Vec()[i];
-			}
-#endif
-		}
-
-		SIMDVectorF4 SetVector(float x, float y, float z, float w)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			ret.Vec() = _mm_set_ps(w, z, y, x);
-#else
-			ret.Vec()[0] = x;
-			ret.Vec()[1] = y;
-			ret.Vec()[2] = z;
-			ret.Vec()[3] = w;
-#endif
-			return ret;
-		}
-
-		SIMDVectorF4 SetVector(float v)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			ret.Vec() = _mm_set_ps1(v);
-#else
-			ret.Vec()[0] = v;
-			ret.Vec()[1] = v;
-			ret.Vec()[2] = v;
-			ret.Vec()[3] = v;
-#endif
-			return ret;
-		}
-
-		float GetX(SIMDVectorF4 const & rhs)
-		{
-#if defined(SIMD_MATH_SSE)
-			return _mm_cvtss_f32(rhs.Vec());
-#else
-			return GetByIndex(rhs, 0);
-#endif
-		}
-
-		float GetY(SIMDVectorF4 const & rhs)
-		{
-#if defined(SIMD_MATH_SSE)
-			__m128 tmp = _mm_shuffle_ps(rhs.Vec(), rhs.Vec(), _MM_SHUFFLE(1, 1, 1, 1));
-			return _mm_cvtss_f32(tmp);
-#else
-			return GetByIndex(rhs, 1);
-#endif
-		}
-
-		float GetZ(SIMDVectorF4 const & rhs)
-		{
-#if defined(SIMD_MATH_SSE)
-			__m128 tmp = _mm_shuffle_ps(rhs.Vec(), rhs.Vec(), _MM_SHUFFLE(2, 2, 2, 2));
-			return _mm_cvtss_f32(tmp);
-#else
-			return GetByIndex(rhs, 2);
-#endif
-		}
-
-		float GetW(SIMDVectorF4 const & rhs)
-		{
-#if defined(SIMD_MATH_SSE)
-			__m128 tmp = _mm_shuffle_ps(rhs.Vec(), rhs.Vec(), _MM_SHUFFLE(3, 3, 3, 3));
-			return _mm_cvtss_f32(tmp);
-#else
-			return GetByIndex(rhs, 3);
-#endif
-		}
-
-		float GetByIndex(SIMDVectorF4 const & rhs, size_t index)
-		{
-#if defined(SIMD_MATH_SSE)
-#ifdef KLAYGE_COMPILER_MSVC
-			return rhs.Vec().m128_f32[index];
-#else
-			union
-			{
-				__m128 v;
-				float comp[4];
-			} converter;
-			converter.v = rhs.Vec();
-			return converter.comp[index];
-#endif
-#else
-			return rhs.Vec()[index];
-#endif
-		}
-
-		SIMDVectorF4 SetX(SIMDVectorF4 const & rhs, float v)
-		{
-#if defined(SIMD_MATH_SSE)
-			SIMDVectorF4 ret;
-			ret.Vec() = _mm_move_ss(rhs.Vec(), _mm_set_ss(v));
-			return ret;
-#else
-			return SetByIndex(rhs, v, 0);
-#endif
-		}
-
-		SIMDVectorF4 SetY(SIMDVectorF4 const & rhs, float v)
-		{
-#if defined(SIMD_MATH_SSE)
-			SIMDVectorF4 ret;
-			__m128 yxzw = _mm_shuffle_ps(rhs.Vec(), rhs.Vec(), _MM_SHUFFLE(3, 2, 0, 1));
-			yxzw = _mm_move_ss(yxzw, _mm_set_ss(v));
-			ret.Vec() = _mm_shuffle_ps(yxzw, yxzw, _MM_SHUFFLE(3, 2, 0, 1));
-			return ret;
-#else
-			return SetByIndex(rhs, v, 1);
-#endif
-		}
-
-		SIMDVectorF4 SetZ(SIMDVectorF4 const & rhs, float v)
-		{
-#if defined(SIMD_MATH_SSE)
-			SIMDVectorF4 ret;
-			__m128 zyxw = _mm_shuffle_ps(rhs.Vec(), rhs.Vec(), _MM_SHUFFLE(3, 0, 1, 2));
-			zyxw = _mm_move_ss(zyxw, _mm_set_ss(v));
-			ret.Vec() = _mm_shuffle_ps(zyxw, zyxw, _MM_SHUFFLE(3, 0, 1, 2));
-			return ret;
-#else
-			return SetByIndex(rhs, v, 2);
-#endif
-		}
-
-		SIMDVectorF4 SetW(SIMDVectorF4 const & rhs, float v)
-		{
-#if defined(SIMD_MATH_SSE)
-			SIMDVectorF4 ret;
-			__m128 wyzx = _mm_shuffle_ps(rhs.Vec(), rhs.Vec(), _MM_SHUFFLE(0, 2, 1, 3));
-			wyzx = _mm_move_ss(wyzx, _mm_set_ss(v));
-			ret.Vec() = _mm_shuffle_ps(wyzx, wyzx, _MM_SHUFFLE(0, 2, 1, 3));
-			return ret;
-#else
-			return SetByIndex(rhs, v, 3);
-#endif
-		}
-
-		SIMDVectorF4 SetByIndex(SIMDVectorF4 const & rhs, float v, size_t index)
-		{
-			SIMDVectorF4 ret = rhs;
-#if defined(SIMD_MATH_SSE)
-#ifdef KLAYGE_COMPILER_MSVC
-			ret.Vec().m128_f32[index] = v;
-#else
-			union
-			{
-				__m128 v;
-				float comp[4];
-			} converter;
-			converter.v = rhs.Vec();
-			converter.comp[index] = v;
-			ret.Vec() = converter.v;
-#endif
-#else
-			ret.Vec()[index] = v;
-#endif
-			return ret;
-		}
-
-		SIMDVectorF4 Maximize(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			ret.Vec() = _mm_max_ps(lhs.Vec(), rhs.Vec());
-#else
-			for (int i = 0; i < 4; ++ i)
-			{
-				ret.Vec()[i] = std::max(lhs.Vec()[i], rhs.Vec()[i]);
-			}
-#endif
-			return ret;
-		}
-
-		SIMDVectorF4 Minimize(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			ret.Vec() = _mm_min_ps(lhs.Vec(), rhs.Vec());
-#else
-			for (int i = 0; i < 4; ++ i)
-			{
-				ret.Vec()[i] = std::min(lhs.Vec()[i], rhs.Vec()[i]);
-			}
-#endif
-			return ret;
-		}
-
-		SIMDVectorF4 Reflect(SIMDVectorF4 const & incident, SIMDVectorF4 const & normal)
-		{
-			return incident - 2 * DotVector3(incident, normal) * normal;
-		}
-
-		SIMDVectorF4 Refract(SIMDVectorF4 const & incident, SIMDVectorF4 const & normal, float refraction_index)
-		{
-			float const t = GetX(DotVector3(incident, normal));
-			float const r = 1 - refraction_index * refraction_index * (1 - t * t);
-
-			if (r < 0)
-			{
-				// Total internal reflection
-				return SIMDVectorF4::Zero();
-			}
-			else
-			{
-				float const s = refraction_index * t + sqrt(std::abs(r));
-				return refraction_index * incident - s * normal;
-			}
-		}
-
-		// 2D Vector
-		///////////////////////////////////////////////////////////////////////////////
-		SIMDVectorF4 CrossVector2(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			__m128 res1 = lhs.Vec();
-			__m128 res2 = rhs.Vec();
-			res2 = _mm_shuffle_ps(res2, res2, _MM_SHUFFLE(0, 0, 0, 1));
-			res1 = _mm_mul_ps(res1, res2);
-			res2 = _mm_shuffle_ps(res1, res1, _MM_SHUFFLE(1, 1, 1, 1));
-			res1 = _mm_sub_ps(res1, res2);
-			ret.Vec() = _mm_shuffle_ps(res1, res1, _MM_SHUFFLE(0, 0, 0, 0));
-#else
-			ret = SetVector(GetX(lhs) * GetY(rhs) - GetY(lhs) * GetX(rhs));
-#endif
-			return ret;
-		}
-
-		SIMDVectorF4 DotVector2(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			__m128 res1 = lhs.Vec();
-			__m128 res2 = rhs.Vec();
-			res1 = _mm_mul_ps(res1, res2);
-			__m128 y = _mm_shuffle_ps(res1, res1, _MM_SHUFFLE(1, 1, 1, 1));
-			res1 = _mm_add_ps(res1, y);
-			ret.Vec() = _mm_shuffle_ps(res1, res1, _MM_SHUFFLE(0, 0, 0, 0));
-#else
-			ret = SetVector(GetX(lhs) * GetX(rhs) + GetY(lhs) * GetY(rhs));
-#endif
-			return ret;
-		}
-
-		SIMDVectorF4 LengthSqVector2(SIMDVectorF4 const & rhs)
-		{
-			return DotVector2(rhs, rhs);
-		}
+#include <algorithm>
+#include <tuple>
 
-		SIMDVectorF4 LengthVector2(SIMDVectorF4 const & rhs)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			ret.Vec() = _mm_sqrt_ps(LengthSqVector2(rhs).Vec());
-#else
-			ret = SetVector(sqrt(GetX(LengthSqVector2(rhs))));
-#endif
-			return ret;
-		}
+namespace
+{
+	using namespace KlayGE;
 
-		SIMDVectorF4 NormalizeVector2(SIMDVectorF4 const & rhs)
+#if defined(SIMD_MATH_AVX2)
+	// Runs 8 points a time through transform in SoA form. The tail is padded to 8, so every point goes through the same path.
+	template <typename Transform>
+	void TransformVector3Batch(float3* out, float3 const * in, size_t num, Transform const & transform)
+	{
+		for (size_t i = 0; i < num; i += 8)
 		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			__m128 temp = _mm_sqrt_ps(LengthSqVector2(rhs).Vec());
-			temp = _mm_rcp_ps(temp);
-			ret.Vec() = _mm_mul_ps(rhs.Vec(), temp);
-#else
-			ret = rhs * MathLib::recip_sqrt(GetX(LengthSqVector2(rhs)));
-#endif
-			return ret;
-		}
+			size_t const n = std::min<size_t>(num - i, 8);
 
-		SIMDVectorF4 TransformCoordVector2(SIMDVectorF4 const & v, SIMDMatrixF4 const & mat)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			__m128 temp = v.Vec();
-			__m128 res1 = _mm_mul_ps(_mm_shuffle_ps(temp, temp, _MM_SHUFFLE(0, 0, 0, 0)), mat.Row(0).Vec());
-			__m128 res2 = _mm_mul_ps(_mm_shuffle_ps(temp, temp, _MM_SHUFFLE(1, 1, 1, 1)), mat.Row(1).Vec());
-			res1 = _mm_add_ps(res1, res2);
-			res1 = _mm_add_ps(res1, mat.Row(3).Vec());
-			__m128 w = _mm_shuffle_ps(res1, res1, _MM_SHUFFLE(3, 3, 3, 3));
-			__m128 inv_w = _mm_rcp_ps(w);
-			ret.Vec() = _mm_mul_ps(res1, inv_w);
-#else
-			SIMDVectorF4 temp;
-			for (int i = 0; i < 4; ++ i)
-			{
-				temp.Vec()[i] = GetX(v) * mat(0, i) + GetY(v) * mat(1, i) + mat(3, i);
-			}
-			if (MathLib::equal(GetW(temp), 0.0f))
-			{
-				ret = SIMDVectorF4::Zero();
-			}
-			else
+			float3 padded[8];
+			float3 const * src = in + i;
+			if (n < 8)
 			{
-				for (int i = 0; i < 2; ++ i)
-				{
-					ret.Vec()[i] = temp.Vec()[i] / GetW(temp);
-				}
-				for (int i = 2; i < 4; ++ i)
-				{
-					ret.Vec()[i] = 0;
-				}
+				std::copy(src, src + n, padded);
+				std::fill(padded + n, padded + 8, float3(0, 0, 0));
+				src = padded;
 			}
-#endif
-			return ret;
-		}
 
-		SIMDVectorF4 TransformNormalVector2(SIMDVectorF4 const & v, SIMDMatrixF4 const & mat)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			__m128 temp = v.Vec();
-			__m128 res1 = _mm_mul_ps(_mm_shuffle_ps(temp, temp, _MM_SHUFFLE(0, 0, 0, 0)), mat.Row(0).Vec());
-			__m128 res2 = _mm_mul_ps(_mm_shuffle_ps(temp, temp, _MM_SHUFFLE(1, 1, 1, 1)), mat.Row(1).Vec());
-			ret.Vec() = _mm_add_ps(res1, res2);
-#else
-			for (int i = 0; i < 2; ++ i)
-			{
-				ret.Vec()[i] = GetX(v) * mat(0, i) + GetY(v) * mat(1, i);
-			}
-			for (int i = 2; i < 4; ++ i)
+			SIMDVectorF8 x, y, z;
+			__m256i const index = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+			x.Vec() = _mm256_i32gather_ps(src->data() + 0, index, 4);
+			y.Vec() = _mm256_i32gather_ps(src->data() + 1, index, 4);
+			z.Vec() = _mm256_i32gather_ps(src->data() + 2, index, 4);
+
+			transform(x, y, z);
+
+			float rx[8], ry[8], rz[8];
+			SIMDMathLib::StoreVector8(rx, x);
+			SIMDMathLib::StoreVector8(ry, y);
+			SIMDMathLib::StoreVector8(rz, z);
+			for (size_t j = 0; j < n; ++ j)
 			{
-				ret.Vec()[i] = 0;
+				out[i + j] = float3(rx[j], ry[j], rz[j]);
 			}
-#endif
-			return ret;
 		}
+	}
+#endif
+}
 
-		// 3D Vector
+namespace KlayGE
+{
+	namespace SIMDMathLib
+	{
+		// General Vector
 		///////////////////////////////////////////////////////////////////////////////
-		SIMDVectorF4 Angle(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
+		SIMDVectorF4 BaryCentric(SIMDVectorF4 const & v1, SIMDVectorF4 const & v2, SIMDVectorF4 const & v3,
+			float f, float g)
 		{
-			return SetVector(MathLib::acos(GetX(DotVector3(lhs, rhs) / (LengthVector3(lhs) * LengthVector3(rhs)))));
+			return (1 - f - g) * v1 + f * v2 + g * v3;
 		}
 
-		SIMDVectorF4 CrossVector3(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
+		SIMDVectorF4 CatmullRom(SIMDVectorF4 const & v0, SIMDVectorF4 const & v1,
+			SIMDVectorF4 const & v2, SIMDVectorF4 const & v3, float s)
 		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			__m128 m1 = _mm_shuffle_ps(lhs.Vec(), lhs.Vec(), _MM_SHUFFLE(0, 0, 2, 1));
-			__m128 m2 = _mm_shuffle_ps(rhs.Vec(), rhs.Vec(), _MM_SHUFFLE(0, 1, 0, 2));
-			__m128 res1 = _mm_mul_ps(m1, m2);
-			m1 = _mm_shuffle_ps(lhs.Vec(), lhs.Vec(), _MM_SHUFFLE(0, 1, 0, 2));
-			m2 = _mm_shuffle_ps(rhs.Vec(), rhs.Vec(), _MM_SHUFFLE(0, 0, 2, 1));
-			__m128 res2 = _mm_mul_ps(m1, m2);
-			ret.Vec() = _mm_sub_ps(res1, res2);
-#else
-			ret = SetVector(GetY(lhs) * GetZ(rhs) - GetZ(lhs) * GetY(rhs),
-				GetZ(lhs) * GetX(rhs) - GetX(lhs) * GetZ(rhs),
-				GetX(lhs) * GetY(rhs) - GetY(lhs) * GetX(rhs),
-				0.0f);
-#endif
-			return ret;
+			float const s2 = s * s;
+			float const s3 = s2 * s;
+			return ((-s3 + 2 * s2 - s) * v0 + (3 * s3 - 5 * s2 + 2) * v1
+				+ (-3 * s3 + 4 * s2 + s) * v2 + (s3 - s2) * v3) * 0.5f;
 		}
 
-		SIMDVectorF4 DotVector3(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
+		SIMDVectorF4 CubicBezier(SIMDVectorF4 const & v0, SIMDVectorF4 const & v1,
+			SIMDVectorF4 const & v2, SIMDVectorF4 const & v3, float s)
 		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			__m128 res1 = lhs.Vec();
-			__m128 res2 = rhs.Vec();
-			res1 = _mm_mul_ps(res1, res2);
-			__m128 y = _mm_shuffle_ps(res1, res1, _MM_SHUFFLE(1, 1, 1, 1));
-			__m128 z = _mm_shuffle_ps(res1, res1, _MM_SHUFFLE(2, 2, 2, 2));
-			res1 = _mm_add_ps(res1, y);
-			res1 = _mm_add_ps(res1, z);
-			ret.Vec() = _mm_shuffle_ps(res1, res1, _MM_SHUFFLE(0, 0, 0, 0));
-#else
-			ret = SetVector(GetX(lhs) * GetX(rhs) + GetY(lhs) * GetY(rhs)
-				+ GetZ(lhs) * GetZ(rhs));
-#endif
-			return ret;
-		}
+			// From http://en.wikipedia.org/wiki/B%C3%A9zier_curve
 
-		SIMDVectorF4 LengthSqVector3(SIMDVectorF4 const & rhs)
-		{
-			return DotVector3(rhs, rhs);
+			float const s2 = s * s;
+			float const s3 = s2 * s;
+			return ((-s3 + 3 * s2 - 3 * s + 1) * v0 + (3 * s3 - 6 * s2 + 3 * s) * v1
+				+ (-3 * s3 + 3 * s2) * v2 + s3 * v3);
 		}
 
-		SIMDVectorF4 LengthVector3(SIMDVectorF4 const & rhs)
+		SIMDVectorF4 CubicBSpline(SIMDVectorF4 const & v0, SIMDVectorF4 const & v1,
+			SIMDVectorF4 const & v2, SIMDVectorF4 const & v3, float s)
 		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			ret.Vec() = _mm_sqrt_ps(LengthSqVector3(rhs).Vec());
-#else
-			ret = SetVector(sqrt(GetX(LengthSqVector3(rhs))));
-#endif
-			return ret;
+			// From http://en.wikipedia.org/wiki/B-spline
+
+			float const s2 = s * s;
+			float const s3 = s2 * s;
+			return ((-s3 + 3 * s2 - 3 * s + 1) * v0 + (3 * s3 - 6 * s2 + 4) * v1
+				+ (-3 * s3 + 3 * s2 + 3 * s + 1) * v2 + s3 * v3) / 6;
 		}
 
-		SIMDVectorF4 NormalizeVector3(SIMDVectorF4 const & rhs)
+		SIMDVectorF4 Hermite(SIMDVectorF4 const & v1, SIMDVectorF4 const & t1,
+			SIMDVectorF4 const & v2, SIMDVectorF4 const & t2, float s)
 		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			__m128 temp = _mm_sqrt_ps(LengthSqVector3(rhs).Vec());
-			temp = _mm_rcp_ps(temp);
-			ret.Vec() = _mm_mul_ps(rhs.Vec(), temp);
-#else
-			ret = rhs * MathLib::recip_sqrt(GetX(LengthSqVector3(rhs)));
-#endif
-			return ret;
+			float const s2 = s * s;
+			float const s3 = s2 * s;
+			float const h1 = 2 * s3 - 3 * s2 + 1;
+			float const h2 = s3 - 2 * s2 + s;
+			float const h3 = -2 * s3 + 3 * s2;
+			float const h4 = s3 - s2;
+			return h1 * v1 + h2 * t1 + h3 * v2 + h4 * t2;
 		}
 
-		SIMDVectorF4 TransformCoordVector3(SIMDVectorF4 const & v, SIMDMatrixF4 const & mat)
+		SIMDVectorF4 Reflect(SIMDVectorF4 const & incident, SIMDVectorF4 const & normal)
 		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			__m128 temp = v.Vec();
-			__m128 res1 = _mm_mul_ps(_mm_shuffle_ps(temp, temp, _MM_SHUFFLE(0, 0, 0, 0)), mat.Row(0).Vec());
-			__m128 res2 = _mm_mul_ps(_mm_shuffle_ps(temp, temp, _MM_SHUFFLE(1, 1, 1, 1)), mat.Row(1).Vec());
-			res1 = _mm_add_ps(res1, res2);
-			res2 = _mm_mul_ps(_mm_shuffle_ps(temp, temp, _MM_SHUFFLE(2, 2, 2, 2)), mat.Row(2).Vec());
-			res2 = _mm_add_ps(res2, mat.Row(3).Vec());
-			res1 = _mm_add_ps(res1, res2);
-			__m128 w = _mm_shuffle_ps(res1, res1, _MM_SHUFFLE(3, 3, 3, 3));
-			__m128 inv_w = _mm_rcp_ps(w);
-			ret.Vec() = _mm_mul_ps(res1, inv_w);
-#else
-			SIMDVectorF4 temp;
-			for (int i = 0; i < 4; ++ i)
-			{
-				temp.Vec()[i] = GetX(v) * mat(0, i) + GetY(v) * mat(1, i)
-					+ GetZ(v) * mat(2, i) + mat(3, i);
-			}
-			if (MathLib::equal(GetW(temp), 0.0f))
-			{
-				ret = SIMDVectorF4::Zero();
-			}
-			else
-			{
-				for (int i = 0; i < 3; ++ i)
-				{
-					ret.Vec()[i] = temp.Vec()[i] / GetW(temp);
-				}
-				for (int i = 3; i < 4; ++ i)
-				{
-					ret.Vec()[i] = 0;
-				}
-			}
-#endif
-			return ret;
+			return incident - 2 * DotVector3(incident, normal) * normal;
 		}
 
-		SIMDVectorF4 TransformNormalVector3(SIMDVectorF4 const & v, SIMDMatrixF4 const & mat)
+		SIMDVectorF4 Refract(SIMDVectorF4 const & incident, SIMDVectorF4 const & normal, float refraction_index)
 		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			__m128 temp = v.Vec();
-			__m128 res1 = _mm_mul_ps(_mm_shuffle_ps(temp, temp, _MM_SHUFFLE(0, 0, 0, 0)), mat.Row(0).Vec());
-			__m128 res2 = _mm_mul_ps(_mm_shuffle_ps(temp, temp, _MM_SHUFFLE(1, 1, 1, 1)), mat.Row(1).Vec());
-			res1 = _mm_add_ps(res1, res2);
-			res2 = _mm_mul_ps(_mm_shuffle_ps(temp, temp, _MM_SHUFFLE(2, 2, 2, 2)), mat.Row(2).Vec());
-			ret.Vec() = _mm_add_ps(res1, res2);
-#else
-			for (int i = 0; i < 3; ++ i)
+			float const t = GetX(DotVector3(incident, normal));
+			float const r = 1 - refraction_index * refraction_index * (1 - t * t);
+
+			if (r < 0)
 			{
-				ret.Vec()[i] = GetX(v) * mat(0, i) + GetY(v) * mat(1, i)
-					+ GetZ(v) * mat(2, i);
+				// Total internal reflection
+				return SIMDVectorF4::Zero();
 			}
-			for (int i = 3; i < 4; ++ i)
+			else
 			{
-				ret.Vec()[i] = 0;
+				float const s = refraction_index * t + sqrt(std::abs(r));
+				return refraction_index * incident - s * normal;
 			}
-#endif
-			return ret;
 		}
 
-		SIMDVectorF4 TransformQuat(SIMDVectorF4 const & v, SIMDVectorF4 const & quat)
+		// 3D Vector
+		///////////////////////////////////////////////////////////////////////////////
+		SIMDVectorF4 Angle(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
 		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			// TODO
-#endif
-			ret = v + CrossVector3(quat, CrossVector3(quat, v) + GetW(quat) * v) * 2;
-			return ret;
+			return SetVector(MathLib::acos(GetX(DotVector3(lhs, rhs) / (LengthVector3(lhs) * LengthVector3(rhs)))));
 		}
 
 		SIMDVectorF4 Project(SIMDVectorF4 const & vec,
@@ -914,180 +245,47 @@ namespace KlayGE
 			return ret;
 		}
 
-		SIMDVectorF4 DotVector4(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			__m128 res1 = lhs.Vec();
-			__m128 res2 = rhs.Vec();
-			res1 = _mm_mul_ps(res1, res2);
-			__m128 yw = _mm_shuffle_ps(res1, res1, _MM_SHUFFLE(1, 1, 3, 3));
-			res1 = _mm_add_ps(res1, yw);
-			__m128 zw = _mm_shuffle_ps(res1, res1, _MM_SHUFFLE(2, 2, 2, 2));
-			res1 = _mm_add_ps(res1, zw);
-			ret.Vec() = _mm_shuffle_ps(res1, res1, _MM_SHUFFLE(0, 0, 0, 0));
-#else
-			ret = SetVector(GetX(lhs) * GetX(rhs) + GetY(lhs) * GetY(rhs)
-				+ GetZ(lhs) * GetZ(rhs) + GetW(lhs) * GetW(rhs));
-#endif
-			return ret;
-		}
-
-		SIMDVectorF4 LengthSqVector4(SIMDVectorF4 const & rhs)
-		{
-			return DotVector4(rhs, rhs);
-		}
-
-		SIMDVectorF4 LengthVector4(SIMDVectorF4 const & rhs)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			ret.Vec() = _mm_sqrt_ps(LengthSqVector4(rhs).Vec());
-#else
-			ret = SetVector(sqrt(GetX(LengthSqVector4(rhs))));
-#endif
-			return ret;
-		}
-
-		SIMDVectorF4 NormalizeVector4(SIMDVectorF4 const & rhs)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			__m128 temp = _mm_sqrt_ps(LengthSqVector4(rhs).Vec());
-			temp = _mm_rcp_ps(temp);
-			ret.Vec() = _mm_mul_ps(rhs.Vec(), temp);
+		// 8-wide Vector
+		///////////////////////////////////////////////////////////////////////////////
+		// Without AVX2, SIMDVectorF8 is two SIMDVectorF4 halves, and going through SoA costs more than it saves. The points
+		// go through the 4-wide path one by one instead.
+		void TransformCoordVector3(float3* out, float3 const * in, size_t num, SIMDMatrixF4 const & mat)
+		{
+			SIMDMatrixF4 const m = mat;
+#if defined(SIMD_MATH_AVX2)
+			TransformVector3Batch(out, in, num,
+				[&m](SIMDVectorF8& x, SIMDVectorF8& y, SIMDVectorF8& z)
+				{
+					TransformCoordVector3(x, y, z, m);
+				});
 #else
-			ret = rhs * MathLib::recip_sqrt(GetX(LengthSqVector4(rhs)));
+			for (size_t i = 0; i < num; ++ i)
+			{
+				SIMDVectorF4 const v = TransformVector4(SetVector(in[i].x(), in[i].y(), in[i].z(), 1), m);
+				StoreVector3(out[i], v / SetVector(GetW(v)));
+			}
 #endif
-			return ret;
 		}
 
-		SIMDVectorF4 TransformVector4(SIMDVectorF4 const & v, SIMDMatrixF4 const & mat)
+		void TransformNormalVector3(float3* out, float3 const * in, size_t num, SIMDMatrixF4 const & mat)
 		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			__m128 temp = v.Vec();
-			__m128 res1 = _mm_mul_ps(_mm_shuffle_ps(temp, temp, _MM_SHUFFLE(0, 0, 0, 0)), mat.Row(0).Vec());
-			__m128 res2 = _mm_mul_ps(_mm_shuffle_ps(temp, temp, _MM_SHUFFLE(1, 1, 1, 1)), mat.Row(1).Vec());
-			res1 = _mm_add_ps(res1, res2);
-			res2 = _mm_mul_ps(_mm_shuffle_ps(temp, temp, _MM_SHUFFLE(2, 2, 2, 2)), mat.Row(2).Vec());
-			res1 = _mm_add_ps(res1, res2);
-			res2 = _mm_mul_ps(_mm_shuffle_ps(temp, temp, _MM_SHUFFLE(3, 3, 3, 3)), mat.Row(3).Vec());
-			ret.Vec() = _mm_add_ps(res1, res2);
+			SIMDMatrixF4 const m = mat;
+#if defined(SIMD_MATH_AVX2)
+			TransformVector3Batch(out, in, num,
+				[&m](SIMDVectorF8& x, SIMDVectorF8& y, SIMDVectorF8& z)
+				{
+					TransformNormalVector3(x, y, z, m);
+				});
 #else
-			for (int i = 0; i < 4; ++ i)
+			for (size_t i = 0; i < num; ++ i)
 			{
-				ret.Vec()[i] = GetX(v) * mat(0, i) + GetY(v) * mat(1, i)
-					+ GetZ(v) * mat(2, i) + GetW(v) * mat(3, i);
+				StoreVector3(out[i], TransformNormalVector3(LoadVector3(in[i]), m));
 			}
 #endif
-			return ret;
 		}
 
 		// 4D Matrix
 		///////////////////////////////////////////////////////////////////////////////
-		SIMDMatrixF4 Add(SIMDMatrixF4 const & lhs, SIMDMatrixF4 const & rhs)
-		{
-			return SIMDMatrixF4(Add(lhs.Row(0), rhs.Row(0)),
-				Add(lhs.Row(1), rhs.Row(1)),
-				Add(lhs.Row(2), rhs.Row(2)),
-				Add(lhs.Row(3), rhs.Row(3)));
-		}
-
-		SIMDMatrixF4 Substract(SIMDMatrixF4 const & lhs, SIMDMatrixF4 const & rhs)
-		{
-			return SIMDMatrixF4(Substract(lhs.Row(0), rhs.Row(0)),
-				Substract(lhs.Row(1), rhs.Row(1)),
-				Substract(lhs.Row(2), rhs.Row(2)),
-				Substract(lhs.Row(3), rhs.Row(3)));
-		}
-#if defined(SIMD_MATH_SSE)
-		#define GetVector(v, i) _mm_shuffle_ps(v, v, _MM_SHUFFLE(i, i, i, i))
-#endif
-
-		SIMDMatrixF4 Multiply(SIMDMatrixF4 const & lhs, SIMDMatrixF4 const & rhs)
-		{
-#if defined(SIMD_MATH_SSE)
-			V4TYPE const & l0 = lhs.Row(0).Vec();
-			V4TYPE const & l1 = lhs.Row(1).Vec();
-			V4TYPE const & l2 = lhs.Row(2).Vec();
-			V4TYPE const & l3 = lhs.Row(3).Vec();
-
-			V4TYPE const & t0 = rhs.Row(0).Vec();
-			V4TYPE const & t1 = rhs.Row(1).Vec();
-			V4TYPE const & t2 = rhs.Row(2).Vec();
-			V4TYPE const & t3 = rhs.Row(3).Vec();
-
-			SIMDVectorF4 row1;			
-			SIMDVectorF4 row2;			
-			SIMDVectorF4 row3;	
-			SIMDVectorF4 row4;
-			row1.Vec() = _mm_mul_ps(t0, GetVector(l0, 0));
-			row2.Vec() = _mm_mul_ps(t0, GetVector(l1, 0));
-			row3.Vec() = _mm_mul_ps(t0, GetVector(l2, 0));
-			row4.Vec() = _mm_mul_ps(t0, GetVector(l3, 0));
-
-			row1.Vec() = _mm_add_ps(row1.Vec(), _mm_mul_ps(t1, GetVector(l0, 1)));
-			row2.Vec() = _mm_add_ps(row2.Vec(), _mm_mul_ps(t1, GetVector(l1, 1)));
-			row3.Vec() = _mm_add_ps(row3.Vec(), _mm_mul_ps(t1, GetVector(l2, 1)));
-			row4.Vec() = _mm_add_ps(row4.Vec(), _mm_mul_ps(t1, GetVector(l3, 1)));
-
-			row1.Vec() = _mm_add_ps(row1.Vec(), _mm_mul_ps(t2, GetVector(l0, 2)));
-			row2.Vec() = _mm_add_ps(row2.Vec(), _mm_mul_ps(t2, GetVector(l1, 2)));
-			row3.Vec() = _mm_add_ps(row3.Vec(), _mm_mul_ps(t2, GetVector(l2, 2)));
-			row4.Vec() = _mm_add_ps(row4.Vec(), _mm_mul_ps(t2, GetVector(l3, 2)));
-
-			row1.Vec() = _mm_add_ps(row1.Vec(), _mm_mul_ps(t3, GetVector(l0, 3)));
-			row2.Vec() = _mm_add_ps(row2.Vec(), _mm_mul_ps(t3, GetVector(l1, 3)));
-			row3.Vec() = _mm_add_ps(row3.Vec(), _mm_mul_ps(t3, GetVector(l2, 3)));
-			row4.Vec() = _mm_add_ps(row4.Vec(), _mm_mul_ps(t3, GetVector(l3, 3)));
-
-			return SIMDMatrixF4(row1, row2,row3,row4);
-#else
-			SIMDMatrixF4 const tmp = Transpose(rhs);
-
-			V4TYPE const & l0 = lhs.Row(0).Vec();
-			V4TYPE const & l1 = lhs.Row(1).Vec();
-			V4TYPE const & l2 = lhs.Row(2).Vec();
-			V4TYPE const & l3 = lhs.Row(3).Vec();
-
-			V4TYPE const & t0 = tmp.Row(0).Vec();
-			V4TYPE const & t1 = tmp.Row(1).Vec();
-			V4TYPE const & t2 = tmp.Row(2).Vec();
-			V4TYPE const & t3 = tmp.Row(3).Vec();
-
-			return SIMDMatrixF4(
-				l0[0] * t0[0] + l0[1] * t0[1] + l0[2] * t0[2] + l0[3] * t0[3],
-				l0[0] * t1[0] + l0[1] * t1[1] + l0[2] * t1[2] + l0[3] * t1[3],
-				l0[0] * t2[0] + l0[1] * t2[1] + l0[2] * t2[2] + l0[3] * t2[3],
-				l0[0] * t3[0] + l0[1] * t3[1] + l0[2] * t3[2] + l0[3] * t3[3],
-
-				l1[0] * t0[0] + l1[1] * t0[1] + l1[2] * t0[2] + l1[3] * t0[3],
-				l1[0] * t1[0] + l1[1] * t1[1] + l1[2] * t1[2] + l1[3] * t1[3],
-				l1[0] * t2[0] + l1[1] * t2[1] + l1[2] * t2[2] + l1[3] * t2[3],
-				l1[0] * t3[0] + l1[1] * t3[1] + l1[2] * t3[2] + l1[3] * t3[3],
-
-				l2[0] * t0[0] + l2[1] * t0[1] + l2[2] * t0[2] + l2[3] * t0[3],
-				l2[0] * t1[0] + l2[1] * t1[1] + l2[2] * t1[2] + l2[3] * t1[3],
-				l2[0] * t2[0] + l2[1] * t2[1] + l2[2] * t2[2] + l2[3] * t2[3],
-				l2[0] * t3[0] + l2[1] * t3[1] + l2[2] * t3[2] + l2[3] * t3[3],
-
-				l3[0] * t0[0] + l3[1] * t0[1] + l3[2] * t0[2] + l3[3] * t0[3],
-				l3[0] * t1[0] + l3[1] * t1[1] + l3[2] * t1[2] + l3[3] * t1[3],
-				l3[0] * t2[0] + l3[1] * t2[1] + l3[2] * t2[2] + l3[3] * t2[3],
-				l3[0] * t3[0] + l3[1] * t3[1] + l3[2] * t3[2] + l3[3] * t3[3]);
-#endif
-		}
-
-		SIMDMatrixF4 Multiply(SIMDMatrixF4 const & lhs, float rhs)
-		{
-			SIMDVectorF4 r = SetVector(rhs, rhs, rhs, rhs);
-			return SIMDMatrixF4(Multiply(lhs.Row(0), r),
-				Multiply(lhs.Row(1), r),
-				Multiply(lhs.Row(2), r),
-				Multiply(lhs.Row(3), r));
-		}
-
 		SIMDVectorF4 Determinant(SIMDMatrixF4 const & rhs)
 		{
 			SIMDVectorF4 ret;
@@ -1152,25 +350,14 @@ namespace KlayGE
 			float const _3244_3442 = rhs(2, 1) * rhs(3, 3) - rhs(2, 3) * rhs(3, 1);
 			float const _3344_3443 = rhs(2, 2) * rhs(3, 3) - rhs(2, 3) * rhs(3, 2);
 
-			ret.Vec()[0] = rhs(0, 0) * (rhs(1, 1) * _3344_3443 - rhs(1, 2) * _3244_3442 + rhs(1, 3) * _3243_3342)
+			ret = SetVector(rhs(0, 0) * (rhs(1, 1) * _3344_3443 - rhs(1, 2) * _3244_3442 + rhs(1, 3) * _3243_3342)
 				- rhs(0, 1) * (rhs(1, 0) * _3344_3443 - rhs(1, 2) * _3144_3441 + rhs(1, 3) * _3143_3341)
 				+ rhs(0, 2) * (rhs(1, 0) * _3244_3442 - rhs(1, 1) * _3144_3441 + rhs(1, 3) * _3142_3241)
-				- rhs(0, 3) * (rhs(1, 0) * _3243_3342 - rhs(1, 1) * _3143_3341 + rhs(1, 2) * _3142_3241);
-			ret.Vec()[1] = ret.Vec()[0];
-			ret.Vec()[2] = ret.Vec()[0];
-			ret.Vec()[3] = ret.Vec()[0];
+				- rhs(0, 3) * (rhs(1, 0) * _3243_3342 - rhs(1, 1) * _3143_3341 + rhs(1, 2) * _3142_3241));
 #endif
 			return ret;
 		}
 
-		SIMDMatrixF4 Negative(SIMDMatrixF4 const & rhs)
-		{
-			return SIMDMatrixF4(Negative(rhs.Row(0)),
-				Negative(rhs.Row(1)),
-				Negative(rhs.Row(2)),
-				Negative(rhs.Row(3)));
-		}
-
 		SIMDMatrixF4 Inverse(SIMDMatrixF4 const & rhs)
 		{
 			SIMDMatrixF4 ret;
@@ -1602,32 +789,6 @@ namespace KlayGE
 			return Translation(GetX(pos), GetY(pos), GetZ(pos));
 		}
 
-		SIMDMatrixF4 Transpose(SIMDMatrixF4 const & rhs)
-		{
-#if defined(SIMD_MATH_SSE)
-			SIMDVectorF4 r0;
-			SIMDVectorF4 r1;
-			SIMDVectorF4 r2;
-			SIMDVectorF4 r3;
-			r0.Vec() = rhs.Row(0).Vec();
-			r1.Vec() = rhs.Row(1).Vec();
-			r2.Vec() = rhs.Row(2).Vec();
-			r3.Vec() = rhs.Row(3).Vec();
-			_MM_TRANSPOSE4_PS(r0.Vec(), r1.Vec(), r2.Vec(), r3.Vec());
-			return SIMDMatrixF4(r0, r1, r2, r3);
-#else
-			V4TYPE const & r0 = rhs.Row(0).Vec();
-			V4TYPE const & r1 = rhs.Row(1).Vec();
-			V4TYPE const & r2 = rhs.Row(2).Vec();
-			V4TYPE const & r3 = rhs.Row(3).Vec();
-			return SIMDMatrixF4(
-				r0[0], r1[0], r2[0], r3[0],
-				r0[1], r1[1], r2[1], r3[1],
-				r0[2], r1[2], r2[2], r3[2],
-				r0[3], r1[3], r2[3], r3[3]);
-#endif
-		}
-
 		SIMDMatrixF4 LHToRH(SIMDMatrixF4 const & rhs)
 		{
 			SIMDMatrixF4 ret = rhs;
@@ -1649,23 +810,16 @@ namespace KlayGE
 
 			trans = SetVector(rhs(3, 0), rhs(3, 1), rhs(3, 2), 0);
 
-			SIMDMatrixF4 rot_mat;
+			SIMDMatrixF4 rot_mat = SIMDMatrixF4::Identity();
 			rot_mat.Set(0, 0, rhs(0, 0) / GetX(scale));
 			rot_mat.Set(0, 1, rhs(0, 1) / GetX(scale));
 			rot_mat.Set(0, 2, rhs(0, 2) / GetX(scale));
-			rot_mat.Set(0, 3, 0);
 			rot_mat.Set(1, 0, rhs(1, 0) / GetY(scale));
 			rot_mat.Set(1, 1, rhs(1, 1) / GetY(scale));
 			rot_mat.Set(1, 2, rhs(1, 2) / GetY(scale));
-			rot_mat.Set(1, 3, 0);
 			rot_mat.Set(2, 0, rhs(2, 0) / GetZ(scale));
 			rot_mat.Set(2, 1, rhs(2, 1) / GetZ(scale));
 			rot_mat.Set(2, 2, rhs(2, 2) / GetZ(scale));
-			rot_mat.Set(2, 3, 0);
-			rot_mat.Set(3, 0, 0);
-			rot_mat.Set(3, 1, 0);
-			rot_mat.Set(3, 2, 0);
-			rot_mat.Set(3, 3, 1);
 			rot = ToQuaternion(rot_mat);
 		}
 
@@ -1733,11 +887,6 @@ namespace KlayGE
 
 		// Quaternion
 		///////////////////////////////////////////////////////////////////////////////
-		SIMDVectorF4 Conjugate(SIMDVectorF4 const & rhs)
-		{
-			return SetVector(-GetX(rhs), -GetY(rhs), -GetZ(rhs), GetW(rhs));
-		}
-
 		SIMDVectorF4 AxisToAxis(SIMDVectorF4 const & from, SIMDVectorF4 const & to)
 		{
 			SIMDVectorF4 const a = NormalizeVector3(from);
@@ -1806,15 +955,6 @@ namespace KlayGE
 			return SetVector(-GetX(rhs), -GetY(rhs), -GetZ(rhs), GetW(rhs)) * inv;
 		}
 
-		SIMDVectorF4 MultiplyQuat(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
-		{
-			return SetVector(
-				GetX(lhs) * GetW(rhs) - GetY(lhs) * GetZ(rhs) + GetZ(lhs) * GetY(rhs) + GetW(lhs) * GetX(rhs),
-				GetX(lhs) * GetZ(rhs) + GetY(lhs) * GetW(rhs) - GetZ(lhs) * GetX(rhs) + GetW(lhs) * GetY(rhs),
-				GetY(lhs) * GetX(rhs) - GetX(lhs) * GetY(rhs) + GetZ(lhs) * GetW(rhs) + GetW(lhs) * GetZ(rhs),
-				GetW(lhs) * GetW(rhs) - GetX(lhs) * GetX(rhs) - GetY(lhs) * GetY(rhs) - GetZ(lhs) * GetZ(rhs));
-		}
-
 		SIMDVectorF4 RotationAxis(SIMDVectorF4 const & v, float angle)
 		{
 			float sa, ca;
@@ -2088,23 +1228,60 @@ namespace KlayGE
 			return Slerp(Slerp(q1, c, t), Slerp(a, b, t), 2 * t * (1 - t));
 		}
 
-		// Plane
+		// Dual quaternion
 		///////////////////////////////////////////////////////////////////////////////
-		SIMDVectorF4 DotPlane(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
+		std::pair<SIMDVectorF4, SIMDVectorF4> InverseDual(SIMDVectorF4 const & real, SIMDVectorF4 const & dual)
 		{
-			return DotVector4(lhs, rhs);
+			float const sqr_len_0 = GetX(DotVector4(real, real));
+			float const sqr_len_e = 2.0f * GetX(DotVector4(real, dual));
+			float const inv_sqr_len_0 = 1.0f / sqr_len_0;
+			float const inv_sqr_len_e = -sqr_len_e / (sqr_len_0 * sqr_len_0);
+			SIMDVectorF4 const conj_real = Conjugate(real);
+			SIMDVectorF4 const conj_dual = Conjugate(dual);
+			return std::make_pair(conj_real * inv_sqr_len_0, conj_dual * inv_sqr_len_0 + conj_real * inv_sqr_len_e);
 		}
 
-		SIMDVectorF4 DotCoord(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
+		std::pair<SIMDVectorF4, SIMDVectorF4> Sclerp(SIMDVectorF4 const & lhs_real, SIMDVectorF4 const & lhs_dual,
+			SIMDVectorF4 const & rhs_real, SIMDVectorF4 const & rhs_dual, float s)
 		{
-			return DotVector4(lhs, SetW(rhs, 1));
-		}
+			// Make sure dot product is >= 0
+			SIMDVectorF4 to_sign_corrected_real = rhs_real;
+			SIMDVectorF4 to_sign_corrected_dual = rhs_dual;
+			if (GetX(DotVector4(lhs_real, rhs_real)) < 0)
+			{
+				to_sign_corrected_real = -to_sign_corrected_real;
+				to_sign_corrected_dual = -to_sign_corrected_dual;
+			}
 
-		SIMDVectorF4 DotNormal(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
-		{
-			return DotVector4(lhs, SetW(rhs, 0));
+			std::pair<SIMDVectorF4, SIMDVectorF4> dif_dq = InverseDual(lhs_real, lhs_dual);
+			dif_dq.second = MultiplyDual(dif_dq.first, dif_dq.second, to_sign_corrected_real, to_sign_corrected_dual);
+			dif_dq.first = MultiplyQuat(dif_dq.first, to_sign_corrected_real);
+
+			// The screw math is scalar, it's shared with MathLib::sclerp
+			Quaternion real;
+			Quaternion dual;
+			StoreVector4(&real[0], dif_dq.first);
+			StoreVector4(&dual[0], dif_dq.second);
+
+			float angle, pitch;
+			float3 dir, moment;
+			MathLib::udq_to_screw(angle, pitch, dir, moment, real, dual);
+
+			angle *= s;
+			pitch *= s;
+			std::tie(real, dual) = MathLib::udq_from_screw(angle, pitch, dir, moment);
+			dif_dq.first = LoadVector4(&real[0]);
+			dif_dq.second = LoadVector4(&dual[0]);
+
+			dif_dq.second = MultiplyDual(lhs_real, lhs_dual, dif_dq.first, dif_dq.second);
+			dif_dq.first = MultiplyQuat(lhs_real, dif_dq.first);
+
+			return dif_dq;
 		}
 
+
+		// Plane
+		///////////////////////////////////////////////////////////////////////////////
 		SIMDVectorF4 FromPointNormal(SIMDVectorF4 const & point, SIMDVectorF4 const & normal)
 		{
 			return SetW(normal, -GetX(DotVector3(point, normal)));
@@ -2154,20 +1331,5 @@ namespace KlayGE
 			float const c = 1 / GetX(DotPlane(clip_plane, q));
 			proj.Col(2, clip_plane * SetVector(c));
 		}
-
-		// Color
-		///////////////////////////////////////////////////////////////////////////////
-		SIMDVectorF4 NegativeColor(SIMDVectorF4 const & rhs)
-		{
-			SIMDVectorF4 ret;
-			ret = SetVector(1) - rhs;
-			ret = SetW(ret, GetW(rhs));
-			return ret;
-		}
-
-		SIMDVectorF4 ModulateColor(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
-		{
-			return lhs * rhs;
-		}
 	}
 }
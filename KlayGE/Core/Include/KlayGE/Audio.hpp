@@ -36,7 +36,15 @@
 #include <KlayGE/PreDeclare.hpp>
 #include <KFL/Vector.hpp>
 
+#include <chrono>
+#include <condition_variable>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <vector>
+
+#include <KFL/Thread.hpp>
 
 #include <KlayGE/AudioDataSource.hpp>
 
@@ -92,8 +100,11 @@ namespace KlayGE
 
 	class KLAYGE_CORE_API MusicBuffer : public AudioBuffer
 	{
+		friend class AudioStreamer;
+
 	public:
-		explicit MusicBuffer(AudioDataSourcePtr const & data_source);
+		// The buffer is serviced by the audio engine's streamer, unless another one is given
+		MusicBuffer(AudioDataSourcePtr const & data_source, uint32_t buffer_seconds, AudioStreamer* streamer = nullptr);
 		~MusicBuffer() override;
 
 		void Play(bool loop = false) override;
@@ -107,7 +118,80 @@ namespace KlayGE
 		virtual void DoPlay(bool loop) = 0;
 		virtual void DoStop() = 0;
 
+		// Called on the streaming thread to feed the device from the decoded data. Returns false once everything is played,
+		// otherwise sets how long it can wait before the next update.
+		virtual bool DoUpdate(std::chrono::milliseconds& next_update) = 0;
+
+		// The decoded data is only touched by the streaming thread while the buffer is playing,
+		// and by the owner thread after it's stopped.
+		void Decode();
+		size_t ReadDecoded(void* data, size_t size);
+		void ResetDecoded();
+		bool EndOfStream() const;
+
+		AudioStreamer& Streamer() const;
+
 		static uint32_t constexpr BUFFERS_PER_SECOND = 2;
+
+	protected:
+		bool loop_;
+		uint32_t buffer_size_;
+
+	private:
+		bool Update(std::chrono::milliseconds& next_update);
+
+	private:
+		AudioStreamer* streamer_;
+
+		std::vector<uint8_t> decoded_;
+		size_t decoded_start_;
+		size_t decoded_size_;
+		bool source_end_;
+	};
+
+	// Streams all the playing music buffers on one thread. A buffer is updated when its deadline comes,
+	// or earlier if the device wakes it up.
+	class KLAYGE_CORE_API AudioStreamer : boost::noncopyable
+	{
+	public:
+		AudioStreamer();
+		~AudioStreamer();
+
+		void Add(MusicBuffer& buffer);
+		// Waits until the buffer is not being updated
+		void Remove(MusicBuffer& buffer);
+		void Wake(MusicBuffer& buffer);
+
+		size_t NumBuffers() const;
+
+	private:
+		void ThreadFunc();
+
+	private:
+		struct Task
+		{
+			std::chrono::steady_clock::time_point due;
+			MusicBuffer* buffer;
+
+			bool operator<(Task const & rhs) const
+			{
+				// The earliest comes to the top
+				return due > rhs.due;
+			}
+		};
+
+		mutable std::mutex mutex_;
+		std::condition_variable cond_;
+		std::condition_variable updated_cond_;
+
+		std::priority_queue<Task> tasks_;
+		// The time each buffer is due. Tasks that don't match it are stale.
+		std::map<MusicBuffer*, std::chrono::steady_clock::time_point> due_;
+		MusicBuffer* updating_;
+
+		bool quit_;
+		bool started_;
+		joiner<void> thread_;
 	};
 
 	class KLAYGE_CORE_API AudioEngine : boost::noncopyable
@@ -136,6 +220,8 @@ namespace KlayGE
 		void  MusicVolume(float vol);
 		float MusicVolume() const;
 
+		AudioStreamer& Streamer();
+
 		virtual float3 GetListenerPos() const = 0;
 		virtual void SetListenerPos(float3 const & v) = 0;
 		virtual float3 GetListenerVel() const = 0;
@@ -152,6 +238,8 @@ namespace KlayGE
 
 		float sound_vol_;
 		float music_vol_;
+
+		std::unique_ptr<AudioStreamer> streamer_;
 	};
 }
 
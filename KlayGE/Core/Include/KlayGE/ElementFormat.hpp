@@ -673,6 +673,9 @@ namespace KlayGE
 
 	KLAYGE_CORE_API void ConvertToABGR32F(ElementFormat fmt, void const * input, uint32_t num_elems, Color* output);
 	KLAYGE_CORE_API void ConvertFromABGR32F(ElementFormat fmt, Color const * input, uint32_t num_elems, void* output);
+	// Same results as ConvertToABGR32F followed by ConvertFromABGR32F, but 8-bit unorm pairs skip the float intermediate
+	KLAYGE_CORE_API void ConvertFormat(ElementFormat src_fmt, ElementFormat dst_fmt, void const * input, uint32_t num_elems,
+		void* output);
 
 
 	enum ElementAccessHint
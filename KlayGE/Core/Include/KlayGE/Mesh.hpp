@@ -28,10 +28,12 @@
 #pragma once
 
 #include <KlayGE/PreDeclare.hpp>
+#include <KFL/ArrayRef.hpp>
 #include <KFL/CXX17/string_view.hpp>
 #include <KlayGE/Renderable.hpp>
 #include <KlayGE/RenderLayout.hpp>
 #include <KFL/Math.hpp>
+#include <KFL/SIMDMath.hpp>
 #include <KlayGE/SceneNode.hpp>
 
 #include <string>
@@ -252,6 +254,10 @@ namespace KlayGE
 		std::vector<float> bind_scale;
 
 		std::tuple<Quaternion, Quaternion, float> Frame(float frame) const;
+		// The cursor keeps the key frame used last time. When the frame only moves forward, the next key frame is found
+		// without a search.
+		std::tuple<Quaternion, Quaternion, float> Frame(float frame, uint32_t& cursor) const;
+		void Frame(float frame, uint32_t& cursor, SIMDVectorF4& real, SIMDVectorF4& dual, float& scale) const;
 	};
 
 	struct KLAYGE_CORE_API AABBKeyFrameSet
@@ -337,6 +343,8 @@ namespace KlayGE
 
 		float GetFrame() const;
 		void SetFrame(float frame);
+		// Sets the frames of many models. The skeletons are evaluated in parallel, so a model can appear only once.
+		static void SetFrames(ArrayRef<SkinnedModel*> models, ArrayRef<float> frames);
 
 		void RebindJoints();
 		void UnbindJoints();
@@ -354,12 +362,23 @@ namespace KlayGE
 	protected:
 		void BuildBones(float frame);
 		void UpdateBinds();
+		void ComposeBinds();
 
 	protected:
 		std::vector<Joint> joints_;
 		std::vector<float4> bind_reals_;
 		std::vector<float4> bind_duals_;
 
+		// The joints in SoA layout. The animation works on these, and copies the poses back to joints_.
+		std::vector<int16_t> joint_parents_;
+		std::vector<SIMDVectorF4> inverse_origin_reals_;
+		std::vector<SIMDVectorF4> inverse_origin_duals_;
+		std::vector<float> inverse_origin_scales_;
+		std::vector<SIMDVectorF4> pose_reals_;
+		std::vector<SIMDVectorF4> pose_duals_;
+		std::vector<float> pose_scales_;
+		std::vector<uint32_t> key_frame_cursors_;
+
 		std::shared_ptr<std::vector<KeyFrameSet>> key_frame_sets_;
 		float last_frame_;
 
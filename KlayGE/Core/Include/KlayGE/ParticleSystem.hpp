@@ -55,6 +55,56 @@ namespace KlayGE
 		float init_life;
 	};
 
+	// A contiguous range of particles in the structure-of-arrays store of a ParticleSystem
+	struct ParticleBatch
+	{
+		float* pos_x;
+		float* pos_y;
+		float* pos_z;
+		float* vel_x;
+		float* vel_y;
+		float* vel_z;
+		float* life;
+		float* spin;
+		float* size;
+		float* alpha;
+		float* init_life;
+
+		uint32_t num_particles;
+
+		Particle Get(uint32_t i) const
+		{
+			BOOST_ASSERT(i < num_particles);
+
+			Particle par;
+			par.pos = float3(pos_x[i], pos_y[i], pos_z[i]);
+			par.vel = float3(vel_x[i], vel_y[i], vel_z[i]);
+			par.life = life[i];
+			par.spin = spin[i];
+			par.size = size[i];
+			par.alpha = alpha[i];
+			par.init_life = init_life[i];
+			return par;
+		}
+
+		void Set(uint32_t i, Particle const & par) const
+		{
+			BOOST_ASSERT(i < num_particles);
+
+			pos_x[i] = par.pos.x();
+			pos_y[i] = par.pos.y();
+			pos_z[i] = par.pos.z();
+			vel_x[i] = par.vel.x();
+			vel_y[i] = par.vel.y();
+			vel_z[i] = par.vel.z();
+			life[i] = par.life;
+			spin[i] = par.spin;
+			size[i] = par.size;
+			alpha[i] = par.alpha;
+			init_life[i] = par.init_life;
+		}
+	};
+
 	class KLAYGE_CORE_API ParticleEmitter
 	{
 	public:
@@ -216,6 +266,9 @@ namespace KlayGE
 		virtual ParticleUpdaterPtr Clone() = 0;
 
 		virtual void Update(Particle& par, float elapse_time) = 0;
+		// Updates the alive particles in a batch. It's called concurrently on disjoint batches after SnapParams.
+		// The default one goes through Update one particle at a time.
+		virtual void UpdateBatch(ParticleBatch const & batch, float elapse_time);
 		virtual void SnapParams() = 0;
 
 	protected:
@@ -291,20 +344,13 @@ namespace KlayGE
 
 		uint32_t NumParticles() const
 		{
-			return static_cast<uint32_t>(particles_.size());
+			return num_particles_;
 		}
 		uint32_t NumActiveParticles() const;
 		uint32_t GetActiveParticleIndex(uint32_t i) const;
-		Particle const & GetParticle(uint32_t i) const
-		{
-			BOOST_ASSERT(i < particles_.size());
-			return particles_[i];
-		}
-		Particle& GetParticle(uint32_t i)
-		{
-			BOOST_ASSERT(i < particles_.size());
-			return particles_[i];
-		}
+		Particle GetParticle(uint32_t i) const;
+		void SetParticle(uint32_t i, Particle const & par);
+		ParticleBatch ParticleRange(uint32_t first, uint32_t num);
 		void ClearParticles();
 
 		void ParticleAlphaFromTex(std::string const & tex_name);
@@ -330,17 +376,39 @@ namespace KlayGE
 
 		void SceneDepthTexture(TexturePtr const & depth_tex);
 
+	private:
+		struct SimulationChunk
+		{
+			std::vector<std::pair<uint32_t, float>> actived_particles;
+			std::vector<uint32_t> free_particles;
+			float3 min_bb;
+			float3 max_bb;
+		};
+
 	private:
 		void UpdateParticlesNoLock(float elapsed_time);
+		void SimulateChunk(SimulationChunk& chunk, uint32_t first, uint32_t last, float elapsed_time);
+		void ActivateParticle(SimulationChunk& chunk, uint32_t index);
 		void UpdateParticleBufferNoLock();
 
 	protected:
 		std::vector<ParticleEmitterPtr> emitters_;
 		std::vector<ParticleUpdaterPtr> updaters_;
 
-		std::vector<Particle> particles_;
+		// One array per attribute, each has num_particles_ elements
+		uint32_t num_particles_;
+		std::vector<float> particle_attribs_;
+
 		std::vector<std::pair<uint32_t, float>> actived_particles_;
 		mutable std::mutex actived_particles_mutex_;
+		// The sub thread simulates, the main thread gives the result to the renderable
+		AABBox actived_particles_aabb_;
+		bool actived_particles_dirty_;
+
+		std::vector<SimulationChunk> simulation_chunks_;
+		std::vector<std::pair<uint32_t, float>> sort_scratch_;
+		float4 depth_z_row_;
+		float4 depth_w_row_;
 
 		float gravity_;
 		float3 force_;
@@ -417,8 +485,30 @@ namespace KlayGE
 		}
 
 		void Update(Particle& par, float elapse_time) override;
+		void UpdateBatch(ParticleBatch const & batch, float elapse_time) override;
 		void SnapParams() override;
 
+	private:
+		// A polyline is stored as its first point and the slope before it, plus one ramp per segment, so it can be
+		// evaluated without branches
+		struct PolylineRamp
+		{
+			float x;
+			float inv_width;
+			float dy;
+		};
+
+		struct Polyline
+		{
+			float x0;
+			float y0;
+			float slope0;
+			std::vector<PolylineRamp> ramps;
+		};
+
+		static void BuildPolyline(Polyline& polyline, std::vector<float2> const & ctrl_points);
+		static float EvaluatePolyline(Polyline const & polyline, float x);
+
 	private:
 		std::mutex update_mutex_;
 
@@ -426,9 +516,9 @@ namespace KlayGE
 		std::vector<float2> mass_over_life_;
 		std::vector<float2> opacity_over_life_;
 
-		std::vector<float2> this_frame_size_over_life_;
-		std::vector<float2> this_frame_mass_over_life_;
-		std::vector<float2> this_frame_opacity_over_life_;
+		Polyline this_frame_size_over_life_;
+		Polyline this_frame_mass_over_life_;
+		Polyline this_frame_opacity_over_life_;
 	};
 }
 
@@ -36,16 +36,36 @@
 #include <KlayGE/PreDeclare.hpp>
 #include <KFL/Timer.hpp>
 
+#include <atomic>
+#include <chrono>
 #include <map>
+#include <mutex>
+#include <ostream>
 #include <string>
 #include <tuple>
 
 namespace KlayGE
 {
+	class PerfThreadBuffer;
+
+	// A scope on the CPU timeline of the current thread. Zones nest, and are written to the thread's own buffer without locks.
+	// The name isn't copied, it has to live as long as the profiler. A string literal usually.
+	class KLAYGE_CORE_API PerfZone : boost::noncopyable
+	{
+	public:
+		explicit PerfZone(char const * name);
+		~PerfZone();
+
+	private:
+		char const * name_;
+		PerfThreadBuffer* buffer_;
+		uint64_t start_;
+	};
+
 	class KLAYGE_CORE_API PerfRange : boost::noncopyable
 	{
 	public:
-		PerfRange();
+		explicit PerfRange(std::string const & name);
 
 		void Begin();
 		void End();
@@ -57,8 +77,13 @@ namespace KlayGE
 		bool Dirty() const;
 
 	private:
+		std::string name_;
+		std::string gpu_counter_name_;
+
 		Timer cpu_timer_;
 		QueryPtr gpu_timer_query_;
+		PerfThreadBuffer* buffer_;
+		uint64_t start_;
 
 		double cpu_time_;
 		double gpu_time_;
@@ -70,6 +95,7 @@ namespace KlayGE
 	{
 	public:
 		PerfProfiler();
+		~PerfProfiler();
 
 		static PerfProfiler& Instance();
 		static void Destroy();
@@ -77,10 +103,32 @@ namespace KlayGE
 		void Suspend();
 		void Resume();
 
+		// Starts as Context's config says. Read once per zone, so switching it on the fly is cheap.
+		bool Enabled() const
+		{
+			return enabled_.load(std::memory_order_relaxed);
+		}
+		void Enabled(bool enabled);
+
 		PerfRangePtr CreatePerfRange(int category, std::string const & name);
 		void CollectData();
 
+		// The name shown for the current thread in the trace
+		void ThreadName(std::string_view name);
+		// Names have the same lifetime requirement as PerfZone's
+		void MarkFrame();
+		void Counter(char const * name, double value);
+
 		void ExportToCSV(std::string const & file_name) const;
+		void ExportToChromeTrace(std::string const & file_name) const;
+		void ExportToChromeTrace(std::ostream& os) const;
+
+		// Nanoseconds since the profiler is created
+		uint64_t Now() const
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_time_).count();
+		}
+		PerfThreadBuffer* CurrentThreadBuffer();
 
 	private:
 		static std::unique_ptr<PerfProfiler> perf_profiler_instance_;
@@ -88,6 +136,13 @@ namespace KlayGE
 		std::vector<std::tuple<int, std::string, PerfRangePtr,
 			std::vector<std::tuple<uint32_t, double, double>>>> perf_ranges_;
 		uint32_t frame_id_;
+
+		std::atomic<bool> enabled_;
+		uint32_t const id_;
+		std::chrono::steady_clock::time_point const start_time_;
+
+		mutable std::mutex thread_buffers_mutex_;
+		std::vector<std::unique_ptr<PerfThreadBuffer>> thread_buffers_;
 	};
 }
 
@@ -40,12 +40,14 @@ namespace KlayGE
 	class ResLoadingDesc;
 	typedef std::shared_ptr<ResLoadingDesc> ResLoadingDescPtr;
 	class ResLoader;
+	class PerfZone;
 	class PerfRange;
 	typedef std::shared_ptr<PerfRange> PerfRangePtr;
 	class PerfProfiler;
 	typedef std::shared_ptr<PerfProfiler> PerfProfilerPtr;
 
 	class SceneManager;
+	class RenderQueue;
 	class SceneNode;
 	typedef std::shared_ptr<SceneNode> SceneNodePtr;
 	class SceneObjectLightSourceProxy;
@@ -339,6 +341,7 @@ namespace KlayGE
 	typedef std::shared_ptr<AudioBuffer> AudioBufferPtr;
 	class SoundBuffer;
 	class MusicBuffer;
+	class AudioStreamer;
 	class AudioDataSource;
 	typedef std::shared_ptr<AudioDataSource> AudioDataSourcePtr;
 	class AudioFactory;
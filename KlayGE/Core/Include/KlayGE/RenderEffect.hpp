@@ -276,7 +276,7 @@ namespace KlayGE
 				if (val_in_cbuff != value)
 				{
 					val_in_cbuff = value;
-					cbuff_desc.cbuff->Dirty(true);
+					cbuff_desc.cbuff->Dirty(cbuff_desc.offset, static_cast<uint32_t>(sizeof(T)));
 				}
 			}
 			else
@@ -447,7 +447,10 @@ namespace KlayGE
 					dst += cbuff_desc.stride;
 				}
 
-				cbuff_desc.cbuff->Dirty(true);
+				if (!value.empty())
+				{
+					cbuff_desc.cbuff->Dirty(cbuff_desc.offset, static_cast<uint32_t>((value.size() - 1) * cbuff_desc.stride + sizeof(T)));
+				}
 			}
 			else
 			{
@@ -745,6 +748,43 @@ namespace KlayGE
 		std::string impl_;
 	};
 
+	// Maps name hashes to the indices of parameters, cbuffers or techniques. Open addressing with linear probing.
+	// Different names could have the same hash, so the caller confirms every hit by comparing the names.
+	class KLAYGE_CORE_API RenderEffectNameTable
+	{
+	public:
+		static uint32_t constexpr INVALID_INDEX = 0xFFFFFFFFU;
+
+		void Clear();
+		void Insert(size_t name_hash, uint32_t index);
+
+		template <typename IsName>
+		uint32_t Find(size_t name_hash, IsName&& is_name) const
+		{
+			if (!slots_.empty())
+			{
+				size_t const mask = slots_.size() - 1;
+				for (size_t i = name_hash & mask; slots_[i].index != INVALID_INDEX; i = (i + 1) & mask)
+				{
+					if ((slots_[i].name_hash == name_hash) && is_name(slots_[i].index))
+					{
+						return slots_[i].index;
+					}
+				}
+			}
+			return INVALID_INDEX;
+		}
+
+	private:
+		struct Slot
+		{
+			size_t name_hash;
+			uint32_t index;
+		};
+		std::vector<Slot> slots_;
+		uint32_t num_entries_ = 0;
+	};
+
 	// ȾЧ
 	//////////////////////////////////////////////////////////////////////////////////
 	class KLAYGE_CORE_API RenderEffect : boost::noncopyable
@@ -773,6 +813,8 @@ namespace KlayGE
 		}
 		RenderEffectParameter* ParameterBySemantic(std::string_view semantic) const;
 		RenderEffectParameter* ParameterByName(std::string_view name) const;
+		// name_hash is HashRange(name), or CT_HASH of a string literal
+		RenderEffectParameter* ParameterByName(std::string_view name, size_t name_hash) const;
 		RenderEffectParameter* ParameterByIndex(uint32_t n) const
 		{
 			BOOST_ASSERT(n < this->NumParameters());
@@ -784,6 +826,7 @@ namespace KlayGE
 			return static_cast<uint32_t>(cbuffers_.size());
 		}
 		RenderEffectConstantBuffer* CBufferByName(std::string_view name) const;
+		RenderEffectConstantBuffer* CBufferByName(std::string_view name, size_t name_hash) const;
 		RenderEffectConstantBuffer* CBufferByIndex(uint32_t n) const
 		{
 			BOOST_ASSERT(n < this->NumCBuffers());
@@ -792,6 +835,7 @@ namespace KlayGE
 
 		uint32_t NumTechniques() const;
 		RenderTechnique* TechniqueByName(std::string_view name) const;
+		RenderTechnique* TechniqueByName(std::string_view name, size_t name_hash) const;
 		RenderTechnique* TechniqueByIndex(uint32_t n) const;
 
 		uint32_t NumShaderFragments() const;
@@ -854,6 +898,7 @@ namespace KlayGE
 			return static_cast<uint32_t>(techniques_.size());
 		}
 		RenderTechnique* TechniqueByName(std::string_view name) const;
+		RenderTechnique* TechniqueByName(std::string_view name, size_t name_hash) const;
 		RenderTechnique* TechniqueByIndex(uint32_t n) const
 		{
 			BOOST_ASSERT(n < this->NumTechniques());
@@ -902,7 +947,20 @@ namespace KlayGE
 		}
 #endif
 
+		// Indices are the same in all the clones of an effect, so the tables are shared through the template
+		RenderEffectNameTable const & ParameterNameTable() const
+		{
+			return param_name_table_;
+		}
+		RenderEffectNameTable const & CBufferNameTable() const
+		{
+			return cbuffer_name_table_;
+		}
+
 	private:
+		void BuildNameTables(RenderEffect const & effect);
+		void ClearNameTables();
+
 #if KLAYGE_IS_DEV_PLATFORM
 		void PreprocessIncludes(XMLDocument& doc, XMLNode& root, std::vector<std::unique_ptr<XMLDocument>>& include_docs);
 		void RecursiveIncludeNode(XMLNode const & root, std::vector<std::string>& include_names) const;
@@ -936,6 +994,10 @@ namespace KlayGE
 		std::vector<ShaderDesc> shader_descs_;
 
 		std::vector<RenderShaderGraphNode> shader_graph_nodes_;
+
+		RenderEffectNameTable param_name_table_;
+		RenderEffectNameTable cbuffer_name_table_;
+		RenderEffectNameTable tech_name_table_;
 	};
 
 	class KLAYGE_CORE_API RenderTechnique : boost::noncopyable
@@ -1111,7 +1173,7 @@ namespace KlayGE
 	{
 	public:
 		RenderEffectConstantBuffer()
-			: dirty_(true)
+			: dirty_(true), all_dirty_(true)
 		{
 		}
 
@@ -1175,6 +1237,24 @@ namespace KlayGE
 		void Dirty(bool dirty)
 		{
 			dirty_ = dirty;
+			all_dirty_ = dirty;
+			if (!dirty)
+			{
+				std::fill(dirty_regs_.begin(), dirty_regs_.end(), 0ULL);
+			}
+		}
+		// Only the 16-byte registers overlapping the range are uploaded, if the device can update a part of a cbuffer
+		void Dirty(uint32_t offset, uint32_t size)
+		{
+			if (!all_dirty_ && (size > 0))
+			{
+				uint32_t const last = (offset + size - 1) / 16;
+				for (uint32_t reg = offset / 16; reg <= last; ++ reg)
+				{
+					dirty_regs_[reg / 64] |= 1ULL << (reg % 64);
+				}
+			}
+			dirty_ = true;
 		}
 		bool Dirty() const
 		{
@@ -1194,7 +1274,9 @@ namespace KlayGE
 
 		GraphicsBufferPtr hw_buff_;
 		std::vector<uint8_t> buff_;
+		std::vector<uint64_t> dirty_regs_;
 		bool dirty_;
+		bool all_dirty_;
 	};
 
 	class KLAYGE_CORE_API RenderEffectParameter : boost::noncopyable
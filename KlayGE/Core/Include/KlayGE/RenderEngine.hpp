@@ -112,6 +112,10 @@ namespace KlayGE
 		uint32_t NumVerticesJustRendered();
 		uint32_t NumDrawsJustCalled();
 		uint32_t NumDispatchesJustCalled();
+		// The bytes sent to the constant buffers, and what it would be if they were uploaded as a whole
+		uint32_t NumCBufferBytesJustUploaded();
+		uint32_t NumCBufferBytesJustUpdated();
+		void AddCBufferUpload(uint32_t cbuffer_size, uint32_t uploaded_size);
 
 		void CreateRenderWindow(std::string const & name, RenderSettings& settings);
 		void DestroyRenderWindow();
@@ -308,6 +312,8 @@ namespace KlayGE
 		uint32_t num_vertices_just_rendered_;
 		uint32_t num_draws_just_called_;
 		uint32_t num_dispatches_just_called_;
+		uint32_t num_cbuffer_bytes_just_uploaded_;
+		uint32_t num_cbuffer_bytes_just_updated_;
 
 		RenderDeviceCaps caps_;
 
@@ -77,6 +77,13 @@ namespace KlayGE
 		SurfaceDetailMode detail_mode;
 		float2 height_offset_scale;
 		float4 tess_factors;
+
+		// Textures of tex_names, queued by ASyncLoadRenderMaterial. Empty if the material is loaded in other ways.
+		std::array<TexturePtr, TS_NumTextureSlots> textures;
+
+		// An asynchronously loaded material is filled in on the main thread, by ResLoader::Update. Other members are
+		// meaningless until this is true.
+		bool loaded = true;
 	};
 
 	float const MAX_SHININESS = 8192;
@@ -0,0 +1,106 @@
+/**
+* @file RenderQueue.hpp
+* @author Minmin Gong
+*
+* @section DESCRIPTION
+*
+* This source file is part of KlayGE
+* For the latest info, see http://www.klayge.org
+*
+* @section LICENSE
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published
+* by the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* You may alternatively use this source under the terms of
+* the KlayGE Proprietary License (KPL). You can obtained such a license
+* from http://www.klayge.org/licensing/.
+*/
+
+#ifndef _KLAYGE_RENDERQUEUE_HPP
+#define _KLAYGE_RENDERQUEUE_HPP
+
+#pragma once
+
+#include <KlayGE/PreDeclare.hpp>
+#include <KFL/Vector.hpp>
+
+#include <unordered_map>
+#include <vector>
+
+namespace KlayGE
+{
+	// Every queued renderable gets a 64-bit key:
+	//   [63:48] rank of the technique, ordered by RenderTechnique::Weight
+	//   [47:16] min view depth, as an order preserving uint32. 0 for techniques that aren't depth sorted
+	//   [15: 0] bits of the material, to keep renderables with the same material together
+	// and the whole queue is sorted by one stable LSD radix sort.
+	class KLAYGE_CORE_API RenderQueue : boost::noncopyable
+	{
+	public:
+		static uint32_t constexpr MAX_NUM_TECHNIQUES = 1UL << 16;
+
+	public:
+		void Clear();
+		void Add(RenderTechnique const * tech, Renderable* renderable);
+
+		void Sort(float4 const & view_mat_z);
+
+		size_t NumItems() const
+		{
+			return items_.size();
+		}
+		std::vector<Renderable*> const & SortedItems() const
+		{
+			return sorted_items_;
+		}
+
+		static uint64_t MakeKey(uint16_t tech_rank, float depth, uint16_t material);
+		static uint16_t MaterialBits(void const * material);
+
+		// Stable. tmp_keys and tmp_values are scratch, so they can be reused across frames.
+		static void RadixSort(std::vector<uint64_t>& keys, std::vector<uint32_t>& values,
+			std::vector<uint64_t>& tmp_keys, std::vector<uint32_t>& tmp_values);
+
+	private:
+		float MinDepth(Renderable const & renderable, float4 const & view_mat_z) const;
+
+	private:
+		struct TechniqueSlot
+		{
+			RenderTechnique const * tech;
+			uint32_t num_items;
+			uint16_t rank;
+		};
+
+		struct Item
+		{
+			Renderable* renderable;
+			uint32_t tech_slot;
+		};
+
+		std::unordered_map<RenderTechnique const *, uint32_t> tech_slot_map_;
+		std::vector<TechniqueSlot> tech_slots_;
+		std::vector<uint32_t> ranked_slots_;
+		std::vector<Item> items_;
+
+		std::vector<uint64_t> keys_;
+		std::vector<uint32_t> indices_;
+		std::vector<uint64_t> tmp_keys_;
+		std::vector<uint32_t> tmp_indices_;
+		std::vector<Renderable*> sorted_items_;
+	};
+}
+
+#endif		// _KLAYGE_RENDERQUEUE_HPP
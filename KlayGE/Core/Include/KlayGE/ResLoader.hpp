@@ -34,12 +34,14 @@
 #pragma once
 
 #include <KlayGE/PreDeclare.hpp>
+#include <array>
+#include <condition_variable>
+#include <deque>
 #include <istream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
-#include <boost/lockfree/spsc_queue.hpp>
-
 #include <KFL/ResIdentifier.hpp>
 #include <KFL/Thread.hpp>
 
@@ -69,6 +71,8 @@ namespace KlayGE
 
 		virtual bool HasSubThreadStage() const = 0;
 
+		// Descs that Match() each other must return the same Hash(). It's used to index the loaded resources.
+		virtual uint64_t Hash() const = 0;
 		virtual bool Match(ResLoadingDesc const & rhs) const = 0;
 		virtual void CopyDataFrom(ResLoadingDesc const & rhs) = 0;
 		virtual std::shared_ptr<void> CloneResourceFrom(std::shared_ptr<void> const & resource) = 0;
@@ -76,6 +80,15 @@ namespace KlayGE
 		virtual std::shared_ptr<void> Resource() const = 0;
 	};
 
+	enum ResLoadingPriority
+	{
+		RLP_High = 0,
+		RLP_Normal,
+		RLP_Low,
+
+		RLP_NumPriorities
+	};
+
 	class KLAYGE_CORE_API ResLoader : boost::noncopyable
 	{
 	public:
@@ -104,8 +117,14 @@ namespace KlayGE
 		uint64_t Timestamp(std::string_view name);
 		std::string AbsPath(std::string_view path);
 
+		void NumLoadingThreads(uint32_t num);
+		uint32_t NumLoadingThreads() const
+		{
+			return static_cast<uint32_t>(loading_threads_.size());
+		}
+
 		std::shared_ptr<void> SyncQuery(ResLoadingDescPtr const & res_desc);
-		std::shared_ptr<void> ASyncQuery(ResLoadingDescPtr const & res_desc);
+		std::shared_ptr<void> ASyncQuery(ResLoadingDescPtr const & res_desc, ResLoadingPriority priority = RLP_Normal);
 		void Unload(std::shared_ptr<void> const & res);
 
 		template <typename T>
@@ -115,9 +134,9 @@ namespace KlayGE
 		}
 
 		template <typename T>
-		std::shared_ptr<T> ASyncQueryT(ResLoadingDescPtr const & res_desc)
+		std::shared_ptr<T> ASyncQueryT(ResLoadingDescPtr const & res_desc, ResLoadingPriority priority = RLP_Normal)
 		{
-			return std::static_pointer_cast<T>(this->ASyncQuery(res_desc));
+			return std::static_pointer_cast<T>(this->ASyncQuery(res_desc, priority));
 		}
 
 		template <typename T>
@@ -139,6 +158,8 @@ namespace KlayGE
 		std::shared_ptr<void> FindMatchLoadedResource(ResLoadingDescPtr const & res_desc);
 		void RemoveUnrefResources();
 
+		void StartLoadingThreads(uint32_t num);
+		void StopLoadingThreads();
 		void LoadingThreadFunc();
 
 #if defined(KLAYGE_PLATFORM_ANDROID)
@@ -164,15 +185,19 @@ namespace KlayGE
 		std::vector<std::tuple<uint64_t, uint32_t, std::string, PackagePtr>> paths_;
 		std::mutex paths_mutex_;
 
+		// Both containers are keyed by ResLoadingDesc::Hash(), Match() is only called inside a bucket
 		std::mutex loaded_mutex_;
 		std::mutex loading_mutex_;
-		std::vector<std::pair<ResLoadingDescPtr, std::weak_ptr<void>>> loaded_res_;
-		std::vector<std::pair<ResLoadingDescPtr, std::shared_ptr<volatile LoadingStatus>>> loading_res_;
-		boost::lockfree::spsc_queue<std::pair<ResLoadingDescPtr, std::shared_ptr<volatile LoadingStatus>>,
-			boost::lockfree::capacity<1024>> loading_res_queue_;
+		std::unordered_multimap<uint64_t, std::pair<ResLoadingDescPtr, std::weak_ptr<void>>> loaded_res_;
+		std::unordered_multimap<uint64_t, std::pair<ResLoadingDescPtr, std::shared_ptr<volatile LoadingStatus>>> loading_res_;
+
+		std::mutex loading_queue_mutex_;
+		std::condition_variable loading_queue_cv_;
+		std::array<std::deque<std::pair<ResLoadingDescPtr, std::shared_ptr<volatile LoadingStatus>>>, RLP_NumPriorities>
+			loading_res_queues_;
 
-		std::unique_ptr<joiner<void>> loading_thread_;
-		volatile bool quit_;
+		std::vector<std::unique_ptr<joiner<void>>> loading_threads_;
+		bool quit_;
 	};
 }
 
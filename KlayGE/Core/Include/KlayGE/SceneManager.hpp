@@ -25,9 +25,11 @@
 
 #include <KlayGE/SceneNode.hpp>
 #include <KlayGE/Renderable.hpp>
+#include <KlayGE/RenderQueue.hpp>
 #include <KFL/Frustum.hpp>
 #include <KFL/Thread.hpp>
 
+#include <array>
 #include <vector>
 #include <unordered_map>
 
@@ -44,6 +46,10 @@ namespace KlayGE
 
 		void SmallObjectThreshold(float area);
 		void SceneUpdateElapse(float elapse);
+
+		// Number of threads propagating transforms and bounds through the scene. 0 means one per hardware thread.
+		void NumTransformThreads(uint32_t num_threads);
+		uint32_t NumTransformThreads() const;
 		virtual void ClipScene();
 
 		void AddCamera(CameraPtr const & camera);
@@ -95,6 +101,12 @@ namespace KlayGE
 		virtual void ClearObject();
 
 		void Update();
+		// One pass of sub thread update handlers. The update thread calls it in a loop. update_mutex_ is only held while the
+		// nodes' state is copied, not while the handlers run, so a slow handler delays the next pass instead of the frame.
+		// For the same reason handlers must not lock MutexForUpdate(), and must not change the hierarchy.
+		void SubThreadUpdate(float app_time, float elapsed_time);
+		// Brings a node a handler touches into the current pass
+		void AddToSubThreadUpdate(SceneNode& node);
 
 		uint32_t NumObjectsRendered() const;
 		uint32_t NumRenderablesRendered() const;
@@ -103,7 +115,11 @@ namespace KlayGE
 		uint32_t NumDrawCalls() const;
 		uint32_t NumDispatchCalls() const;
 
+		uint64_t NumVisibleMarksCacheHits() const;
+		uint64_t NumVisibleMarksCacheMisses() const;
+
 		virtual void OnSceneChanged() = 0;
+		void OnHierarchyChanged();
 
 	protected:
 		void Flush(uint32_t urt);
@@ -125,8 +141,6 @@ namespace KlayGE
 		SceneNode scene_root_;
 		SceneNode overlay_root_;
 
-		std::unordered_map<size_t, std::unique_ptr<BoundOverlap[]>> visible_marks_map_;
-
 		float small_obj_threshold_;
 		float update_elapse_;
 
@@ -136,10 +150,17 @@ namespace KlayGE
 	private:
 		void FlushScene();
 
+		void LoadVisibleMarks(std::vector<SceneNode*> const & scene_nodes, size_t seed);
+
+		void FlattenScene();
+		void PropagateTransforms();
+		void PropagatePosBounds();
+		void ParallelForNodes(size_t begin, size_t end, std::function<void(size_t, size_t)> const & func);
+
 	private:
 		uint32_t urt_;
 
-		std::vector<std::pair<RenderTechnique const *, std::vector<Renderable*>>> render_queue_;
+		RenderQueue render_queue_;
 
 		uint32_t num_objects_rendered_;
 		uint32_t num_renderables_rendered_;
@@ -152,7 +173,37 @@ namespace KlayGE
 		std::unique_ptr<joiner<void>> update_thread_;
 		volatile bool quit_;
 
+		// The nodes of the running sub thread update, and the ones the main thread has to apply. Children are referenced, so
+		// nodes removed from the scene in the meantime stay alive, and are released on the main thread.
+		std::mutex sub_thread_update_mutex_;
+		std::vector<std::pair<SceneNode*, SceneNodePtr>> sub_thread_nodes_;
+		std::vector<std::pair<SceneNode*, SceneNodePtr>> pending_sub_thread_nodes_;
+
 		bool deferred_mode_;
+
+		// all_scene_nodes_ is kept in depth order, so each level can be processed in parallel once the level above is done.
+		// It's rebuilt only when the hierarchy changes.
+		std::vector<size_t> scene_level_offsets_;
+		bool scene_hierarchy_dirty_;
+		uint32_t num_transform_threads_;
+
+		// Visible marks of the passes already clipped in this frame, keyed by a hash of the visible list and the camera.
+		// Marks are packed in 2 bits per node. Entries from older frames are stale, and the least recently used entry is
+		// recycled when all slots are taken.
+		struct VisibleMarksEntry
+		{
+			size_t seed;
+			size_t num_nodes;
+			uint32_t generation;
+			uint64_t last_use;
+			std::vector<uint8_t> marks;
+		};
+		static uint32_t constexpr MAX_VISIBLE_MARKS_ENTRIES = 16;
+		std::array<VisibleMarksEntry, MAX_VISIBLE_MARKS_ENTRIES> visible_marks_cache_;
+		uint32_t visible_marks_generation_;
+		uint64_t visible_marks_clock_;
+		uint64_t visible_marks_hits_;
+		uint64_t visible_marks_misses_;
 	};
 }
 
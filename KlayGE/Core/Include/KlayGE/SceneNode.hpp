@@ -97,6 +97,7 @@ namespace KlayGE
 		virtual AABBox const & PosBoundOS() const;
 		virtual AABBox const & PosBoundWS() const;
 		void UpdateTransforms();
+		void UpdatePosBound();
 		void UpdatePosBoundSubtree();
 		bool Updated() const;
 		void VisibleMark(BoundOverlap vm);
@@ -115,6 +116,20 @@ namespace KlayGE
 		void SubThreadUpdate(float app_time, float elapsed_time);
 		void MainThreadUpdate(float app_time, float elapsed_time);
 
+		// Sub thread update handlers run while the scene is rendered. They work on a copy of the transforms, bounds and
+		// visibility. The copy is taken before the handlers run, and their changes are kept aside after them until the main
+		// thread applies them at the start of its next update. All three run with the scene manager's update mutex locked.
+		// The main thread never sees a half-updated node, and the handlers never see one in the middle of a propagation.
+		// Any other node a handler reads or writes joins the pass on first access. The hierarchy itself can't be changed
+		// from a handler, and any other render state has to be synchronized by its owner, or changed in a main thread
+		// update handler instead.
+		void BeginSubThreadUpdate();
+		// Returns true if the node isn't in the scene manager's list of nodes to apply yet
+		bool EndSubThreadUpdate();
+		void ApplySubThreadUpdate();
+		// Set by the scene manager on the thread running the sub thread update handlers
+		static void SubThreadUpdating(bool updating);
+
 		uint32_t Attrib() const;
 		bool Visible() const;
 		void Visible(bool vis);
@@ -141,7 +156,8 @@ namespace KlayGE
 		void FindAllNode(std::vector<SceneNode*>& nodes, std::wstring_view name);
 
 		void Parent(SceneNode* so);
-		void EmitSceneChanged();
+		void EmitSceneChanged(bool hierarchy_changed);
+
 
 	protected:
 		std::wstring name_;
@@ -165,6 +181,31 @@ namespace KlayGE
 		UpdateEvent main_thread_update_event_;
 
 		bool updated_ = false;
+
+		struct SubThreadState
+		{
+			// Only touched by the thread running the sub thread update
+			float4x4 xform_to_parent;
+			float4x4 xform_to_world;
+			float4x4 parent_xform_to_world;
+			AABBox pos_aabb_os;
+			AABBox pos_aabb_ws;
+			uint32_t attrib;
+			bool xform_dirty;
+			bool attrib_dirty;
+			bool active = false;
+
+			// Guarded by the scene manager's update mutex
+			float4x4 pending_xform_to_parent;
+			uint32_t pending_attrib;
+			bool pending_xform = false;
+			bool pending_attrib_dirty = false;
+			bool pending_listed = false;
+		};
+		std::unique_ptr<SubThreadState> sub_thread_state_;
+
+	private:
+		SubThreadState* CurrentSubThreadState() const;
 	};
 }
 
@@ -36,6 +36,7 @@
 #include <KlayGE/PreDeclare.hpp>
 
 #include <array>
+#include <functional>
 
 namespace KlayGE
 {
@@ -61,6 +62,10 @@ namespace KlayGE
 	class KLAYGE_CORE_API TexCompression : boost::noncopyable
 	{
 	public:
+		TexCompression()
+			: num_threads_(0)
+		{
+		}
 		virtual ~TexCompression()
 		{
 		}
@@ -68,6 +73,14 @@ namespace KlayGE
 		virtual void EncodeBlock(void* output, void const * input, TexCompressionMethod method) = 0;
 		virtual void DecodeBlock(void* output, void const * input) = 0;
 
+		// Decodes num_blocks consecutive blocks of a block row. Block rows in the output are out_row_pitch apart. The default
+		// one decodes the blocks one by one. Codecs with a faster path for many blocks can override it.
+		virtual void DecodeBlocks(void* output, uint32_t out_row_pitch, void const * input, uint32_t num_blocks);
+
+		// Creates a codec of the same type. Codecs keep states in EncodeBlock/DecodeBlock, so each worker thread of
+		// EncodeMem/DecodeMem runs its own instance. A codec that returns null here can only be used single-threaded.
+		virtual TexCompressionPtr Clone() const;
+
 		virtual void EncodeMem(uint32_t width, uint32_t height, 
 			void* output, uint32_t out_row_pitch, uint32_t out_slice_pitch,
 			void const * input, uint32_t in_row_pitch, uint32_t in_slice_pitch,
@@ -79,8 +92,24 @@ namespace KlayGE
 		virtual void EncodeTex(TexturePtr const & out_tex, TexturePtr const & in_tex, TexCompressionMethod method);
 		virtual void DecodeTex(TexturePtr const & out_tex, TexturePtr const & in_tex);
 
+		// Maximum number of threads used by EncodeMem/DecodeMem. 0 means one per hardware thread.
+		void NumThreads(uint32_t num_threads)
+		{
+			num_threads_ = num_threads;
+		}
+		uint32_t NumThreads() const
+		{
+			return num_threads_;
+		}
+
+	private:
+		void ForEachBlockRow(uint32_t num_block_rows, std::function<void(TexCompression& codec, uint32_t block_row)> const & func);
+
 	protected:
 		ElementFormat compression_format_;
+
+	private:
+		uint32_t num_threads_;
 	};
 
 	class ARGBColor32 : boost::equality_comparable<ARGBColor32>
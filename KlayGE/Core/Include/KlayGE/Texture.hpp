@@ -68,6 +68,15 @@ namespace KlayGE
 		TMA_Read_Write
 	};
 
+	enum TextureResizeFilter
+	{
+		TRF_Point,
+		TRF_Linear,		// 2 taps, like a bilinear sampler. Aliases when shrinking more than 2x
+		TRF_Box,
+		TRF_Kaiser,
+		TRF_Lanczos
+	};
+
 	// Abstract class representing a Texture resource.
 	// @remarks
 	// The actual concrete subclass which will exist for a texture
@@ -372,6 +381,11 @@ namespace KlayGE
 		void const * src_data, uint32_t src_row_pitch, uint32_t src_slice_pitch, ElementFormat src_format,
 		uint32_t src_width, uint32_t src_height, uint32_t src_depth,
 		bool linear);
+	KLAYGE_CORE_API void ResizeTexture(void* dst_data, uint32_t dst_row_pitch, uint32_t dst_slice_pitch, ElementFormat dst_format,
+		uint32_t dst_width, uint32_t dst_height, uint32_t dst_depth,
+		void const * src_data, uint32_t src_row_pitch, uint32_t src_slice_pitch, ElementFormat src_format,
+		uint32_t src_width, uint32_t src_height, uint32_t src_depth,
+		TextureResizeFilter filter);
 
 	// return the lookat and up vector in cubemap view
 	//////////////////////////////////////////////////////////////////////////////////
@@ -35,8 +35,12 @@
 
 #include <KlayGE/PreDeclare.hpp>
 
-#include <vector>
+#include <array>
+#include <atomic>
 #include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace KlayGE
 {
@@ -70,6 +74,29 @@ namespace KlayGE
 			}
 		};
 
+		// A contiguous range of the ring that one frame allocates from
+		struct RingWindow
+		{
+			uint32_t begin;
+			uint32_t end;
+		};
+
+		// A frame that may still be read by the GPU
+		struct RingFrame
+		{
+			uint32_t frame_id;
+			uint32_t begin;
+			uint32_t end;
+		};
+
+		// CPU copy of a part of the ring. It never moves, so growing doesn't disturb concurrent writers.
+		struct RingChunk
+		{
+			uint32_t begin;
+			uint32_t end;
+			std::unique_ptr<uint8_t[]> data;
+		};
+
 	public:
 		enum BindFlag
 		{
@@ -77,8 +104,18 @@ namespace KlayGE
 			BF_Index
 		};
 
+		enum AllocMode
+		{
+			// First fit from a free list. Single threaded, and the buffer is copied when it grows.
+			AM_FreeList,
+			// Lock-free bump allocation from a ring. Space is reclaimed a whole frame at a time, so Dealloc does nothing.
+			// Alloc can be called from several threads at once, but not while EnsureDataReady or OnPresent is running.
+			// Offsets are sums of earlier allocation sizes, so a buffer that holds one element type stays aligned to it.
+			AM_Ring
+		};
+
 	public:
-		TransientBuffer(uint32_t size_in_byte, BindFlag bind_flag);
+		TransientBuffer(uint32_t size_in_byte, BindFlag bind_flag, AllocMode mode = AM_FreeList);
 
 		// Allocate a sub space from transient buffer
 		SubAlloc Alloc(uint32_t size_in_byte, void const * data);
@@ -88,6 +125,11 @@ namespace KlayGE
 		// Do with retired frames
 		void OnPresent();
 
+		AllocMode Mode() const
+		{
+			return mode_;
+		}
+
 		GraphicsBufferPtr const & GetBuffer() const
 		{
 			return buffer_;
@@ -98,7 +140,14 @@ namespace KlayGE
 		// Free the sub alloc and return the space allocated back to transient buffer.
 		void DoFree(SubAlloc const & alloc);
 
+		SubAlloc RingAlloc(uint32_t size_in_byte, void const * data);
+		bool RingGrow(uint32_t seen_end, uint32_t size_in_byte, uint32_t& offset);
+		void RingWrite(uint32_t offset, void const * data, uint32_t size_in_byte);
+		void RingEnsureDataReady();
+		void RingOnPresent();
+
 	private:
+		AllocMode mode_;
 		bool use_no_overwrite_;
 		uint32_t num_pre_frames_;
 
@@ -110,6 +159,19 @@ namespace KlayGE
 		std::vector<uint8_t> simulate_buffer_;
 		uint32_t valid_min_;
 		uint32_t valid_max_;
+
+		// Ring mode. The next offset is in the low 32 bits of ring_window_, and the end of the window in the high 32 bits,
+		// so one fetch_add both reserves the space and tells whether it fits.
+		std::atomic<uint64_t> ring_window_;
+		std::mutex ring_grow_mutex_;
+		uint32_t ring_capacity_;
+		std::array<RingChunk, 32> ring_chunks_;
+		std::atomic<uint32_t> num_ring_chunks_;
+		std::vector<RingWindow> ring_frame_windows_;
+		std::list<RingFrame> ring_in_flight_;
+		uint32_t ring_head_;
+		uint32_t ring_uploaded_windows_;
+		uint32_t ring_uploaded_offset_;
 	};
 }
 
@@ -32,6 +32,8 @@
 
 namespace KlayGE
 {
+	class UIGeometry;
+
 	enum UI_Control_State
 	{
 		UICS_Normal = 0,
@@ -165,6 +167,14 @@ namespace KlayGE
 
 		virtual void Render() = 0;
 
+		// Tells the dialog that the cached geometry of this control is out of date.
+		void Invalidate();
+		// Controls that change without any input, like a blinking caret, are re-emitted every frame.
+		virtual bool IsAnimating() const
+		{
+			return false;
+		}
+
 		virtual bool CanHaveFocus() const
 		{
 			return false;
@@ -205,6 +215,7 @@ namespace KlayGE
 		virtual void SetEnabled(bool bEnabled)
 		{
 			enabled_ = bEnabled;
+			this->Invalidate();
 		}
 		virtual bool GetEnabled() const
 		{
@@ -213,6 +224,7 @@ namespace KlayGE
 		virtual void SetVisible(bool bVisible)
 		{
 			visible_ = bVisible;
+			this->Invalidate();
 		}
 		virtual bool GetVisible() const
 		{
@@ -238,12 +250,14 @@ namespace KlayGE
 			x_ = x;
 			y_ = y;
 			this->UpdateRects();
+			this->Invalidate();
 		}
 		void SetSize(int width, int height)
 		{
 			width_ = width;
 			height_ = height;
 			this->UpdateRects();
+			this->Invalidate();
 		}
 
 		void SetHotkey(uint8_t hotkey)
@@ -262,6 +276,7 @@ namespace KlayGE
 			{
 				element->FontColor().States[UICS_Normal] = color;
 			}
+			this->Invalidate();
 		}
 		UIElement* GetElement(uint32_t iElement) const
 		{
@@ -277,6 +292,7 @@ namespace KlayGE
 
 			// Update the data
 			*elements_[iElement] = element;
+			this->Invalidate();
 		}
 
 		bool GetIsDefault() const
@@ -286,6 +302,7 @@ namespace KlayGE
 		void SetIsDefault(bool bIsDefault)
 		{
 			is_default_ = bIsDefault;
+			this->Invalidate();
 		}
 		uint32_t GetIndex() const
 		{
@@ -427,9 +444,20 @@ namespace KlayGE
 		}
 
 	private:
+		struct AtlasRegion
+		{
+			bool packed;
+			int2 offset;
+		};
+
 		void Init();
 		void InputHandler(InputEngine const & sender, InputAction const & action);
 
+		UIGeometry& CurrGeometry();
+		GraphicsBufferPtr const & QuadIndices(uint32_t num_quads);
+		AtlasRegion const & PackIntoAtlas(TexturePtr const & texture);
+		float2 AtlasTexcoord(TexturePtr const & texture, AtlasRegion const & region, float2 const & tc) const;
+
 	private:
 		static std::unique_ptr<UIManager> ui_mgr_instance_;
 
@@ -443,17 +471,18 @@ namespace KlayGE
 
 		std::array<std::vector<IRect >, UICT_Num_Control_Types> elem_texture_rcs_;
 
-		std::map<TexturePtr, RenderablePtr> rects_;
+		// Skin textures are copied into one atlas the first time they are drawn, so that each dialog
+		// usually ends up with a single batch. Textures that don't fit keep their own batch.
+		TexturePtr atlas_tex_;
+		std::map<TexturePtr, AtlasRegion> atlas_regions_;
+		int2 atlas_cursor_;
+		int atlas_shelf_height_;
+		float2 atlas_white_tc_;
 
-		struct string_cache
-		{
-			Rect rc;
-			float depth;
-			Color clr;
-			std::wstring text;
-			uint32_t align;
-		};
-		std::map<size_t, std::vector<string_cache>> strings_;
+		GraphicsBufferPtr quad_ib_;      // Shared by all batches, 6 indices per quad
+		uint32_t quad_ib_capacity_;
+		UIGeometry* curr_geometry_;
+		std::unique_ptr<UIGeometry> immediate_geometry_;   // For drawing outside of UIDialog::Render
 
 		bool mouse_on_ui_;
 		bool inited_;
@@ -513,6 +542,14 @@ namespace KlayGE
 
 		void Render();
 
+		// Forces the dialog to re-emit its geometry in the next UIManager::Render. Call it after
+		// modifying an element returned by UIControl::GetElement.
+		void Invalidate()
+		{
+			geometry_dirty_ = true;
+		}
+		bool IsAnimating() const;
+
 		void RequestFocus(UIControl& control);
 		void ClearFocus();
 
@@ -524,6 +561,7 @@ namespace KlayGE
 		void SetVisible(bool bVisible)
 		{
 			visible_ = bVisible;
+			this->Invalidate();
 		}
 		bool GetMinimized() const
 		{
@@ -532,6 +570,7 @@ namespace KlayGE
 		void SetMinimized(bool bMinimized)
 		{
 			minimized_ = bMinimized;
+			this->Invalidate();
 		}
 		void SetBackgroundColors(Color const & colorAllCorners);
 		void SetBackgroundColors(Color const & colorTopLeft, Color const & colorTopRight,
@@ -539,6 +578,7 @@ namespace KlayGE
 		void EnableCaption(bool bEnable)
 		{
 			show_caption_ = bEnable;
+			this->Invalidate();
 		}
 		bool IsCaptionEnabled() const
 		{
@@ -551,6 +591,7 @@ namespace KlayGE
 		void SetCaptionHeight(int nHeight)
 		{
 			caption_height_ = nHeight;
+			this->Invalidate();
 		}
 		void SetID(std::string const & id)
 		{
@@ -563,6 +604,7 @@ namespace KlayGE
 		void SetCaptionText(std::wstring const & strText)
 		{
 			caption_ = strText;
+			this->Invalidate();
 		}
 		int2 GetLocation() const
 		{
@@ -576,11 +618,13 @@ namespace KlayGE
 			bounding_box_.top() = y;
 			bounding_box_.right() = x + w;
 			bounding_box_.bottom() = y + h;
+			this->Invalidate();
 		}
 		void SetSize(int width, int height)
 		{
 			bounding_box_.right() = bounding_box_.left() + width;
 			bounding_box_.bottom() = bounding_box_.top() + height;
+			this->Invalidate();
 		}
 		int GetWidth() const
 		{
@@ -593,6 +637,7 @@ namespace KlayGE
 		void AlwaysInOpacity(bool opacity)
 		{
 			always_in_opacity_ = opacity;
+			this->Invalidate();
 		}
 		bool AlwaysInOpacity() const
 		{
@@ -649,6 +694,8 @@ namespace KlayGE
 		// Control events
 		bool OnCycleFocus(bool bForward);
 
+		void UpdateOpacity(bool active);
+
 	private:
 		bool keyboard_input_;
 		bool mouse_input_;
@@ -683,6 +730,9 @@ namespace KlayGE
 
 		std::map<std::string, int> id_name_;
 		std::map<int, ControlLocation> id_location_;
+
+		std::unique_ptr<UIGeometry> geometry_;
+		bool geometry_dirty_;
 	};
 
 	class KLAYGE_CORE_API UIStatic : public UIControl
@@ -1075,6 +1125,10 @@ namespace KlayGE
 
 		virtual void Render();
 		virtual void UpdateRects();
+		virtual bool IsAnimating() const
+		{
+			return arrow_ != CLEAR;
+		}
 
 		void SetTrackRange(size_t nStart, size_t nEnd);
 		size_t GetTrackPos() const
@@ -1086,6 +1140,7 @@ namespace KlayGE
 			position_ = nPosition;
 			this->Cap();
 			this->UpdateThumbRect();
+			this->Invalidate();
 		}
 		size_t GetPageSize() const
 		{
@@ -1096,6 +1151,7 @@ namespace KlayGE
 			page_size_ = nPageSize;
 			this->Cap();
 			this->UpdateThumbRect();
+			this->Invalidate();
 		}
 
 		void Scroll(int nDelta);    // Scroll by nDelta items (plus or minus)
@@ -1178,6 +1234,10 @@ namespace KlayGE
 
 		virtual void    Render();
 		virtual void    UpdateRects();
+		virtual bool IsAnimating() const
+		{
+			return scroll_bar_.IsAnimating();
+		}
 
 		STYLE GetStyle() const
 		{
@@ -1190,6 +1250,7 @@ namespace KlayGE
 		void SetStyle(STYLE style)
 		{
 			style_ = style;
+			this->Invalidate();
 		}
 		int  GetScrollBarWidth() const
 		{
@@ -1199,11 +1260,13 @@ namespace KlayGE
 		{
 			sb_width_ = width;
 			this->UpdateRects();
+			this->Invalidate();
 		}
 		void SetBorder(int border, int margin)
 		{
 			border_ = border;
 			margin_ = margin;
+			this->Invalidate();
 		}
 		int AddItem(std::wstring const & strText);
 		void SetItemData(int nIndex, std::any const & data);
@@ -1290,6 +1353,10 @@ namespace KlayGE
 		virtual void OnHotkey();
 		virtual void OnFocusOut();
 		virtual void Render();
+		virtual bool IsAnimating() const
+		{
+			return scroll_bar_.IsAnimating();
+		}
 
 		virtual void UpdateRects();
 
@@ -1306,6 +1373,7 @@ namespace KlayGE
 		{
 			drop_height_ = nHeight;
 			this->UpdateRects();
+			this->Invalidate();
 		}
 		int GetScrollBarWidth() const
 		{
@@ -1315,6 +1383,7 @@ namespace KlayGE
 		{
 			sb_width_ = nWidth;
 			this->UpdateRects();
+			this->Invalidate();
 		}
 
 		std::any const GetSelectedData() const;
@@ -1468,6 +1537,11 @@ namespace KlayGE
 			mouse_drag_ = false;
 		}
 		virtual void Render();
+		virtual bool IsAnimating() const
+		{
+			// The caret blinks
+			return has_focus_;
+		}
 
 		void SetText(std::wstring const & wszText, bool bSelected = false);
 		std::wstring const & GetText() const
@@ -1482,29 +1556,35 @@ namespace KlayGE
 		virtual void SetTextColor(Color const & Color)
 		{
 			text_color_ = Color;	// Text color
+			this->Invalidate();
 		}
 		void SetSelectedTextColor(Color const & Color)
 		{
 			sel_text_color_ = Color;	// Selected text color
+			this->Invalidate();
 		}
 		void SetSelectedBackColor(Color const & Color)
 		{
 			sel_bk_color_ = Color;	// Selected background color
+			this->Invalidate();
 		}
 		void SetCaretColor(Color const & Color)
 		{
 			caret_color_ = Color;	// Caret color
+			this->Invalidate();
 		}
 		void SetBorderWidth(int nBorder)
 		{
 			// Border of the window
 			border_ = nBorder;
 			this->UpdateRects();
+			this->Invalidate();
 		}
 		void SetSpacing(int nSpacing)
 		{
 			spacing_ = nSpacing;
 			this->UpdateRects();
+			this->Invalidate();
 		}
 
 	public:
@@ -37,7 +37,8 @@
 namespace KlayGE
 {
 	AudioEngine::AudioEngine()
-		: sound_vol_(1), music_vol_(1)
+		: sound_vol_(1), music_vol_(1),
+			streamer_(MakeUniquePtr<AudioStreamer>())
 	{
 	}
 
@@ -145,4 +146,9 @@ namespace KlayGE
 	{
 		return music_vol_;
 	}
+
+	AudioStreamer& AudioEngine::Streamer()
+	{
+		return *streamer_;
+	}
 }
@@ -0,0 +1,177 @@
+/**
+ * @file AudioStreamer.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#include <KlayGE/KlayGE.hpp>
+#include <KlayGE/Context.hpp>
+
+#include <algorithm>
+
+#include <KlayGE/Audio.hpp>
+
+namespace KlayGE
+{
+	AudioStreamer::AudioStreamer()
+		: updating_(nullptr), quit_(false), started_(false)
+	{
+	}
+
+	AudioStreamer::~AudioStreamer()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			quit_ = true;
+		}
+		cond_.notify_one();
+
+		if (started_)
+		{
+			thread_();
+		}
+	}
+
+	void AudioStreamer::Add(MusicBuffer& buffer)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+
+			if (!started_)
+			{
+				thread_ = Context::Instance().ThreadPool()([this] { this->ThreadFunc(); });
+				started_ = true;
+			}
+
+			auto const now = std::chrono::steady_clock::now();
+			due_[&buffer] = now;
+			tasks_.push({ now, &buffer });
+		}
+		cond_.notify_one();
+	}
+
+	void AudioStreamer::Remove(MusicBuffer& buffer)
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		due_.erase(&buffer);
+		while (updating_ == &buffer)
+		{
+			updated_cond_.wait(lock);
+		}
+	}
+
+	void AudioStreamer::Wake(MusicBuffer& buffer)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+
+			auto iter = due_.find(&buffer);
+			if (iter == due_.end())
+			{
+				return;
+			}
+
+			auto const now = std::chrono::steady_clock::now();
+			if (iter->second <= now)
+			{
+				// Already due
+				return;
+			}
+
+			iter->second = now;
+			tasks_.push({ now, &buffer });
+		}
+		cond_.notify_one();
+	}
+
+	size_t AudioStreamer::NumBuffers() const
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		return due_.size();
+	}
+
+	void AudioStreamer::ThreadFunc()
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		while (!quit_)
+		{
+			if (tasks_.empty())
+			{
+				cond_.wait(lock);
+				continue;
+			}
+
+			Task const task = tasks_.top();
+			auto iter = due_.find(task.buffer);
+			if ((iter == due_.end()) || (iter->second != task.due))
+			{
+				tasks_.pop();
+				continue;
+			}
+
+			if (std::chrono::steady_clock::now() < task.due)
+			{
+				cond_.wait_until(lock, task.due);
+				continue;
+			}
+
+			tasks_.pop();
+
+			// A wake during the update schedules it again
+			iter->second = std::chrono::steady_clock::time_point::max();
+			updating_ = task.buffer;
+			lock.unlock();
+
+			std::chrono::milliseconds next_update(0);
+			bool const playing = task.buffer->Update(next_update);
+
+			lock.lock();
+			updating_ = nullptr;
+
+			// It could be removed during the update
+			iter = due_.find(task.buffer);
+			if (iter != due_.end())
+			{
+				if (playing)
+				{
+					auto const due = std::min(iter->second, std::chrono::steady_clock::now() + next_update);
+					if (due != iter->second)
+					{
+						iter->second = due;
+						tasks_.push({ due, task.buffer });
+					}
+				}
+				else
+				{
+					due_.erase(iter);
+				}
+			}
+
+			updated_cond_.notify_all();
+		}
+	}
+}
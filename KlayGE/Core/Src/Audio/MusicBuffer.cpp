@@ -29,15 +29,58 @@
  */
 
 #include <KlayGE/KlayGE.hpp>
+#include <KFL/ErrorHandling.hpp>
 #include <KlayGE/AudioDataSource.hpp>
+#include <KlayGE/AudioFactory.hpp>
+#include <KlayGE/Context.hpp>
+
+#include <algorithm>
+#include <cstring>
 
 #include <KlayGE/Audio.hpp>
 
+namespace
+{
+	using namespace KlayGE;
+
+	uint32_t BlockAlign(AudioFormat format)
+	{
+		switch (format)
+		{
+		case AF_Mono8:
+			return 1;
+
+		case AF_Mono16:
+		case AF_Stereo8:
+			return 2;
+
+		case AF_Stereo16:
+			return 4;
+
+		default:
+			KFL_UNREACHABLE("Invalid audio format");
+		}
+	}
+}
+
 namespace KlayGE
 {
-	MusicBuffer::MusicBuffer(AudioDataSourcePtr const & data_source)
-		: AudioBuffer(data_source)
+	MusicBuffer::MusicBuffer(AudioDataSourcePtr const & data_source, uint32_t buffer_seconds, AudioStreamer* streamer)
+		: AudioBuffer(data_source),
+			loop_(false),
+			streamer_(streamer),
+			decoded_start_(0), decoded_size_(0), source_end_(false)
 	{
+		if (!streamer_)
+		{
+			streamer_ = &Context::Instance().AudioFactoryInstance().AudioEngineInstance().Streamer();
+		}
+
+		uint32_t const block_align = BlockAlign(format_);
+		buffer_size_ = freq_ / BUFFERS_PER_SECOND * block_align;
+
+		// Decodes ahead as much as the device queues, so a slow decode doesn't starve the device
+		decoded_.resize(buffer_seconds * BUFFERS_PER_SECOND * buffer_size_);
 	}
 
 	MusicBuffer::~MusicBuffer()
@@ -58,16 +101,92 @@ namespace KlayGE
 
 	void MusicBuffer::Play(bool loop)
 	{
+		streamer_->Remove(*this);
 		this->DoStop();
+
+		loop_ = loop;
+		if (loop_)
+		{
+			source_end_ = false;
+		}
+		this->Decode();
+
 		this->DoPlay(loop);
+		streamer_->Add(*this);
 	}
 
 	void MusicBuffer::Stop()
 	{
+		streamer_->Remove(*this);
 		if (this->IsPlaying())
 		{
 			this->DoStop();
-			data_source_->Reset();
+			this->ResetDecoded();
 		}
 	}
+
+	bool MusicBuffer::Update(std::chrono::milliseconds& next_update)
+	{
+		this->Decode();
+		return this->DoUpdate(next_update);
+	}
+
+	void MusicBuffer::Decode()
+	{
+		bool rewound = false;
+		while (!source_end_ && (decoded_size_ < decoded_.size()))
+		{
+			// Reads straight into the ring, up to its end
+			size_t const write_pos = (decoded_start_ + decoded_size_) % decoded_.size();
+			size_t const size = std::min(decoded_.size() - decoded_size_, decoded_.size() - write_pos);
+			size_t const read = data_source_->Read(&decoded_[write_pos], size);
+			if (read > 0)
+			{
+				decoded_size_ += read;
+				rewound = false;
+			}
+			else if (loop_ && !rewound)
+			{
+				data_source_->Reset();
+				rewound = true;
+			}
+			else
+			{
+				source_end_ = true;
+			}
+		}
+	}
+
+	size_t MusicBuffer::ReadDecoded(void* data, size_t size)
+	{
+		size = std::min(size, decoded_size_);
+		if (data != nullptr)
+		{
+			size_t const first = std::min(size, decoded_.size() - decoded_start_);
+			std::memcpy(data, &decoded_[decoded_start_], first);
+			std::memcpy(static_cast<uint8_t*>(data) + first, &decoded_[0], size - first);
+		}
+
+		decoded_start_ = (decoded_start_ + size) % decoded_.size();
+		decoded_size_ -= size;
+		return size;
+	}
+
+	void MusicBuffer::ResetDecoded()
+	{
+		data_source_->Reset();
+		decoded_start_ = 0;
+		decoded_size_ = 0;
+		source_end_ = false;
+	}
+
+	bool MusicBuffer::EndOfStream() const
+	{
+		return source_end_ && (0 == decoded_size_);
+	}
+
+	AudioStreamer& MusicBuffer::Streamer() const
+	{
+		return *streamer_;
+	}
 }
@@ -29,28 +29,218 @@
 */
 
 #include <KlayGE/KlayGE.hpp>
+#include <KFL/ErrorHandling.hpp>
 #include <KlayGE/RenderFactory.hpp>
 #include <KlayGE/RenderEngine.hpp>
 #include <KlayGE/Query.hpp>
 
+#include <array>
 #include <fstream>
+#include <iomanip>
 #include <mutex>
 
 #include <KlayGE/PerfProfiler.hpp>
 
 namespace
 {
+	using namespace KlayGE;
+
 	std::mutex singleton_mutex;
+
+	std::atomic<uint32_t> profiler_id(0);
+
+	// Escapes the characters JSON doesn't allow in strings
+	void WriteJsonString(std::ostream& os, std::string_view str)
+	{
+		os << '"';
+		for (char ch : str)
+		{
+			switch (ch)
+			{
+			case '"':
+				os << "\\\"";
+				break;
+
+			case '\\':
+				os << "\\\\";
+				break;
+
+			default:
+				if (static_cast<uint8_t>(ch) < 0x20)
+				{
+					os << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<uint32_t>(ch)
+						<< std::dec << std::setfill(' ');
+				}
+				else
+				{
+					os << ch;
+				}
+				break;
+			}
+		}
+		os << '"';
+	}
+
+	void WriteMicroseconds(std::ostream& os, uint64_t ns)
+	{
+		os << ns / 1000 << '.' << std::setw(3) << std::setfill('0') << ns % 1000 << std::setfill(' ');
+	}
 }
 
 namespace KlayGE
 {
+	struct PerfEvent
+	{
+		enum EventType : uint8_t
+		{
+			ET_Zone,
+			ET_Frame,
+			ET_Counter
+		};
+
+		char const * name;
+		uint64_t start;
+		union
+		{
+			uint64_t duration;
+			uint64_t frame_id;
+			double value;
+		};
+		uint32_t depth;
+		EventType type;
+	};
+
+	// Only the owner thread records, any thread can read. A chunk is never moved or freed while the profiler lives, and the
+	// number of events in it is published after the event is written.
+	class PerfThreadBuffer : boost::noncopyable
+	{
+		static uint32_t constexpr CHUNK_SIZE = 1024;
+		// About 40 MB of events per thread. Newer events are dropped after that.
+		static uint32_t constexpr MAX_CHUNKS = 1024;
+
+		struct Chunk
+		{
+			std::array<PerfEvent, CHUNK_SIZE> events;
+			std::atomic<uint32_t> num_events{0};
+			std::atomic<Chunk*> next{nullptr};
+		};
+
+	public:
+		PerfThreadBuffer(uint32_t thread_id, std::string name)
+			: thread_id_(thread_id), name_(std::move(name)), tail_(&head_), num_chunks_(1)
+		{
+		}
+
+		~PerfThreadBuffer()
+		{
+			Chunk* chunk = head_.next.load(std::memory_order_relaxed);
+			while (chunk != nullptr)
+			{
+				Chunk* next = chunk->next.load(std::memory_order_relaxed);
+				delete chunk;
+				chunk = next;
+			}
+		}
+
+		void Record(PerfEvent const & event)
+		{
+			uint32_t num_events = tail_->num_events.load(std::memory_order_relaxed);
+			if (num_events == CHUNK_SIZE)
+			{
+				if (num_chunks_ == MAX_CHUNKS)
+				{
+					return;
+				}
+
+				Chunk* chunk = new Chunk;
+				tail_->next.store(chunk, std::memory_order_release);
+				tail_ = chunk;
+				++ num_chunks_;
+				num_events = 0;
+			}
+
+			tail_->events[num_events] = event;
+			tail_->num_events.store(num_events + 1, std::memory_order_release);
+		}
+
+		template <typename Func>
+		void ForEach(Func&& func) const
+		{
+			for (Chunk const * chunk = &head_; chunk != nullptr; chunk = chunk->next.load(std::memory_order_acquire))
+			{
+				uint32_t const num_events = chunk->num_events.load(std::memory_order_acquire);
+				for (uint32_t i = 0; i < num_events; ++ i)
+				{
+					func(chunk->events[i]);
+				}
+			}
+		}
+
+		uint32_t ThreadID() const
+		{
+			return thread_id_;
+		}
+
+		// Both are guarded by the profiler's thread_buffers_mutex_
+		std::string const & Name() const
+		{
+			return name_;
+		}
+		void Name(std::string_view name)
+		{
+			name_ = std::string(name);
+		}
+
+		// Only touched by the owner thread
+		uint32_t depth = 0;
+
+	private:
+		uint32_t const thread_id_;
+		std::string name_;
+
+		Chunk head_;
+		Chunk* tail_;
+		uint32_t num_chunks_;
+	};
+
+
 	std::unique_ptr<PerfProfiler> PerfProfiler::perf_profiler_instance_;
 
-	PerfRange::PerfRange()
-		: cpu_time_(0), gpu_time_(0), dirty_(false)
+	PerfZone::PerfZone(char const * name)
+		: name_(name), buffer_(nullptr), start_(0)
 	{
-		if (Context::Instance().Config().perf_profiler)
+		PerfProfiler& profiler = PerfProfiler::Instance();
+		if (profiler.Enabled())
+		{
+			buffer_ = profiler.CurrentThreadBuffer();
+			++ buffer_->depth;
+			start_ = profiler.Now();
+		}
+	}
+
+	PerfZone::~PerfZone()
+	{
+		if (buffer_ != nullptr)
+		{
+			uint64_t const end = PerfProfiler::Instance().Now();
+			-- buffer_->depth;
+
+			PerfEvent event;
+			event.name = name_;
+			event.start = start_;
+			event.duration = end - start_;
+			event.depth = buffer_->depth;
+			event.type = PerfEvent::ET_Zone;
+			buffer_->Record(event);
+		}
+	}
+
+	PerfRange::PerfRange(std::string const & name)
+		: name_(name), gpu_counter_name_("GPU: " + name),
+			buffer_(nullptr), start_(0),
+			cpu_time_(0), gpu_time_(0), dirty_(false)
+	{
+		if (PerfProfiler::Instance().Enabled())
 		{
 			RenderFactory& rf = Context::Instance().RenderFactoryInstance();
 			gpu_timer_query_ = rf.MakeTimerQuery();
@@ -59,7 +249,8 @@ namespace KlayGE
 
 	void PerfRange::Begin()
 	{
-		if (Context::Instance().Config().perf_profiler)
+		PerfProfiler& profiler = PerfProfiler::Instance();
+		if (profiler.Enabled())
 		{
 			dirty_ = true;
 			cpu_timer_.restart();
@@ -67,18 +258,39 @@ namespace KlayGE
 			{
 				gpu_timer_query_->Begin();
 			}
+
+			buffer_ = profiler.CurrentThreadBuffer();
+			++ buffer_->depth;
+			start_ = profiler.Now();
 		}
 	}
 
 	void PerfRange::End()
 	{
-		if (Context::Instance().Config().perf_profiler)
+		PerfProfiler& profiler = PerfProfiler::Instance();
+		if (profiler.Enabled())
 		{
 			cpu_time_ = cpu_timer_.elapsed();
 			if (gpu_timer_query_)
 			{
 				gpu_timer_query_->End();
 			}
+
+			// Begin and End are on the same thread
+			if ((buffer_ != nullptr) && (buffer_ == profiler.CurrentThreadBuffer()))
+			{
+				uint64_t const end = profiler.Now();
+				-- buffer_->depth;
+
+				PerfEvent event;
+				event.name = name_.c_str();
+				event.start = start_;
+				event.duration = end - start_;
+				event.depth = buffer_->depth;
+				event.type = PerfEvent::ET_Zone;
+				buffer_->Record(event);
+			}
+			buffer_ = nullptr;
 		}
 	}
 
@@ -89,6 +301,7 @@ namespace KlayGE
 			if (gpu_timer_query_)
 			{
 				gpu_time_ = checked_pointer_cast<TimerQuery>(gpu_timer_query_)->TimeElapsed();
+				PerfProfiler::Instance().Counter(gpu_counter_name_.c_str(), gpu_time_ * 1000);
 			}
 			dirty_ = false;
 		}
@@ -111,10 +324,15 @@ namespace KlayGE
 
 
 	PerfProfiler::PerfProfiler()
-		: frame_id_(0)
+		: frame_id_(0),
+			enabled_(Context::Instance().Config().perf_profiler),
+			id_(++ profiler_id),
+			start_time_(std::chrono::steady_clock::now())
 	{
 	}
 
+	PerfProfiler::~PerfProfiler() = default;
+
 	PerfProfiler& PerfProfiler::Instance()
 	{
 		if (!perf_profiler_instance_)
@@ -142,9 +360,14 @@ namespace KlayGE
 	{
 	}
 
+	void PerfProfiler::Enabled(bool enabled)
+	{
+		enabled_.store(enabled, std::memory_order_relaxed);
+	}
+
 	PerfRangePtr PerfProfiler::CreatePerfRange(int category, std::string const & name)
 	{
-		PerfRangePtr range = MakeSharedPtr<PerfRange>();
+		PerfRangePtr range = MakeSharedPtr<PerfRange>(name);
 		typedef std::remove_reference<decltype(std::get<3>(perf_ranges_[0]))>::type PerfDataType;
 		perf_ranges_.push_back(std::make_tuple(category, name, range, PerfDataType()));
 		return range;
@@ -152,7 +375,7 @@ namespace KlayGE
 
 	void PerfProfiler::CollectData()
 	{
-		if (Context::Instance().Config().perf_profiler)
+		if (this->Enabled())
 		{
 			for (auto& range : perf_ranges_)
 			{
@@ -164,13 +387,69 @@ namespace KlayGE
 				}
 			}
 
-			++ frame_id_;
+			this->MarkFrame();
+		}
+	}
+
+	PerfThreadBuffer* PerfProfiler::CurrentThreadBuffer()
+	{
+		// The profiler could be destroyed and created again, so the cached buffer is tagged with the profiler's id
+		thread_local PerfThreadBuffer* buffer = nullptr;
+		thread_local uint32_t buffer_profiler_id = 0;
+
+		if (buffer_profiler_id != id_)
+		{
+			std::lock_guard<std::mutex> lock(thread_buffers_mutex_);
+
+			uint32_t const thread_id = static_cast<uint32_t>(thread_buffers_.size()) + 1;
+			thread_buffers_.push_back(MakeUniquePtr<PerfThreadBuffer>(thread_id, "Thread " + std::to_string(thread_id)));
+			buffer = thread_buffers_.back().get();
+			buffer_profiler_id = id_;
+		}
+		return buffer;
+	}
+
+	void PerfProfiler::ThreadName(std::string_view name)
+	{
+		PerfThreadBuffer* buffer = this->CurrentThreadBuffer();
+
+		std::lock_guard<std::mutex> lock(thread_buffers_mutex_);
+		buffer->Name(name);
+	}
+
+	void PerfProfiler::MarkFrame()
+	{
+		if (this->Enabled())
+		{
+			PerfEvent event;
+			event.name = "Frame";
+			event.start = this->Now();
+			event.frame_id = frame_id_;
+			event.depth = 0;
+			event.type = PerfEvent::ET_Frame;
+			this->CurrentThreadBuffer()->Record(event);
+		}
+
+		++ frame_id_;
+	}
+
+	void PerfProfiler::Counter(char const * name, double value)
+	{
+		if (this->Enabled())
+		{
+			PerfEvent event;
+			event.name = name;
+			event.start = this->Now();
+			event.value = value;
+			event.depth = 0;
+			event.type = PerfEvent::ET_Counter;
+			this->CurrentThreadBuffer()->Record(event);
 		}
 	}
 
 	void PerfProfiler::ExportToCSV(std::string const & file_name) const
 	{
-		if (Context::Instance().Config().perf_profiler)
+		if (this->Enabled())
 		{
 			std::ofstream ofs(file_name.c_str());
 			ofs << "Frame" << ',' << "Category" << ',' << "Name" << ','
@@ -193,4 +472,76 @@ namespace KlayGE
 			ofs << std::endl;
 		}
 	}
+
+	void PerfProfiler::ExportToChromeTrace(std::string const & file_name) const
+	{
+		std::ofstream ofs(file_name.c_str());
+		this->ExportToChromeTrace(ofs);
+	}
+
+	// The trace event format: https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+	// One event per line.
+	void PerfProfiler::ExportToChromeTrace(std::ostream& os) const
+	{
+		std::lock_guard<std::mutex> lock(thread_buffers_mutex_);
+
+		os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+		bool first = true;
+		auto begin_event = [&os, &first](char const * ph, uint32_t thread_id)
+		{
+			os << (first ? "\n" : ",\n") << "{\"pid\":0,\"tid\":" << thread_id << ",\"ph\":\"" << ph << '"';
+			first = false;
+		};
+
+		for (auto const & buffer : thread_buffers_)
+		{
+			uint32_t const thread_id = buffer->ThreadID();
+
+			begin_event("M", thread_id);
+			os << ",\"name\":\"thread_name\",\"args\":{\"name\":";
+			WriteJsonString(os, buffer->Name());
+			os << "}}";
+
+			buffer->ForEach([&os, &begin_event, thread_id](PerfEvent const & event)
+				{
+					switch (event.type)
+					{
+					case PerfEvent::ET_Zone:
+						begin_event("X", thread_id);
+						os << ",\"name\":";
+						WriteJsonString(os, event.name);
+						os << ",\"ts\":";
+						WriteMicroseconds(os, event.start);
+						os << ",\"dur\":";
+						WriteMicroseconds(os, event.duration);
+						os << ",\"args\":{\"depth\":" << event.depth << "}}";
+						break;
+
+					case PerfEvent::ET_Frame:
+						begin_event("i", thread_id);
+						os << ",\"s\":\"g\",\"name\":";
+						WriteJsonString(os, event.name);
+						os << ",\"ts\":";
+						WriteMicroseconds(os, event.start);
+						os << ",\"args\":{\"frame\":" << event.frame_id << "}}";
+						break;
+
+					case PerfEvent::ET_Counter:
+						begin_event("C", thread_id);
+						os << ",\"name\":";
+						WriteJsonString(os, event.name);
+						os << ",\"ts\":";
+						WriteMicroseconds(os, event.start);
+						os << ",\"args\":{\"value\":" << event.value << "}}";
+						break;
+
+					default:
+						KFL_UNREACHABLE("Invalid event type");
+					}
+				});
+		}
+
+		os << "\n]}" << std::endl;
+	}
 }
@@ -29,9 +29,12 @@
  */
 
 #include <KlayGE/KlayGE.hpp>
+#include <KFL/CustomizedStreamBuf.hpp>
 #include <KFL/Hash.hpp>
+#include <KFL/MappedFile.hpp>
 #include <KFL/Util.hpp>
 #include <KlayGE/Package.hpp>
+#include <KlayGE/PerfProfiler.hpp>
 #include <KFL/CXX17/filesystem.hpp>
 
 #if defined KLAYGE_PLATFORM_LINUX
@@ -61,7 +64,6 @@
 #elif defined KLAYGE_PLATFORM_ANDROID
 #include <android_native_app_glue.h>
 #include <android/asset_manager.h>
-#include <KFL/CustomizedStreamBuf.hpp>
 #elif defined KLAYGE_PLATFORM_DARWIN
 #include <mach-o/dyld.h>
 #elif defined KLAYGE_PLATFORM_IOS
@@ -94,6 +96,43 @@ namespace
 		AAsset* asset_;
 	};
 #endif
+
+	class MappedFileStreamBuf : public KlayGE::MemInputStreamBuf
+	{
+	public:
+		explicit MappedFileStreamBuf(std::unique_ptr<KlayGE::MappedFile> file)
+			: MemInputStreamBuf(file->Data().data(), static_cast<std::streamsize>(file->Size())),
+				file_(std::move(file))
+		{
+		}
+
+		KlayGE::ArrayRef<uint8_t> Data() const
+		{
+			return file_->Data();
+		}
+
+	private:
+		std::unique_ptr<KlayGE::MappedFile> file_;
+	};
+
+	KlayGE::ResIdentifierPtr OpenFile(std::string_view name, std::string const & res_name, uint64_t timestamp)
+	{
+		using namespace KlayGE;
+
+		auto file = MakeUniquePtr<MappedFile>();
+		if (file->Open(res_name))
+		{
+			auto msb = MakeSharedPtr<MappedFileStreamBuf>(std::move(file));
+			auto const data = msb->Data();
+			return MakeSharedPtr<ResIdentifier>(name, timestamp, MakeSharedPtr<std::istream>(msb.get()), msb, data);
+		}
+		else
+		{
+			// The static_cast is a workaround for a bug in clang/c2
+			return MakeSharedPtr<ResIdentifier>(name, timestamp,
+				MakeSharedPtr<std::ifstream>(res_name.c_str(), static_cast<std::ios_base::openmode>(std::ios_base::binary)));
+		}
+	}
 }
 
 namespace KlayGE
@@ -232,14 +271,13 @@ namespace KlayGE
 #endif
 #endif
 
-		loading_thread_ = MakeUniquePtr<joiner<void>>(Context::Instance().ThreadPool()(
-			[this] { this->LoadingThreadFunc(); }));
+		uint32_t const num_cores = std::thread::hardware_concurrency();
+		this->StartLoadingThreads(MathLib::clamp(num_cores / 2, 1U, 4U));
 	}
 
 	ResLoader::~ResLoader()
 	{
-		quit_ = true;
-		(*loading_thread_)();
+		this->StopLoadingThreads();
 	}
 
 	ResLoader& ResLoader::Instance()
@@ -270,6 +308,46 @@ namespace KlayGE
 		// TODO
 	}
 
+	void ResLoader::NumLoadingThreads(uint32_t num)
+	{
+		num = std::max(num, 1U);
+		if (num != loading_threads_.size())
+		{
+			// Jobs stay in the queues while the workers are restarted
+			this->StopLoadingThreads();
+			this->StartLoadingThreads(num);
+		}
+	}
+
+	void ResLoader::StartLoadingThreads(uint32_t num)
+	{
+		{
+			std::lock_guard<std::mutex> lock(loading_queue_mutex_);
+			quit_ = false;
+		}
+
+		for (uint32_t i = 0; i < num; ++ i)
+		{
+			loading_threads_.push_back(MakeUniquePtr<joiner<void>>(Context::Instance().ThreadPool()(
+				[this] { this->LoadingThreadFunc(); })));
+		}
+	}
+
+	void ResLoader::StopLoadingThreads()
+	{
+		{
+			std::lock_guard<std::mutex> lock(loading_queue_mutex_);
+			quit_ = true;
+		}
+		loading_queue_cv_.notify_all();
+
+		for (auto& thread : loading_threads_)
+		{
+			(*thread)();
+		}
+		loading_threads_.clear();
+	}
+
 	std::string ResLoader::AbsPath(std::string_view path)
 	{
 		std::string path_str(path);
@@ -637,9 +715,11 @@ namespace KlayGE
 		AAsset* asset = this->LocateFileAndroid(name);
 		if (asset != nullptr)
 		{
+			ArrayRef<uint8_t> const data(static_cast<uint8_t const *>(AAsset_getBuffer(asset)),
+				static_cast<size_t>(AAsset_getLength(asset)));
 			std::shared_ptr<AAssetStreamBuf> asb = MakeSharedPtr<AAssetStreamBuf>(asset);
 			std::shared_ptr<std::istream> asset_file = MakeSharedPtr<std::istream>(asb.get());
-			return MakeSharedPtr<ResIdentifier>(name, 0, asset_file, asb);
+			return MakeSharedPtr<ResIdentifier>(name, 0, asset_file, asb, data);
 		}
 #elif defined(KLAYGE_PLATFORM_IOS)
 		std::string const & res_name = this->LocateFileIOS(name);
@@ -652,8 +732,7 @@ namespace KlayGE
 			uint64_t timestamp = std::filesystem::last_write_time(res_path);
 #endif
 
-			return MakeSharedPtr<ResIdentifier>(name, timestamp,
-				MakeSharedPtr<std::ifstream>(res_name.c_str(), std::ios_base::binary));
+			return OpenFile(name, res_name, timestamp);
 		}
 #else
 		{
@@ -680,9 +759,7 @@ namespace KlayGE
 #else
 						uint64_t timestamp = std::filesystem::last_write_time(res_path);
 #endif
-						// The static_cast is a workaround for a bug in clang/c2
-						return MakeSharedPtr<ResIdentifier>(name, timestamp,
-							MakeSharedPtr<std::ifstream>(res_name.c_str(), static_cast<std::ios_base::openmode>(std::ios_base::binary)));
+						return OpenFile(name, res_name, timestamp);
 					}
 					else
 					{
@@ -738,7 +815,9 @@ namespace KlayGE
 
 	std::shared_ptr<void> ResLoader::SyncQuery(ResLoadingDescPtr const & res_desc)
 	{
-		this->RemoveUnrefResources();
+#ifndef KLAYGE_SHIP
+		PerfZone zone("ResLoader::SyncQuery");
+#endif
 
 		std::shared_ptr<void> loaded_res = this->FindMatchLoadedResource(res_desc);
 		std::shared_ptr<void> res;
@@ -764,8 +843,10 @@ namespace KlayGE
 			{
 				std::lock_guard<std::mutex> lock(loading_mutex_);
 
-				for (auto const & lrq : loading_res_)
+				auto const range = loading_res_.equal_range(res_desc->Hash());
+				for (auto iter = range.first; iter != range.second; ++ iter)
 				{
+					auto const & lrq = iter->second;
 					if (lrq.first->Match(*res_desc))
 					{
 						res_desc->CopyDataFrom(*lrq.first);
@@ -798,9 +879,9 @@ namespace KlayGE
 		return res;
 	}
 
-	std::shared_ptr<void> ResLoader::ASyncQuery(ResLoadingDescPtr const & res_desc)
+	std::shared_ptr<void> ResLoader::ASyncQuery(ResLoadingDescPtr const & res_desc, ResLoadingPriority priority)
 	{
-		this->RemoveUnrefResources();
+		BOOST_ASSERT(priority < RLP_NumPriorities);
 
 		std::shared_ptr<void> loaded_res = this->FindMatchLoadedResource(res_desc);
 		std::shared_ptr<void> res;
@@ -826,8 +907,10 @@ namespace KlayGE
 			{
 				std::lock_guard<std::mutex> lock(loading_mutex_);
 
-				for (auto const & lrq : loading_res_)
+				auto const range = loading_res_.equal_range(res_desc->Hash());
+				for (auto iter = range.first; iter != range.second; ++ iter)
 				{
+					auto const & lrq = iter->second;
 					if (lrq.first->Match(*res_desc))
 					{
 						res_desc->CopyDataFrom(*lrq.first);
@@ -845,7 +928,7 @@ namespace KlayGE
 				if (!res_desc->StateLess())
 				{
 					std::lock_guard<std::mutex> lock(loading_mutex_);
-					loading_res_.emplace_back(res_desc, async_is_done);
+					loading_res_.emplace(res_desc->Hash(), std::make_pair(res_desc, async_is_done));
 				}
 			}
 			else
@@ -858,9 +941,13 @@ namespace KlayGE
 
 					{
 						std::lock_guard<std::mutex> lock(loading_mutex_);
-						loading_res_.emplace_back(res_desc, async_is_done);
+						loading_res_.emplace(res_desc->Hash(), std::make_pair(res_desc, async_is_done));
 					}
-					loading_res_queue_.push(std::make_pair(res_desc, async_is_done));
+					{
+						std::lock_guard<std::mutex> lock(loading_queue_mutex_);
+						loading_res_queues_[priority].emplace_back(res_desc, async_is_done);
+					}
+					loading_queue_cv_.notify_one();
 				}
 				else
 				{
@@ -879,7 +966,7 @@ namespace KlayGE
 
 		for (auto iter = loaded_res_.begin(); iter != loaded_res_.end(); ++ iter)
 		{
-			if (res == iter->second.lock())
+			if (res == iter->second.second.lock())
 			{
 				loaded_res_.erase(iter);
 				break;
@@ -891,9 +978,12 @@ namespace KlayGE
 	{
 		std::lock_guard<std::mutex> lock(loaded_mutex_);
 
+		uint64_t const hash = res_desc->Hash();
 		bool found = false;
-		for (auto& c_desc : loaded_res_)
+		auto const range = loaded_res_.equal_range(hash);
+		for (auto iter = range.first; iter != range.second; ++ iter)
 		{
+			auto& c_desc = iter->second;
 			if (c_desc.first == res_desc)
 			{
 				c_desc.second = std::weak_ptr<void>(res);
@@ -903,7 +993,7 @@ namespace KlayGE
 		}
 		if (!found)
 		{
-			loaded_res_.emplace_back(res_desc, std::weak_ptr<void>(res));
+			loaded_res_.emplace(hash, std::make_pair(res_desc, std::weak_ptr<void>(res)));
 		}
 	}
 
@@ -912,12 +1002,26 @@ namespace KlayGE
 		std::lock_guard<std::mutex> lock(loaded_mutex_);
 
 		std::shared_ptr<void> loaded_res;
-		for (auto const & lr : loaded_res_)
+		auto const range = loaded_res_.equal_range(res_desc->Hash());
+		for (auto iter = range.first; iter != range.second;)
 		{
-			if (lr.first->Match(*res_desc))
+			auto const & lr = iter->second;
+			if (lr.second.expired())
 			{
-				loaded_res = lr.second.lock();
-				break;
+				// Expired entries in the bucket are dropped here, the rest are swept in Update()
+				iter = loaded_res_.erase(iter);
+			}
+			else
+			{
+				if (lr.first->Match(*res_desc))
+				{
+					loaded_res = lr.second.lock();
+					if (loaded_res)
+					{
+						break;
+					}
+				}
+				++ iter;
 			}
 		}
 		return loaded_res;
@@ -929,7 +1033,7 @@ namespace KlayGE
 
 		for (auto iter = loaded_res_.begin(); iter != loaded_res_.end();)
 		{
-			if (iter->second.lock())
+			if (!iter->second.second.expired())
 			{
 				++ iter;
 			}
@@ -942,10 +1046,20 @@ namespace KlayGE
 
 	void ResLoader::Update()
 	{
+#ifndef KLAYGE_SHIP
+		PerfZone zone("ResLoader::Update");
+#endif
+
+		this->RemoveUnrefResources();
+
 		std::vector<std::pair<ResLoadingDescPtr, std::shared_ptr<volatile LoadingStatus>>> tmp_loading_res;
 		{
 			std::lock_guard<std::mutex> lock(loading_mutex_);
-			tmp_loading_res = loading_res_;
+			tmp_loading_res.reserve(loading_res_.size());
+			for (auto const & lrq : loading_res_)
+			{
+				tmp_loading_res.push_back(lrq.second);
+			}
 		}
 
 		for (auto& lrq : tmp_loading_res)
@@ -987,7 +1101,7 @@ namespace KlayGE
 			std::lock_guard<std::mutex> lock(loading_mutex_);
 			for (auto iter = loading_res_.begin(); iter != loading_res_.end();)
 			{
-				if (LS_CanBeRemoved == *(iter->second))
+				if (LS_CanBeRemoved == *(iter->second.second))
 				{
 					iter = loading_res_.erase(iter);
 				}
@@ -1001,19 +1115,51 @@ namespace KlayGE
 
 	void ResLoader::LoadingThreadFunc()
 	{
-		while (!quit_)
+#ifndef KLAYGE_SHIP
+		bool thread_named = false;
+#endif
+
+		for (;;)
 		{
 			std::pair<ResLoadingDescPtr, std::shared_ptr<volatile LoadingStatus>> res_pair;
-			while (loading_res_queue_.pop(res_pair))
 			{
-				if (LS_Loading == *res_pair.second)
+				std::unique_lock<std::mutex> lock(loading_queue_mutex_);
+				loading_queue_cv_.wait(lock, [this]
+					{
+						return quit_ || std::any_of(loading_res_queues_.begin(), loading_res_queues_.end(),
+							[](auto const & queue) { return !queue.empty(); });
+					});
+				if (quit_)
 				{
-					res_pair.first->SubThreadStage();
-					*res_pair.second = LS_Complete;
+					break;
+				}
+
+				for (auto& queue : loading_res_queues_)
+				{
+					if (!queue.empty())
+					{
+						res_pair = std::move(queue.front());
+						queue.pop_front();
+						break;
+					}
 				}
 			}
 
-			Sleep(10);
+			if (LS_Loading == *res_pair.second)
+			{
+#ifndef KLAYGE_SHIP
+				// Named on the first resource, so the profiler isn't created by a loading thread during startup
+				if (!thread_named)
+				{
+					PerfProfiler::Instance().ThreadName("Loading");
+					thread_named = true;
+				}
+				PerfZone zone("ResLoader::SubThreadStage");
+#endif
+
+				res_pair.first->SubThreadStage();
+				*res_pair.second = LS_Complete;
+			}
 		}
 	}
 
@@ -206,14 +206,11 @@ namespace KlayGE
 	{
 		uint8_t const * p = static_cast<uint8_t const *>(input.data());
 
-		std::vector<uint8_t> in_data(static_cast<size_t>(input.size()));
-		std::memcpy(&in_data[0], p, static_cast<std::streamsize>(in_data.size()));
-
 		SizeT s_out_len = static_cast<SizeT>(original_len);
 
 		SizeT s_src_len = static_cast<SizeT>(input.size() - LZMA_PROPS_SIZE);
-		int res = LZMALoader::Instance().LzmaUncompress(static_cast<Byte*>(output), &s_out_len, &in_data[LZMA_PROPS_SIZE], &s_src_len,
-			&in_data[0], LZMA_PROPS_SIZE);
+		int res = LZMALoader::Instance().LzmaUncompress(static_cast<Byte*>(output), &s_out_len, p + LZMA_PROPS_SIZE, &s_src_len,
+			p, LZMA_PROPS_SIZE);
 		Verify(0 == res);
 	}
 }
@@ -1362,6 +1362,10 @@ namespace KlayGE
 
 	uint32_t DeferredRenderingLayer::Update(uint32_t pass)
 	{
+#ifndef KLAYGE_SHIP
+		PerfZone zone("DeferredRenderingLayer::Update");
+#endif
+
 		SceneManager& scene_mgr = Context::Instance().SceneManagerInstance();
 
 		if (0 == pass)
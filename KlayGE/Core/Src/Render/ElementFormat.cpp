@@ -37,6 +37,247 @@
 #include <KFL/Math.hpp>
 #include <KFL/Half.hpp>
 
+#include <array>
+#include <cstring>
+#include <vector>
+
+#if defined(KLAYGE_SSE2_SUPPORT)
+	#include <emmintrin.h>
+#elif defined(KLAYGE_NEON_SUPPORT)
+	#include <arm_neon.h>
+#endif
+
+namespace
+{
+	using namespace KlayGE;
+
+	// Unsigned 11 and 10 bit floats in B10G11R11F, with 6 and 5 bit mantissa
+	float DecodeSmallFloat(uint32_t exponent, uint32_t mantissa, uint32_t mantissa_bits)
+	{
+		union FNI
+		{
+			float f;
+			int32_t i;
+		} result;
+
+		if (0x1F == exponent) // INF or NAN
+		{
+			result.i = 0x7F800000 | (mantissa << (23 - mantissa_bits));
+		}
+		else
+		{
+			if (0 == exponent)
+			{
+				if (mantissa != 0)
+				{
+					// The value is denormalized
+
+					// Normalize the value in the resulting float
+					exponent = 1;
+
+					do
+					{
+						-- exponent;
+						mantissa <<= 1;
+					} while (0 == (mantissa & (1UL << mantissa_bits)));
+
+					mantissa &= (1UL << mantissa_bits) - 1;
+				}
+				else
+				{
+					// The value is zero
+
+					exponent = static_cast<uint32_t>(-112);
+				}
+			}
+
+			result.i = ((exponent + 112) << 23) | (mantissa << (23 - mantissa_bits));
+		}
+
+		return result.f;
+	}
+
+	// Lookup tables for the common formats. They are filled by the scalar formulas, so they are bit exact with them.
+	class ConversionTables
+	{
+	public:
+		static ConversionTables const & Instance()
+		{
+			static ConversionTables const tables;
+			return tables;
+		}
+
+	private:
+		ConversionTables()
+		{
+			for (uint32_t i = 0; i < unorm8.size(); ++ i)
+			{
+				unorm8[i] = i / 255.0f;
+				srgb8[i] = MathLib::srgb_to_linear(i / 255.0f);
+			}
+
+			half_to_float.resize(65536);
+			for (uint32_t i = 0; i < half_to_float.size(); ++ i)
+			{
+				half_to_float[i] = half::from_bits(static_cast<uint16_t>(i));
+			}
+
+			for (uint32_t i = 0; i < uf11_to_float.size(); ++ i)
+			{
+				uf11_to_float[i] = DecodeSmallFloat(i >> 6, i & 0x3F, 6);
+			}
+			for (uint32_t i = 0; i < uf10_to_float.size(); ++ i)
+			{
+				uf10_to_float[i] = DecodeSmallFloat(i >> 5, i & 0x1F, 5);
+			}
+
+			// Whether encoding a decoded sRGB value gives back the same byte. pow isn't the same on all platforms,
+			// so it's checked here instead of assumed.
+			srgb8_round_trip = true;
+			for (uint32_t i = 0; i < srgb8.size(); ++ i)
+			{
+				srgb8_round_trip &= (MathLib::clamp(static_cast<int>(MathLib::linear_to_srgb(srgb8[i]) * 255.0f + 0.5f), 0, 255)
+					== static_cast<int>(i));
+			}
+		}
+
+	public:
+		std::array<float, 256> unorm8;
+		std::array<float, 256> srgb8;
+		std::vector<float> half_to_float;
+		std::array<float, 2048> uf11_to_float;
+		std::array<float, 1024> uf10_to_float;
+		bool srgb8_round_trip;
+	};
+
+	// EF_ABGR8, or EF_ARGB8 if swap_rb
+	void UNorm8x4ToABGR32F(uint8_t const * input, uint32_t num_elems, Color* output, bool swap_rb)
+	{
+		uint32_t i = 0;
+#if defined(KLAYGE_SSE2_SUPPORT)
+		// Int to float and the division are both exact in SSE, so the results are the same as the table's
+		__m128 const scale = _mm_set1_ps(255.0f);
+		__m128i const zero = _mm_setzero_si128();
+		for (; i + 4 <= num_elems; i += 4)
+		{
+			__m128i const bytes = _mm_loadu_si128(reinterpret_cast<__m128i const *>(input + i * 4));
+			__m128i const lo = _mm_unpacklo_epi8(bytes, zero);
+			__m128i const hi = _mm_unpackhi_epi8(bytes, zero);
+			__m128i texels[] = { _mm_unpacklo_epi16(lo, zero), _mm_unpackhi_epi16(lo, zero),
+				_mm_unpacklo_epi16(hi, zero), _mm_unpackhi_epi16(hi, zero) };
+			for (uint32_t j = 0; j < 4; ++ j)
+			{
+				if (swap_rb)
+				{
+					texels[j] = _mm_shuffle_epi32(texels[j], _MM_SHUFFLE(3, 0, 1, 2));
+				}
+				_mm_storeu_ps(&output[i + j].r(), _mm_div_ps(_mm_cvtepi32_ps(texels[j]), scale));
+			}
+		}
+#endif
+
+		auto const & unorm8 = ConversionTables::Instance().unorm8;
+		uint32_t const r = swap_rb ? 2 : 0;
+		uint32_t const b = swap_rb ? 0 : 2;
+		for (uint8_t const * p = input + i * 4; i < num_elems; ++ i, p += 4)
+		{
+			output[i] = Color(unorm8[p[r]], unorm8[p[1]], unorm8[p[b]], unorm8[p[3]]);
+		}
+	}
+
+	// EF_ABGR8, or EF_ARGB8 if swap_rb
+	void ABGR32FToUNorm8x4(Color const * input, uint32_t num_elems, uint8_t* output, bool swap_rb)
+	{
+		uint32_t i = 0;
+#if defined(KLAYGE_SSE2_SUPPORT)
+		// The same mul, add and truncation as the scalar code. The 2 saturated packs clamp to [0, 255].
+		__m128 const scale = _mm_set1_ps(255.0f);
+		__m128 const half_one = _mm_set1_ps(0.5f);
+		for (; i + 4 <= num_elems; i += 4)
+		{
+			__m128i texels[4];
+			for (uint32_t j = 0; j < 4; ++ j)
+			{
+				__m128 clr = _mm_loadu_ps(&input[i + j].r());
+				if (swap_rb)
+				{
+					clr = _mm_shuffle_ps(clr, clr, _MM_SHUFFLE(3, 0, 1, 2));
+				}
+				texels[j] = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(clr, scale), half_one));
+			}
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(output + i * 4),
+				_mm_packus_epi16(_mm_packs_epi32(texels[0], texels[1]), _mm_packs_epi32(texels[2], texels[3])));
+		}
+#elif defined(KLAYGE_NEON_SUPPORT)
+		float32x4_t const half_one = vdupq_n_f32(0.5f);
+		for (; i + 2 <= num_elems; i += 2)
+		{
+			float32x4_t clr0 = vld1q_f32(&input[i + 0].r());
+			float32x4_t clr1 = vld1q_f32(&input[i + 1].r());
+			int32x4_t const texel0 = vcvtq_s32_f32(vaddq_f32(vmulq_n_f32(clr0, 255.0f), half_one));
+			int32x4_t const texel1 = vcvtq_s32_f32(vaddq_f32(vmulq_n_f32(clr1, 255.0f), half_one));
+			uint8x8_t bytes = vqmovn_u16(vcombine_u16(vqmovun_s32(texel0), vqmovun_s32(texel1)));
+			if (swap_rb)
+			{
+				uint8_t const swizzle[] = { 2, 1, 0, 3, 6, 5, 4, 7 };
+				bytes = vtbl1_u8(bytes, vld1_u8(swizzle));
+			}
+			vst1_u8(output + i * 4, bytes);
+		}
+#endif
+
+		uint32_t const r = swap_rb ? 2 : 0;
+		uint32_t const b = swap_rb ? 0 : 2;
+		for (uint8_t* p = output + i * 4; i < num_elems; ++ i, p += 4)
+		{
+			p[r] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(input[i].r() * 255.0f + 0.5f), 0, 255));
+			p[1] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(input[i].g() * 255.0f + 0.5f), 0, 255));
+			p[b] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(input[i].b() * 255.0f + 0.5f), 0, 255));
+			p[3] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(input[i].a() * 255.0f + 0.5f), 0, 255));
+		}
+	}
+
+	// Byte offsets of R, G, B, A in the 8-bit unorm formats, -1 for missing channels
+	struct UNorm8Layout
+	{
+		uint32_t elem_size;
+		int8_t offsets[4];
+	};
+
+	bool GetUNorm8Layout(ElementFormat fmt, UNorm8Layout& layout)
+	{
+		switch (fmt)
+		{
+		case EF_A8:
+			layout = { 1, { -1, -1, -1, 0 } };
+			return true;
+
+		case EF_R8:
+			layout = { 1, { 0, -1, -1, -1 } };
+			return true;
+
+		case EF_GR8:
+			layout = { 2, { 0, 1, -1, -1 } };
+			return true;
+
+		case EF_BGR8:
+			layout = { 3, { 0, 1, 2, -1 } };
+			return true;
+
+		case EF_ARGB8:
+			layout = { 4, { 2, 1, 0, 3 } };
+			return true;
+
+		case EF_ABGR8:
+			layout = { 4, { 0, 1, 2, 3 } };
+			return true;
+
+		default:
+			return false;
+		}
+	}
+}
+
 namespace KlayGE
 {
 	void ConvertToABGR32F(ElementFormat fmt, void const * input, uint32_t num_elems, Color* output)
@@ -47,9 +288,12 @@ namespace KlayGE
 		switch (fmt)
 		{
 		case EF_A8:
-			for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
 			{
-				*output = Color(0, 0, 0, *p / 255.0f);
+				auto const & unorm8 = ConversionTables::Instance().unorm8;
+				for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
+				{
+					*output = Color(0, 0, 0, unorm8[*p]);
+				}
 			}
 			break;
 
@@ -77,16 +321,22 @@ namespace KlayGE
 			break;
 
 		case EF_R8:
-			for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
 			{
-				*output = Color(*p / 255.0f, 0, 0, 1);
+				auto const & unorm8 = ConversionTables::Instance().unorm8;
+				for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
+				{
+					*output = Color(unorm8[*p], 0, 0, 1);
+				}
 			}
 			break;
 
 		case EF_GR8:
-			for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
 			{
-				*output = Color(p[0] / 255.0f, p[1] / 255.0f, 0, 1);
+				auto const & unorm8 = ConversionTables::Instance().unorm8;
+				for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
+				{
+					*output = Color(unorm8[p[0]], unorm8[p[1]], 0, 1);
+				}
 			}
 			break;
 
@@ -99,9 +349,12 @@ namespace KlayGE
 			break;
 
 		case EF_BGR8:
-			for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
 			{
-				*output = Color(p[0] / 255.0f, p[1] / 255.0f, p[2] / 255.0f, 1);
+				auto const & unorm8 = ConversionTables::Instance().unorm8;
+				for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
+				{
+					*output = Color(unorm8[p[0]], unorm8[p[1]], unorm8[p[2]], 1);
+				}
 			}
 			break;
 
@@ -114,17 +367,11 @@ namespace KlayGE
 			break;
 
 		case EF_ARGB8:
-			for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
-			{
-				*output = Color(p[2] / 255.0f, p[1] / 255.0f, p[0] / 255.0f, p[3] / 255.0f);
-			}
+			UNorm8x4ToABGR32F(p, num_elems, output, true);
 			break;
 
 		case EF_ABGR8:
-			for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
-			{
-				*output = Color(p[0] / 255.0f, p[1] / 255.0f, p[2] / 255.0f, p[3] / 255.0f);
-			}
+			UNorm8x4ToABGR32F(p, num_elems, output, false);
 			break;
 
 		case EF_SIGNED_ABGR8:
@@ -538,126 +785,59 @@ namespace KlayGE
 
 
 		case EF_R16F:
-			for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
 			{
-				half const s = *reinterpret_cast<half const *>(p);
-				*output = Color(s, 0, 0, 1);
+				auto const & half_to_float = ConversionTables::Instance().half_to_float;
+				for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
+				{
+					uint16_t const * s = reinterpret_cast<uint16_t const *>(p);
+					*output = Color(half_to_float[s[0]], 0, 0, 1);
+				}
 			}
 			break;
 
 		case EF_GR16F:
-			for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
 			{
-				half const * s = reinterpret_cast<half const *>(p);
-				*output = Color(s[0], s[1], 0, 1);
+				auto const & half_to_float = ConversionTables::Instance().half_to_float;
+				for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
+				{
+					uint16_t const * s = reinterpret_cast<uint16_t const *>(p);
+					*output = Color(half_to_float[s[0]], half_to_float[s[1]], 0, 1);
+				}
 			}
 			break;
 
 		case EF_B10G11R11F:
-			for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
 			{
 				// E5B5 E5G6 E5R6
-				uint32_t const s = *reinterpret_cast<uint32_t const *>(p);
-
-				union FNI
-				{
-					float f;
-					int32_t i;
-				} result[4];
-				uint32_t mantissa;
-				uint32_t exponent;
-
-				for (int j = 0; j < 2; ++ j)
+				auto const & tables = ConversionTables::Instance();
+				for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
 				{
-					// X & Y Channel (6-bit mantissa)
-					mantissa = (s >> (j * 11)) & 0x3F;
-					exponent = (s >> (j * 11 + 6)) & 0x1F;
-
-					if (0x1F == exponent) // INF or NAN
-					{
-						result[0].i = 0x7F800000 | (mantissa << 17);
-					}
-					else
-					{
-						if (0 == exponent)
-						{
-							if (mantissa != 0)
-							{
-								// The value is denormalized
-
-								// Normalize the value in the resulting float
-								exponent = 1;
-
-								do
-								{
-									-- exponent;
-									mantissa <<= 1;
-								} while (0 == (mantissa & 0x40));
-
-								mantissa &= 0x3F;
-							}
-							else
-							{
-								// The value is zero
-
-								exponent = static_cast<uint32_t>(-112);
-							}
-						}
-
-						result[j].i = ((exponent + 112) << 23) | (mantissa << 17);
-					}
-				}
-
-				// Z Channel (5-bit mantissa)
-				mantissa = (s >> 22) & 0x3F;
-				exponent = (s >> 27) & 0x1F;
-
-				if (0x1F == exponent) // INF or NAN
-				{
-					result[2].i = 0x7F800000 | (mantissa << 17);
+					uint32_t const s = *reinterpret_cast<uint32_t const *>(p);
+					*output = Color(tables.uf11_to_float[s & 0x7FF], tables.uf11_to_float[(s >> 11) & 0x7FF],
+						tables.uf10_to_float[s >> 22], 1);
 				}
-				else
-				{
-					if (0 == exponent)
-					{
-						if (mantissa != 0)
-						{
-							exponent = 1;
-	
-							do
-							{
-								-- exponent;
-								mantissa <<= 1;
-							} while (0 == (mantissa & 0x20));
-	
-							mantissa &= 0x1F;
-						}
-						else
-						{
-							exponent = static_cast<uint32_t>(-112);
-						}
-					}
-
-					result[2].i = ((exponent + 112) << 23) | (mantissa << 18);
-				}
-
-				*output = Color(result[0].f, result[1].f, result[2].f, 1);
 			}
 			break;
 
 		case EF_BGR16F:
-			for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
 			{
-				half const * s = reinterpret_cast<half const *>(p);
-				*output = Color(s[0], s[1], s[2], 1);
+				auto const & half_to_float = ConversionTables::Instance().half_to_float;
+				for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
+				{
+					uint16_t const * s = reinterpret_cast<uint16_t const *>(p);
+					*output = Color(half_to_float[s[0]], half_to_float[s[1]], half_to_float[s[2]], 1);
+				}
 			}
 			break;
 
 		case EF_ABGR16F:
-			for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
 			{
-				half const * s = reinterpret_cast<half const *>(p);
-				*output = Color(s[0], s[1], s[2], s[3]);
+				auto const & half_to_float = ConversionTables::Instance().half_to_float;
+				for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
+				{
+					uint16_t const * s = reinterpret_cast<uint16_t const *>(p);
+					*output = Color(half_to_float[s[0]], half_to_float[s[1]], half_to_float[s[2]], half_to_float[s[3]]);
+				}
 			}
 			break;
 
@@ -720,22 +900,22 @@ namespace KlayGE
 
 
 		case EF_ARGB8_SRGB:
-			for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
 			{
-				*output = Color(MathLib::srgb_to_linear(p[2] / 255.0f),
-					MathLib::srgb_to_linear(p[1] / 255.0f),
-					MathLib::srgb_to_linear(p[0] / 255.0f),
-					MathLib::srgb_to_linear(p[3] / 255.0f));
+				auto const & srgb8 = ConversionTables::Instance().srgb8;
+				for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
+				{
+					*output = Color(srgb8[p[2]], srgb8[p[1]], srgb8[p[0]], srgb8[p[3]]);
+				}
 			}
 			break;
 
 		case EF_ABGR8_SRGB:
-			for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
 			{
-				*output = Color(MathLib::srgb_to_linear(p[0] / 255.0f),
-					MathLib::srgb_to_linear(p[1] / 255.0f),
-					MathLib::srgb_to_linear(p[2] / 255.0f),
-					MathLib::srgb_to_linear(p[3] / 255.0f));
+				auto const & srgb8 = ConversionTables::Instance().srgb8;
+				for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
+				{
+					*output = Color(srgb8[p[0]], srgb8[p[1]], srgb8[p[2]], srgb8[p[3]]);
+				}
 			}
 			break;
 
@@ -835,23 +1015,11 @@ namespace KlayGE
 			break;
 
 		case EF_ARGB8:
-			for (uint32_t i = 0; i < num_elems; ++ i, ++ input, p += elem_size)
-			{
-				p[0] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(input->b() * 255.0f + 0.5f), 0, 255));
-				p[1] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(input->g() * 255.0f + 0.5f), 0, 255));
-				p[2] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(input->r() * 255.0f + 0.5f), 0, 255));
-				p[3] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(input->a() * 255.0f + 0.5f), 0, 255));
-			}
+			ABGR32FToUNorm8x4(input, num_elems, p, true);
 			break;
 
 		case EF_ABGR8:
-			for (uint32_t i = 0; i < num_elems; ++ i, ++ input, p += elem_size)
-			{
-				p[0] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(input->r() * 255.0f + 0.5f), 0, 255));
-				p[1] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(input->g() * 255.0f + 0.5f), 0, 255));
-				p[2] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(input->b() * 255.0f + 0.5f), 0, 255));
-				p[3] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(input->a() * 255.0f + 0.5f), 0, 255));
-			}
+			ABGR32FToUNorm8x4(input, num_elems, p, false);
 			break;
 
 		case EF_SIGNED_ABGR8:
@@ -1534,4 +1702,73 @@ namespace KlayGE
 			KFL_UNREACHABLE("Not supported element format");
 		}
 	}
+
+	void ConvertFormat(ElementFormat src_fmt, ElementFormat dst_fmt, void const * input, uint32_t num_elems, void* output)
+	{
+		uint8_t const * src = static_cast<uint8_t const *>(input);
+		uint8_t* dst = static_cast<uint8_t*>(output);
+
+		// 8-bit unorm to 8-bit unorm is a byte shuffle. Missing channels are filled the same way ConvertToABGR32F does.
+		UNorm8Layout src_layout;
+		UNorm8Layout dst_layout;
+		bool direct = GetUNorm8Layout(src_fmt, src_layout) && GetUNorm8Layout(dst_fmt, dst_layout);
+		if (!direct && ConversionTables::Instance().srgb8_round_trip)
+		{
+			if (((EF_ARGB8_SRGB == src_fmt) || (EF_ABGR8_SRGB == src_fmt))
+				&& ((EF_ARGB8_SRGB == dst_fmt) || (EF_ABGR8_SRGB == dst_fmt)))
+			{
+				GetUNorm8Layout((EF_ARGB8_SRGB == src_fmt) ? EF_ARGB8 : EF_ABGR8, src_layout);
+				GetUNorm8Layout((EF_ARGB8_SRGB == dst_fmt) ? EF_ARGB8 : EF_ABGR8, dst_layout);
+				direct = true;
+			}
+		}
+
+		if (direct)
+		{
+			if (src_fmt == dst_fmt)
+			{
+				// Only formats that survive the float round trip get here, half and float formats don't always
+				std::memcpy(output, input, num_elems * src_layout.elem_size);
+			}
+			else if ((4 == src_layout.elem_size) && (4 == dst_layout.elem_size))
+			{
+				// ARGB8 <-> ABGR8
+				for (uint32_t i = 0; i < num_elems; ++ i, src += 4, dst += 4)
+				{
+					uint32_t texel;
+					std::memcpy(&texel, src, sizeof(texel));
+					texel = (texel & 0xFF00FF00) | ((texel >> 16) & 0xFF) | ((texel & 0xFF) << 16);
+					std::memcpy(dst, &texel, sizeof(texel));
+				}
+			}
+			else
+			{
+				uint8_t const defaults[] = { 0, 0, 0, 255 };
+				for (uint32_t i = 0; i < num_elems; ++ i, src += src_layout.elem_size, dst += dst_layout.elem_size)
+				{
+					for (uint32_t c = 0; c < 4; ++ c)
+					{
+						if (dst_layout.offsets[c] >= 0)
+						{
+							dst[dst_layout.offsets[c]] = (src_layout.offsets[c] >= 0) ? src[src_layout.offsets[c]] : defaults[c];
+						}
+					}
+				}
+			}
+		}
+		else
+		{
+			uint32_t const src_elem_size = NumFormatBytes(src_fmt);
+			uint32_t const dst_elem_size = NumFormatBytes(dst_fmt);
+
+			uint32_t const BATCH_SIZE = 256;
+			std::array<Color, BATCH_SIZE> batch;
+			for (uint32_t i = 0; i < num_elems; i += BATCH_SIZE)
+			{
+				uint32_t const n = std::min(num_elems - i, BATCH_SIZE);
+				ConvertToABGR32F(src_fmt, src + i * src_elem_size, n, batch.data());
+				ConvertFromABGR32F(dst_fmt, batch.data(), n, dst + i * dst_elem_size);
+			}
+		}
+	}
 }
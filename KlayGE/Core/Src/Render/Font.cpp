@@ -72,9 +72,11 @@ namespace KlayGE
 	public:
 		explicit FontRenderable(std::shared_ptr<KFont> const & kfl)
 				: Renderable(L"Font"),
+					lru_head_(INVALID_SLOT), lru_tail_(INVALID_SLOT),
+					first_free_word_(0),
 					three_dim_(false),
-					kfont_loader_(kfl),
-					tick_(0)
+					dirty_rc_(0, 0, 0, 0),
+					kfont_loader_(kfl)
 		{
 			RenderFactory& rf = Context::Instance().RenderFactoryInstance();
 
@@ -96,9 +98,12 @@ namespace KlayGE
 			RenderDeviceCaps const & caps = renderEngine.DeviceCaps();
 			uint32_t size = std::min<uint32_t>(2048U, std::min<uint32_t>(caps.max_texture_width, caps.max_texture_height)) / kfont_char_size * kfont_char_size;
 			dist_texture_ = rf.MakeTexture2D(size, size, 1, 1, EF_R8, 1, 0, EAH_GPU_Read);
-			a_char_data_.resize(kfont_char_size * kfont_char_size);
+			atlas_data_.resize(size * size, 0);
 
-			char_free_list_.emplace_back(0, size * size / kfont_char_size / kfont_char_size);
+			uint32_t const num_slots = (size / kfont_char_size) * (size / kfont_char_size);
+			slots_.resize(num_slots, SlotInfo{ 0, INVALID_SLOT, INVALID_SLOT });
+			slot_bitmap_.resize((num_slots + 63) / 64, 0);
+			char_info_map_.reserve(num_slots);
 
 			effect_ = SyncLoadRenderEffect("Font.fxml");
 			*(effect_->ParameterByName("distance_tex")) = dist_texture_;
@@ -110,8 +115,10 @@ namespace KlayGE
 
 			uint32_t const INDEX_PER_CHAR = restart_ ? 5 : 6;
 			uint32_t const INIT_NUM_CHAR = 1024;
-			tb_vb_ = MakeUniquePtr<TransientBuffer>(static_cast<uint32_t>(INIT_NUM_CHAR * 4 * sizeof(FontVert)), TransientBuffer::BF_Vertex);
-			tb_ib_ = MakeUniquePtr<TransientBuffer>(static_cast<uint32_t>(INIT_NUM_CHAR * INDEX_PER_CHAR * sizeof(uint16_t)), TransientBuffer::BF_Index);
+			tb_vb_ = MakeUniquePtr<TransientBuffer>(static_cast<uint32_t>(INIT_NUM_CHAR * 4 * sizeof(FontVert)), TransientBuffer::BF_Vertex,
+				TransientBuffer::AM_Ring);
+			tb_ib_ = MakeUniquePtr<TransientBuffer>(static_cast<uint32_t>(INIT_NUM_CHAR * INDEX_PER_CHAR * sizeof(uint16_t)), TransientBuffer::BF_Index,
+				TransientBuffer::AM_Ring);
 
 			rls_[0]->BindVertexStream(tb_vb_->GetBuffer(), { VertexElement(VEU_Position, 0, EF_BGR32F),
 				VertexElement(VEU_Diffuse, 0, EF_ABGR8), VertexElement(VEU_TextureCoord, 0, EF_GR32F) });
@@ -145,6 +152,8 @@ namespace KlayGE
 				*dpi_scale_ep_ = Context::Instance().AppInstance().MainWnd()->DPIScale();
 			}
 
+			this->UploadDirtyGlyphs();
+
 			tb_vb_->EnsureDataReady();
 			tb_ib_->EnsureDataReady();
 
@@ -521,17 +530,12 @@ namespace KlayGE
 		/////////////////////////////////////////////////////////////////////////////////
 		void UpdateTexture(std::wstring_view text)
 		{
-			++ tick_;
-
-			uint32_t const tex_size = dist_texture_->Width(0);
-
 			KFont& kl = *kfont_loader_;
 			auto& cim = char_info_map_;
 
+			uint32_t const tex_size = dist_texture_->Width(0);
 			uint32_t const kfont_char_size = kl.CharSize();
-
 			uint32_t const num_chars_a_row = tex_size / kfont_char_size;
-			uint32_t const num_total_chars = num_chars_a_row * num_chars_a_row;
 
 			for (auto const & ch : text)
 			{
@@ -541,123 +545,143 @@ namespace KlayGE
 					auto cmiter = cim.find(ch);
 					if (cmiter != cim.end())
 					{
-						// ҵ
-
-						cmiter->second.tick = tick_;
+						this->UnlinkSlot(cmiter->second.slot);
+						this->LinkSlotAsMostRecent(cmiter->second.slot);
 					}
 					else
 					{
-						// ҲԵ
-
-						KFont::font_info const & ci = kl.CharInfo(offset);
-
-						uint32_t width = ci.width;
-						uint32_t height = ci.height;
-
-						int2 char_pos;
-						CharInfo charInfo;
-						if (cim.size() < num_total_chars)
+						uint32_t slot = this->AllocSlot();
+						if (INVALID_SLOT == slot)
 						{
-							// пռ
-
-							uint32_t const s = char_free_list_.front().first;
-						
-							char_pos.y() = s / num_chars_a_row;
-							char_pos.x() = s - char_pos.y() * num_chars_a_row;
+							// The atlas is full, reuses the slot of the least recently used char
+							slot = lru_tail_;
+							this->UnlinkSlot(slot);
+							cim.erase(slots_[slot].ch);
+						}
+						slots_[slot].ch = ch;
+						this->LinkSlotAsMostRecent(slot);
 
-							char_pos.x() *= kfont_char_size;
-							char_pos.y() *= kfont_char_size;
+						uint32_t const x = slot % num_chars_a_row * kfont_char_size;
+						uint32_t const y = slot / num_chars_a_row * kfont_char_size;
 
-							charInfo.rc.left() = static_cast<float>(char_pos.x()) / tex_size;
-							charInfo.rc.top() = static_cast<float>(char_pos.y()) / tex_size;
+						KFont::font_info const & ci = kl.CharInfo(offset);
 
-							++ char_free_list_.front().first;
-							if (char_free_list_.front().first == char_free_list_.front().second)
-							{
-								char_free_list_.pop_front();
-							}
+						CharInfo char_info;
+						char_info.rc.left() = static_cast<float>(x) / tex_size;
+						char_info.rc.top() = static_cast<float>(y) / tex_size;
+						char_info.rc.right() = char_info.rc.left() + static_cast<float>(ci.width) / tex_size;
+						char_info.rc.bottom() = char_info.rc.top() + static_cast<float>(ci.height) / tex_size;
+						char_info.slot = slot;
+						cim.emplace(ch, char_info);
+
+						// Decoded into the CPU copy only, all the glyphs changed in a frame go to the texture in one update
+						kl.GetDistanceData(&atlas_data_[y * tex_size + x], tex_size, offset);
+						UIRect const char_rc(x, y, x + kfont_char_size, y + kfont_char_size);
+						if (dirty_rc_.IsEmpty())
+						{
+							dirty_rc_ = char_rc;
 						}
 						else
 						{
-							// ҵʹʱûʹõ
-
-							uint64_t min_tick = cim.begin()->second.tick;
-							auto min_chiter = cim.begin();
-							for (auto chiter = cim.begin(); chiter != cim.end(); ++ chiter)
-							{
-								if (chiter->second.tick < min_tick)
-								{
-									min_tick = chiter->second.tick;
-									min_chiter = chiter;
-								}
-							}
-
-							char_pos.x() = static_cast<int32_t>(min_chiter->second.rc.left() * tex_size);
-							char_pos.y() = static_cast<int32_t>(min_chiter->second.rc.top() * tex_size);
-							charInfo.rc.left() = min_chiter->second.rc.left();
-							charInfo.rc.top() = min_chiter->second.rc.top();
-
-							for (auto chiter = cim.begin(); chiter != cim.end(); ++ chiter)
-							{
-								if (chiter->second.tick == min_tick)
-								{
-									uint32_t const x = static_cast<int32_t>(chiter->second.rc.left() * tex_size);
-									uint32_t const y = static_cast<int32_t>(chiter->second.rc.top() * tex_size);
-									uint32_t const id = y * num_chars_a_row + x;
-									auto freeiter = char_free_list_.begin();
-									while ((freeiter != char_free_list_.end()) && (freeiter->second <= id))
-									{
-										++ freeiter;
-									}
-									char_free_list_.emplace(freeiter, id, id + 1);
-
-									cim.erase(chiter);
-									break;
-								}
-							}
-							for (auto freeiter = char_free_list_.begin(); freeiter != char_free_list_.end();)
-							{
-								auto nextiter = freeiter;
-								++ nextiter;
-
-								if (nextiter != char_free_list_.end())
-								{
-									if (freeiter->second == nextiter->first)
-									{
-										freeiter->second = nextiter->second;
-										char_free_list_.erase(nextiter);
-									}
-									else
-									{
-										++ freeiter;
-									}
-								}
-								else
-								{
-									break;
-								}
-							}
+							dirty_rc_ |= char_rc;
 						}
+					}
+				}
+			}
+		}
 
-						charInfo.rc.right()		= charInfo.rc.left() + static_cast<float>(width) / tex_size;
-						charInfo.rc.bottom()	= charInfo.rc.top() + static_cast<float>(height) / tex_size;
-						charInfo.tick			= tick_;
+		void UploadDirtyGlyphs()
+		{
+			if (!dirty_rc_.IsEmpty())
+			{
+				uint32_t const tex_size = dist_texture_->Width(0);
+				dist_texture_->UpdateSubresource2D(0, 0, dirty_rc_.left(), dirty_rc_.top(), dirty_rc_.Width(), dirty_rc_.Height(),
+					&atlas_data_[dirty_rc_.top() * tex_size + dirty_rc_.left()], tex_size);
+				dirty_rc_ = UIRect(0, 0, 0, 0);
+			}
+		}
 
-						kl.GetDistanceData(&a_char_data_[0], kfont_char_size, offset);
-						dist_texture_->UpdateSubresource2D(0, 0, char_pos.x(), char_pos.y(), kfont_char_size, kfont_char_size,
-							&a_char_data_[0], kfont_char_size);
+		// Finds a free slot in the bitmap. Once the atlas is full, slots are only reused through the LRU list.
+		uint32_t AllocSlot()
+		{
+			for (; first_free_word_ < slot_bitmap_.size(); ++ first_free_word_)
+			{
+				uint64_t const word = slot_bitmap_[first_free_word_];
+				if (word != ~uint64_t(0))
+				{
+					uint32_t bit = 0;
+					while (word & (uint64_t(1) << bit))
+					{
+						++ bit;
+					}
 
-						cim.emplace(ch, charInfo);
+					uint32_t const slot = first_free_word_ * 64 + bit;
+					if (slot >= slots_.size())
+					{
+						break;
 					}
+
+					slot_bitmap_[first_free_word_] |= uint64_t(1) << bit;
+					return slot;
 				}
 			}
+
+			return INVALID_SLOT;
+		}
+
+		void UnlinkSlot(uint32_t slot)
+		{
+			SlotInfo& info = slots_[slot];
+			if (info.prev != INVALID_SLOT)
+			{
+				slots_[info.prev].next = info.next;
+			}
+			else
+			{
+				lru_head_ = info.next;
+			}
+			if (info.next != INVALID_SLOT)
+			{
+				slots_[info.next].prev = info.prev;
+			}
+			else
+			{
+				lru_tail_ = info.prev;
+			}
+			info.prev = info.next = INVALID_SLOT;
+		}
+
+		void LinkSlotAsMostRecent(uint32_t slot)
+		{
+			SlotInfo& info = slots_[slot];
+			info.prev = INVALID_SLOT;
+			info.next = lru_head_;
+			if (lru_head_ != INVALID_SLOT)
+			{
+				slots_[lru_head_].prev = slot;
+			}
+			else
+			{
+				lru_tail_ = slot;
+			}
+			lru_head_ = slot;
 		}
 
 	private:
+		static uint32_t constexpr INVALID_SLOT = 0xFFFFFFFFU;
+
 		struct CharInfo
 		{
 			Rect rc;
-			uint64_t tick;
+			uint32_t slot;
+		};
+
+		// A node of the intrusive LRU list, one per atlas slot. prev is the more recently used one.
+		struct SlotInfo
+		{
+			wchar_t ch;
+			uint32_t prev;
+			uint32_t next;
 		};
 
 #ifdef KLAYGE_HAS_STRUCT_PACK
@@ -684,7 +708,11 @@ namespace KlayGE
 		bool restart_;
 
 		std::unordered_map<wchar_t, CharInfo> char_info_map_;
-		std::list<std::pair<uint32_t, uint32_t>> char_free_list_;
+		std::vector<SlotInfo> slots_;
+		uint32_t lru_head_;
+		uint32_t lru_tail_;
+		std::vector<uint64_t> slot_bitmap_;
+		uint32_t first_free_word_;
 
 		bool three_dim_;
 
@@ -694,15 +722,14 @@ namespace KlayGE
 		std::vector<SubAlloc> tb_ib_sub_allocs_;
 
 		TexturePtr		dist_texture_;
-		std::vector<uint8_t> a_char_data_;
+		std::vector<uint8_t> atlas_data_;
+		UIRect dirty_rc_;
 
 		RenderEffectParameter* half_width_height_ep_;
 		RenderEffectParameter* dpi_scale_ep_;
 		RenderEffectParameter* mvp_ep_;
 
 		std::shared_ptr<KFont> kfont_loader_;
-
-		uint64_t tick_;
 	};
 }
 
@@ -773,6 +800,15 @@ namespace
 			return true;
 		}
 
+		uint64_t Hash() const override
+		{
+			size_t seed = 0;
+			HashCombine(seed, this->Type());
+			HashRange(seed, font_desc_.res_name.begin(), font_desc_.res_name.end());
+			HashCombine(seed, font_desc_.flag);
+			return seed;
+		}
+
 		bool Match(ResLoadingDesc const & rhs) const override
 		{
 			if (this->Type() == rhs.Type())
@@ -21,6 +21,7 @@
 
 #include <KlayGE/KlayGE.hpp>
 #include <KFL/CXX17/filesystem.hpp>
+#include <KFL/CustomizedStreamBuf.hpp>
 #include <KFL/ErrorHandling.hpp>
 #include <KFL/Math.hpp>
 #include <KlayGE/Context.hpp>
@@ -36,13 +37,16 @@
 #include <KlayGE/RenderMaterial.hpp>
 #include <KlayGE/DevHelper.hpp>
 #include <KFL/Hash.hpp>
+#include <KFL/Thread.hpp>
 #include <KlayGE/DeferredRenderingLayer.hpp>
 #include <KlayGE/SceneManager.hpp>
 
 #include <algorithm>
 #include <fstream>
+#include <functional>
 #include <sstream>
 #include <cstring>
+#include <thread>
 
 #include <KlayGE/Mesh.hpp>
 
@@ -50,7 +54,87 @@ namespace
 {
 	using namespace KlayGE;
 
-	uint32_t const MODEL_BIN_VERSION = 16;
+	uint32_t const MODEL_BIN_VERSION = 17;
+
+	// Since version 17, the payload of a .model_bin is split into chunks. Every chunk is compressed on its own, so they can be
+	// decoded in parallel, and vertex/index chunks are decoded straight into their buffers.
+	enum ModelChunkType
+	{
+		MCT_Header = 0,
+		MCT_Materials,
+		MCT_VertexStream,
+		MCT_Indices,
+		MCT_Meshes,
+		MCT_Nodes,
+		MCT_Joints,
+		MCT_KeyFrames
+	};
+
+	enum ModelChunkFlag
+	{
+		MCF_LZMA = 1UL << 0
+	};
+
+	struct ModelChunkDesc
+	{
+		uint32_t type;
+		uint32_t flags;
+		uint64_t original_len;
+		uint64_t stored_len;
+	};
+	static_assert(sizeof(ModelChunkDesc) == 24, "ModelChunkDesc must be tightly packed.");
+
+	// Chunks smaller than this are stored uncompressed
+	uint64_t const MIN_COMPRESSED_CHUNK_SIZE = 256;
+	// Chunks smaller than this are decoded on the calling thread
+	uint64_t const MIN_PARALLEL_CHUNK_SIZE = 64 * 1024;
+
+	void DecodeModelChunk(ModelChunkDesc const & desc, ArrayRef<uint8_t> stored, void* output)
+	{
+		if (desc.original_len > 0)
+		{
+			if (desc.flags & MCF_LZMA)
+			{
+				LZMACodec lzma;
+				lzma.Decode(output, stored, desc.original_len);
+			}
+			else
+			{
+				BOOST_ASSERT(stored.size() == desc.original_len);
+				std::memcpy(output, stored.data(), stored.size());
+			}
+		}
+	}
+
+	class ModelChunkStreamBuf : public MemInputStreamBuf
+	{
+	public:
+		explicit ModelChunkStreamBuf(std::vector<uint8_t> data)
+			: MemInputStreamBuf(data.data(), static_cast<std::streamsize>(data.size())),
+				data_(std::move(data))
+		{
+		}
+
+	private:
+		std::vector<uint8_t> data_;
+	};
+
+	// Uncompressed chunks are read in place, so the stored data has to outlive the returned ResIdentifier.
+	ResIdentifierPtr OpenModelChunk(ResIdentifier const & file, ModelChunkDesc const & desc, ArrayRef<uint8_t> stored)
+	{
+		std::shared_ptr<std::streambuf> sb;
+		if (desc.flags & MCF_LZMA)
+		{
+			std::vector<uint8_t> decoded(static_cast<size_t>(desc.original_len));
+			DecodeModelChunk(desc, stored, decoded.data());
+			sb = MakeSharedPtr<ModelChunkStreamBuf>(std::move(decoded));
+		}
+		else
+		{
+			sb = MakeSharedPtr<MemInputStreamBuf>(stored.data(), static_cast<std::streamsize>(stored.size()));
+		}
+		return MakeSharedPtr<ResIdentifier>(file.ResName(), file.Timestamp(), MakeSharedPtr<std::istream>(sb.get()), sb);
+	}
 
 	class RenderModelLoadingDesc : public ResLoadingDesc
 	{
@@ -133,6 +217,14 @@ namespace
 			return true;
 		}
 
+		uint64_t Hash() const override
+		{
+			size_t seed = 0;
+			HashCombine(seed, this->Type());
+			HashRange(seed, model_desc_.res_name.begin(), model_desc_.res_name.end());
+			return seed;
+		}
+
 		bool Match(ResLoadingDesc const & rhs) const override
 		{
 			KFL_UNUSED(rhs);
@@ -342,6 +434,50 @@ namespace
 		ModelDesc model_desc_;
 		std::mutex main_thread_stage_mutex_;
 	};
+
+	SIMDVectorF4 LoadQuaternion(Quaternion const & q)
+	{
+		return SIMDMathLib::SetVector(q.x(), q.y(), q.z(), q.w());
+	}
+
+	Quaternion StoreQuaternion(SIMDVectorF4 const & v)
+	{
+		Quaternion q;
+		SIMDMathLib::StoreVector4(&q[0], v);
+		return q;
+	}
+
+	// Dual quaternions can't represent mirroring, so a negative scale on either side goes through matrices
+	void ComposeThroughMatrices(Quaternion const & lhs_real, Quaternion const & lhs_dual, float lhs_scale,
+		Quaternion const & rhs_real, Quaternion const & rhs_dual, float rhs_scale,
+		Quaternion& real, Quaternion& dual, float& scale, float& flip)
+	{
+		float4x4 tmp_mat = MathLib::scaling(MathLib::abs(lhs_scale), MathLib::abs(lhs_scale), lhs_scale)
+			* MathLib::to_matrix(lhs_real)
+			* MathLib::translation(MathLib::udq_to_trans(lhs_real, lhs_dual))
+			* MathLib::scaling(MathLib::abs(rhs_scale), MathLib::abs(rhs_scale), rhs_scale)
+			* MathLib::to_matrix(rhs_real)
+			* MathLib::translation(MathLib::udq_to_trans(rhs_real, rhs_dual));
+
+		flip = 1;
+		if (MathLib::dot(MathLib::cross(float3(tmp_mat(0, 0), tmp_mat(0, 1), tmp_mat(0, 2)),
+			float3(tmp_mat(1, 0), tmp_mat(1, 1), tmp_mat(1, 2))),
+			float3(tmp_mat(2, 0), tmp_mat(2, 1), tmp_mat(2, 2))) < 0)
+		{
+			tmp_mat(2, 0) = -tmp_mat(2, 0);
+			tmp_mat(2, 1) = -tmp_mat(2, 1);
+			tmp_mat(2, 2) = -tmp_mat(2, 2);
+
+			flip = -1;
+		}
+
+		float3 scale3;
+		float3 trans;
+		MathLib::decompose(scale3, real, trans, tmp_mat);
+
+		dual = MathLib::quat_trans_to_udq(real, trans);
+		scale = scale3.x();
+	}
 }
 
 namespace KlayGE
@@ -646,27 +782,66 @@ namespace KlayGE
 
 	std::tuple<Quaternion, Quaternion, float> KeyFrameSet::Frame(float frame) const
 	{
-		std::tuple<Quaternion, Quaternion, float> ret;
-		if (frame_id.size() == 1)
+		uint32_t cursor = 0;
+		return this->Frame(frame, cursor);
+	}
+
+	std::tuple<Quaternion, Quaternion, float> KeyFrameSet::Frame(float frame, uint32_t& cursor) const
+	{
+		SIMDVectorF4 real;
+		SIMDVectorF4 dual;
+		float scale;
+		this->Frame(frame, cursor, real, dual, scale);
+		return std::make_tuple(StoreQuaternion(real), StoreQuaternion(dual), scale);
+	}
+
+	void KeyFrameSet::Frame(float frame, uint32_t& cursor, SIMDVectorF4& real, SIMDVectorF4& dual, float& scale) const
+	{
+		uint32_t const num_keys = static_cast<uint32_t>(frame_id.size());
+		if (num_keys == 1)
 		{
-			ret = std::make_tuple(bind_real[0], bind_dual[0], bind_scale[0]);
+			cursor = 0;
+			real = LoadQuaternion(bind_real[0]);
+			dual = LoadQuaternion(bind_dual[0]);
+			scale = bind_scale[0];
 		}
 		else
 		{
-			frame = std::fmod(frame, static_cast<float>(frame_id.back() + 1));
+			float const period = static_cast<float>(frame_id.back() + 1);
+			if (frame >= period)
+			{
+				frame = std::fmod(frame, period);
+			}
 
-			auto iter = std::upper_bound(frame_id.begin(), frame_id.end(), frame);
-			int index = static_cast<int>(iter - frame_id.begin());
+			auto in_segment = [this, num_keys, frame](uint32_t index)
+				{
+					return (index < num_keys) && (frame_id[index] <= frame)
+						&& ((index + 1 == num_keys) || (frame < frame_id[index + 1]));
+				};
+			if (!in_segment(cursor))
+			{
+				if (in_segment(cursor + 1))
+				{
+					++ cursor;
+				}
+				else
+				{
+					auto iter = std::upper_bound(frame_id.begin(), frame_id.end(), frame);
+					cursor = static_cast<uint32_t>(std::max<ptrdiff_t>(iter - frame_id.begin(), 1) - 1);
+				}
+			}
 
-			int index0 = index - 1;
-			int index1 = index % frame_id.size();
+			uint32_t const index0 = cursor;
+			uint32_t const index1 = (cursor + 1) % num_keys;
 			int frame0 = frame_id[index0];
 			int frame1 = frame_id[index1];
 			float factor = (frame - frame0) / (frame1 - frame0);
-			auto dq = MathLib::sclerp(bind_real[index0], bind_dual[index0], bind_real[index1], bind_dual[index1], factor);
-			ret = std::make_tuple(dq.first, dq.second, MathLib::lerp(bind_scale[index0], bind_scale[index1], factor));
+			auto dq = SIMDMathLib::Sclerp(LoadQuaternion(bind_real[index0]), LoadQuaternion(bind_dual[index0]),
+				LoadQuaternion(bind_real[index1]), LoadQuaternion(bind_dual[index1]), factor);
+			real = dq.first;
+			dual = dq.second;
+			scale = MathLib::lerp(bind_scale[index0], bind_scale[index1], factor);
 		}
-		return ret;
 	}
 
 	AABBox AABBKeyFrameSet::Frame(float frame) const
@@ -707,91 +882,117 @@ namespace KlayGE
 
 	void SkinnedModel::BuildBones(float frame)
 	{
-		for (size_t i = 0; i < joints_.size(); ++ i)
-		{
-			Joint& joint = joints_[i];
-			KeyFrameSet const & kf = (*key_frame_sets_)[i];
+		size_t const num_joints = joints_.size();
+		key_frame_cursors_.resize(num_joints, 0);
 
-			std::tuple<Quaternion, Quaternion, float> key_dq = kf.Frame(frame);
+		for (size_t i = 0; i < num_joints; ++ i)
+		{
+			SIMDVectorF4 key_real;
+			SIMDVectorF4 key_dual;
+			float key_scale;
+			(*key_frame_sets_)[i].Frame(frame, key_frame_cursors_[i], key_real, key_dual, key_scale);
 
-			if (joint.parent != -1)
+			int16_t const parent = joint_parents_[i];
+			if (parent != -1)
 			{
-				Joint const & parent(joints_[joint.parent]);
+				SIMDVectorF4 const & parent_real = pose_reals_[parent];
+				SIMDVectorF4 const & parent_dual = pose_duals_[parent];
+				float const parent_scale = pose_scales_[parent];
 
-				if (MathLib::dot(std::get<0>(key_dq), parent.bind_real) < 0)
+				if (SIMDMathLib::GetX(SIMDMathLib::DotVector4(key_real, parent_real)) < 0)
 				{
-					std::get<0>(key_dq) = -std::get<0>(key_dq);
-					std::get<1>(key_dq) = -std::get<1>(key_dq);
+					key_real = -key_real;
+					key_dual = -key_dual;
 				}
 
-				if ((MathLib::SignBit(std::get<2>(key_dq)) > 0) && (MathLib::SignBit(parent.bind_scale) > 0))
+				if ((MathLib::SignBit(key_scale) > 0) && (MathLib::SignBit(parent_scale) > 0))
 				{
-					joint.bind_real = MathLib::mul_real(std::get<0>(key_dq), parent.bind_real);
-					joint.bind_dual = MathLib::mul_dual(std::get<0>(key_dq), std::get<1>(key_dq) * parent.bind_scale,
-						parent.bind_real, parent.bind_dual);
-					joint.bind_scale = std::get<2>(key_dq) * parent.bind_scale;
+					pose_reals_[i] = SIMDMathLib::MultiplyQuat(key_real, parent_real);
+					pose_duals_[i] = SIMDMathLib::MultiplyDual(key_real, key_dual * parent_scale, parent_real, parent_dual);
+					pose_scales_[i] = key_scale * parent_scale;
 				}
 				else
 				{
-					float const key_scale = std::get<2>(key_dq);
-					float4x4 tmp_mat = MathLib::scaling(MathLib::abs(key_scale), MathLib::abs(key_scale), key_scale)
-						* MathLib::to_matrix(std::get<0>(key_dq))
-						* MathLib::translation(MathLib::udq_to_trans(std::get<0>(key_dq), std::get<1>(key_dq)))
-						* MathLib::scaling(MathLib::abs(parent.bind_scale), MathLib::abs(parent.bind_scale), parent.bind_scale)
-						* MathLib::to_matrix(parent.bind_real)
-						* MathLib::translation(MathLib::udq_to_trans(parent.bind_real, parent.bind_dual));
-
-					float flip = 1;
-					if (MathLib::dot(MathLib::cross(float3(tmp_mat(0, 0), tmp_mat(0, 1), tmp_mat(0, 2)),
-						float3(tmp_mat(1, 0), tmp_mat(1, 1), tmp_mat(1, 2))),
-						float3(tmp_mat(2, 0), tmp_mat(2, 1), tmp_mat(2, 2))) < 0)
-					{
-						tmp_mat(2, 0) = -tmp_mat(2, 0);
-						tmp_mat(2, 1) = -tmp_mat(2, 1);
-						tmp_mat(2, 2) = -tmp_mat(2, 2);
-
-						flip = -1;
-					}
-
-					float3 scale;
-					Quaternion rot;
-					float3 trans;
-					MathLib::decompose(scale, rot, trans, tmp_mat);
-
-					joint.bind_real = rot;
-					joint.bind_dual = MathLib::quat_trans_to_udq(rot, trans);
-					joint.bind_scale = flip * scale.x();
+					Quaternion real;
+					Quaternion dual;
+					float scale;
+					float flip;
+					ComposeThroughMatrices(StoreQuaternion(key_real), StoreQuaternion(key_dual), key_scale,
+						StoreQuaternion(parent_real), StoreQuaternion(parent_dual), parent_scale,
+						real, dual, scale, flip);
+
+					pose_reals_[i] = LoadQuaternion(real);
+					pose_duals_[i] = LoadQuaternion(dual);
+					pose_scales_[i] = flip * scale;
 				}
 			}
 			else
 			{
-				joint.bind_real = std::get<0>(key_dq);
-				joint.bind_dual = std::get<1>(key_dq);
-				joint.bind_scale = std::get<2>(key_dq);
+				pose_reals_[i] = key_real;
+				pose_duals_[i] = key_dual;
+				pose_scales_[i] = key_scale;
 			}
 		}
 
-		this->UpdateBinds();
+		for (size_t i = 0; i < num_joints; ++ i)
+		{
+			Joint& joint = joints_[i];
+			joint.bind_real = StoreQuaternion(pose_reals_[i]);
+			joint.bind_dual = StoreQuaternion(pose_duals_[i]);
+			joint.bind_scale = pose_scales_[i];
+		}
+
+		this->ComposeBinds();
 	}
 
 	void SkinnedModel::UpdateBinds()
 	{
-		bind_reals_.resize(joints_.size());
-		bind_duals_.resize(joints_.size());
-		for (size_t i = 0; i < joints_.size(); ++ i)
+		size_t const num_joints = joints_.size();
+		joint_parents_.resize(num_joints);
+		inverse_origin_reals_.resize(num_joints);
+		inverse_origin_duals_.resize(num_joints);
+		inverse_origin_scales_.resize(num_joints);
+		pose_reals_.resize(num_joints);
+		pose_duals_.resize(num_joints);
+		pose_scales_.resize(num_joints);
+		for (size_t i = 0; i < num_joints; ++ i)
 		{
 			Joint const & joint = joints_[i];
 
-			Quaternion bind_real, bind_dual;
+			joint_parents_[i] = joint.parent;
+			inverse_origin_reals_[i] = LoadQuaternion(joint.inverse_origin_real);
+			inverse_origin_duals_[i] = LoadQuaternion(joint.inverse_origin_dual);
+			inverse_origin_scales_[i] = joint.inverse_origin_scale;
+			pose_reals_[i] = LoadQuaternion(joint.bind_real);
+			pose_duals_[i] = LoadQuaternion(joint.bind_dual);
+			pose_scales_[i] = joint.bind_scale;
+		}
+
+		this->ComposeBinds();
+	}
+
+	void SkinnedModel::ComposeBinds()
+	{
+		size_t const num_joints = joints_.size();
+		bind_reals_.resize(num_joints);
+		bind_duals_.resize(num_joints);
+		for (size_t i = 0; i < num_joints; ++ i)
+		{
+			SIMDVectorF4 const & inverse_origin_real = inverse_origin_reals_[i];
+			SIMDVectorF4 const & inverse_origin_dual = inverse_origin_duals_[i];
+			float const inverse_origin_scale = inverse_origin_scales_[i];
+
+			SIMDVectorF4 bind_real;
+			SIMDVectorF4 bind_dual;
 			float bind_scale;
-			if ((MathLib::SignBit(joint.inverse_origin_scale) > 0) && (MathLib::SignBit(joint.bind_scale) > 0))
+			if ((MathLib::SignBit(inverse_origin_scale) > 0) && (MathLib::SignBit(pose_scales_[i]) > 0))
 			{
-				bind_real = MathLib::mul_real(joint.inverse_origin_real, joint.bind_real);
-				bind_dual = MathLib::mul_dual(joint.inverse_origin_real, joint.inverse_origin_dual,
-					joint.bind_real, joint.bind_dual);
-				bind_scale = joint.inverse_origin_scale * joint.bind_scale;
+				bind_real = SIMDMathLib::MultiplyQuat(inverse_origin_real, pose_reals_[i]);
+				bind_dual = SIMDMathLib::MultiplyDual(inverse_origin_real, inverse_origin_dual,
+					pose_reals_[i], pose_duals_[i]);
+				bind_scale = inverse_origin_scale * pose_scales_[i];
 
-				if (MathLib::SignBit(bind_real.w()) < 0)
+				if (MathLib::SignBit(SIMDMathLib::GetW(bind_real)) < 0)
 				{
 					bind_real = -bind_real;
 					bind_dual = -bind_dual;
@@ -799,43 +1000,24 @@ namespace KlayGE
 			}
 			else
 			{
-				float4x4 tmp_mat = MathLib::scaling(MathLib::abs(joint.inverse_origin_scale), MathLib::abs(joint.inverse_origin_scale), joint.inverse_origin_scale)
-					* MathLib::to_matrix(joint.inverse_origin_real)
-					* MathLib::translation(MathLib::udq_to_trans(joint.inverse_origin_real, joint.inverse_origin_dual))
-					* MathLib::scaling(MathLib::abs(joint.bind_scale), MathLib::abs(joint.bind_scale), joint.bind_scale)
-					* MathLib::to_matrix(joint.bind_real)
-					* MathLib::translation(MathLib::udq_to_trans(joint.bind_real, joint.bind_dual));
-
-				float flip = 1;
-				if (MathLib::dot(MathLib::cross(float3(tmp_mat(0, 0), tmp_mat(0, 1), tmp_mat(0, 2)),
-					float3(tmp_mat(1, 0), tmp_mat(1, 1), tmp_mat(1, 2))),
-					float3(tmp_mat(2, 0), tmp_mat(2, 1), tmp_mat(2, 2))) < 0)
-				{
-					tmp_mat(2, 0) = -tmp_mat(2, 0);
-					tmp_mat(2, 1) = -tmp_mat(2, 1);
-					tmp_mat(2, 2) = -tmp_mat(2, 2);
-
-					flip = -1;
-				}
-
-				float3 scale;
-				Quaternion rot;
-				float3 trans;
-				MathLib::decompose(scale, rot, trans, tmp_mat);
-
-				bind_real = rot;
-				bind_dual = MathLib::quat_trans_to_udq(rot, trans);
-				bind_scale = scale.x();
-
-				if (flip * MathLib::SignBit(bind_real.w()) < 0)
+				Quaternion real;
+				Quaternion dual;
+				float flip;
+				ComposeThroughMatrices(StoreQuaternion(inverse_origin_real), StoreQuaternion(inverse_origin_dual), inverse_origin_scale,
+					StoreQuaternion(pose_reals_[i]), StoreQuaternion(pose_duals_[i]), pose_scales_[i],
+					real, dual, bind_scale, flip);
+
+				bind_real = LoadQuaternion(real);
+				bind_dual = LoadQuaternion(dual);
+				if (flip * MathLib::SignBit(real.w()) < 0)
 				{
 					bind_real = -bind_real;
 					bind_dual = -bind_dual;
 				}
 			}
 
-			bind_reals_[i] = float4(bind_real.x(), bind_real.y(), bind_real.z(), bind_real.w()) * bind_scale;
-			bind_duals_[i] = float4(bind_dual.x(), bind_dual.y(), bind_dual.z(), bind_dual.w());
+			SIMDMathLib::StoreVector4(&bind_reals_[i][0], bind_real * bind_scale);
+			SIMDMathLib::StoreVector4(&bind_duals_[i][0], bind_dual);
 		}
 	}
 
@@ -854,6 +1036,61 @@ namespace KlayGE
 		}
 	}
 
+	void SkinnedModel::SetFrames(ArrayRef<SkinnedModel*> models, ArrayRef<float> frames)
+	{
+		BOOST_ASSERT(models.size() == frames.size());
+
+		size_t const MIN_MODELS_PER_TASK = 4;
+
+		std::vector<size_t> changed_models;
+		changed_models.reserve(models.size());
+		for (size_t i = 0; i < models.size(); ++ i)
+		{
+			if (models[i]->last_frame_ != frames[i])
+			{
+				models[i]->last_frame_ = frames[i];
+				changed_models.push_back(i);
+			}
+		}
+
+		auto build_bones = [&models, &frames, &changed_models](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; ++ i)
+				{
+					size_t const index = changed_models[i];
+					models[index]->BuildBones(frames[index]);
+				}
+			};
+
+		size_t const num_models = changed_models.size();
+		size_t const num_tasks = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1U),
+			std::max<size_t>(num_models / MIN_MODELS_PER_TASK, 1));
+		if (num_tasks <= 1)
+		{
+			build_bones(0, num_models);
+		}
+		else
+		{
+			size_t const models_per_task = (num_models + num_tasks - 1) / num_tasks;
+
+			std::vector<joiner<void>> joiners;
+			joiners.reserve(num_tasks - 1);
+			for (size_t task_begin = models_per_task; task_begin < num_models; task_begin += models_per_task)
+			{
+				size_t const task_end = std::min(task_begin + models_per_task, num_models);
+				joiners.push_back(Context::Instance().ThreadPool()([&build_bones, task_begin, task_end]
+					{
+						build_bones(task_begin, task_end);
+					}));
+			}
+			build_bones(0, std::min(models_per_task, num_models));
+			for (auto& task_joiner : joiners)
+			{
+				task_joiner();
+			}
+		}
+	}
+
 	void SkinnedModel::RebindJoints()
 	{
 		this->BuildBones(last_frame_);
@@ -994,129 +1231,9 @@ namespace KlayGE
 		}
 	}
 
-	RenderModelPtr LoadSoftwareModel(std::string_view model_name)
+	void ReadMaterialsChunk(ResIdentifierPtr const & decoded, std::vector<RenderMaterialPtr>& mtls)
 	{
-		char const * JIT_EXT_NAME = ".model_bin";
-
-		std::string runtime_name(model_name);
-		if (std::filesystem::path(runtime_name).extension() != JIT_EXT_NAME)
-		{
-			std::string const metadata_name = runtime_name + ".kmeta";
-			runtime_name += JIT_EXT_NAME;
-
-			bool jit = false;
-			if (ResLoader::Instance().Locate(runtime_name).empty())
-			{
-				jit = true;
-			}
-			else
-			{
-				ResIdentifierPtr runtime_file = ResLoader::Instance().Open(runtime_name);
-				uint32_t fourcc;
-				runtime_file->read(&fourcc, sizeof(fourcc));
-				fourcc = LE2Native(fourcc);
-				uint32_t ver;
-				runtime_file->read(&ver, sizeof(ver));
-				ver = LE2Native(ver);
-				if ((fourcc != MakeFourCC<'K', 'L', 'M', ' '>::value) || (ver != MODEL_BIN_VERSION))
-				{
-					jit = true;
-				}
-				else
-				{
-					uint64_t const runtime_file_timestamp = runtime_file->Timestamp();
-					uint64_t const input_file_timestamp = ResLoader::Instance().Timestamp(model_name);
-					uint64_t const metadata_timestamp = ResLoader::Instance().Timestamp(metadata_name);
-					if (((input_file_timestamp > 0) && (runtime_file_timestamp < input_file_timestamp))
-						|| ((metadata_timestamp > 0) && (runtime_file_timestamp < metadata_timestamp)))
-					{
-						jit = true;
-					}
-				}
-			}
-
-			if (jit)
-			{
-#if KLAYGE_IS_DEV_PLATFORM
-				RenderFactory& rf = Context::Instance().RenderFactoryInstance();
-				RenderDeviceCaps const & caps = rf.RenderEngineInstance().DeviceCaps();
-
-				return Context::Instance().DevHelperInstance().ConvertModel(model_name, metadata_name, runtime_name, &caps);
-#else
-				LogError() << "Could NOT locate " << runtime_name << std::endl;
-				return RenderModelPtr();
-#endif
-			}
-		}
-
-		std::vector<RenderMaterialPtr> mtls;
-		std::vector<VertexElement> merged_ves;
-		char all_is_index_16_bit;
-		std::vector<std::vector<uint8_t>> merged_buff;
-		std::vector<uint8_t> merged_indices;
-		std::vector<std::string> mesh_names;
-		std::vector<int32_t> mtl_ids;
-		std::vector<uint32_t> mesh_lods;
-		std::vector<AABBox> pos_bbs;
-		std::vector<AABBox> tc_bbs;
-		std::vector<uint32_t> mesh_num_vertices;
-		std::vector<uint32_t> mesh_base_vertices;
-		std::vector<uint32_t> mesh_num_indices;
-		std::vector<uint32_t> mesh_start_indices;
-		std::vector<std::pair<SceneNodePtr, std::vector<uint16_t>>> nodes;
-		std::vector<Joint> joints;
-		std::shared_ptr<std::vector<AnimationAction>> actions;
-		std::shared_ptr<std::vector<KeyFrameSet>> kfs;
-		uint32_t num_frames = 0;
-		uint32_t frame_rate = 0;
-		std::vector<std::shared_ptr<AABBKeyFrameSet>> frame_pos_bbs;
-
-		ResIdentifierPtr runtime_file = ResLoader::Instance().Open(runtime_name);
-
-		uint32_t fourcc;
-		runtime_file->read(&fourcc, sizeof(fourcc));
-		fourcc = LE2Native(fourcc);
-		BOOST_ASSERT((fourcc == MakeFourCC<'K', 'L', 'M', ' '>::value));
-
-		uint32_t ver;
-		runtime_file->read(&ver, sizeof(ver));
-		ver = LE2Native(ver);
-		BOOST_ASSERT(MODEL_BIN_VERSION == ver);
-
-		std::shared_ptr<std::stringstream> ss = MakeSharedPtr<std::stringstream>();
-
-		uint64_t original_len, len;
-		runtime_file->read(&original_len, sizeof(original_len));
-		original_len = LE2Native(original_len);
-		runtime_file->read(&len, sizeof(len));
-		len = LE2Native(len);
-
-		LZMACodec lzma;
-		lzma.Decode(*ss, runtime_file, len, original_len);
-
-		ResIdentifierPtr decoded = MakeSharedPtr<ResIdentifier>(runtime_file->ResName(), runtime_file->Timestamp(), ss);
-
-		uint32_t num_mtls;
-		decoded->read(&num_mtls, sizeof(num_mtls));
-		num_mtls = LE2Native(num_mtls);
-		uint32_t num_meshes;
-		decoded->read(&num_meshes, sizeof(num_meshes));
-		num_meshes = LE2Native(num_meshes);
-		uint32_t num_nodes;
-		decoded->read(&num_nodes, sizeof(num_nodes));
-		num_nodes = LE2Native(num_nodes);
-		uint32_t num_joints;
-		decoded->read(&num_joints, sizeof(num_joints));
-		num_joints = LE2Native(num_joints);
-		uint32_t num_kfs;
-		decoded->read(&num_kfs, sizeof(num_kfs));
-		num_kfs = LE2Native(num_kfs);
-		uint32_t num_actions;
-		decoded->read(&num_actions, sizeof(num_actions));
-		num_actions = LE2Native(num_actions);
-
-		mtls.resize(num_mtls);
-		for (uint32_t mtl_index = 0; mtl_index < num_mtls; ++ mtl_index)
+		for (uint32_t mtl_index = 0; mtl_index < mtls.size(); ++ mtl_index)
 		{
 			RenderMaterialPtr mtl = MakeSharedPtr<RenderMaterial>();
 			mtls[mtl_index] = mtl;
@@ -1190,56 +1307,26 @@ namespace KlayGE
 				mtl->tess_factors = float4(5, 5, 1, 9);
 			}
 		}
+	}
 
-		uint32_t num_merged_ves;
-		decoded->read(&num_merged_ves, sizeof(num_merged_ves));
-		num_merged_ves = LE2Native(num_merged_ves);
-		merged_ves.resize(num_merged_ves);
-		for (size_t i = 0; i < merged_ves.size(); ++ i)
+	void ReadMeshesChunk(ResIdentifierPtr const & decoded, std::vector<std::string>& mesh_names, std::vector<int32_t>& mtl_ids,
+		std::vector<uint32_t>& mesh_lods, std::vector<AABBox>& pos_bbs, std::vector<AABBox>& tc_bbs,
+		std::vector<uint32_t>& mesh_num_vertices, std::vector<uint32_t>& mesh_base_vertices,
+		std::vector<uint32_t>& mesh_num_indices, std::vector<uint32_t>& mesh_start_indices)
+	{
+		mesh_num_vertices.clear();
+		mesh_base_vertices.clear();
+		mesh_num_indices.clear();
+		mesh_start_indices.clear();
+		for (uint32_t mesh_index = 0; mesh_index < mesh_names.size(); ++ mesh_index)
 		{
-			decoded->read(&merged_ves[i], sizeof(merged_ves[i]));
-
-			merged_ves[i].usage = LE2Native(merged_ves[i].usage);
-			merged_ves[i].format = LE2Native(merged_ves[i].format);
-		}
+			mesh_names[mesh_index] = ReadShortString(decoded);
 
-		uint32_t all_num_vertices;
-		uint32_t all_num_indices;
-		decoded->read(&all_num_vertices, sizeof(all_num_vertices));
-		all_num_vertices = LE2Native(all_num_vertices);
-		decoded->read(&all_num_indices, sizeof(all_num_indices));
-		all_num_indices = LE2Native(all_num_indices);
-		decoded->read(&all_is_index_16_bit, sizeof(all_is_index_16_bit));
+			decoded->read(&mtl_ids[mesh_index], sizeof(mtl_ids[mesh_index]));
+			mtl_ids[mesh_index] = LE2Native(mtl_ids[mesh_index]);
 
-		int const index_elem_size = all_is_index_16_bit ? 2 : 4;
-
-		merged_buff.resize(merged_ves.size());
-		for (size_t i = 0; i < merged_buff.size(); ++ i)
-		{
-			merged_buff[i].resize(all_num_vertices * merged_ves[i].element_size());
-			decoded->read(&merged_buff[i][0], merged_buff[i].size() * sizeof(merged_buff[i][0]));
-		}
-		merged_indices.resize(all_num_indices * index_elem_size);
-		decoded->read(&merged_indices[0], merged_indices.size() * sizeof(merged_indices[0]));
-
-		mesh_names.resize(num_meshes);
-		mtl_ids.resize(num_meshes);
-		mesh_lods.resize(num_meshes);
-		pos_bbs.resize(num_meshes);
-		tc_bbs.resize(num_meshes);
-		mesh_num_vertices.clear();
-		mesh_base_vertices.clear();
-		mesh_num_indices.clear();
-		mesh_start_indices.clear();
-		for (uint32_t mesh_index = 0; mesh_index < num_meshes; ++ mesh_index)
-		{
-			mesh_names[mesh_index] = ReadShortString(decoded);
-
-			decoded->read(&mtl_ids[mesh_index], sizeof(mtl_ids[mesh_index]));
-			mtl_ids[mesh_index] = LE2Native(mtl_ids[mesh_index]);
-
-			decoded->read(&mesh_lods[mesh_index], sizeof(mesh_lods[mesh_index]));
-			mesh_lods[mesh_index] = LE2Native(mesh_lods[mesh_index]);
+			decoded->read(&mesh_lods[mesh_index], sizeof(mesh_lods[mesh_index]));
+			mesh_lods[mesh_index] = LE2Native(mesh_lods[mesh_index]);
 
 			float3 min_bb, max_bb;
 			decoded->read(&min_bb, sizeof(min_bb));
@@ -1277,8 +1364,10 @@ namespace KlayGE
 				mesh_start_indices.push_back(LE2Native(tmp));
 			}
 		}
+	}
 
-		nodes.resize(num_nodes);
+	void ReadNodesChunk(ResIdentifierPtr const & decoded, std::vector<std::pair<SceneNodePtr, std::vector<uint16_t>>>& nodes)
+	{
 		for (auto& node : nodes)
 		{
 			auto node_name = ReadShortString(decoded);
@@ -1321,9 +1410,11 @@ namespace KlayGE
 			}
 			node.first->TransformToParent(xform_to_parent);
 		}
+	}
 
-		joints.resize(num_joints);
-		for (uint32_t joint_index = 0; joint_index < num_joints; ++ joint_index)
+	void ReadBonesChunk(ResIdentifierPtr const & decoded, std::vector<Joint>& joints)
+	{
+		for (uint32_t joint_index = 0; joint_index < joints.size(); ++ joint_index)
 		{
 			Joint& joint = joints[joint_index];
 
@@ -1376,100 +1467,405 @@ namespace KlayGE
 
 			joint.bind_scale *= flip;
 		}
+	}
 
-		if (num_kfs > 0)
+	void ReadKeyFramesChunk(ResIdentifierPtr const & decoded, uint32_t num_kfs, uint32_t& num_frames, uint32_t& frame_rate,
+		std::vector<KeyFrameSet>& kfs)
+	{
+		decoded->read(&num_frames, sizeof(num_frames));
+		num_frames = LE2Native(num_frames);
+		decoded->read(&frame_rate, sizeof(frame_rate));
+		frame_rate = LE2Native(frame_rate);
+
+		for (uint32_t kf_index = 0; kf_index < num_kfs; ++ kf_index)
 		{
-			decoded->read(&num_frames, sizeof(num_frames));
-			num_frames = LE2Native(num_frames);
-			decoded->read(&frame_rate, sizeof(frame_rate));
-			frame_rate = LE2Native(frame_rate);
+			uint32_t joint_index = kf_index;
+
+			uint32_t num_kf;
+			decoded->read(&num_kf, sizeof(num_kf));
+			num_kf = LE2Native(num_kf);
+
+			KeyFrameSet kf;
+			kf.frame_id.resize(num_kf);
+			kf.bind_real.resize(num_kf);
+			kf.bind_dual.resize(num_kf);
+			kf.bind_scale.resize(num_kf);
+			for (uint32_t k_index = 0; k_index < num_kf; ++ k_index)
+			{
+				decoded->read(&kf.frame_id[k_index], sizeof(kf.frame_id[k_index]));
+				kf.frame_id[k_index] = LE2Native(kf.frame_id[k_index]);
+				decoded->read(&kf.bind_real[k_index], sizeof(kf.bind_real[k_index]));
+				kf.bind_real[k_index][0] = LE2Native(kf.bind_real[k_index][0]);
+				kf.bind_real[k_index][1] = LE2Native(kf.bind_real[k_index][1]);
+				kf.bind_real[k_index][2] = LE2Native(kf.bind_real[k_index][2]);
+				kf.bind_real[k_index][3] = LE2Native(kf.bind_real[k_index][3]);
+				decoded->read(&kf.bind_dual[k_index], sizeof(kf.bind_dual[k_index]));
+				kf.bind_dual[k_index][0] = LE2Native(kf.bind_dual[k_index][0]);
+				kf.bind_dual[k_index][1] = LE2Native(kf.bind_dual[k_index][1]);
+				kf.bind_dual[k_index][2] = LE2Native(kf.bind_dual[k_index][2]);
+				kf.bind_dual[k_index][3] = LE2Native(kf.bind_dual[k_index][3]);
+
+				float flip = MathLib::SignBit(kf.bind_real[k_index].w());
+
+				kf.bind_scale[k_index] = MathLib::length(kf.bind_real[k_index]);
+				kf.bind_real[k_index] /= kf.bind_scale[k_index];
+
+				kf.bind_scale[k_index] *= flip;
+			}
+
+			if (joint_index < kfs.size())
+			{
+				kfs[joint_index] = std::move(kf);
+			}
+		}
+	}
+
+	void ReadBBKeyFramesChunk(ResIdentifierPtr const & decoded, std::vector<std::shared_ptr<AABBKeyFrameSet>>& frame_pos_bbs)
+	{
+		for (uint32_t mesh_index = 0; mesh_index < frame_pos_bbs.size(); ++ mesh_index)
+		{
+			uint32_t num_bb_kf;
+			decoded->read(&num_bb_kf, sizeof(num_bb_kf));
+			num_bb_kf = LE2Native(num_bb_kf);
+
+			frame_pos_bbs[mesh_index] = MakeSharedPtr<AABBKeyFrameSet>();
+			frame_pos_bbs[mesh_index]->frame_id.resize(num_bb_kf);
+			frame_pos_bbs[mesh_index]->bb.resize(num_bb_kf);
+
+			for (uint32_t bb_k_index = 0; bb_k_index < num_bb_kf; ++ bb_k_index)
+			{
+				decoded->read(&frame_pos_bbs[mesh_index]->frame_id[bb_k_index], sizeof(frame_pos_bbs[mesh_index]->frame_id[bb_k_index]));
+				frame_pos_bbs[mesh_index]->frame_id[bb_k_index] = LE2Native(frame_pos_bbs[mesh_index]->frame_id[bb_k_index]);
+
+				float3 bb_min, bb_max;
+				decoded->read(&bb_min, sizeof(bb_min));
+				bb_min[0] = LE2Native(bb_min[0]);
+				bb_min[1] = LE2Native(bb_min[1]);
+				bb_min[2] = LE2Native(bb_min[2]);
+				decoded->read(&bb_max, sizeof(bb_max));
+				bb_max[0] = LE2Native(bb_max[0]);
+				bb_max[1] = LE2Native(bb_max[1]);
+				bb_max[2] = LE2Native(bb_max[2]);
+				frame_pos_bbs[mesh_index]->bb[bb_k_index] = AABBox(bb_min, bb_max);
+			}
+		}
+	}
+
+	void ReadActionsChunk(ResIdentifierPtr const & decoded, std::vector<AnimationAction>& actions)
+	{
+		for (uint32_t action_index = 0; action_index < actions.size(); ++ action_index)
+		{
+			AnimationAction action;
+			action.name = ReadShortString(decoded);
+			decoded->read(&action.start_frame, sizeof(action.start_frame));
+			action.start_frame = LE2Native(action.start_frame);
+			decoded->read(&action.end_frame, sizeof(action.end_frame));
+			action.end_frame = LE2Native(action.end_frame);
+			actions[action_index] = action;
+		}
+	}
+
+	// Reads the chunk table of a .model_bin and leaves the file at the start of the payload. False if the file isn't a model
+	// of this version, or if its chunks don't fit in it.
+	bool ReadModelChunkTable(ResIdentifier& file, std::vector<ModelChunkDesc>& chunk_descs, uint64_t& payload_offset)
+	{
+		file.seekg(0, std::ios_base::end);
+		int64_t const file_size = file.tellg();
+		file.seekg(0, std::ios_base::beg);
+		if (!file || (file_size < 0))
+		{
+			return false;
+		}
+
+		uint32_t fourcc;
+		file.read(&fourcc, sizeof(fourcc));
+		fourcc = LE2Native(fourcc);
+		uint32_t ver;
+		file.read(&ver, sizeof(ver));
+		ver = LE2Native(ver);
+		uint32_t num_chunks;
+		file.read(&num_chunks, sizeof(num_chunks));
+		num_chunks = LE2Native(num_chunks);
+		if (!file || (fourcc != MakeFourCC<'K', 'L', 'M', ' '>::value) || (ver != MODEL_BIN_VERSION) || (num_chunks == 0)
+			|| (num_chunks > static_cast<uint64_t>(file_size) / sizeof(ModelChunkDesc)))
+		{
+			return false;
+		}
+
+		chunk_descs.resize(num_chunks);
+		file.read(chunk_descs.data(), chunk_descs.size() * sizeof(chunk_descs[0]));
+		if (!file)
+		{
+			return false;
+		}
+
+		payload_offset = file.tellg();
+		uint64_t const payload_capacity = static_cast<uint64_t>(file_size) - payload_offset;
+		uint64_t payload_len = 0;
+		for (auto& desc : chunk_descs)
+		{
+			desc.type = LE2Native(desc.type);
+			desc.flags = LE2Native(desc.flags);
+			desc.original_len = LE2Native(desc.original_len);
+			desc.stored_len = LE2Native(desc.stored_len);
+
+			if ((desc.stored_len > payload_capacity - payload_len)
+				|| (!(desc.flags & MCF_LZMA) && (desc.original_len != desc.stored_len)))
+			{
+				return false;
+			}
+			payload_len += desc.stored_len;
+		}
+
+		return (MCT_Header == chunk_descs[0].type);
+	}
+
+	// Decodes the chunks of a .model_bin whose table passed ReadModelChunkTable. Null if the buffer chunks don't match the
+	// sizes in the header.
+	RenderModelPtr ReadModelBin(ResIdentifierPtr const & runtime_file, std::vector<ModelChunkDesc> const & chunk_descs,
+		uint64_t payload_offset)
+	{
+		std::vector<RenderMaterialPtr> mtls;
+		std::vector<VertexElement> merged_ves;
+		char all_is_index_16_bit;
+		std::vector<GraphicsBufferPtr> merged_vbs;
+		GraphicsBufferPtr merged_ib;
+		std::vector<std::string> mesh_names;
+		std::vector<int32_t> mtl_ids;
+		std::vector<uint32_t> mesh_lods;
+		std::vector<AABBox> pos_bbs;
+		std::vector<AABBox> tc_bbs;
+		std::vector<uint32_t> mesh_num_vertices;
+		std::vector<uint32_t> mesh_base_vertices;
+		std::vector<uint32_t> mesh_num_indices;
+		std::vector<uint32_t> mesh_start_indices;
+		std::vector<std::pair<SceneNodePtr, std::vector<uint16_t>>> nodes;
+		std::vector<Joint> joints;
+		std::shared_ptr<std::vector<AnimationAction>> actions;
+		std::shared_ptr<std::vector<KeyFrameSet>> kfs;
+		uint32_t num_frames = 0;
+		uint32_t frame_rate = 0;
+		std::vector<std::shared_ptr<AABBKeyFrameSet>> frame_pos_bbs;
+
+		// The chunk table is checked against the file size, so the payload is all there
+		uint64_t payload_len = 0;
+		for (auto const & desc : chunk_descs)
+		{
+			payload_len += desc.stored_len;
+		}
+
+		// Chunks are decoded from the mapped file directly. If the file isn't mapped, the whole payload is read in one go.
+		std::vector<uint8_t> payload_storage;
+		uint8_t const * payload;
+		ArrayRef<uint8_t> const mapped_data = runtime_file->MappedData();
+		if (!mapped_data.empty())
+		{
+			BOOST_ASSERT(payload_offset + payload_len <= mapped_data.size());
+			payload = mapped_data.data() + payload_offset;
+		}
+		else
+		{
+			payload_storage.resize(static_cast<size_t>(payload_len));
+			runtime_file->read(payload_storage.data(), payload_storage.size());
+			payload = payload_storage.data();
+		}
+
+		std::vector<ArrayRef<uint8_t>> chunk_data;
+		chunk_data.reserve(chunk_descs.size());
+		for (auto const & desc : chunk_descs)
+		{
+			chunk_data.push_back(MakeArrayRef(payload, static_cast<size_t>(desc.stored_len)));
+			payload += desc.stored_len;
+		}
+
+		ResIdentifierPtr header = OpenModelChunk(*runtime_file, chunk_descs[0], chunk_data[0]);
+
+		uint32_t num_mtls;
+		header->read(&num_mtls, sizeof(num_mtls));
+		num_mtls = LE2Native(num_mtls);
+		uint32_t num_meshes;
+		header->read(&num_meshes, sizeof(num_meshes));
+		num_meshes = LE2Native(num_meshes);
+		uint32_t num_nodes;
+		header->read(&num_nodes, sizeof(num_nodes));
+		num_nodes = LE2Native(num_nodes);
+		uint32_t num_joints;
+		header->read(&num_joints, sizeof(num_joints));
+		num_joints = LE2Native(num_joints);
+		uint32_t num_kfs;
+		header->read(&num_kfs, sizeof(num_kfs));
+		num_kfs = LE2Native(num_kfs);
+		uint32_t num_actions;
+		header->read(&num_actions, sizeof(num_actions));
+		num_actions = LE2Native(num_actions);
+
+		uint32_t num_merged_ves;
+		header->read(&num_merged_ves, sizeof(num_merged_ves));
+		num_merged_ves = LE2Native(num_merged_ves);
+		merged_ves.resize(num_merged_ves);
+		for (size_t i = 0; i < merged_ves.size(); ++ i)
+		{
+			header->read(&merged_ves[i], sizeof(merged_ves[i]));
+
+			merged_ves[i].usage = LE2Native(merged_ves[i].usage);
+			merged_ves[i].format = LE2Native(merged_ves[i].format);
+		}
+
+		uint32_t all_num_vertices;
+		uint32_t all_num_indices;
+		header->read(&all_num_vertices, sizeof(all_num_vertices));
+		all_num_vertices = LE2Native(all_num_vertices);
+		header->read(&all_num_indices, sizeof(all_num_indices));
+		all_num_indices = LE2Native(all_num_indices);
+		header->read(&all_is_index_16_bit, sizeof(all_is_index_16_bit));
+
+		int const index_elem_size = all_is_index_16_bit ? 2 : 4;
+
+		// Everything touched by the chunk decoders is allocated up front, so they don't share any state.
+		mtls.resize(num_mtls);
+
+		merged_vbs.resize(merged_ves.size());
+		for (size_t i = 0; i < merged_vbs.size(); ++ i)
+		{
+			auto vb = MakeSharedPtr<SoftwareGraphicsBuffer>(all_num_vertices * merged_ves[i].element_size(), false);
+			vb->CreateHWResource(nullptr);
+
+			merged_vbs[i] = vb;
+		}
+		merged_ib = MakeSharedPtr<SoftwareGraphicsBuffer>(all_num_indices * index_elem_size, false);
+		merged_ib->CreateHWResource(nullptr);
+
+		mesh_names.resize(num_meshes);
+		mtl_ids.resize(num_meshes);
+		mesh_lods.resize(num_meshes);
+		pos_bbs.resize(num_meshes);
+		tc_bbs.resize(num_meshes);
+
+		nodes.resize(num_nodes);
+		joints.resize(num_joints);
 
+		if (num_kfs > 0)
+		{
 			kfs = MakeSharedPtr<std::vector<KeyFrameSet>>(joints.size());
-			for (uint32_t kf_index = 0; kf_index < num_kfs; ++ kf_index)
+			frame_pos_bbs.resize(num_meshes);
+			if (num_actions > 0)
 			{
-				uint32_t joint_index = kf_index;
+				actions = MakeSharedPtr<std::vector<AnimationAction>>(num_actions);
+			}
+		}
+
+		std::vector<std::pair<uint64_t, std::function<void()>>> decoding_tasks;
+		uint32_t stream_index = 0;
+		for (uint32_t chunk_index = 1; chunk_index < chunk_descs.size(); ++ chunk_index)
+		{
+			ModelChunkDesc const & desc = chunk_descs[chunk_index];
+			ArrayRef<uint8_t> const data = chunk_data[chunk_index];
 
-				uint32_t num_kf;
-				decoded->read(&num_kf, sizeof(num_kf));
-				num_kf = LE2Native(num_kf);
+			std::function<void()> task;
+			switch (desc.type)
+			{
+			case MCT_Materials:
+				task = [&runtime_file, &desc, data, &mtls]
+					{
+						ReadMaterialsChunk(OpenModelChunk(*runtime_file, desc, data), mtls);
+					};
+				break;
 
-				KeyFrameSet kf;
-				kf.frame_id.resize(num_kf);
-				kf.bind_real.resize(num_kf);
-				kf.bind_dual.resize(num_kf);
-				kf.bind_scale.resize(num_kf);
-				for (uint32_t k_index = 0; k_index < num_kf; ++ k_index)
+			case MCT_VertexStream:
+				// Decoded straight into the buffer, so its size has to match exactly
+				if ((stream_index >= merged_vbs.size()) || (desc.original_len != merged_vbs[stream_index]->Size()))
+				{
+					return RenderModelPtr();
+				}
+				task = [&desc, data, &vb = merged_vbs[stream_index]]
+					{
+						GraphicsBuffer::Mapper mapper(*vb, BA_Write_Only);
+						DecodeModelChunk(desc, data, mapper.Pointer<uint8_t>());
+					};
+				++ stream_index;
+				break;
+
+			case MCT_Indices:
+				if (desc.original_len != merged_ib->Size())
 				{
-					decoded->read(&kf.frame_id[k_index], sizeof(kf.frame_id[k_index]));
-					kf.frame_id[k_index] = LE2Native(kf.frame_id[k_index]);
-					decoded->read(&kf.bind_real[k_index], sizeof(kf.bind_real[k_index]));
-					kf.bind_real[k_index][0] = LE2Native(kf.bind_real[k_index][0]);
-					kf.bind_real[k_index][1] = LE2Native(kf.bind_real[k_index][1]);
-					kf.bind_real[k_index][2] = LE2Native(kf.bind_real[k_index][2]);
-					kf.bind_real[k_index][3] = LE2Native(kf.bind_real[k_index][3]);
-					decoded->read(&kf.bind_dual[k_index], sizeof(kf.bind_dual[k_index]));
-					kf.bind_dual[k_index][0] = LE2Native(kf.bind_dual[k_index][0]);
-					kf.bind_dual[k_index][1] = LE2Native(kf.bind_dual[k_index][1]);
-					kf.bind_dual[k_index][2] = LE2Native(kf.bind_dual[k_index][2]);
-					kf.bind_dual[k_index][3] = LE2Native(kf.bind_dual[k_index][3]);
-
-					float flip = MathLib::SignBit(kf.bind_real[k_index].w());
-
-					kf.bind_scale[k_index] = MathLib::length(kf.bind_real[k_index]);
-					kf.bind_real[k_index] /= kf.bind_scale[k_index];
-
-					kf.bind_scale[k_index] *= flip;
+					return RenderModelPtr();
 				}
+				task = [&desc, data, &merged_ib]
+					{
+						GraphicsBuffer::Mapper mapper(*merged_ib, BA_Write_Only);
+						DecodeModelChunk(desc, data, mapper.Pointer<uint8_t>());
+					};
+				break;
+
+			case MCT_Meshes:
+				task = [&, data]
+					{
+						ReadMeshesChunk(OpenModelChunk(*runtime_file, desc, data), mesh_names, mtl_ids, mesh_lods, pos_bbs, tc_bbs,
+							mesh_num_vertices, mesh_base_vertices, mesh_num_indices, mesh_start_indices);
+					};
+				break;
+
+			case MCT_Nodes:
+				task = [&runtime_file, &desc, data, &nodes]
+					{
+						ReadNodesChunk(OpenModelChunk(*runtime_file, desc, data), nodes);
+					};
+				break;
 
-				if (joint_index < num_joints)
+			case MCT_Joints:
+				task = [&runtime_file, &desc, data, &joints]
+					{
+						ReadBonesChunk(OpenModelChunk(*runtime_file, desc, data), joints);
+					};
+				break;
+
+			case MCT_KeyFrames:
+				if (kfs)
 				{
-					(*kfs)[joint_index] = kf;
+					task = [&, data]
+						{
+							ResIdentifierPtr decoded = OpenModelChunk(*runtime_file, desc, data);
+							ReadKeyFramesChunk(decoded, num_kfs, num_frames, frame_rate, *kfs);
+							ReadBBKeyFramesChunk(decoded, frame_pos_bbs);
+							if (actions)
+							{
+								ReadActionsChunk(decoded, *actions);
+							}
+						};
 				}
+				break;
+
+			default:
+				// Unknown chunks are skipped
+				break;
 			}
 
-			frame_pos_bbs.resize(num_meshes);
-			for (uint32_t mesh_index = 0; mesh_index < num_meshes; ++ mesh_index)
+			if (task)
 			{
-				uint32_t num_bb_kf;
-				decoded->read(&num_bb_kf, sizeof(num_bb_kf));
-				num_bb_kf = LE2Native(num_bb_kf);
-
-				frame_pos_bbs[mesh_index] = MakeSharedPtr<AABBKeyFrameSet>();
-				frame_pos_bbs[mesh_index]->frame_id.resize(num_bb_kf);
-				frame_pos_bbs[mesh_index]->bb.resize(num_bb_kf);
+				decoding_tasks.emplace_back(desc.original_len, std::move(task));
+			}
+		}
 
-				for (uint32_t bb_k_index = 0; bb_k_index < num_bb_kf; ++ bb_k_index)
+		{
+			std::vector<joiner<void>> joiners;
+			for (auto const & task : decoding_tasks)
+			{
+				if (task.first >= MIN_PARALLEL_CHUNK_SIZE)
 				{
-					decoded->read(&frame_pos_bbs[mesh_index]->frame_id[bb_k_index], sizeof(frame_pos_bbs[mesh_index]->frame_id[bb_k_index]));
-					frame_pos_bbs[mesh_index]->frame_id[bb_k_index] = LE2Native(frame_pos_bbs[mesh_index]->frame_id[bb_k_index]);
-
-					float3 bb_min, bb_max;
-					decoded->read(&bb_min, sizeof(bb_min));
-					bb_min[0] = LE2Native(bb_min[0]);
-					bb_min[1] = LE2Native(bb_min[1]);
-					bb_min[2] = LE2Native(bb_min[2]);
-					decoded->read(&bb_max, sizeof(bb_max));
-					bb_max[0] = LE2Native(bb_max[0]);
-					bb_max[1] = LE2Native(bb_max[1]);
-					bb_max[2] = LE2Native(bb_max[2]);
-					frame_pos_bbs[mesh_index]->bb[bb_k_index] = AABBox(bb_min, bb_max);
+					joiners.push_back(Context::Instance().ThreadPool()(task.second));
 				}
 			}
-
-			if (num_actions > 0)
+			for (auto const & task : decoding_tasks)
 			{
-				actions = MakeSharedPtr<std::vector<AnimationAction>>(num_actions);
-				for (uint32_t action_index = 0; action_index < num_actions; ++ action_index)
+				if (task.first < MIN_PARALLEL_CHUNK_SIZE)
 				{
-					AnimationAction action;
-					action.name = ReadShortString(decoded);
-					decoded->read(&action.start_frame, sizeof(action.start_frame));
-					action.start_frame = LE2Native(action.start_frame);
-					decoded->read(&action.end_frame, sizeof(action.end_frame));
-					action.end_frame = LE2Native(action.end_frame);
-					(*actions)[action_index] = action;
+					task.second();
 				}
 			}
+			for (auto& task_joiner : joiners)
+			{
+				task_joiner();
+			}
 		}
 
 		bool const skinned = kfs && !kfs->empty();
@@ -1490,17 +1886,6 @@ namespace KlayGE
 			model->GetMaterial(mtl_index) = mtls[mtl_index];
 		}
 
-		std::vector<GraphicsBufferPtr> merged_vbs(merged_buff.size());
-		for (size_t i = 0; i < merged_buff.size(); ++ i)
-		{
-			auto vb = MakeSharedPtr<SoftwareGraphicsBuffer>(static_cast<uint32_t>(merged_buff[i].size()), false);
-			vb->CreateHWResource(merged_buff[i].data());
-
-			merged_vbs[i] = vb;
-		}
-		auto merged_ib = MakeSharedPtr<SoftwareGraphicsBuffer>(static_cast<uint32_t>(merged_indices.size()), false);
-		merged_ib->CreateHWResource(merged_indices.data());
-
 		uint32_t mesh_lod_index = 0;
 		std::vector<StaticMeshPtr> meshes(num_meshes);
 		for (uint32_t mesh_index = 0; mesh_index < num_meshes; ++ mesh_index)
@@ -1526,7 +1911,7 @@ namespace KlayGE
 			mesh->NumLods(lods);
 			for (uint32_t lod = 0; lod < lods; ++ lod, ++ mesh_lod_index)
 			{
-				for (uint32_t ve_index = 0; ve_index < merged_buff.size(); ++ ve_index)
+				for (uint32_t ve_index = 0; ve_index < merged_vbs.size(); ++ ve_index)
 				{
 					mesh->AddVertexStream(lod, merged_vbs[ve_index], merged_ves[ve_index]);
 				}
@@ -1576,6 +1961,83 @@ namespace KlayGE
 		return model;
 	}
 
+	RenderModelPtr LoadSoftwareModel(std::string_view model_name)
+	{
+		char const * JIT_EXT_NAME = ".model_bin";
+
+		std::string runtime_name(model_name);
+		ResIdentifierPtr runtime_file;
+		std::vector<ModelChunkDesc> chunk_descs;
+		uint64_t payload_offset = 0;
+		if (std::filesystem::path(runtime_name).extension() != JIT_EXT_NAME)
+		{
+			std::string const metadata_name = runtime_name + ".kmeta";
+			runtime_name += JIT_EXT_NAME;
+
+			bool jit = false;
+			if (ResLoader::Instance().Locate(runtime_name).empty())
+			{
+				jit = true;
+			}
+			else
+			{
+				// A truncated or corrupted file is converted again, like an outdated one
+				runtime_file = ResLoader::Instance().Open(runtime_name);
+				if (!runtime_file || !ReadModelChunkTable(*runtime_file, chunk_descs, payload_offset))
+				{
+					jit = true;
+				}
+				else
+				{
+					uint64_t const runtime_file_timestamp = runtime_file->Timestamp();
+					uint64_t const input_file_timestamp = ResLoader::Instance().Timestamp(model_name);
+					uint64_t const metadata_timestamp = ResLoader::Instance().Timestamp(metadata_name);
+					if (((input_file_timestamp > 0) && (runtime_file_timestamp < input_file_timestamp))
+						|| ((metadata_timestamp > 0) && (runtime_file_timestamp < metadata_timestamp)))
+					{
+						jit = true;
+					}
+				}
+			}
+
+			if (!jit)
+			{
+				RenderModelPtr model = ReadModelBin(runtime_file, chunk_descs, payload_offset);
+				if (model)
+				{
+					return model;
+				}
+			}
+
+			// The converter overwrites it
+			runtime_file.reset();
+
+#if KLAYGE_IS_DEV_PLATFORM
+			RenderFactory& rf = Context::Instance().RenderFactoryInstance();
+			RenderDeviceCaps const & caps = rf.RenderEngineInstance().DeviceCaps();
+
+			return Context::Instance().DevHelperInstance().ConvertModel(model_name, metadata_name, runtime_name, &caps);
+#else
+			LogError() << "Could NOT locate " << runtime_name << std::endl;
+			return RenderModelPtr();
+#endif
+		}
+		else
+		{
+			runtime_file = ResLoader::Instance().Open(runtime_name);
+			RenderModelPtr model;
+			if (runtime_file && ReadModelChunkTable(*runtime_file, chunk_descs, payload_offset))
+			{
+				model = ReadModelBin(runtime_file, chunk_descs, payload_offset);
+			}
+			if (!model)
+			{
+				LogError() << runtime_name << " is not a valid model." << std::endl;
+			}
+			return model;
+		}
+	}
+
 	void WriteMaterialsChunk(std::vector<RenderMaterialPtr> const & mtls, std::ostream& os)
 	{
 		for (size_t i = 0; i < mtls.size(); ++ i)
@@ -1645,33 +2107,8 @@ namespace KlayGE
 	void WriteMeshesChunk(std::vector<std::string> const & mesh_names, std::vector<int32_t> const & mtl_ids, std::vector<uint32_t> const & mesh_lods,
 		std::vector<AABBox> const & pos_bbs, std::vector<AABBox> const & tc_bbs,
 		std::vector<uint32_t> const & mesh_num_vertices, std::vector<uint32_t> const & mesh_base_vertices,
-		std::vector<uint32_t> const & mesh_num_indices, std::vector<uint32_t> const & mesh_start_indices,
-		std::vector<VertexElement> const & merged_ves,
-		std::vector<std::vector<uint8_t>> const & merged_vertices, std::vector<uint8_t> const & merged_indices,
-		char is_index_16_bit, std::ostream& os)
+		std::vector<uint32_t> const & mesh_num_indices, std::vector<uint32_t> const & mesh_start_indices, std::ostream& os)
 	{
-		uint32_t num_merged_ves = Native2LE(static_cast<uint32_t>(merged_ves.size()));
-		os.write(reinterpret_cast<char*>(&num_merged_ves), sizeof(num_merged_ves));
-		for (size_t i = 0; i < merged_ves.size(); ++ i)
-		{
-			VertexElement ve = merged_ves[i];
-			ve.usage = Native2LE(ve.usage);
-			ve.format = Native2LE(ve.format);
-			os.write(reinterpret_cast<char*>(&ve), sizeof(ve));
-		}
-
-		uint32_t num_vertices = Native2LE(mesh_base_vertices.back());
-		os.write(reinterpret_cast<char*>(&num_vertices), sizeof(num_vertices));
-		uint32_t num_indices = Native2LE(mesh_start_indices.back());
-		os.write(reinterpret_cast<char*>(&num_indices), sizeof(num_indices));
-		os.write(&is_index_16_bit, sizeof(is_index_16_bit));
-
-		for (size_t i = 0; i < merged_vertices.size(); ++ i)
-		{
-			os.write(reinterpret_cast<char const *>(&merged_vertices[i][0]), merged_vertices[i].size() * sizeof(merged_vertices[i][0]));
-		}
-		os.write(reinterpret_cast<char const *>(&merged_indices[0]), merged_indices.size() * sizeof(merged_indices[0]));
-
 		uint32_t mesh_lod_index = 0;
 		for (uint32_t mesh_index = 0; mesh_index < mesh_names.size(); ++ mesh_index)
 		{
@@ -1886,57 +2323,138 @@ namespace KlayGE
 		std::shared_ptr<std::vector<KeyFrameSet>> const & kfs, uint32_t num_frames, uint32_t frame_rate,
 		std::vector<std::shared_ptr<AABBKeyFrameSet>> const & frame_pos_bbs)
 	{
-		std::ostringstream ss;
-
+		std::ostringstream header_ss;
 		{
 			uint32_t num_mtls = Native2LE(static_cast<uint32_t>(mtls.size()));
-			ss.write(reinterpret_cast<char*>(&num_mtls), sizeof(num_mtls));
+			header_ss.write(reinterpret_cast<char*>(&num_mtls), sizeof(num_mtls));
 
 			uint32_t num_meshes = Native2LE(static_cast<uint32_t>(pos_bbs.size()));
-			ss.write(reinterpret_cast<char*>(&num_meshes), sizeof(num_meshes));
+			header_ss.write(reinterpret_cast<char*>(&num_meshes), sizeof(num_meshes));
 
 			uint32_t num_nodes = Native2LE(static_cast<uint32_t>(nodes.size()));
-			ss.write(reinterpret_cast<char*>(&num_nodes), sizeof(num_nodes));
+			header_ss.write(reinterpret_cast<char*>(&num_nodes), sizeof(num_nodes));
 
 			uint32_t num_joints = Native2LE(static_cast<uint32_t>(joints.size()));
-			ss.write(reinterpret_cast<char*>(&num_joints), sizeof(num_joints));
+			header_ss.write(reinterpret_cast<char*>(&num_joints), sizeof(num_joints));
 
 			uint32_t num_kfs = Native2LE(kfs ? static_cast<uint32_t>(kfs->size()) : 0);
-			ss.write(reinterpret_cast<char*>(&num_kfs), sizeof(num_kfs));
+			header_ss.write(reinterpret_cast<char*>(&num_kfs), sizeof(num_kfs));
 
 			uint32_t num_actions = Native2LE(actions ? std::max(static_cast<uint32_t>(actions->size()), 1U) : 0);
-			ss.write(reinterpret_cast<char*>(&num_actions), sizeof(num_actions));
+			header_ss.write(reinterpret_cast<char*>(&num_actions), sizeof(num_actions));
+
+			uint32_t num_merged_ves = Native2LE(static_cast<uint32_t>(merged_ves.size()));
+			header_ss.write(reinterpret_cast<char*>(&num_merged_ves), sizeof(num_merged_ves));
+			for (size_t i = 0; i < merged_ves.size(); ++ i)
+			{
+				VertexElement ve = merged_ves[i];
+				ve.usage = Native2LE(ve.usage);
+				ve.format = Native2LE(ve.format);
+				header_ss.write(reinterpret_cast<char*>(&ve), sizeof(ve));
+			}
+
+			uint32_t num_vertices = Native2LE(mesh_base_vertices.empty() ? 0 : mesh_base_vertices.back());
+			header_ss.write(reinterpret_cast<char*>(&num_vertices), sizeof(num_vertices));
+			uint32_t num_indices = Native2LE(mesh_base_indices.empty() ? 0 : mesh_base_indices.back());
+			header_ss.write(reinterpret_cast<char*>(&num_indices), sizeof(num_indices));
+			header_ss.write(&all_is_index_16_bit, sizeof(all_is_index_16_bit));
 		}
 
+		std::ostringstream mtls_ss;
 		if (!mtls.empty())
 		{
-			WriteMaterialsChunk(mtls, ss);
+			WriteMaterialsChunk(mtls, mtls_ss);
 		}
 
+		std::ostringstream meshes_ss;
 		if (!mesh_names.empty())
 		{
 			WriteMeshesChunk(mesh_names, mtl_ids, mesh_lods, pos_bbs, tc_bbs,
-				mesh_num_vertices, mesh_base_vertices, mesh_num_indices, mesh_base_indices,
-				merged_ves, merged_buffs, merged_indices, all_is_index_16_bit, ss);
+				mesh_num_vertices, mesh_base_vertices, mesh_num_indices, mesh_base_indices, meshes_ss);
 		}
 
+		std::ostringstream nodes_ss;
 		if (!nodes.empty())
 		{
-			WriteNodesChunk(nodes, renderables, ss);
+			WriteNodesChunk(nodes, renderables, nodes_ss);
 		}
 
+		std::ostringstream joints_ss;
 		if (!joints.empty())
 		{
-			WriteBonesChunk(joints, ss);
+			WriteBonesChunk(joints, joints_ss);
 		}
 
+		std::ostringstream kfs_ss;
 		if (kfs && !kfs->empty())
 		{
-			WriteKeyFramesChunk(num_frames, frame_rate, *kfs, ss);
+			WriteKeyFramesChunk(num_frames, frame_rate, *kfs, kfs_ss);
 
-			WriteBBKeyFramesChunk(frame_pos_bbs, ss);
+			WriteBBKeyFramesChunk(frame_pos_bbs, kfs_ss);
 
-			WriteActionsChunk(*actions, ss);
+			WriteActionsChunk(*actions, kfs_ss);
+		}
+
+		std::string const header_str = header_ss.str();
+		std::string const mtls_str = mtls_ss.str();
+		std::string const meshes_str = meshes_ss.str();
+		std::string const nodes_str = nodes_ss.str();
+		std::string const joints_str = joints_ss.str();
+		std::string const kfs_str = kfs_ss.str();
+		auto const str_ref = [](std::string const & str)
+			{
+				return MakeArrayRef(reinterpret_cast<uint8_t const *>(str.data()), str.size());
+			};
+
+		std::vector<std::pair<ModelChunkType, ArrayRef<uint8_t>>> chunks;
+		chunks.emplace_back(MCT_Header, str_ref(header_str));
+		chunks.emplace_back(MCT_Materials, str_ref(mtls_str));
+		for (auto const & buff : merged_buffs)
+		{
+			chunks.emplace_back(MCT_VertexStream, MakeArrayRef(buff));
+		}
+		chunks.emplace_back(MCT_Indices, MakeArrayRef(merged_indices));
+		chunks.emplace_back(MCT_Meshes, str_ref(meshes_str));
+		chunks.emplace_back(MCT_Nodes, str_ref(nodes_str));
+		chunks.emplace_back(MCT_Joints, str_ref(joints_str));
+		chunks.emplace_back(MCT_KeyFrames, str_ref(kfs_str));
+
+		std::vector<std::vector<uint8_t>> compressed(chunks.size());
+		{
+			std::vector<joiner<void>> joiners;
+			for (size_t i = 0; i < chunks.size(); ++ i)
+			{
+				if (chunks[i].second.size() >= MIN_COMPRESSED_CHUNK_SIZE)
+				{
+					joiners.push_back(Context::Instance().ThreadPool()([&compressed, &chunks, i]
+						{
+							LZMACodec lzma;
+							lzma.Encode(compressed[i], chunks[i].second);
+						}));
+				}
+			}
+			for (auto& task_joiner : joiners)
+			{
+				task_joiner();
+			}
+		}
+
+		std::vector<ModelChunkDesc> chunk_descs(chunks.size());
+		for (size_t i = 0; i < chunks.size(); ++ i)
+		{
+			auto& desc = chunk_descs[i];
+			desc.type = chunks[i].first;
+			desc.original_len = chunks[i].second.size();
+			if (!compressed[i].empty() && (compressed[i].size() < chunks[i].second.size()))
+			{
+				desc.flags = MCF_LZMA;
+				desc.stored_len = compressed[i].size();
+			}
+			else
+			{
+				desc.flags = 0;
+				desc.stored_len = desc.original_len;
+			}
 		}
 
 		std::ofstream ofs(jit_name.c_str(), std::ios_base::binary);
@@ -1947,20 +2465,23 @@ namespace KlayGE
 		uint32_t ver = Native2LE(MODEL_BIN_VERSION);
 		ofs.write(reinterpret_cast<char*>(&ver), sizeof(ver));
 
-		auto const & ss_str = ss.str();
-		uint64_t original_len = Native2LE(static_cast<uint64_t>(ss_str.size()));
-		ofs.write(reinterpret_cast<char*>(&original_len), sizeof(original_len));
-
-		std::ofstream::pos_type p = ofs.tellp();
-		uint64_t len = 0;
-		ofs.write(reinterpret_cast<char*>(&len), sizeof(len));
-
-		LZMACodec lzma;
-		len = lzma.Encode(ofs, MakeArrayRef(reinterpret_cast<uint8_t const *>(ss_str.c_str()), ss_str.size()));
+		uint32_t num_chunks = Native2LE(static_cast<uint32_t>(chunk_descs.size()));
+		ofs.write(reinterpret_cast<char*>(&num_chunks), sizeof(num_chunks));
+		for (auto const & desc : chunk_descs)
+		{
+			ModelChunkDesc le_desc;
+			le_desc.type = Native2LE(desc.type);
+			le_desc.flags = Native2LE(desc.flags);
+			le_desc.original_len = Native2LE(desc.original_len);
+			le_desc.stored_len = Native2LE(desc.stored_len);
+			ofs.write(reinterpret_cast<char*>(&le_desc), sizeof(le_desc));
+		}
 
-		ofs.seekp(p, std::ios_base::beg);
-		len = Native2LE(len);
-		ofs.write(reinterpret_cast<char*>(&len), sizeof(len));
+		for (size_t i = 0; i < chunks.size(); ++ i)
+		{
+			ArrayRef<uint8_t> const stored = (chunk_descs[i].flags & MCF_LZMA) ? MakeArrayRef(compressed[i]) : chunks[i].second;
+			ofs.write(reinterpret_cast<char const *>(stored.data()), static_cast<std::streamsize>(stored.size()));
+		}
 	}
 
 	void SaveModel(RenderModel const & model, std::string_view model_name)
@@ -30,6 +30,7 @@
 
 #include <KlayGE/KlayGE.hpp>
 #include <KFL/ErrorHandling.hpp>
+#include <KlayGE/Context.hpp>
 #include <KlayGE/Texture.hpp>
 #include <KlayGE/RenderFactory.hpp>
 #include <KlayGE/RenderEngine.hpp>
@@ -42,8 +43,18 @@
 #include <KlayGE/DeferredRenderingLayer.hpp>
 #include <KFL/Hash.hpp>
 
+#include <array>
+#include <cstring>
 #include <fstream>
+#include <limits>
 #include <string>
+#include <thread>
+
+#if defined(KLAYGE_SSE2_SUPPORT)
+	#include <emmintrin.h>
+#elif defined(KLAYGE_NEON_SUPPORT)
+	#include <arm_neon.h>
+#endif
 
 #include <boost/algorithm/string/split.hpp>
 #include <boost/algorithm/string/trim.hpp>
@@ -56,6 +67,203 @@ namespace
 
 	uint32_t const NUM_PARTICLES = 4096;
 
+	enum ParticleAttrib
+	{
+		PA_PosX = 0,
+		PA_PosY,
+		PA_PosZ,
+		PA_VelX,
+		PA_VelY,
+		PA_VelZ,
+		PA_Life,
+		PA_Spin,
+		PA_Size,
+		PA_Alpha,
+		PA_InitLife,
+
+		PA_NumAttribs
+	};
+
+#if defined(KLAYGE_SSE2_SUPPORT) || defined(KLAYGE_NEON_SUPPORT)
+	#define KLAYGE_PARTICLE_SIMD
+#endif
+
+#if defined(KLAYGE_SSE2_SUPPORT)
+	typedef __m128 Lanes;
+
+	Lanes LoadLanes(float const * p)
+	{
+		return _mm_loadu_ps(p);
+	}
+	void StoreLanes(float* p, Lanes v)
+	{
+		_mm_storeu_ps(p, v);
+	}
+	Lanes SplatLanes(float v)
+	{
+		return _mm_set1_ps(v);
+	}
+	Lanes AddLanes(Lanes lhs, Lanes rhs)
+	{
+		return _mm_add_ps(lhs, rhs);
+	}
+	Lanes SubLanes(Lanes lhs, Lanes rhs)
+	{
+		return _mm_sub_ps(lhs, rhs);
+	}
+	Lanes MulLanes(Lanes lhs, Lanes rhs)
+	{
+		return _mm_mul_ps(lhs, rhs);
+	}
+	Lanes DivLanes(Lanes lhs, Lanes rhs)
+	{
+		return _mm_div_ps(lhs, rhs);
+	}
+	Lanes MinLanes(Lanes lhs, Lanes rhs)
+	{
+		return _mm_min_ps(lhs, rhs);
+	}
+	Lanes SaturateLanes(Lanes v)
+	{
+		return _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+	}
+	Lanes GreaterLanes(Lanes lhs, Lanes rhs)
+	{
+		return _mm_cmpgt_ps(lhs, rhs);
+	}
+	bool AnyLanes(Lanes mask)
+	{
+		return _mm_movemask_ps(mask) != 0;
+	}
+	Lanes SelectLanes(Lanes mask, Lanes if_true, Lanes if_false)
+	{
+		return _mm_or_ps(_mm_and_ps(mask, if_true), _mm_andnot_ps(mask, if_false));
+	}
+#elif defined(KLAYGE_NEON_SUPPORT)
+	typedef float32x4_t Lanes;
+
+	Lanes LoadLanes(float const * p)
+	{
+		return vld1q_f32(p);
+	}
+	void StoreLanes(float* p, Lanes v)
+	{
+		vst1q_f32(p, v);
+	}
+	Lanes SplatLanes(float v)
+	{
+		return vdupq_n_f32(v);
+	}
+	Lanes AddLanes(Lanes lhs, Lanes rhs)
+	{
+		return vaddq_f32(lhs, rhs);
+	}
+	Lanes SubLanes(Lanes lhs, Lanes rhs)
+	{
+		return vsubq_f32(lhs, rhs);
+	}
+	Lanes MulLanes(Lanes lhs, Lanes rhs)
+	{
+		return vmulq_f32(lhs, rhs);
+	}
+	Lanes DivLanes(Lanes lhs, Lanes rhs)
+	{
+#if defined(KLAYGE_CPU_ARM64)
+		return vdivq_f32(lhs, rhs);
+#else
+		// Two Newton-Raphson steps on the estimate give a full precision reciprocal
+		float32x4_t rcp = vrecpeq_f32(rhs);
+		rcp = vmulq_f32(vrecpsq_f32(rhs, rcp), rcp);
+		rcp = vmulq_f32(vrecpsq_f32(rhs, rcp), rcp);
+		return vmulq_f32(lhs, rcp);
+#endif
+	}
+	Lanes MinLanes(Lanes lhs, Lanes rhs)
+	{
+		return vminq_f32(lhs, rhs);
+	}
+	Lanes SaturateLanes(Lanes v)
+	{
+		return vminq_f32(vmaxq_f32(v, vdupq_n_f32(0.0f)), vdupq_n_f32(1.0f));
+	}
+	Lanes GreaterLanes(Lanes lhs, Lanes rhs)
+	{
+		return vreinterpretq_f32_u32(vcgtq_f32(lhs, rhs));
+	}
+	bool AnyLanes(Lanes mask)
+	{
+		uint32x4_t const m = vreinterpretq_u32_f32(mask);
+		uint32x2_t const m2 = vorr_u32(vget_low_u32(m), vget_high_u32(m));
+		return (vget_lane_u32(m2, 0) | vget_lane_u32(m2, 1)) != 0;
+	}
+	Lanes SelectLanes(Lanes mask, Lanes if_true, Lanes if_false)
+	{
+		return vbslq_f32(vreinterpretq_u32_f32(mask), if_true, if_false);
+	}
+#endif
+
+	// Stable LSD radix sort, farthest particle first. The float depths are mapped to integer keys that sort in the same order.
+	void RadixSortByDepth(std::vector<std::pair<uint32_t, float>>& particles, std::vector<std::pair<uint32_t, float>>& scratch)
+	{
+		if (particles.size() <= 1)
+		{
+			return;
+		}
+
+		auto depth_key = [](float depth)
+			{
+				uint32_t bits;
+				std::memcpy(&bits, &depth, sizeof(bits));
+				uint32_t const ascending_key = (bits & 0x80000000U) ? ~bits : (bits | 0x80000000U);
+				return ~ascending_key;
+			};
+
+		std::array<std::array<uint32_t, 256>, 4> histograms = {};
+		for (auto const & particle : particles)
+		{
+			uint32_t const key = depth_key(particle.second);
+			for (uint32_t pass = 0; pass < 4; ++ pass)
+			{
+				++ histograms[pass][(key >> (pass * 8)) & 0xFF];
+			}
+		}
+
+		scratch.resize(particles.size());
+
+		auto* src = &particles;
+		auto* dst = &scratch;
+		for (uint32_t pass = 0; pass < 4; ++ pass)
+		{
+			uint32_t const shift = pass * 8;
+			auto& histogram = histograms[pass];
+
+			// All the keys have the same digit, nothing to do in this pass
+			if (histogram[(depth_key(src->front().second) >> shift) & 0xFF] == src->size())
+			{
+				continue;
+			}
+
+			uint32_t offset = 0;
+			for (auto& count : histogram)
+			{
+				uint32_t const c = count;
+				count = offset;
+				offset += c;
+			}
+
+			for (auto const & particle : *src)
+			{
+				(*dst)[histogram[(depth_key(particle.second) >> shift) & 0xFF]++] = particle;
+			}
+			std::swap(src, dst);
+		}
+
+		if (src != &particles)
+		{
+			particles.swap(scratch);
+		}
+	}
+
 	class ParticleSystemLoadingDesc : public ResLoadingDesc
 	{
 	private:
@@ -344,6 +552,14 @@ namespace
 			return true;
 		}
 
+		uint64_t Hash() const override
+		{
+			size_t seed = 0;
+			HashCombine(seed, this->Type());
+			HashRange(seed, ps_desc_.res_name.begin(), ps_desc_.res_name.end());
+			return seed;
+		}
+
 		bool Match(ResLoadingDesc const & rhs) const override
 		{
 			if (this->Type() == rhs.Type())
@@ -590,6 +806,19 @@ namespace KlayGE
 	{
 	}
 
+	void ParticleUpdater::UpdateBatch(ParticleBatch const & batch, float elapse_time)
+	{
+		for (uint32_t i = 0; i < batch.num_particles; ++ i)
+		{
+			if (batch.life[i] > 0)
+			{
+				Particle par = batch.Get(i);
+				this->Update(par, elapse_time);
+				batch.Set(i, par);
+			}
+		}
+	}
+
 	void ParticleUpdater::DoClone(ParticleUpdaterPtr const & rhs)
 	{
 		rhs->ps_ = ps_;
@@ -598,7 +827,8 @@ namespace KlayGE
 
 	ParticleSystem::ParticleSystem(uint32_t max_num_particles, bool sort_particles)
 		: SceneNode(SOA_Moveable | SOA_NotCastShadow),
-			particles_(max_num_particles),
+			num_particles_(max_num_particles), particle_attribs_(max_num_particles * PA_NumAttribs),
+			actived_particles_dirty_(false),
 			gravity_(0.5f), force_(0, 0, 0), media_density_(0.0f),
 			sort_particles_(sort_particles)
 	{
@@ -731,88 +961,151 @@ namespace KlayGE
 		return actived_particles_[i].first;
 	}
 
-	void ParticleSystem::ClearParticles()
+	Particle ParticleSystem::GetParticle(uint32_t i) const
 	{
-		for (auto& particle : particles_)
-		{
-			particle.life = 0;
-		}
+		BOOST_ASSERT(i < num_particles_);
+
+		float const * attribs = particle_attribs_.data() + i;
+		Particle par;
+		par.pos = float3(attribs[PA_PosX * num_particles_], attribs[PA_PosY * num_particles_], attribs[PA_PosZ * num_particles_]);
+		par.vel = float3(attribs[PA_VelX * num_particles_], attribs[PA_VelY * num_particles_], attribs[PA_VelZ * num_particles_]);
+		par.life = attribs[PA_Life * num_particles_];
+		par.spin = attribs[PA_Spin * num_particles_];
+		par.size = attribs[PA_Size * num_particles_];
+		par.alpha = attribs[PA_Alpha * num_particles_];
+		par.init_life = attribs[PA_InitLife * num_particles_];
+		return par;
 	}
 
-	void ParticleSystem::UpdateParticlesNoLock(float elapsed_time)
+	void ParticleSystem::SetParticle(uint32_t i, Particle const & par)
+	{
+		this->ParticleRange(i, 1).Set(0, par);
+	}
+
+	ParticleBatch ParticleSystem::ParticleRange(uint32_t first, uint32_t num)
 	{
-		auto emitter_iter = emitters_.begin();
-		uint32_t new_particle = (*emitter_iter)->Update(elapsed_time);
+		BOOST_ASSERT(first + num <= num_particles_);
+
+		float* attribs = particle_attribs_.data() + first;
+		ParticleBatch batch;
+		batch.pos_x = attribs + PA_PosX * num_particles_;
+		batch.pos_y = attribs + PA_PosY * num_particles_;
+		batch.pos_z = attribs + PA_PosZ * num_particles_;
+		batch.vel_x = attribs + PA_VelX * num_particles_;
+		batch.vel_y = attribs + PA_VelY * num_particles_;
+		batch.vel_z = attribs + PA_VelZ * num_particles_;
+		batch.life = attribs + PA_Life * num_particles_;
+		batch.spin = attribs + PA_Spin * num_particles_;
+		batch.size = attribs + PA_Size * num_particles_;
+		batch.alpha = attribs + PA_Alpha * num_particles_;
+		batch.init_life = attribs + PA_InitLife * num_particles_;
+		batch.num_particles = num;
+		return batch;
+	}
 
-		float4x4 const & view_mat = Context::Instance().AppInstance().ActiveCamera().ViewMatrix();
+	void ParticleSystem::ClearParticles()
+	{
+		ParticleBatch const batch = this->ParticleRange(0, num_particles_);
+		std::fill(batch.life, batch.life + num_particles_, 0.0f);
+		std::fill(batch.init_life, batch.init_life + num_particles_, 1.0f);
+	}
 
-		actived_particles_.clear();
+	void ParticleSystem::UpdateParticlesNoLock(float elapsed_time)
+	{
+		uint32_t const MIN_PARTICLES_PER_TASK = 2048;
 
-		float3 min_bb(+1e10f, +1e10f, +1e10f);
-		float3 max_bb(-1e10f, -1e10f, -1e10f);
+		if (sort_particles_)
+		{
+			float4x4 const & view_mat = Context::Instance().AppInstance().ActiveCamera().ViewMatrix();
+			depth_z_row_ = view_mat.Col(2);
+			depth_w_row_ = view_mat.Col(3);
+		}
 
 		for (auto const & updater : updaters_)
 		{
 			updater->SnapParams();
 		}
 
-		for (uint32_t i = 0; i < particles_.size(); ++ i)
-		{
-			Particle& particle = particles_[i];
+		// Every chunk but the last one is a multiple of 4 particles, so the SIMD updaters only have a scalar tail at the end
+		uint32_t num_tasks = std::min(std::max(std::thread::hardware_concurrency(), 1U),
+			std::max(num_particles_ / MIN_PARTICLES_PER_TASK, 1U));
+		uint32_t const particles_per_task = std::max(((num_particles_ + num_tasks - 1) / num_tasks + 3) & ~3U, 4U);
+		num_tasks = std::max((num_particles_ + particles_per_task - 1) / particles_per_task, 1U);
+		simulation_chunks_.resize(num_tasks);
 
-			if (particle.life > 0)
+		if (num_tasks <= 1)
+		{
+			this->SimulateChunk(simulation_chunks_[0], 0, num_particles_, elapsed_time);
+		}
+		else
+		{
+			std::vector<joiner<void>> joiners;
+			joiners.reserve(num_tasks - 1);
+			for (uint32_t i = 1; i < num_tasks; ++ i)
 			{
-				for (auto const & updater : updaters_)
-				{
-					updater->Update(particle, elapsed_time);
-				}
+				uint32_t const first = i * particles_per_task;
+				uint32_t const last = std::min(first + particles_per_task, num_particles_);
+				joiners.push_back(Context::Instance().ThreadPool()([this, i, first, last, elapsed_time]
+					{
+						this->SimulateChunk(simulation_chunks_[i], first, last, elapsed_time);
+					}));
 			}
-			else
+			this->SimulateChunk(simulation_chunks_[0], 0, particles_per_task, elapsed_time);
+			for (auto& task_joiner : joiners)
+			{
+				task_joiner();
+			}
+		}
+
+		// Emitting stays serial, every emitter has its own random generator. New particles go to the slots freed by the chunks.
+		auto chunk_iter = simulation_chunks_.begin();
+		size_t free_index = 0;
+		for (auto const & emitter : emitters_)
+		{
+			for (uint32_t new_particle = emitter->Update(elapsed_time); new_particle > 0; -- new_particle)
 			{
-				if (new_particle > 0)
+				while ((chunk_iter != simulation_chunks_.end()) && (free_index == chunk_iter->free_particles.size()))
 				{
-					(*emitter_iter)->Emit(particle);
-					for (auto const & updater : updaters_)
-					{
-						updater->Update(particle, 0);
-					}
-					-- new_particle;
+					++ chunk_iter;
+					free_index = 0;
 				}
-				else
+				if (chunk_iter == simulation_chunks_.end())
 				{
-					if (emitter_iter != emitters_.end())
-					{
-						++ emitter_iter;
-						if (emitter_iter != emitters_.end())
-						{
-							new_particle = (*emitter_iter)->Update(elapsed_time);
-						}
-					}
+					break;
 				}
-			}
 
-			if (particle.life > 0)
-			{
-				float3 const & pos = particle.pos;
+				uint32_t const index = chunk_iter->free_particles[free_index];
+				++ free_index;
 
-				float depth_es;
-				if (sort_particles_)
-				{
-					float4 const pos4(pos.x(), pos.y(), pos.z(), 1);
-					float4 const z_row = view_mat.Col(2);
-					float4 const w_row = view_mat.Col(3);
+				Particle par{};
+				emitter->Emit(par);
 
-					depth_es = MathLib::dot(pos4, z_row) / MathLib::dot(pos4, w_row);
+				ParticleBatch const batch = this->ParticleRange(index, 1);
+				batch.Set(0, par);
+				for (auto const & updater : updaters_)
+				{
+					updater->UpdateBatch(batch, 0);
 				}
-				else
+
+				if (batch.life[0] > 0)
 				{
-					depth_es = 0;
+					this->ActivateParticle(*chunk_iter, index);
 				}
+			}
+		}
 
-				actived_particles_.emplace_back(i, depth_es);
+		actived_particles_.clear();
 
-				min_bb = MathLib::minimize(min_bb, pos);
-				max_bb = MathLib::maximize(min_bb, pos);
+		float3 min_bb(+1e10f, +1e10f, +1e10f);
+		float3 max_bb(-1e10f, -1e10f, -1e10f);
+		for (auto const & chunk : simulation_chunks_)
+		{
+			if (!chunk.actived_particles.empty())
+			{
+				actived_particles_.insert(actived_particles_.end(), chunk.actived_particles.begin(), chunk.actived_particles.end());
+
+				min_bb = MathLib::minimize(min_bb, chunk.min_bb);
+				max_bb = MathLib::maximize(max_bb, chunk.max_bb);
 			}
 		}
 
@@ -820,21 +1113,68 @@ namespace KlayGE
 		{
 			if (sort_particles_)
 			{
-				std::sort(actived_particles_.begin(), actived_particles_.end(),
-					[](std::pair<uint32_t, float> const & lhs, std::pair<uint32_t, float> const & rhs)
-					{
-						return lhs.second > rhs.second;
-					});
+				RadixSortByDepth(actived_particles_, sort_scratch_);
+			}
+
+			actived_particles_aabb_ = AABBox(min_bb, max_bb);
+		}
+		actived_particles_dirty_ = true;
+	}
+
+	void ParticleSystem::SimulateChunk(SimulationChunk& chunk, uint32_t first, uint32_t last, float elapsed_time)
+	{
+		chunk.actived_particles.clear();
+		chunk.free_particles.clear();
+		chunk.min_bb = float3(+1e10f, +1e10f, +1e10f);
+		chunk.max_bb = float3(-1e10f, -1e10f, -1e10f);
+
+		ParticleBatch const batch = this->ParticleRange(first, last - first);
+		for (auto const & updater : updaters_)
+		{
+			updater->UpdateBatch(batch, elapsed_time);
+		}
+
+		for (uint32_t i = first; i < last; ++ i)
+		{
+			if (batch.life[i - first] > 0)
+			{
+				this->ActivateParticle(chunk, i);
+			}
+			else
+			{
+				chunk.free_particles.push_back(i);
 			}
+		}
+	}
+
+	void ParticleSystem::ActivateParticle(SimulationChunk& chunk, uint32_t index)
+	{
+		float const * attribs = particle_attribs_.data() + index;
+		float3 const pos(attribs[PA_PosX * num_particles_], attribs[PA_PosY * num_particles_], attribs[PA_PosZ * num_particles_]);
 
-			checked_pointer_cast<RenderParticles>(renderables_[0])->PosBound(AABBox(min_bb, max_bb));
+		float depth_es;
+		if (sort_particles_)
+		{
+			float4 const pos4(pos.x(), pos.y(), pos.z(), 1);
+			depth_es = MathLib::dot(pos4, depth_z_row_) / MathLib::dot(pos4, depth_w_row_);
+		}
+		else
+		{
+			depth_es = 0;
 		}
+
+		chunk.actived_particles.emplace_back(index, depth_es);
+
+		chunk.min_bb = MathLib::minimize(chunk.min_bb, pos);
+		chunk.max_bb = MathLib::maximize(chunk.max_bb, pos);
 	}
 
 	void ParticleSystem::UpdateParticleBufferNoLock()
 	{
 		if (!actived_particles_.empty())
 		{
+			checked_pointer_cast<RenderParticles>(renderables_[0])->PosBound(actived_particles_aabb_);
+
 			RenderLayout& rl = renderables_[0]->GetRenderLayout();
 
 			GraphicsBufferPtr instance_gb;
@@ -878,44 +1218,40 @@ namespace KlayGE
 			}
 
 			{
+				ParticleBatch const particles = this->ParticleRange(0, num_particles_);
+
 				GraphicsBuffer::Mapper mapper(*instance_gb, BA_Write_Only);
 				ParticleInstance* instance_data = mapper.Pointer<ParticleInstance>();
 				for (uint32_t i = 0; i < num_active_particles; ++ i, ++ instance_data)
 				{
-					Particle const & par = particles_[actived_particles_[i].first];
-					instance_data->pos = par.pos;
-					instance_data->life = par.life;
-					instance_data->spin = par.spin;
-					instance_data->size = par.size;
-					instance_data->life_factor = (par.init_life - par.life) / par.init_life;
-					instance_data->alpha = par.alpha;
+					uint32_t const index = actived_particles_[i].first;
+					instance_data->pos = float3(particles.pos_x[index], particles.pos_y[index], particles.pos_z[index]);
+					instance_data->life = particles.life[index];
+					instance_data->spin = particles.spin[index];
+					instance_data->size = particles.size[index];
+					instance_data->life_factor = (particles.init_life[index] - particles.life[index]) / particles.init_life[index];
+					instance_data->alpha = particles.alpha[index];
 				}
 			}
 		}
 	}
 
+	// The sub thread update runs while the scene is rendered, so the renderable is only touched on the main thread
 	void ParticleSystem::SubThreadUpdateFunc(float elapsed_time)
 	{
 		std::lock_guard<std::mutex> lock(actived_particles_mutex_);
 
 		this->UpdateParticlesNoLock(elapsed_time);
-
-		auto& rf = Context::Instance().RenderFactoryInstance();
-		auto const & caps = rf.RenderEngineInstance().DeviceCaps();
-		if (caps.arbitrary_multithread_rendering_support)
-		{
-			this->UpdateParticleBufferNoLock();
-		}
 	}
 
 	void ParticleSystem::MainThreadUpdateFunc()
 	{
-		auto& rf = Context::Instance().RenderFactoryInstance();
-		auto const & caps = rf.RenderEngineInstance().DeviceCaps();
-		if (!caps.arbitrary_multithread_rendering_support)
+		std::lock_guard<std::mutex> lock(actived_particles_mutex_);
+
+		if (actived_particles_dirty_)
 		{
-			std::lock_guard<std::mutex> lock(actived_particles_mutex_);
 			this->UpdateParticleBufferNoLock();
+			actived_particles_dirty_ = false;
 		}
 	}
 
@@ -1184,65 +1520,151 @@ namespace KlayGE
 
 	void PolylineParticleUpdater::Update(Particle& par, float elapse_time)
 	{
-		BOOST_ASSERT(!this_frame_size_over_life_.empty());
-		BOOST_ASSERT(!this_frame_mass_over_life_.empty());
-		BOOST_ASSERT(!this_frame_opacity_over_life_.empty());
+		float const pos = (par.init_life - par.life) / par.init_life;
+
+		float const cur_size = EvaluatePolyline(this_frame_size_over_life_, pos);
+		float const cur_mass = EvaluatePolyline(this_frame_mass_over_life_, pos);
+		float const cur_alpha = EvaluatePolyline(this_frame_opacity_over_life_, pos);
+
+		ParticleSystemPtr ps = ps_.lock();
+		float buoyancy = 4.0f / 3 * PI * MathLib::cube(cur_size) * ps->MediaDensity() * ps->Gravity();
+		float3 accel = (ps->Force() + float3(0, buoyancy, 0)) / cur_mass - float3(0, ps->Gravity(), 0);
+		par.vel += accel * elapse_time;
+		par.pos += par.vel * elapse_time;
+		par.life -= elapse_time;
+		par.spin += 0.001f;
+		par.size = cur_size;
+		par.alpha = cur_alpha;
+	}
+
+	void PolylineParticleUpdater::UpdateBatch(ParticleBatch const & batch, float elapse_time)
+	{
+		uint32_t i = 0;
 
-		float pos = (par.init_life - par.life) / par.init_life;
+#ifdef KLAYGE_PARTICLE_SIMD
+		ParticleSystemPtr ps = ps_.lock();
+		float const buoyancy_scale = 4.0f / 3 * PI * ps->MediaDensity() * ps->Gravity();
+
+		Lanes const zero = SplatLanes(0);
+		Lanes const dt = SplatLanes(elapse_time);
+		Lanes const force_x = SplatLanes(ps->Force().x());
+		Lanes const force_y = SplatLanes(ps->Force().y());
+		Lanes const force_z = SplatLanes(ps->Force().z());
+		Lanes const gravity = SplatLanes(ps->Gravity());
+		Lanes const buoyancy_factor = SplatLanes(buoyancy_scale);
+		Lanes const spin_step = SplatLanes(0.001f);
+
+		auto evaluate = [](Polyline const & polyline, Lanes x)
+			{
+				Lanes y = AddLanes(SplatLanes(polyline.y0),
+					MulLanes(MinLanes(SubLanes(x, SplatLanes(polyline.x0)), SplatLanes(0)), SplatLanes(polyline.slope0)));
+				for (auto const & ramp : polyline.ramps)
+				{
+					Lanes const s = SaturateLanes(MulLanes(SubLanes(x, SplatLanes(ramp.x)), SplatLanes(ramp.inv_width)));
+					y = AddLanes(y, MulLanes(s, SplatLanes(ramp.dy)));
+				}
+				return y;
+			};
 
-		float cur_size = this_frame_size_over_life_.back().y();
-		for (auto iter = std::next(this_frame_size_over_life_.begin()); iter != this_frame_size_over_life_.end(); ++ iter)
+		for (; i + 4 <= batch.num_particles; i += 4)
 		{
-			if (iter->x() >= pos)
+			Lanes const life = LoadLanes(batch.life + i);
+			Lanes const alive = GreaterLanes(life, zero);
+			if (!AnyLanes(alive))
 			{
-				float2 const & prev = *std::prev(iter);
-				float const s = (pos - prev.x()) / (iter->x() - prev.x());
-				cur_size = MathLib::lerp(prev.y(), iter->y(), s);
-				break;
+				continue;
 			}
-		}
 
-		float cur_mass = this_frame_mass_over_life_.back().y();
-		for (auto iter = std::next(this_frame_mass_over_life_.begin()); iter != this_frame_mass_over_life_.end(); ++ iter)
-		{
-			if (iter->x() >= pos)
+			Lanes const init_life = LoadLanes(batch.init_life + i);
+			Lanes const pos = DivLanes(SubLanes(init_life, life), init_life);
+
+			Lanes const cur_size = evaluate(this_frame_size_over_life_, pos);
+			Lanes const cur_mass = evaluate(this_frame_mass_over_life_, pos);
+			Lanes const cur_alpha = evaluate(this_frame_opacity_over_life_, pos);
+
+			Lanes const buoyancy = MulLanes(MulLanes(MulLanes(cur_size, cur_size), cur_size), buoyancy_factor);
+			Lanes const accel[] =
 			{
-				float2 const & prev = *std::prev(iter);
-				float const s = (pos - prev.x()) / (iter->x() - prev.x());
-				cur_mass = MathLib::lerp(prev.y(), iter->y(), s);
-				break;
+				DivLanes(force_x, cur_mass),
+				SubLanes(DivLanes(AddLanes(force_y, buoyancy), cur_mass), gravity),
+				DivLanes(force_z, cur_mass)
+			};
+
+			// Dead particles in the same 4 are computed too, but never written back
+			float* const vels[] = { batch.vel_x + i, batch.vel_y + i, batch.vel_z + i };
+			float* const poses[] = { batch.pos_x + i, batch.pos_y + i, batch.pos_z + i };
+			for (uint32_t axis = 0; axis < 3; ++ axis)
+			{
+				Lanes const vel = LoadLanes(vels[axis]);
+				Lanes const new_vel = AddLanes(vel, MulLanes(accel[axis], dt));
+				StoreLanes(vels[axis], SelectLanes(alive, new_vel, vel));
+
+				Lanes const p = LoadLanes(poses[axis]);
+				StoreLanes(poses[axis], SelectLanes(alive, AddLanes(p, MulLanes(new_vel, dt)), p));
 			}
+
+			StoreLanes(batch.life + i, SelectLanes(alive, SubLanes(life, dt), life));
+			Lanes const spin = LoadLanes(batch.spin + i);
+			StoreLanes(batch.spin + i, SelectLanes(alive, AddLanes(spin, spin_step), spin));
+			StoreLanes(batch.size + i, SelectLanes(alive, cur_size, LoadLanes(batch.size + i)));
+			StoreLanes(batch.alpha + i, SelectLanes(alive, cur_alpha, LoadLanes(batch.alpha + i)));
 		}
+#endif
 
-		float cur_alpha = this_frame_opacity_over_life_.back().y();
-		for (auto iter = std::next(this_frame_opacity_over_life_.begin()); iter != this_frame_opacity_over_life_.end(); ++ iter)
+		for (; i < batch.num_particles; ++ i)
 		{
-			if (iter->x() >= pos)
+			if (batch.life[i] > 0)
 			{
-				float2 const & prev = *std::prev(iter);
-				float const s = (pos - prev.x()) / (iter->x() - prev.x());
-				cur_alpha = MathLib::lerp(prev.y(), iter->y(), s);
-				break;
+				Particle par = batch.Get(i);
+				this->Update(par, elapse_time);
+				batch.Set(i, par);
 			}
 		}
-
-		ParticleSystemPtr ps = ps_.lock();
-		float buoyancy = 4.0f / 3 * PI * MathLib::cube(cur_size) * ps->MediaDensity() * ps->Gravity();
-		float3 accel = (ps->Force() + float3(0, buoyancy, 0)) / cur_mass - float3(0, ps->Gravity(), 0);
-		par.vel += accel * elapse_time;
-		par.pos += par.vel * elapse_time;
-		par.life -= elapse_time;
-		par.spin += 0.001f;
-		par.size = cur_size;
-		par.alpha = cur_alpha;
 	}
 
 	void PolylineParticleUpdater::SnapParams()
 	{
 		std::lock_guard<std::mutex> lock(update_mutex_);
 
-		this_frame_size_over_life_ = size_over_life_;
-		this_frame_mass_over_life_ = mass_over_life_;
-		this_frame_opacity_over_life_ = opacity_over_life_;
+		BuildPolyline(this_frame_size_over_life_, size_over_life_);
+		BuildPolyline(this_frame_mass_over_life_, mass_over_life_);
+		BuildPolyline(this_frame_opacity_over_life_, opacity_over_life_);
+	}
+
+	void PolylineParticleUpdater::BuildPolyline(Polyline& polyline, std::vector<float2> const & ctrl_points)
+	{
+		// A vertical segment becomes a step. Before the first point, the first segment is extended, like the curves have
+		// always been evaluated.
+		polyline.x0 = ctrl_points.empty() ? 0.0f : ctrl_points.front().x();
+		polyline.y0 = ctrl_points.empty() ? 0.0f : ctrl_points.front().y();
+		polyline.slope0 = 0;
+		polyline.ramps.clear();
+		for (size_t i = 1; i < ctrl_points.size(); ++ i)
+		{
+			float2 const & prev = ctrl_points[i - 1];
+			float2 const & curr = ctrl_points[i];
+			float const width = curr.x() - prev.x();
+
+			PolylineRamp ramp;
+			ramp.x = prev.x();
+			ramp.inv_width = (width > 0) ? 1 / width : std::numeric_limits<float>::max();
+			ramp.dy = curr.y() - prev.y();
+			polyline.ramps.push_back(ramp);
+
+			if ((1 == i) && (width > 0))
+			{
+				polyline.slope0 = ramp.dy / width;
+			}
+		}
+	}
+
+	float PolylineParticleUpdater::EvaluatePolyline(Polyline const & polyline, float x)
+	{
+		float y = polyline.y0 + std::min(x - polyline.x0, 0.0f) * polyline.slope0;
+		for (auto const & ramp : polyline.ramps)
+		{
+			y += MathLib::clamp((x - ramp.x) * ramp.inv_width, 0.0f, 1.0f) * ramp.dy;
+		}
+		return y;
 	}
 }
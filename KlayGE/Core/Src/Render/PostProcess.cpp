@@ -191,6 +191,15 @@ namespace
 			return true;
 		}
 
+		uint64_t Hash() const override
+		{
+			size_t seed = 0;
+			HashCombine(seed, this->Type());
+			HashRange(seed, pp_desc_.res_name.begin(), pp_desc_.res_name.end());
+			HashRange(seed, pp_desc_.pp_name.begin(), pp_desc_.pp_name.end());
+			return seed;
+		}
+
 		bool Match(ResLoadingDesc const & rhs) const override
 		{
 			if (this->Type() == rhs.Type())
@@ -2586,6 +2586,17 @@ namespace KlayGE
 			return true;
 		}
 
+		uint64_t Hash() const override
+		{
+			size_t seed = 0;
+			HashCombine(seed, this->Type());
+			for (auto const & name : effect_desc_.res_name)
+			{
+				HashRange(seed, name.begin(), name.end());
+			}
+			return seed;
+		}
+
 		bool Match(ResLoadingDesc const & rhs) const override
 		{
 			if (this->Type() == rhs.Type())
@@ -2669,6 +2680,55 @@ namespace KlayGE
 #endif
 
 
+	void RenderEffectNameTable::Clear()
+	{
+		slots_.clear();
+		num_entries_ = 0;
+	}
+
+	void RenderEffectNameTable::Insert(size_t name_hash, uint32_t index)
+	{
+		BOOST_ASSERT(index != INVALID_INDEX);
+
+		// At most half full, so every probe ends at an empty slot
+		if ((num_entries_ + 1) * 2 > slots_.size())
+		{
+			std::vector<Slot> entries;
+			entries.reserve(num_entries_);
+			for (auto const & slot : slots_)
+			{
+				if (slot.index != INVALID_INDEX)
+				{
+					entries.push_back(slot);
+				}
+			}
+			// Reinserted in the original order, so the first of the entries with the same name is still found first
+			std::sort(entries.begin(), entries.end(),
+				[](Slot const & lhs, Slot const & rhs)
+				{
+					return lhs.index < rhs.index;
+				});
+
+			slots_.assign(std::max<size_t>(slots_.size() * 2, 16), Slot{ 0, INVALID_INDEX });
+			num_entries_ = 0;
+			for (auto const & entry : entries)
+			{
+				this->Insert(entry.name_hash, entry.index);
+			}
+		}
+
+		size_t const mask = slots_.size() - 1;
+		size_t i = name_hash & mask;
+		while (slots_[i].index != INVALID_INDEX)
+		{
+			i = (i + 1) & mask;
+		}
+		slots_[i].name_hash = name_hash;
+		slots_[i].index = index;
+		++ num_entries_;
+	}
+
+
 	void RenderEffect::Open(ArrayRef<std::string> names)
 	{
 		effect_template_ = MakeSharedPtr<RenderEffectTemplate>();
@@ -2762,15 +2822,24 @@ namespace KlayGE
 
 	RenderEffectParameter* RenderEffect::ParameterByName(std::string_view name) const
 	{
-		size_t const name_hash = HashRange(name.begin(), name.end());
-		for (auto const & param : params_)
+		return this->ParameterByName(name, HashRange(name.begin(), name.end()));
+	}
+
+	RenderEffectParameter* RenderEffect::ParameterByName(std::string_view name, size_t name_hash) const
+	{
+		BOOST_ASSERT(name_hash == HashRange(name.begin(), name.end()));
+
+		if (!effect_template_)
 		{
-			if (name_hash == param->NameHash())
-			{
-				return param.get();
-			}
+			return nullptr;
 		}
-		return nullptr;
+
+		uint32_t const index = effect_template_->ParameterNameTable().Find(name_hash,
+			[this, name](uint32_t i)
+			{
+				return params_[i]->Name() == name;
+			});
+		return (index != RenderEffectNameTable::INVALID_INDEX) ? params_[index].get() : nullptr;
 	}
 
 	RenderEffectParameter* RenderEffect::ParameterBySemantic(std::string_view semantic) const
@@ -2788,15 +2857,24 @@ namespace KlayGE
 
 	RenderEffectConstantBuffer* RenderEffect::CBufferByName(std::string_view name) const
 	{
-		size_t const name_hash = HashRange(name.begin(), name.end());
-		for (auto const & cbuffer : cbuffers_)
+		return this->CBufferByName(name, HashRange(name.begin(), name.end()));
+	}
+
+	RenderEffectConstantBuffer* RenderEffect::CBufferByName(std::string_view name, size_t name_hash) const
+	{
+		BOOST_ASSERT(name_hash == HashRange(name.begin(), name.end()));
+
+		if (!effect_template_)
 		{
-			if (name_hash == cbuffer->NameHash())
-			{
-				return cbuffer.get();
-			}
+			return nullptr;
 		}
-		return nullptr;
+
+		uint32_t const index = effect_template_->CBufferNameTable().Find(name_hash,
+			[this, name](uint32_t i)
+			{
+				return cbuffers_[i]->Name() == name;
+			});
+		return (index != RenderEffectNameTable::INVALID_INDEX) ? cbuffers_[index].get() : nullptr;
 	}
 
 	uint32_t RenderEffect::NumTechniques() const
@@ -2809,6 +2887,11 @@ namespace KlayGE
 		return effect_template_->TechniqueByName(name);
 	}
 
+	RenderTechnique* RenderEffect::TechniqueByName(std::string_view name, size_t name_hash) const
+	{
+		return effect_template_->TechniqueByName(name, name_hash);
+	}
+
 	RenderTechnique* RenderEffect::TechniqueByIndex(uint32_t n) const
 	{
 		return effect_template_->TechniqueByIndex(n);
@@ -3180,6 +3263,8 @@ namespace KlayGE
 			effect.params_.back()->Load(node);
 		}
 
+		this->BuildNameTables(effect);
+
 		for (XMLNodePtr shader_graph_nodes_node = root.FirstNode("shader_graph_nodes"); shader_graph_nodes_node;
 			shader_graph_nodes_node = shader_graph_nodes_node->NextSibling("shader_graph_nodes"))
 		{
@@ -3223,6 +3308,7 @@ namespace KlayGE
 		{
 			techniques_.push_back(MakeUniquePtr<RenderTechnique>());
 			techniques_.back()->Open(effect, node, index);
+			tech_name_table_.Insert(techniques_.back()->NameHash(), index);
 		}
 	}
 #endif
@@ -3290,6 +3376,7 @@ namespace KlayGE
 			hlsl_shader_.clear();
 			techniques_.clear();
 			shader_graph_nodes_.clear();
+			this->ClearNameTables();
 
 			shader_descs_.resize(1);
 
@@ -3439,6 +3526,8 @@ namespace KlayGE
 							}
 						}
 
+						this->BuildNameTables(effect);
+
 						{
 							uint8_t num_shader_graph_nodes;
 							source->read(&num_shader_graph_nodes, sizeof(num_shader_graph_nodes));
@@ -3501,6 +3590,7 @@ namespace KlayGE
 							{
 								techniques_[i] = MakeUniquePtr<RenderTechnique>();
 								ret &= techniques_[i]->StreamIn(effect, source, i);
+								tech_name_table_.Insert(techniques_[i]->NameHash(), i);
 							}
 						}
 					}
@@ -3639,15 +3729,45 @@ namespace KlayGE
 
 	RenderTechnique* RenderEffectTemplate::TechniqueByName(std::string_view name) const
 	{
-		size_t const name_hash = HashRange(name.begin(), name.end());
-		for (auto const & tech : techniques_)
-		{
-			if (name_hash == tech->NameHash())
+		return this->TechniqueByName(name, HashRange(name.begin(), name.end()));
+	}
+
+	RenderTechnique* RenderEffectTemplate::TechniqueByName(std::string_view name, size_t name_hash) const
+	{
+		BOOST_ASSERT(name_hash == HashRange(name.begin(), name.end()));
+
+		uint32_t const index = tech_name_table_.Find(name_hash,
+			[this, name](uint32_t i)
 			{
-				return tech.get();
-			}
+				return techniques_[i]->Name() == name;
+			});
+		return (index != RenderEffectNameTable::INVALID_INDEX) ? techniques_[index].get() : nullptr;
+	}
+
+	// Techniques look up parameters, cbuffers and their parent techniques while loading. So the parameter and cbuffer tables are
+	// built before the techniques, and every technique is added to its table once it's loaded.
+	void RenderEffectTemplate::BuildNameTables(RenderEffect const & effect)
+	{
+		param_name_table_.Clear();
+		for (uint32_t i = 0; i < effect.params_.size(); ++ i)
+		{
+			param_name_table_.Insert(effect.params_[i]->NameHash(), i);
 		}
-		return nullptr;
+
+		cbuffer_name_table_.Clear();
+		for (uint32_t i = 0; i < effect.cbuffers_.size(); ++ i)
+		{
+			cbuffer_name_table_.Insert(effect.cbuffers_[i]->NameHash(), i);
+		}
+
+		tech_name_table_.Clear();
+	}
+
+	void RenderEffectTemplate::ClearNameTables()
+	{
+		param_name_table_.Clear();
+		cbuffer_name_table_.Clear();
+		tech_name_table_.Clear();
 	}
 
 	uint32_t RenderEffectTemplate::AddShaderDesc(ShaderDesc const & sd)
@@ -5305,17 +5425,61 @@ namespace KlayGE
 				hw_buff_ = rf.MakeConstantBuffer(BU_Dynamic, 0, size, nullptr);
 			}
 		}
+		dirty_regs_.assign((size + 16 * 64 - 1) / (16 * 64), 0);
 
 		dirty_ = true;
+		all_dirty_ = true;
 	}
 
 	void RenderEffectConstantBuffer::Update()
 	{
 		if (dirty_)
 		{
-			hw_buff_->UpdateSubresource(0, static_cast<uint32_t>(buff_.size()), &buff_[0]);
+			RenderEngine& re = Context::Instance().RenderFactoryInstance().RenderEngineInstance();
+
+			uint32_t const size = static_cast<uint32_t>(buff_.size());
+			uint32_t uploaded = 0;
+			if (all_dirty_ || !re.DeviceCaps().partial_cbuffer_update_support)
+			{
+				hw_buff_->UpdateSubresource(0, size, &buff_[0]);
+				uploaded = size;
+			}
+			else
+			{
+				// One upload for each run of dirty registers
+				uint32_t const num_regs = (size + 15) / 16;
+				uint32_t reg = 0;
+				while (reg < num_regs)
+				{
+					if ((0 == (reg & 63)) && (0 == dirty_regs_[reg / 64]))
+					{
+						reg += 64;
+					}
+					else if (dirty_regs_[reg / 64] & (1ULL << (reg & 63)))
+					{
+						uint32_t const offset = reg * 16;
+						do
+						{
+							++ reg;
+						} while ((reg < num_regs) && (dirty_regs_[reg / 64] & (1ULL << (reg & 63))));
+
+						uint32_t const run_size = std::min(reg * 16, size) - offset;
+						hw_buff_->UpdateSubresource(offset, run_size, &buff_[offset]);
+						uploaded += run_size;
+					}
+					else
+					{
+						++ reg;
+					}
+				}
+
+				std::fill(dirty_regs_.begin(), dirty_regs_.end(), 0ULL);
+			}
+
+			re.AddCBufferUpload(size, uploaded);
 
 			dirty_ = false;
+			all_dirty_ = false;
 		}
 	}
 
@@ -5323,6 +5487,7 @@ namespace KlayGE
 	{
 		hw_buff_ = buff;
 		buff_.resize(buff->Size());
+		dirty_regs_.assign((buff_.size() + 16 * 64 - 1) / (16 * 64), 0);
 	}
 
 
@@ -6285,7 +6450,7 @@ namespace KlayGE
 				++ dst;
 			}
 
-			cbuff_desc.cbuff->Dirty(true);
+			cbuff_desc.cbuff->Dirty(cbuff_desc.offset, static_cast<uint32_t>(size_ * sizeof(float4x4)));
 		}
 		else
 		{
@@ -68,6 +68,7 @@ namespace KlayGE
 	RenderEngine::RenderEngine()
 		: num_primitives_just_rendered_(0), num_vertices_just_rendered_(0),
 			num_draws_just_called_(0), num_dispatches_just_called_(0),
+			num_cbuffer_bytes_just_uploaded_(0), num_cbuffer_bytes_just_updated_(0),
 			default_fov_(PI / 4), default_render_width_scale_(1), default_render_height_scale_(1),
 			stereo_method_(STM_None), stereo_separation_(0),
 			fb_stage_(0), force_line_mode_(false)
@@ -418,6 +419,7 @@ namespace KlayGE
 
 #ifndef KLAYGE_SHIP
 		PerfProfiler& profiler = PerfProfiler::Instance();
+		profiler.ThreadName("Main");
 		hdr_pp_perf_ = profiler.CreatePerfRange(0, "HDR PP");
 		smaa_pp_perf_ = profiler.CreatePerfRange(0, "SMAA PP");
 		post_tone_mapping_pp_perf_ = profiler.CreatePerfRange(0, "Post tone mapping PP");
@@ -618,6 +620,26 @@ namespace KlayGE
 		return ret;
 	}
 
+	uint32_t RenderEngine::NumCBufferBytesJustUploaded()
+	{
+		uint32_t const ret = num_cbuffer_bytes_just_uploaded_;
+		num_cbuffer_bytes_just_uploaded_ = 0;
+		return ret;
+	}
+
+	uint32_t RenderEngine::NumCBufferBytesJustUpdated()
+	{
+		uint32_t const ret = num_cbuffer_bytes_just_updated_;
+		num_cbuffer_bytes_just_updated_ = 0;
+		return ret;
+	}
+
+	void RenderEngine::AddCBufferUpload(uint32_t cbuffer_size, uint32_t uploaded_size)
+	{
+		num_cbuffer_bytes_just_updated_ += cbuffer_size;
+		num_cbuffer_bytes_just_uploaded_ += uploaded_size;
+	}
+
 	// ȡȾ豸
 	/////////////////////////////////////////////////////////////////////////////////
 	RenderDeviceCaps const & RenderEngine::DeviceCaps() const
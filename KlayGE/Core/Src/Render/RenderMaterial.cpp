@@ -34,6 +34,7 @@
 #include <KFL/XMLDom.hpp>
 #include <KlayGE/RenderFactory.hpp>
 #include <KlayGE/RenderEngine.hpp>
+#include <KlayGE/Texture.hpp>
 #include <KFL/Hash.hpp>
 #include <KFL/CXX17/filesystem.hpp>
 
@@ -68,285 +69,454 @@ namespace
 		}
 	}
 
-	class RenderMaterialLoadingDesc : public ResLoadingDesc
+	uint32_t const MTL_BIN_VERSION = 1;
+	char const * const JIT_EXT_NAME = ".mtl_bin";
+
+	void LoadMaterialXml(ResIdentifierPtr const & source, std::string_view res_name, RenderMaterial& mtl)
 	{
-	private:
-		struct RenderMaterialDesc
-		{
-			std::string res_name;
+		KlayGE::XMLDocument doc;
+		XMLNodePtr root = doc.Parse(source);
 
-			struct RenderMaterialData
+		{
+			XMLAttributePtr attr = root->Attrib("name");
+			if (attr)
 			{
-				std::string name;
-
-				float4 albedo;
-				float metalness;
-				float glossiness;
-				float3 emissive;
-
-				bool transparent;
-				float alpha_test;
-				bool sss;
-				bool two_sided;
-
-				std::array<std::string, RenderMaterial::TS_NumTextureSlots> tex_names;
-
-				RenderMaterial::SurfaceDetailMode detail_mode;
-				float2 height_offset_scale;
-				float4 tess_factors;
-			};
-			std::shared_ptr<RenderMaterialData> mtl_data;
+				mtl.name = std::string(attr->ValueString());
+			}
+			else
+			{
+				std::filesystem::path res_path(res_name);
+				mtl.name = res_path.stem().string();
+			}
+		}
 
-			std::shared_ptr<RenderMaterialPtr> mtl;
-		};
+		mtl.albedo = float4(0, 0, 0, 1);
+		mtl.metalness = 0;
+		mtl.glossiness = 0;
+		mtl.emissive = float3(0, 0, 0);
+		mtl.transparent = false;
+		mtl.alpha_test = 0;
+		mtl.sss = false;
+		mtl.two_sided = false;
+
+		mtl.detail_mode = RenderMaterial::SDM_Parallax;
+		mtl.height_offset_scale = float2(-0.5f, 0.06f);
+		mtl.tess_factors = float4(5, 5, 1, 9);
+
+		XMLNodePtr albedo_node = root->FirstNode("albedo");
+		if (albedo_node)
+		{
+			XMLAttributePtr attr = albedo_node->Attrib("color");
+			if (attr)
+			{
+				ExtractFVector<4>(attr->ValueString(), &mtl.albedo[0]);
+			}
+			attr = albedo_node->Attrib("texture");
+			if (attr)
+			{
+				mtl.tex_names[RenderMaterial::TS_Albedo] = std::string(attr->ValueString());
+			}
+		}
 
-	public:
-		explicit RenderMaterialLoadingDesc(std::string_view res_name)
+		XMLNodePtr metalness_node = root->FirstNode("metalness");
+		if (metalness_node)
 		{
-			mtl_desc_.res_name = std::string(res_name);
-			mtl_desc_.mtl_data = MakeSharedPtr<RenderMaterialDesc::RenderMaterialData>();
-			mtl_desc_.mtl = MakeSharedPtr<RenderMaterialPtr>();
+			XMLAttributePtr attr = metalness_node->Attrib("value");
+			if (attr)
+			{
+				mtl.metalness = attr->ValueFloat();
+			}
+			attr = metalness_node->Attrib("texture");
+			if (attr)
+			{
+				mtl.tex_names[RenderMaterial::TS_Metalness] = std::string(attr->ValueString());
+			}
 		}
 
-		uint64_t Type() const override
+		XMLNodePtr glossiness_node = root->FirstNode("glossiness");
+		if (glossiness_node)
 		{
-			static uint64_t const type = CT_HASH("RenderMaterialLoadingDesc");
-			return type;
+			XMLAttributePtr attr = glossiness_node->Attrib("value");
+			if (attr)
+			{
+				mtl.glossiness = attr->ValueFloat();
+			}
+			attr = glossiness_node->Attrib("texture");
+			if (attr)
+			{
+				mtl.tex_names[RenderMaterial::TS_Glossiness] = std::string(attr->ValueString());
+			}
 		}
 
-		bool StateLess() const override
+		XMLNodePtr emissive_node = root->FirstNode("emissive");
+		if (emissive_node)
 		{
-			return true;
+			XMLAttributePtr attr = emissive_node->Attrib("color");
+			if (attr)
+			{
+				ExtractFVector<3>(attr->ValueString(), &mtl.emissive[0]);
+			}
+			attr = emissive_node->Attrib("texture");
+			if (attr)
+			{
+				mtl.tex_names[RenderMaterial::TS_Emissive] = std::string(attr->ValueString());
+			}
 		}
 
-		void SubThreadStage() override
+		XMLNodePtr normal_node = root->FirstNode("normal");
+		if (normal_node)
 		{
-			std::lock_guard<std::mutex> lock(main_thread_stage_mutex_);
+			XMLAttributePtr attr = normal_node->Attrib("texture");
+			if (attr)
+			{
+				mtl.tex_names[RenderMaterial::TS_Normal] = std::string(attr->ValueString());
+			}
+		}
 
-			if (*mtl_desc_.mtl)
+		XMLNodePtr height_node = root->FirstNode("height");
+		if (height_node)
+		{
+			XMLAttributePtr attr = height_node->Attrib("texture");
+			if (attr)
 			{
-				return;
+				mtl.tex_names[RenderMaterial::TS_Height] = std::string(attr->ValueString());
 			}
 
-			ResIdentifierPtr mtl_input = ResLoader::Instance().Open(mtl_desc_.res_name);
+			attr = height_node->Attrib("offset");
+			if (attr)
+			{
+				mtl.height_offset_scale.x() = attr->ValueFloat();
+			}
 
-			KlayGE::XMLDocument doc;
-			XMLNodePtr root = doc.Parse(mtl_input);
+			attr = height_node->Attrib("scale");
+			if (attr)
+			{
+				mtl.height_offset_scale.y() = attr->ValueFloat();
+			}
+		}
 
+		XMLNodePtr detail_node = root->FirstNode("detail");
+		if (detail_node)
+		{
+			XMLAttributePtr attr = detail_node->Attrib("mode");
+			if (attr)
 			{
-				XMLAttributePtr attr = root->Attrib("name");
-				if (attr)
+				std::string_view const mode_str = attr->ValueString();
+				size_t const mode_hash = HashRange(mode_str.begin(), mode_str.end());
+				if (CT_HASH("Flat Tessellation") == mode_hash)
 				{
-					mtl_desc_.mtl_data->name = std::string(attr->ValueString());
+					mtl.detail_mode = RenderMaterial::SDM_FlatTessellation;
 				}
-				else
+				else if (CT_HASH("Smooth Tessellation") == mode_hash)
 				{
-					std::filesystem::path res_path(mtl_desc_.res_name);
-					mtl_desc_.mtl_data->name = res_path.stem().string();
+					mtl.detail_mode = RenderMaterial::SDM_SmoothTessellation;
 				}
 			}
 
-			mtl_desc_.mtl_data->albedo = float4(0, 0, 0, 1);
-			mtl_desc_.mtl_data->metalness = 0;
-			mtl_desc_.mtl_data->glossiness = 0;
-			mtl_desc_.mtl_data->emissive = float3(0, 0, 0);
-			mtl_desc_.mtl_data->transparent = false;
-			mtl_desc_.mtl_data->alpha_test = 0;
-			mtl_desc_.mtl_data->sss = false;
-			mtl_desc_.mtl_data->two_sided = false;
-
-			mtl_desc_.mtl_data->detail_mode = RenderMaterial::SDM_Parallax;
-			mtl_desc_.mtl_data->height_offset_scale = float2(-0.5f, 0.06f);
-			mtl_desc_.mtl_data->tess_factors = float4(5, 5, 1, 9);
-
-			XMLNodePtr albedo_node = root->FirstNode("albedo");
-			if (albedo_node)
+			XMLNodePtr tess_node = detail_node->FirstNode("tess");
+			if (tess_node)
 			{
-				XMLAttributePtr attr = albedo_node->Attrib("color");
+				attr = tess_node->Attrib("edge_hint");
 				if (attr)
 				{
-					ExtractFVector<4>(attr->ValueString(), &mtl_desc_.mtl_data->albedo[0]);
+					mtl.tess_factors.x() = attr->ValueFloat();
 				}
-				attr = albedo_node->Attrib("texture");
+				attr = tess_node->Attrib("inside_hint");
 				if (attr)
 				{
-					mtl_desc_.mtl_data->tex_names[RenderMaterial::TS_Albedo] = std::string(attr->ValueString());
+					mtl.tess_factors.y() = attr->ValueFloat();
 				}
-			}
-
-			XMLNodePtr metalness_node = root->FirstNode("metalness");
-			if (metalness_node)
-			{
-				XMLAttributePtr attr = metalness_node->Attrib("value");
+				attr = tess_node->Attrib("min");
 				if (attr)
 				{
-					mtl_desc_.mtl_data->metalness = attr->ValueFloat();
+					mtl.tess_factors.z() = attr->ValueFloat();
 				}
-				attr = metalness_node->Attrib("texture");
+				attr = tess_node->Attrib("max");
 				if (attr)
 				{
-					mtl_desc_.mtl_data->tex_names[RenderMaterial::TS_Metalness] = std::string(attr->ValueString());
+					mtl.tess_factors.w() = attr->ValueFloat();
 				}
 			}
+		}
 
-			XMLNodePtr glossiness_node = root->FirstNode("glossiness");
-			if (glossiness_node)
+		XMLNodePtr transparent_node = root->FirstNode("transparent");
+		if (transparent_node)
+		{
+			XMLAttributePtr attr = transparent_node->Attrib("value");
+			if (attr)
 			{
-				XMLAttributePtr attr = glossiness_node->Attrib("value");
-				if (attr)
-				{
-					mtl_desc_.mtl_data->glossiness = attr->ValueFloat();
-				}
-				attr = glossiness_node->Attrib("texture");
-				if (attr)
-				{
-					mtl_desc_.mtl_data->tex_names[RenderMaterial::TS_Glossiness] = std::string(attr->ValueString());
-				}
+				mtl.transparent = attr->ValueInt() ? true : false;
 			}
+		}
 
-			XMLNodePtr emissive_node = root->FirstNode("emissive");
-			if (emissive_node)
+		XMLNodePtr alpha_test_node = root->FirstNode("alpha_test");
+		if (alpha_test_node)
+		{
+			XMLAttributePtr attr = alpha_test_node->Attrib("value");
+			if (attr)
 			{
-				XMLAttributePtr attr = emissive_node->Attrib("color");
-				if (attr)
-				{
-					ExtractFVector<3>(attr->ValueString(), &mtl_desc_.mtl_data->emissive[0]);
-				}
-				attr = emissive_node->Attrib("texture");
-				if (attr)
-				{
-					mtl_desc_.mtl_data->tex_names[RenderMaterial::TS_Emissive] = std::string(attr->ValueString());
-				}
+				mtl.alpha_test = attr->ValueFloat();
 			}
+		}
 
-			XMLNodePtr normal_node = root->FirstNode("normal");
-			if (normal_node)
+		XMLNodePtr sss_node = root->FirstNode("sss");
+		if (sss_node)
+		{
+			XMLAttributePtr attr = sss_node->Attrib("value");
+			if (attr)
 			{
-				XMLAttributePtr attr = normal_node->Attrib("texture");
-				if (attr)
-				{
-					mtl_desc_.mtl_data->tex_names[RenderMaterial::TS_Normal] = std::string(attr->ValueString());
-				}
+				mtl.sss = attr->ValueInt() ? true : false;
 			}
+		}
 
-			XMLNodePtr height_node = root->FirstNode("height");
-			if (height_node)
+		XMLNodePtr two_sided_node = root->FirstNode("two_sided");
+		if (two_sided_node)
+		{
+			XMLAttributePtr attr = two_sided_node->Attrib("value");
+			if (attr)
 			{
-				XMLAttributePtr attr = height_node->Attrib("texture");
-				if (attr)
-				{
-					mtl_desc_.mtl_data->tex_names[RenderMaterial::TS_Height] = std::string(attr->ValueString());
-				}
+				mtl.two_sided = attr->ValueInt() ? true : false;
+			}
+		}
+	}
 
-				attr = height_node->Attrib("offset");
-				if (attr)
-				{
-					mtl_desc_.mtl_data->height_offset_scale.x() = attr->ValueFloat();
-				}
+	bool LoadMaterialBin(ResIdentifierPtr const & source, RenderMaterial& mtl)
+	{
+		uint32_t fourcc;
+		source->read(&fourcc, sizeof(fourcc));
+		fourcc = LE2Native(fourcc);
+		uint32_t ver;
+		source->read(&ver, sizeof(ver));
+		ver = LE2Native(ver);
+		if (!*source || (fourcc != MakeFourCC<'K', 'M', 'T', 'L'>::value) || (ver != MTL_BIN_VERSION))
+		{
+			return false;
+		}
 
-				attr = height_node->Attrib("scale");
-				if (attr)
-				{
-					mtl_desc_.mtl_data->height_offset_scale.y() = attr->ValueFloat();
-				}
-			}
+		mtl.name = ReadShortString(source);
 
-			XMLNodePtr detail_node = root->FirstNode("detail");
-			if (detail_node)
-			{
-				XMLAttributePtr attr = detail_node->Attrib("mode");
-				if (attr)
-				{
-					std::string_view const mode_str = attr->ValueString();
-					size_t const mode_hash = HashRange(mode_str.begin(), mode_str.end());
-					if (CT_HASH("Flat Tessellation") == mode_hash)
-					{
-						mtl_desc_.mtl_data->detail_mode = RenderMaterial::SDM_FlatTessellation;
-					}
-					else if (CT_HASH("Smooth Tessellation") == mode_hash)
-					{
-						mtl_desc_.mtl_data->detail_mode = RenderMaterial::SDM_SmoothTessellation;
-					}
-				}
+		source->read(&mtl.albedo, sizeof(mtl.albedo));
+		for (uint32_t i = 0; i < 4; ++ i)
+		{
+			mtl.albedo[i] = LE2Native(mtl.albedo[i]);
+		}
+		source->read(&mtl.metalness, sizeof(mtl.metalness));
+		mtl.metalness = LE2Native(mtl.metalness);
+		source->read(&mtl.glossiness, sizeof(mtl.glossiness));
+		mtl.glossiness = LE2Native(mtl.glossiness);
+		source->read(&mtl.emissive, sizeof(mtl.emissive));
+		for (uint32_t i = 0; i < 3; ++ i)
+		{
+			mtl.emissive[i] = LE2Native(mtl.emissive[i]);
+		}
 
-				XMLNodePtr tess_node = detail_node->FirstNode("tess");
-				if (tess_node)
-				{
-					attr = tess_node->Attrib("edge_hint");
-					if (attr)
-					{
-						mtl_desc_.mtl_data->tess_factors.x() = attr->ValueFloat();
-					}
-					attr = tess_node->Attrib("inside_hint");
-					if (attr)
-					{
-						mtl_desc_.mtl_data->tess_factors.y() = attr->ValueFloat();
-					}
-					attr = tess_node->Attrib("min");
-					if (attr)
-					{
-						mtl_desc_.mtl_data->tess_factors.z() = attr->ValueFloat();
-					}
-					attr = tess_node->Attrib("max");
-					if (attr)
-					{
-						mtl_desc_.mtl_data->tess_factors.w() = attr->ValueFloat();
-					}
-				}
-			}
+		uint8_t flags;
+		source->read(&flags, sizeof(flags));
+		mtl.transparent = (flags & 1) ? true : false;
+		mtl.sss = (flags & 2) ? true : false;
+		mtl.two_sided = (flags & 4) ? true : false;
+		source->read(&mtl.alpha_test, sizeof(mtl.alpha_test));
+		mtl.alpha_test = LE2Native(mtl.alpha_test);
+
+		for (size_t i = 0; i < RenderMaterial::TS_NumTextureSlots; ++ i)
+		{
+			mtl.tex_names[i] = ReadShortString(source);
+		}
+
+		uint8_t detail_mode;
+		source->read(&detail_mode, sizeof(detail_mode));
+		mtl.detail_mode = static_cast<RenderMaterial::SurfaceDetailMode>(detail_mode);
+		source->read(&mtl.height_offset_scale, sizeof(mtl.height_offset_scale));
+		for (uint32_t i = 0; i < 2; ++ i)
+		{
+			mtl.height_offset_scale[i] = LE2Native(mtl.height_offset_scale[i]);
+		}
+		source->read(&mtl.tess_factors, sizeof(mtl.tess_factors));
+		for (uint32_t i = 0; i < 4; ++ i)
+		{
+			mtl.tess_factors[i] = LE2Native(mtl.tess_factors[i]);
+		}
+
+		return !!*source;
+	}
+
+#if KLAYGE_IS_DEV_PLATFORM
+	// All the values are kept as they are, so a material from the binary is the same as the one from the XML
+	void SaveMaterialBin(RenderMaterial const & mtl, std::ostream& os)
+	{
+		uint32_t const fourcc = Native2LE(MakeFourCC<'K', 'M', 'T', 'L'>::value);
+		os.write(reinterpret_cast<char const *>(&fourcc), sizeof(fourcc));
+		uint32_t const ver = Native2LE(MTL_BIN_VERSION);
+		os.write(reinterpret_cast<char const *>(&ver), sizeof(ver));
+
+		WriteShortString(os, mtl.name);
+
+		for (uint32_t i = 0; i < 4; ++ i)
+		{
+			float const value = Native2LE(mtl.albedo[i]);
+			os.write(reinterpret_cast<char const *>(&value), sizeof(value));
+		}
+		float const metalness = Native2LE(mtl.metalness);
+		os.write(reinterpret_cast<char const *>(&metalness), sizeof(metalness));
+		float const glossiness = Native2LE(mtl.glossiness);
+		os.write(reinterpret_cast<char const *>(&glossiness), sizeof(glossiness));
+		for (uint32_t i = 0; i < 3; ++ i)
+		{
+			float const value = Native2LE(mtl.emissive[i]);
+			os.write(reinterpret_cast<char const *>(&value), sizeof(value));
+		}
+
+		uint8_t const flags = (mtl.transparent ? 1 : 0) | (mtl.sss ? 2 : 0) | (mtl.two_sided ? 4 : 0);
+		os.write(reinterpret_cast<char const *>(&flags), sizeof(flags));
+		float const alpha_test = Native2LE(mtl.alpha_test);
+		os.write(reinterpret_cast<char const *>(&alpha_test), sizeof(alpha_test));
+
+		for (size_t i = 0; i < RenderMaterial::TS_NumTextureSlots; ++ i)
+		{
+			WriteShortString(os, mtl.tex_names[i]);
+		}
 
-			XMLNodePtr transparent_node = root->FirstNode("transparent");
-			if (transparent_node)
+		uint8_t const detail_mode = static_cast<uint8_t>(mtl.detail_mode);
+		os.write(reinterpret_cast<char const *>(&detail_mode), sizeof(detail_mode));
+		for (uint32_t i = 0; i < 2; ++ i)
+		{
+			float const value = Native2LE(mtl.height_offset_scale[i]);
+			os.write(reinterpret_cast<char const *>(&value), sizeof(value));
+		}
+		for (uint32_t i = 0; i < 4; ++ i)
+		{
+			float const value = Native2LE(mtl.tess_factors[i]);
+			os.write(reinterpret_cast<char const *>(&value), sizeof(value));
+		}
+	}
+#endif
+
+	class RenderMaterialLoadingDesc : public ResLoadingDesc
+	{
+	private:
+		struct RenderMaterialDesc
+		{
+			std::string res_name;
+			bool queue_textures;
+
+			// Filled on the loading thread, and copied to mtl on the main thread
+			std::shared_ptr<RenderMaterial> mtl_data;
+
+			std::shared_ptr<RenderMaterialPtr> mtl;
+		};
+
+	public:
+		RenderMaterialLoadingDesc(std::string_view res_name, bool queue_textures)
+		{
+			mtl_desc_.res_name = std::string(res_name);
+			mtl_desc_.queue_textures = queue_textures;
+			mtl_desc_.mtl_data = MakeSharedPtr<RenderMaterial>();
+			mtl_desc_.mtl_data->loaded = false;
+			mtl_desc_.mtl = MakeSharedPtr<RenderMaterialPtr>();
+		}
+
+		uint64_t Type() const override
+		{
+			static uint64_t const type = CT_HASH("RenderMaterialLoadingDesc");
+			return type;
+		}
+
+		bool StateLess() const override
+		{
+			return true;
+		}
+
+		std::shared_ptr<void> CreateResource() override
+		{
+			RenderMaterialPtr mtl = MakeSharedPtr<RenderMaterial>();
+			mtl->loaded = false;
+			*mtl_desc_.mtl = mtl;
+			return mtl;
+		}
+
+		void SubThreadStage() override
+		{
+			std::lock_guard<std::mutex> lock(main_thread_stage_mutex_);
+
+			RenderMaterial& mtl = *mtl_desc_.mtl_data;
+			if (mtl.loaded)
 			{
-				XMLAttributePtr attr = transparent_node->Attrib("value");
-				if (attr)
-				{
-					mtl_desc_.mtl_data->transparent = attr->ValueInt() ? true : false;
-				}
+				return;
 			}
 
-			XMLNodePtr alpha_test_node = root->FirstNode("alpha_test");
-			if (alpha_test_node)
+			std::filesystem::path res_path(mtl_desc_.res_name);
+			if (res_path.extension() == JIT_EXT_NAME)
 			{
-				XMLAttributePtr attr = alpha_test_node->Attrib("value");
-				if (attr)
+				ResIdentifierPtr runtime_file = ResLoader::Instance().Open(mtl_desc_.res_name);
+				if (!runtime_file || !LoadMaterialBin(runtime_file, mtl))
 				{
-					mtl_desc_.mtl_data->alpha_test = attr->ValueFloat();
+					LogError() << mtl_desc_.res_name << " is not a valid material." << std::endl;
 				}
 			}
-
-			XMLNodePtr sss_node = root->FirstNode("sss");
-			if (sss_node)
+			else
 			{
-				XMLAttributePtr attr = sss_node->Attrib("value");
-				if (attr)
+				std::string const runtime_name = mtl_desc_.res_name + JIT_EXT_NAME;
+
+				bool jit = true;
+				if (!ResLoader::Instance().Locate(runtime_name).empty())
 				{
-					mtl_desc_.mtl_data->sss = attr->ValueInt() ? true : false;
+					ResIdentifierPtr runtime_file = ResLoader::Instance().Open(runtime_name);
+					if (runtime_file)
+					{
+						uint64_t const runtime_file_timestamp = runtime_file->Timestamp();
+						uint64_t const input_file_timestamp = ResLoader::Instance().Timestamp(mtl_desc_.res_name);
+						if (((input_file_timestamp == 0) || (runtime_file_timestamp >= input_file_timestamp))
+							&& LoadMaterialBin(runtime_file, mtl))
+						{
+							jit = false;
+						}
+					}
 				}
-			}
 
-			XMLNodePtr two_sided_node = root->FirstNode("two_sided");
-			if (two_sided_node)
-			{
-				XMLAttributePtr attr = two_sided_node->Attrib("value");
-				if (attr)
+				if (jit)
 				{
-					mtl_desc_.mtl_data->two_sided = attr->ValueInt() ? true : false;
+					LoadMaterialXml(ResLoader::Instance().Open(mtl_desc_.res_name), mtl_desc_.res_name, mtl);
+#if KLAYGE_IS_DEV_PLATFORM
+					this->SaveRuntimeFile(mtl, runtime_name);
+#endif
 				}
 			}
 
-			RenderFactory& rf = Context::Instance().RenderFactoryInstance();
-			RenderDeviceCaps const & caps = rf.RenderEngineInstance().DeviceCaps();
-			if (caps.multithread_res_creating_support)
-			{
-				this->MainThreadStageNoLock();
-			}
+			mtl.loaded = true;
 		}
 
 		void MainThreadStage() override
 		{
 			std::lock_guard<std::mutex> lock(main_thread_stage_mutex_);
-			this->MainThreadStageNoLock();
+
+			RenderMaterialPtr& mtl = *mtl_desc_.mtl;
+			if (!mtl)
+			{
+				mtl = MakeSharedPtr<RenderMaterial>();
+				mtl->loaded = false;
+			}
+			if (!mtl->loaded)
+			{
+				BOOST_ASSERT(mtl_desc_.mtl_data->loaded);
+				*mtl = *mtl_desc_.mtl_data;
+
+				// Queued here rather than on the loading thread, which may not have a render context to create them on
+				if (mtl_desc_.queue_textures)
+				{
+					for (size_t i = 0; i < RenderMaterial::TS_NumTextureSlots; ++ i)
+					{
+						auto const & tex_name = mtl->tex_names[i];
+						if (!tex_name.empty())
+						{
+							if (!ResLoader::Instance().Locate(tex_name).empty()
+								|| !ResLoader::Instance().Locate(tex_name + ".dds").empty())
+							{
+								mtl->textures[i] = ASyncLoadTexture(tex_name, EAH_GPU_Read | EAH_Immutable);
+							}
+						}
+					}
+				}
+			}
 		}
 
 		bool HasSubThreadStage() const override
@@ -354,12 +524,23 @@ namespace
 			return true;
 		}
 
+		uint64_t Hash() const override
+		{
+			size_t seed = 0;
+			HashCombine(seed, this->Type());
+			HashRange(seed, mtl_desc_.res_name.begin(), mtl_desc_.res_name.end());
+			HashCombine(seed, mtl_desc_.queue_textures);
+			return seed;
+		}
+
 		bool Match(ResLoadingDesc const & rhs) const override
 		{
 			if (this->Type() == rhs.Type())
 			{
 				RenderMaterialLoadingDesc const & mtlld = static_cast<RenderMaterialLoadingDesc const &>(rhs);
-				return (mtl_desc_.res_name == mtlld.mtl_desc_.res_name);
+				// A material loaded without its textures can't stand in for one that queues them
+				return (mtl_desc_.res_name == mtlld.mtl_desc_.res_name)
+					&& (mtl_desc_.queue_textures == mtlld.mtl_desc_.queue_textures);
 			}
 			return false;
 		}
@@ -370,6 +551,7 @@ namespace
 
 			RenderMaterialLoadingDesc const & mtlld = static_cast<RenderMaterialLoadingDesc const &>(rhs);
 			mtl_desc_.res_name = mtlld.mtl_desc_.res_name;
+			mtl_desc_.queue_textures = mtlld.mtl_desc_.queue_textures;
 			mtl_desc_.mtl_data = mtlld.mtl_desc_.mtl_data;
 			mtl_desc_.mtl = mtlld.mtl_desc_.mtl;
 		}
@@ -385,33 +567,27 @@ namespace
 		}
 
 	private:
-		void MainThreadStageNoLock()
+#if KLAYGE_IS_DEV_PLATFORM
+		// Next to the mtlml if possible, like the kfx of an effect
+		void SaveRuntimeFile(RenderMaterial const & mtl, std::string const & runtime_name)
 		{
-			if (!*mtl_desc_.mtl)
-			{
-				RenderMaterialPtr mtl = MakeSharedPtr<RenderMaterial>();
-
-				mtl->name = mtl_desc_.mtl_data->name;
-
-				mtl->albedo = mtl_desc_.mtl_data->albedo;
-				mtl->metalness = mtl_desc_.mtl_data->metalness;
-				mtl->glossiness = mtl_desc_.mtl_data->glossiness;
-				mtl->emissive = mtl_desc_.mtl_data->emissive;
-
-				mtl->transparent = mtl_desc_.mtl_data->transparent;
-				mtl->alpha_test = mtl_desc_.mtl_data->alpha_test;
-				mtl->sss = mtl_desc_.mtl_data->sss;
-				mtl->two_sided = mtl_desc_.mtl_data->two_sided;
+			std::string const input_path = ResLoader::Instance().Locate(mtl_desc_.res_name);
 
-				mtl->tex_names = mtl_desc_.mtl_data->tex_names;
-
-				mtl->detail_mode = mtl_desc_.mtl_data->detail_mode;
-				mtl->height_offset_scale = mtl_desc_.mtl_data->height_offset_scale;
-				mtl->tess_factors = mtl_desc_.mtl_data->tess_factors;
-
-				*mtl_desc_.mtl = mtl;
+			std::ofstream ofs;
+			if (!input_path.empty())
+			{
+				ofs.open((input_path + JIT_EXT_NAME).c_str(), std::ios_base::binary | std::ios_base::out);
+			}
+			if (!ofs)
+			{
+				ofs.open((ResLoader::Instance().LocalFolder() + runtime_name).c_str(), std::ios_base::binary | std::ios_base::out);
+			}
+			if (ofs)
+			{
+				SaveMaterialBin(mtl, ofs);
 			}
 		}
+#endif
 
 	private:
 		RenderMaterialDesc mtl_desc_;
@@ -423,13 +599,12 @@ namespace KlayGE
 {
 	RenderMaterialPtr SyncLoadRenderMaterial(std::string_view mtlml_name)
 	{
-		return ResLoader::Instance().SyncQueryT<RenderMaterial>(MakeSharedPtr<RenderMaterialLoadingDesc>(mtlml_name));
+		return ResLoader::Instance().SyncQueryT<RenderMaterial>(MakeSharedPtr<RenderMaterialLoadingDesc>(mtlml_name, false));
 	}
 
 	RenderMaterialPtr ASyncLoadRenderMaterial(std::string_view mtlml_name)
 	{
-		// TODO: Make it really async
-		return ResLoader::Instance().SyncQueryT<RenderMaterial>(MakeSharedPtr<RenderMaterialLoadingDesc>(mtlml_name));
+		return ResLoader::Instance().ASyncQueryT<RenderMaterial>(MakeSharedPtr<RenderMaterialLoadingDesc>(mtlml_name, true));
 	}
 
 	void SaveRenderMaterial(RenderMaterialPtr const & mtl, std::string const & mtlml_name)
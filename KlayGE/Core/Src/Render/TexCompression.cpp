@@ -32,12 +32,25 @@
 #include <KlayGE/Context.hpp>
 #include <KlayGE/RenderFactory.hpp>
 #include <KlayGE/Texture.hpp>
+#include <KFL/Thread.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
 #include <vector>
 #include <cstring>
 
 #include <KlayGE/TexCompression.hpp>
 
+namespace
+{
+	// Large enough for a 4x4 block of 128-bit pixels
+	uint32_t const MAX_BLOCK_PIXEL_BYTES = 4 * 4 * 16;
+
+	// Below this, starting a worker costs more than it saves
+	uint32_t const MIN_BLOCK_ROWS_PER_WORKER = 2;
+}
+
 namespace KlayGE
 {
 	uint32_t BlockWidth(ElementFormat format)
@@ -275,6 +288,37 @@ namespace KlayGE
 	}
 
 
+	TexCompressionPtr TexCompression::Clone() const
+	{
+		return TexCompressionPtr();
+	}
+
+	void TexCompression::DecodeBlocks(void* output, uint32_t out_row_pitch, void const * input, uint32_t num_blocks)
+	{
+		uint32_t const elem_size = NumFormatBytes(DecodedFormat(compression_format_));
+		uint32_t const block_width = BlockWidth(compression_format_);
+		uint32_t const block_height = BlockHeight(compression_format_);
+		uint32_t const block_bytes = BlockBytes(compression_format_);
+		uint32_t const block_row_bytes = block_width * elem_size;
+		BOOST_ASSERT(block_row_bytes * block_height <= MAX_BLOCK_PIXEL_BYTES);
+
+		std::array<uint8_t, MAX_BLOCK_PIXEL_BYTES> uncompressed;
+
+		uint8_t const * src = static_cast<uint8_t const *>(input);
+		uint8_t* dst = static_cast<uint8_t*>(output);
+		for (uint32_t i = 0; i < num_blocks; ++ i)
+		{
+			this->DecodeBlock(uncompressed.data(), src);
+			src += block_bytes;
+
+			for (uint32_t y = 0; y < block_height; ++ y)
+			{
+				memcpy(&dst[y * out_row_pitch], &uncompressed[y * block_row_bytes], block_row_bytes);
+			}
+			dst += block_row_bytes;
+		}
+	}
+
 	void TexCompression::EncodeMem(uint32_t width, uint32_t height,
 		void* output, uint32_t out_row_pitch, uint32_t out_slice_pitch,
 		void const * input, uint32_t in_row_pitch, uint32_t in_slice_pitch,
@@ -287,38 +331,36 @@ namespace KlayGE
 		uint32_t const block_width = BlockWidth(compression_format_);
 		uint32_t const block_height = BlockHeight(compression_format_);
 		uint32_t const block_bytes = BlockBytes(compression_format_);
+		uint32_t const block_row_bytes = block_width * elem_size;
+		BOOST_ASSERT(block_row_bytes * block_height <= MAX_BLOCK_PIXEL_BYTES);
 
-		uint8_t const * src = static_cast<uint8_t const *>(input);
+		uint32_t const num_block_rows = (height + block_height - 1) / block_height;
+		this->ForEachBlockRow(num_block_rows,
+			[=](TexCompression& codec, uint32_t block_row)
+			{
+				std::array<uint8_t, MAX_BLOCK_PIXEL_BYTES> uncompressed;
 
-		std::vector<uint8_t> uncompressed(block_width * block_height * elem_size);
-		for (uint32_t y_base = 0; y_base < height; y_base += block_height)
-		{
-			uint8_t* dst = static_cast<uint8_t*>(output) + (y_base / block_height) * out_row_pitch;
+				uint32_t const y_base = block_row * block_height;
+				uint32_t const block_h = std::min(block_height, height - y_base);
 
-			for (uint32_t x_base = 0; x_base < width; x_base += block_width)
-			{
-				for (uint32_t y = 0; y < block_height; ++ y)
+				uint8_t const * src = static_cast<uint8_t const *>(input) + y_base * in_row_pitch;
+				uint8_t* dst = static_cast<uint8_t*>(output) + block_row * out_row_pitch;
+				for (uint32_t x_base = 0; x_base < width; x_base += block_width)
 				{
-					for (uint32_t x = 0; x < block_width; ++ x)
+					uint32_t const block_w = std::min(block_width, width - x_base);
+					if ((block_w < block_width) || (block_h < block_height))
 					{
-						if ((x_base + x < width) && (y_base + y < height))
-						{
-							memcpy(&uncompressed[(y * block_width + x) * elem_size],
-								&src[(y_base + y) * in_row_pitch + (x_base + x) * elem_size],
-								elem_size);
-						}
-						else
-						{
-							memset(&uncompressed[(y * block_width + x) * elem_size],
-								0, elem_size);
-						}
+						uncompressed.fill(0);
+					}
+					for (uint32_t y = 0; y < block_h; ++ y)
+					{
+						memcpy(&uncompressed[y * block_row_bytes], &src[y * in_row_pitch + x_base * elem_size], block_w * elem_size);
 					}
-				}
 
-				this->EncodeBlock(dst, &uncompressed[0], method);
-				dst += block_bytes;
-			}
-		}
+					codec.EncodeBlock(dst, uncompressed.data(), method);
+					dst += block_bytes;
+				}
+			});
 	}
 
 	void TexCompression::DecodeMem(uint32_t width, uint32_t height,
@@ -332,30 +374,100 @@ namespace KlayGE
 		uint32_t const block_width = BlockWidth(compression_format_);
 		uint32_t const block_height = BlockHeight(compression_format_);
 		uint32_t const block_bytes = BlockBytes(compression_format_);
+		uint32_t const block_row_bytes = block_width * elem_size;
+		BOOST_ASSERT(block_row_bytes * block_height <= MAX_BLOCK_PIXEL_BYTES);
 
-		uint8_t * dst = static_cast<uint8_t*>(output);
-
-		std::vector<uint8_t> uncompressed(block_width * block_height * elem_size);
-		for (uint32_t y_base = 0; y_base < height; y_base += block_height)
-		{
-			uint8_t const * src = static_cast<uint8_t const *>(input) + in_row_pitch * (y_base / block_height);
-
-			uint32_t const block_h = std::min(block_height, height - y_base);
-			for (uint32_t x_base = 0; x_base < width; x_base += block_width)
+		uint32_t const num_block_rows = (height + block_height - 1) / block_height;
+		this->ForEachBlockRow(num_block_rows,
+			[=](TexCompression& codec, uint32_t block_row)
 			{
-				uint32_t const block_w = std::min(block_width, width - x_base);
+				std::array<uint8_t, MAX_BLOCK_PIXEL_BYTES> uncompressed;
+
+				uint32_t const y_base = block_row * block_height;
+				uint32_t const block_h = std::min(block_height, height - y_base);
 
-				this->DecodeBlock(&uncompressed[0], src);
-				src += block_bytes;
+				uint8_t const * src = static_cast<uint8_t const *>(input) + block_row * in_row_pitch;
+				uint8_t* dst = static_cast<uint8_t*>(output) + y_base * out_row_pitch;
 
-				for (uint32_t y = 0; y < block_h; ++ y)
+				// Whole blocks go straight to the output, only the ones on the right and bottom edges need the scratch
+				uint32_t x_base = 0;
+				if (block_h == block_height)
 				{
-					for (uint32_t x = 0; x < block_w; ++ x)
+					uint32_t const num_whole_blocks = width / block_width;
+					codec.DecodeBlocks(dst, out_row_pitch, src, num_whole_blocks);
+					src += num_whole_blocks * block_bytes;
+					x_base = num_whole_blocks * block_width;
+				}
+				for (; x_base < width; x_base += block_width)
+				{
+					uint32_t const block_w = std::min(block_width, width - x_base);
+
+					codec.DecodeBlock(uncompressed.data(), src);
+					src += block_bytes;
+
+					for (uint32_t y = 0; y < block_h; ++ y)
 					{
-						memcpy(&dst[(y_base + y) * out_row_pitch + (x_base + x) * elem_size],
-							&uncompressed[(y * block_width + x) * elem_size], elem_size);
+						memcpy(&dst[y * out_row_pitch + x_base * elem_size], &uncompressed[y * block_row_bytes], block_w * elem_size);
 					}
 				}
+			});
+	}
+
+	void TexCompression::ForEachBlockRow(uint32_t num_block_rows,
+		std::function<void(TexCompression& codec, uint32_t block_row)> const & func)
+	{
+		uint32_t num_workers = (num_threads_ > 0) ? num_threads_ : std::max(std::thread::hardware_concurrency(), 1U);
+		num_workers = std::min(num_workers, std::max(num_block_rows / MIN_BLOCK_ROWS_PER_WORKER, 1U));
+
+		std::vector<TexCompressionPtr> worker_codecs;
+		for (uint32_t i = 1; i < num_workers; ++ i)
+		{
+			auto codec = this->Clone();
+			if (!codec)
+			{
+				worker_codecs.clear();
+				break;
+			}
+			worker_codecs.push_back(codec);
+		}
+
+		if (worker_codecs.empty())
+		{
+			for (uint32_t block_row = 0; block_row < num_block_rows; ++ block_row)
+			{
+				func(*this, block_row);
+			}
+		}
+		else
+		{
+			// Rows are handed out one at a time, so the workers finish at about the same time even if some rows are much
+			// more expensive than others. A row is always encoded/decoded as a whole by one codec, and written to its own
+			// place, so the output doesn't depend on the scheduling.
+			std::atomic<uint32_t> next_block_row(0);
+			auto const worker = [&next_block_row, num_block_rows, &func](TexCompression& codec)
+				{
+					for (;;)
+					{
+						uint32_t const block_row = next_block_row.fetch_add(1);
+						if (block_row >= num_block_rows)
+						{
+							break;
+						}
+
+						func(codec, block_row);
+					}
+				};
+
+			std::vector<joiner<void>> joiners;
+			joiners.reserve(worker_codecs.size());
+			for (auto const & codec : worker_codecs)
+			{
+				joiners.push_back(Context::Instance().ThreadPool()([&worker, &codec] { worker(*codec); }));
+			}
+			worker(*this);
+			for (auto& task_joiner : joiners)
+			{
+				task_joiner();
 			}
 		}
 	}
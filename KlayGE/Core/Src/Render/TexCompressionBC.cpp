@@ -44,6 +44,11 @@
 #ifdef KLAYGE_COMPILER_MSVC
 	#include <intrin.h>		// For _BitScanForward
 #endif
+#if defined(KLAYGE_SSE2_SUPPORT)
+	#include <emmintrin.h>
+#elif defined(KLAYGE_NEON_SUPPORT)
+	#include <arm_neon.h>
+#endif
 
 #include <KlayGE/TexCompressionBC.hpp>
 #include "../Base/TableGen/Tables.hpp"
@@ -886,6 +891,265 @@ namespace
 		std::uniform_int_distribution<int> random_dis(0, RAND_MAX);
 		return random_dis(gen);
 	}
+
+	// Same arithmetic as the scalar BC4 decoder, shared with the SIMD path to keep the results bit-exact
+	void BC4Palette(std::array<uint8_t, 8>& alpha, BC4Block const & bc4)
+	{
+		float falpha0 = bc4.alpha_0 / 255.0f;
+		float falpha1 = bc4.alpha_1 / 255.0f;
+		alpha[0] = bc4.alpha_0;
+		alpha[1] = bc4.alpha_1;
+		if (alpha[0] > alpha[1])
+		{
+			alpha[2] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::lerp(falpha0, falpha1, 1 / 7.0f) * 255 + 0.5f), 0, 255));
+			alpha[3] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::lerp(falpha0, falpha1, 2 / 7.0f) * 255 + 0.5f), 0, 255));
+			alpha[4] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::lerp(falpha0, falpha1, 3 / 7.0f) * 255 + 0.5f), 0, 255));
+			alpha[5] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::lerp(falpha0, falpha1, 4 / 7.0f) * 255 + 0.5f), 0, 255));
+			alpha[6] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::lerp(falpha0, falpha1, 5 / 7.0f) * 255 + 0.5f), 0, 255));
+			alpha[7] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::lerp(falpha0, falpha1, 6 / 7.0f) * 255 + 0.5f), 0, 255));
+		}
+		else
+		{
+			alpha[2] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::lerp(falpha0, falpha1, 1 / 5.0f) * 255 + 0.5f), 0, 255));
+			alpha[3] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::lerp(falpha0, falpha1, 2 / 5.0f) * 255 + 0.5f), 0, 255));
+			alpha[4] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::lerp(falpha0, falpha1, 3 / 5.0f) * 255 + 0.5f), 0, 255));
+			alpha[5] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::lerp(falpha0, falpha1, 4 / 5.0f) * 255 + 0.5f), 0, 255));
+			alpha[6] = 0;
+			alpha[7] = 255;
+		}
+	}
+
+#if defined(KLAYGE_SSE2_SUPPORT) || defined(KLAYGE_NEON_SUPPORT)
+	uint32_t RGB565ToARGB8(uint16_t rgb)
+	{
+		return ARGBColor32(255, TexCompressionLUT::EXPAND5[(rgb >> 11) & 0x1F], TexCompressionLUT::EXPAND6[(rgb >> 5) & 0x3F],
+			TexCompressionLUT::EXPAND5[(rgb >> 0) & 0x1F]).ARGB();
+	}
+
+	// 2-bit indices of a BC1 row, one row per byte
+	uint32_t BC1RowBits(BC1Block const & bc1, uint32_t row)
+	{
+		return (bc1.bitmap[row / 2] >> (row % 2 * 8)) & 0xFF;
+	}
+#endif
+
+#if defined(KLAYGE_SSE2_SUPPORT)
+	// The 4 colors of a BC1 block, one per 32-bit lane. x / 3 is computed as x * 0x5556 >> 16, which is exact for x <= 765.
+	__m128i BC1PaletteSSE2(BC1Block const & bc1)
+	{
+		__m128i const zero = _mm_setzero_si128();
+		__m128i const c0 = _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(RGB565ToARGB8(bc1.clr_0))), zero);
+		__m128i const c1 = _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(RGB565ToARGB8(bc1.clr_1))), zero);
+		__m128i c2;
+		__m128i c3;
+		if (bc1.clr_0 > bc1.clr_1)
+		{
+			__m128i const one_third = _mm_set1_epi16(0x5556);
+			c2 = _mm_mulhi_epu16(_mm_add_epi16(_mm_add_epi16(c0, c0), c1), one_third);
+			c3 = _mm_mulhi_epu16(_mm_add_epi16(_mm_add_epi16(c1, c1), c0), one_third);
+		}
+		else
+		{
+			c2 = _mm_srli_epi16(_mm_add_epi16(c0, c1), 1);
+			c3 = zero;
+		}
+		return _mm_packus_epi16(_mm_unpacklo_epi64(c0, c1), _mm_unpacklo_epi64(c2, c3));
+	}
+
+	// Decodes the colors of a BC1 block to 4 rows of ARGB8. Each index is compared against all 4 values, and the matching
+	// palette entry is kept with a mask.
+	void DecodeBC1ColorsSSE2(__m128i rows[4], BC1Block const & bc1)
+	{
+		__m128i const palette = BC1PaletteSSE2(bc1);
+		__m128i const clr0 = _mm_shuffle_epi32(palette, 0x00);
+		__m128i const clr1 = _mm_shuffle_epi32(palette, 0x55);
+		__m128i const clr2 = _mm_shuffle_epi32(palette, 0xAA);
+		__m128i const clr3 = _mm_shuffle_epi32(palette, 0xFF);
+
+		__m128i const index_mask = _mm_setr_epi32(0x03, 0x0C, 0x30, 0xC0);
+		__m128i const index1 = _mm_setr_epi32(0x01, 0x04, 0x10, 0x40);
+		__m128i const index2 = _mm_setr_epi32(0x02, 0x08, 0x20, 0x80);
+		for (uint32_t y = 0; y < 4; ++ y)
+		{
+			__m128i const index = _mm_and_si128(_mm_set1_epi32(static_cast<int>(BC1RowBits(bc1, y))), index_mask);
+			__m128i row = _mm_and_si128(_mm_cmpeq_epi32(index, _mm_setzero_si128()), clr0);
+			row = _mm_or_si128(row, _mm_and_si128(_mm_cmpeq_epi32(index, index1), clr1));
+			row = _mm_or_si128(row, _mm_and_si128(_mm_cmpeq_epi32(index, index2), clr2));
+			row = _mm_or_si128(row, _mm_and_si128(_mm_cmpeq_epi32(index, index_mask), clr3));
+			rows[y] = row;
+		}
+	}
+
+	// 8 3-bit indices from 24 bits, one per 16-bit lane. Every lane gets a 16-bit window of the bits that contains its
+	// index, the multiply moves the index to the top 3 bits of the lane.
+	__m128i BC4IndicesSSE2(uint32_t bits)
+	{
+		short const lo = static_cast<short>(bits & 0xFFFF);
+		short const hi = static_cast<short>((bits >> 8) & 0xFFFF);
+		__m128i const windows = _mm_setr_epi16(lo, lo, lo, lo, lo, hi, hi, hi);
+		__m128i const shifts = _mm_setr_epi16(1 << 13, 1 << 10, 1 << 7, 1 << 4, 1 << 1, 1 << 6, 1 << 3, 1 << 0);
+		return _mm_srli_epi16(_mm_mullo_epi16(windows, shifts), 13);
+	}
+
+	// Decodes a BC4 block to 16 bytes, in row major
+	__m128i DecodeBC4SSE2(BC4Block const & bc4)
+	{
+		std::array<uint8_t, 8> alpha;
+		BC4Palette(alpha, bc4);
+
+		uint32_t const bits_lo = (bc4.bitmap[2] << 16) | (bc4.bitmap[1] << 8) | (bc4.bitmap[0] << 0);
+		uint32_t const bits_hi = (bc4.bitmap[5] << 16) | (bc4.bitmap[4] << 8) | (bc4.bitmap[3] << 0);
+		__m128i const index = _mm_packus_epi16(BC4IndicesSSE2(bits_lo), BC4IndicesSSE2(bits_hi));
+
+		__m128i ret = _mm_setzero_si128();
+		for (uint32_t i = 0; i < alpha.size(); ++ i)
+		{
+			__m128i const mask = _mm_cmpeq_epi8(index, _mm_set1_epi8(static_cast<char>(i)));
+			ret = _mm_or_si128(ret, _mm_and_si128(mask, _mm_set1_epi8(static_cast<char>(alpha[i]))));
+		}
+		return ret;
+	}
+
+	// Moves 16 alpha bytes into the alpha channel of 4 rows of ARGB8
+	void MergeAlphaSSE2(__m128i rows[4], __m128i alpha)
+	{
+		__m128i const zero = _mm_setzero_si128();
+		__m128i const rgb_mask = _mm_set1_epi32(0x00FFFFFF);
+		__m128i const alpha_lo = _mm_unpacklo_epi8(zero, alpha);
+		__m128i const alpha_hi = _mm_unpackhi_epi8(zero, alpha);
+		rows[0] = _mm_or_si128(_mm_and_si128(rows[0], rgb_mask), _mm_unpacklo_epi16(zero, alpha_lo));
+		rows[1] = _mm_or_si128(_mm_and_si128(rows[1], rgb_mask), _mm_unpackhi_epi16(zero, alpha_lo));
+		rows[2] = _mm_or_si128(_mm_and_si128(rows[2], rgb_mask), _mm_unpacklo_epi16(zero, alpha_hi));
+		rows[3] = _mm_or_si128(_mm_and_si128(rows[3], rgb_mask), _mm_unpackhi_epi16(zero, alpha_hi));
+	}
+
+	// Expands the 4-bit alpha of a BC2 row to the alpha channel of 4 pixels. The nibble of pixel i is moved to the top of
+	// the high 16-bit half of lane i.
+	__m128i BC2RowAlphaSSE2(uint16_t bits)
+	{
+		__m128i const windows = _mm_set1_epi32(static_cast<int>(static_cast<uint32_t>(bits) << 16));
+		__m128i const masks = _mm_setr_epi32(0x000F0000, 0x00F00000, 0x0F000000, static_cast<int>(0xF0000000U));
+		__m128i const shifts = _mm_setr_epi16(0, 1 << 12, 0, 1 << 8, 0, 1 << 4, 0, 1 << 0);
+		return _mm_mullo_epi16(_mm_and_si128(windows, masks), shifts);
+	}
+
+	void StoreRowsSSE2(uint8_t* output, uint32_t out_row_pitch, __m128i const rows[4])
+	{
+		for (uint32_t y = 0; y < 4; ++ y)
+		{
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(output + y * out_row_pitch), rows[y]);
+		}
+	}
+#elif defined(KLAYGE_NEON_SUPPORT)
+	// The 4 colors of a BC1 block, one per 32-bit lane. x / 3 is computed as x * 0x5556 >> 16, which is exact for x <= 765.
+	uint32x4_t BC1PaletteNEON(BC1Block const & bc1)
+	{
+		uint16x4_t const c0 = vget_low_u16(vmovl_u8(vcreate_u8(RGB565ToARGB8(bc1.clr_0))));
+		uint16x4_t const c1 = vget_low_u16(vmovl_u8(vcreate_u8(RGB565ToARGB8(bc1.clr_1))));
+		uint16x4_t c2;
+		uint16x4_t c3;
+		if (bc1.clr_0 > bc1.clr_1)
+		{
+			uint16x4_t const one_third = vdup_n_u16(0x5556);
+			c2 = vshrn_n_u32(vmull_u16(vadd_u16(vadd_u16(c0, c0), c1), one_third), 16);
+			c3 = vshrn_n_u32(vmull_u16(vadd_u16(vadd_u16(c1, c1), c0), one_third), 16);
+		}
+		else
+		{
+			c2 = vshr_n_u16(vadd_u16(c0, c1), 1);
+			c3 = vdup_n_u16(0);
+		}
+		return vreinterpretq_u32_u8(vcombine_u8(vmovn_u16(vcombine_u16(c0, c1)), vmovn_u16(vcombine_u16(c2, c3))));
+	}
+
+	// Decodes the colors of a BC1 block to 4 rows of ARGB8. Each index is compared against all 4 values, and the matching
+	// palette entry is kept with a mask.
+	void DecodeBC1ColorsNEON(uint32x4_t rows[4], BC1Block const & bc1)
+	{
+		static uint32_t const INDEX_MASK[] = { 0x03, 0x0C, 0x30, 0xC0 };
+		static uint32_t const INDEX1[] = { 0x01, 0x04, 0x10, 0x40 };
+		static uint32_t const INDEX2[] = { 0x02, 0x08, 0x20, 0x80 };
+
+		uint32x4_t const palette = BC1PaletteNEON(bc1);
+		uint32x4_t const clr0 = vdupq_n_u32(vgetq_lane_u32(palette, 0));
+		uint32x4_t const clr1 = vdupq_n_u32(vgetq_lane_u32(palette, 1));
+		uint32x4_t const clr2 = vdupq_n_u32(vgetq_lane_u32(palette, 2));
+		uint32x4_t const clr3 = vdupq_n_u32(vgetq_lane_u32(palette, 3));
+
+		uint32x4_t const index_mask = vld1q_u32(INDEX_MASK);
+		uint32x4_t const index1 = vld1q_u32(INDEX1);
+		uint32x4_t const index2 = vld1q_u32(INDEX2);
+		for (uint32_t y = 0; y < 4; ++ y)
+		{
+			uint32x4_t const index = vandq_u32(vdupq_n_u32(BC1RowBits(bc1, y)), index_mask);
+			uint32x4_t row = vandq_u32(vceqq_u32(index, vdupq_n_u32(0)), clr0);
+			row = vorrq_u32(row, vandq_u32(vceqq_u32(index, index1), clr1));
+			row = vorrq_u32(row, vandq_u32(vceqq_u32(index, index2), clr2));
+			row = vorrq_u32(row, vandq_u32(vceqq_u32(index, index_mask), clr3));
+			rows[y] = row;
+		}
+	}
+
+	// 8 3-bit indices from 24 bits, one per 16-bit lane. Every lane gets a 16-bit window of the bits that contains its
+	// index, and shifts it down with a per-lane shift.
+	uint16x8_t BC4IndicesNEON(uint32_t bits)
+	{
+		static int16_t const SHIFTS[] = { 0, -3, -6, -9, -12, -7, -10, -13 };
+
+		uint16_t const lo = static_cast<uint16_t>(bits & 0xFFFF);
+		uint16_t const hi = static_cast<uint16_t>((bits >> 8) & 0xFFFF);
+		uint16_t const windows[] = { lo, lo, lo, lo, lo, hi, hi, hi };
+		return vandq_u16(vshlq_u16(vld1q_u16(windows), vld1q_s16(SHIFTS)), vdupq_n_u16(7));
+	}
+
+	// Decodes a BC4 block to 16 bytes, in row major
+	uint8x16_t DecodeBC4NEON(BC4Block const & bc4)
+	{
+		std::array<uint8_t, 8> alpha;
+		BC4Palette(alpha, bc4);
+
+		uint32_t const bits_lo = (bc4.bitmap[2] << 16) | (bc4.bitmap[1] << 8) | (bc4.bitmap[0] << 0);
+		uint32_t const bits_hi = (bc4.bitmap[5] << 16) | (bc4.bitmap[4] << 8) | (bc4.bitmap[3] << 0);
+		uint8x16_t const index = vcombine_u8(vmovn_u16(BC4IndicesNEON(bits_lo)), vmovn_u16(BC4IndicesNEON(bits_hi)));
+
+		uint8x16_t ret = vdupq_n_u8(0);
+		for (uint32_t i = 0; i < alpha.size(); ++ i)
+		{
+			uint8x16_t const mask = vceqq_u8(index, vdupq_n_u8(static_cast<uint8_t>(i)));
+			ret = vorrq_u8(ret, vandq_u8(mask, vdupq_n_u8(alpha[i])));
+		}
+		return ret;
+	}
+
+	// Moves 16 alpha bytes into the alpha channel of 4 rows of ARGB8
+	void MergeAlphaNEON(uint32x4_t rows[4], uint8x16_t alpha)
+	{
+		uint32x4_t const rgb_mask = vdupq_n_u32(0x00FFFFFF);
+		uint16x8_t const alpha_lo = vmovl_u8(vget_low_u8(alpha));
+		uint16x8_t const alpha_hi = vmovl_u8(vget_high_u8(alpha));
+		rows[0] = vorrq_u32(vandq_u32(rows[0], rgb_mask), vshlq_n_u32(vmovl_u16(vget_low_u16(alpha_lo)), 24));
+		rows[1] = vorrq_u32(vandq_u32(rows[1], rgb_mask), vshlq_n_u32(vmovl_u16(vget_high_u16(alpha_lo)), 24));
+		rows[2] = vorrq_u32(vandq_u32(rows[2], rgb_mask), vshlq_n_u32(vmovl_u16(vget_low_u16(alpha_hi)), 24));
+		rows[3] = vorrq_u32(vandq_u32(rows[3], rgb_mask), vshlq_n_u32(vmovl_u16(vget_high_u16(alpha_hi)), 24));
+	}
+
+	// Expands the 4-bit alpha of a BC2 row to the alpha channel of 4 pixels. The nibble of pixel i is shifted to the top
+	// of lane i, and the rest is masked out.
+	uint32x4_t BC2RowAlphaNEON(uint16_t bits)
+	{
+		static int32_t const SHIFTS[] = { 28, 24, 20, 16 };
+
+		return vandq_u32(vshlq_u32(vdupq_n_u32(bits), vld1q_s32(SHIFTS)), vdupq_n_u32(0xF0000000U));
+	}
+
+	void StoreRowsNEON(uint8_t* output, uint32_t out_row_pitch, uint32x4_t const rows[4])
+	{
+		for (uint32_t y = 0; y < 4; ++ y)
+		{
+			vst1q_u8(output + y * out_row_pitch, vreinterpretq_u8_u32(rows[y]));
+		}
+	}
+#endif
 }
 
 namespace KlayGE
@@ -897,6 +1161,11 @@ namespace KlayGE
 		compression_format_ = EF_BC1;
 	}
 
+	TexCompressionPtr TexCompressionBC1::Clone() const
+	{
+		return MakeSharedPtr<TexCompressionBC1>();
+	}
+
 	void TexCompressionBC1::EncodeBlock(void* output, void const * input, TexCompressionMethod method)
 	{
 		BOOST_ASSERT(output);
@@ -966,6 +1235,29 @@ namespace KlayGE
 		}
 	}
 
+	void TexCompressionBC1::DecodeBlocks(void* output, uint32_t out_row_pitch, void const * input, uint32_t num_blocks)
+	{
+#if defined(KLAYGE_SSE2_SUPPORT) || defined(KLAYGE_NEON_SUPPORT)
+		uint8_t* dst = static_cast<uint8_t*>(output);
+		BC1Block const * bc1 = static_cast<BC1Block const *>(input);
+		for (uint32_t i = 0; i < num_blocks; ++ i)
+		{
+#if defined(KLAYGE_SSE2_SUPPORT)
+			__m128i rows[4];
+			DecodeBC1ColorsSSE2(rows, bc1[i]);
+			StoreRowsSSE2(dst, out_row_pitch, rows);
+#else
+			uint32x4_t rows[4];
+			DecodeBC1ColorsNEON(rows, bc1[i]);
+			StoreRowsNEON(dst, out_row_pitch, rows);
+#endif
+			dst += 4 * sizeof(ARGBColor32);
+		}
+#else
+		TexCompression::DecodeBlocks(output, out_row_pitch, input, num_blocks);
+#endif
+	}
+
 	ARGBColor32 TexCompressionBC1::RGB565To888(uint16_t rgb) const
 	{
 		return ARGBColor32(255, EXPAND5[(rgb >> 11) & 0x1F], EXPAND6[(rgb >> 5) & 0x3F],
@@ -1384,6 +1676,11 @@ namespace KlayGE
 		compression_format_ = EF_BC2;
 	}
 
+	TexCompressionPtr TexCompressionBC2::Clone() const
+	{
+		return MakeSharedPtr<TexCompressionBC2>();
+	}
+
 	void TexCompressionBC2::EncodeBlock(void* output, void const * input, TexCompressionMethod method)
 	{
 		BOOST_ASSERT(output);
@@ -1429,12 +1726,50 @@ namespace KlayGE
 		}
 	}
 
+	void TexCompressionBC2::DecodeBlocks(void* output, uint32_t out_row_pitch, void const * input, uint32_t num_blocks)
+	{
+#if defined(KLAYGE_SSE2_SUPPORT) || defined(KLAYGE_NEON_SUPPORT)
+		uint8_t* dst = static_cast<uint8_t*>(output);
+		BC2Block const * bc2 = static_cast<BC2Block const *>(input);
+		for (uint32_t i = 0; i < num_blocks; ++ i)
+		{
+#if defined(KLAYGE_SSE2_SUPPORT)
+			__m128i const rgb_mask = _mm_set1_epi32(0x00FFFFFF);
+			__m128i rows[4];
+			DecodeBC1ColorsSSE2(rows, bc2[i].bc1);
+			for (uint32_t y = 0; y < 4; ++ y)
+			{
+				rows[y] = _mm_or_si128(_mm_and_si128(rows[y], rgb_mask), BC2RowAlphaSSE2(bc2[i].alpha[y]));
+			}
+			StoreRowsSSE2(dst, out_row_pitch, rows);
+#else
+			uint32x4_t const rgb_mask = vdupq_n_u32(0x00FFFFFF);
+			uint32x4_t rows[4];
+			DecodeBC1ColorsNEON(rows, bc2[i].bc1);
+			for (uint32_t y = 0; y < 4; ++ y)
+			{
+				rows[y] = vorrq_u32(vandq_u32(rows[y], rgb_mask), BC2RowAlphaNEON(bc2[i].alpha[y]));
+			}
+			StoreRowsNEON(dst, out_row_pitch, rows);
+#endif
+			dst += 4 * sizeof(ARGBColor32);
+		}
+#else
+		TexCompression::DecodeBlocks(output, out_row_pitch, input, num_blocks);
+#endif
+	}
+
 
 	TexCompressionBC3::TexCompressionBC3()
 	{
 		compression_format_ = EF_BC3;
 	}
 
+	TexCompressionPtr TexCompressionBC3::Clone() const
+	{
+		return MakeSharedPtr<TexCompressionBC3>();
+	}
+
 	void TexCompressionBC3::EncodeBlock(void* output, void const * input, TexCompressionMethod method)
 	{
 		BOOST_ASSERT(output);
@@ -1475,12 +1810,42 @@ namespace KlayGE
 		}
 	}
 
+	void TexCompressionBC3::DecodeBlocks(void* output, uint32_t out_row_pitch, void const * input, uint32_t num_blocks)
+	{
+#if defined(KLAYGE_SSE2_SUPPORT) || defined(KLAYGE_NEON_SUPPORT)
+		uint8_t* dst = static_cast<uint8_t*>(output);
+		BC3Block const * bc3 = static_cast<BC3Block const *>(input);
+		for (uint32_t i = 0; i < num_blocks; ++ i)
+		{
+#if defined(KLAYGE_SSE2_SUPPORT)
+			__m128i rows[4];
+			DecodeBC1ColorsSSE2(rows, bc3[i].bc1);
+			MergeAlphaSSE2(rows, DecodeBC4SSE2(bc3[i].alpha));
+			StoreRowsSSE2(dst, out_row_pitch, rows);
+#else
+			uint32x4_t rows[4];
+			DecodeBC1ColorsNEON(rows, bc3[i].bc1);
+			MergeAlphaNEON(rows, DecodeBC4NEON(bc3[i].alpha));
+			StoreRowsNEON(dst, out_row_pitch, rows);
+#endif
+			dst += 4 * sizeof(ARGBColor32);
+		}
+#else
+		TexCompression::DecodeBlocks(output, out_row_pitch, input, num_blocks);
+#endif
+	}
+
 
 	TexCompressionBC4::TexCompressionBC4()
 	{
 		compression_format_ = EF_BC4;
 	}
 
+	TexCompressionPtr TexCompressionBC4::Clone() const
+	{
+		return MakeSharedPtr<TexCompressionBC4>();
+	}
+
 	// Alpha block compression (this is easy for a change)
 	void TexCompressionBC4::EncodeBlock(void* output, void const * input, TexCompressionMethod method)
 	{
@@ -1548,28 +1913,7 @@ namespace KlayGE
 		BC4Block const & bc4 = *static_cast<BC4Block const *>(input);
 
 		std::array<uint8_t, 8> alpha;
-		float falpha0 = bc4.alpha_0 / 255.0f;
-		float falpha1 = bc4.alpha_1 / 255.0f;
-		alpha[0] = bc4.alpha_0;
-		alpha[1] = bc4.alpha_1;
-		if (alpha[0] > alpha[1])
-		{
-			alpha[2] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::lerp(falpha0, falpha1, 1 / 7.0f) * 255 + 0.5f), 0, 255));
-			alpha[3] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::lerp(falpha0, falpha1, 2 / 7.0f) * 255 + 0.5f), 0, 255));
-			alpha[4] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::lerp(falpha0, falpha1, 3 / 7.0f) * 255 + 0.5f), 0, 255));
-			alpha[5] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::lerp(falpha0, falpha1, 4 / 7.0f) * 255 + 0.5f), 0, 255));
-			alpha[6] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::lerp(falpha0, falpha1, 5 / 7.0f) * 255 + 0.5f), 0, 255));
-			alpha[7] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::lerp(falpha0, falpha1, 6 / 7.0f) * 255 + 0.5f), 0, 255));
-		}
-		else
-		{
-			alpha[2] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::lerp(falpha0, falpha1, 1 / 5.0f) * 255 + 0.5f), 0, 255));
-			alpha[3] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::lerp(falpha0, falpha1, 2 / 5.0f) * 255 + 0.5f), 0, 255));
-			alpha[4] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::lerp(falpha0, falpha1, 3 / 5.0f) * 255 + 0.5f), 0, 255));
-			alpha[5] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::lerp(falpha0, falpha1, 4 / 5.0f) * 255 + 0.5f), 0, 255));
-			alpha[6] = 0;
-			alpha[7] = 255;
-		}
+		BC4Palette(alpha, bc4);
 
 		for (int i = 0; i < 2; ++ i)
 		{
@@ -1581,12 +1925,41 @@ namespace KlayGE
 		}
 	}
 
+	void TexCompressionBC4::DecodeBlocks(void* output, uint32_t out_row_pitch, void const * input, uint32_t num_blocks)
+	{
+#if defined(KLAYGE_SSE2_SUPPORT) || defined(KLAYGE_NEON_SUPPORT)
+		uint8_t* dst = static_cast<uint8_t*>(output);
+		BC4Block const * bc4 = static_cast<BC4Block const *>(input);
+		for (uint32_t i = 0; i < num_blocks; ++ i)
+		{
+			std::array<uint8_t, 16> alpha;
+#if defined(KLAYGE_SSE2_SUPPORT)
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(alpha.data()), DecodeBC4SSE2(bc4[i]));
+#else
+			vst1q_u8(alpha.data(), DecodeBC4NEON(bc4[i]));
+#endif
+			for (uint32_t y = 0; y < 4; ++ y)
+			{
+				memcpy(dst + y * out_row_pitch, &alpha[y * 4], 4);
+			}
+			dst += 4;
+		}
+#else
+		TexCompression::DecodeBlocks(output, out_row_pitch, input, num_blocks);
+#endif
+	}
+
 
 	TexCompressionBC5::TexCompressionBC5()
 	{
 		compression_format_ = EF_BC5;
 	}
 
+	TexCompressionPtr TexCompressionBC5::Clone() const
+	{
+		return MakeSharedPtr<TexCompressionBC5>();
+	}
+
 	void TexCompressionBC5::EncodeBlock(void* output, void const * input, TexCompressionMethod method)
 	{
 		BOOST_ASSERT(output);
@@ -1626,6 +1999,35 @@ namespace KlayGE
 		}
 	}
 
+	void TexCompressionBC5::DecodeBlocks(void* output, uint32_t out_row_pitch, void const * input, uint32_t num_blocks)
+	{
+#if defined(KLAYGE_SSE2_SUPPORT) || defined(KLAYGE_NEON_SUPPORT)
+		uint8_t* dst = static_cast<uint8_t*>(output);
+		BC5Block const * bc5 = static_cast<BC5Block const *>(input);
+		for (uint32_t i = 0; i < num_blocks; ++ i)
+		{
+			std::array<uint16_t, 16> gr;
+#if defined(KLAYGE_SSE2_SUPPORT)
+			__m128i const r = DecodeBC4SSE2(bc5[i].red);
+			__m128i const g = DecodeBC4SSE2(bc5[i].green);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&gr[0]), _mm_unpacklo_epi8(r, g));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&gr[8]), _mm_unpackhi_epi8(r, g));
+#else
+			uint8x16x2_t const rg = vzipq_u8(DecodeBC4NEON(bc5[i].red), DecodeBC4NEON(bc5[i].green));
+			vst1q_u8(reinterpret_cast<uint8_t*>(&gr[0]), rg.val[0]);
+			vst1q_u8(reinterpret_cast<uint8_t*>(&gr[8]), rg.val[1]);
+#endif
+			for (uint32_t y = 0; y < 4; ++ y)
+			{
+				memcpy(dst + y * out_row_pitch, &gr[y * 4], 4 * sizeof(uint16_t));
+			}
+			dst += 4 * sizeof(uint16_t);
+		}
+#else
+		TexCompression::DecodeBlocks(output, out_row_pitch, input, num_blocks);
+#endif
+	}
+
 
 	// BC6H Compression
 	TexCompressionBC6U::ModeDescriptor const TexCompressionBC6U::mode_desc_[14][82] =
@@ -1887,6 +2289,11 @@ namespace KlayGE
 		compression_format_ = EF_BC6;
 	}
 
+	TexCompressionPtr TexCompressionBC6U::Clone() const
+	{
+		return MakeSharedPtr<TexCompressionBC6U>();
+	}
+
 	void TexCompressionBC6U::EncodeBlock(void* output, void const * input, TexCompressionMethod method)
 	{
 		KFL_UNUSED(output);
@@ -2138,6 +2545,11 @@ namespace KlayGE
 		compression_format_ = EF_SIGNED_BC6;
 	}
 
+	TexCompressionPtr TexCompressionBC6S::Clone() const
+	{
+		return MakeSharedPtr<TexCompressionBC6S>();
+	}
+
 	void TexCompressionBC6S::EncodeBlock(void* output, void const * input, TexCompressionMethod method)
 	{
 		KFL_UNUSED(output);
@@ -2180,6 +2592,11 @@ namespace KlayGE
 		compression_format_ = EF_BC7;
 	}
 
+	TexCompressionPtr TexCompressionBC7::Clone() const
+	{
+		return MakeSharedPtr<TexCompressionBC7>();
+	}
+
 	void TexCompressionBC7::EncodeBlock(void* output, void const * input, TexCompressionMethod method)
 	{
 		BOOST_ASSERT(output);
@@ -650,6 +650,11 @@ namespace KlayGE
 		sorted_luma_indices_ = nullptr;
 	}
 
+	TexCompressionPtr TexCompressionETC1::Clone() const
+	{
+		return MakeSharedPtr<TexCompressionETC1>();
+	}
+
 	void TexCompressionETC1::EncodeBlock(void* output, void const * input, TexCompressionMethod method)
 	{
 		BOOST_ASSERT(output);
@@ -1822,6 +1827,11 @@ namespace KlayGE
 		etc1_codec_ = MakeSharedPtr<TexCompressionETC1>();
 	}
 
+	TexCompressionPtr TexCompressionETC2RGB8::Clone() const
+	{
+		return MakeSharedPtr<TexCompressionETC2RGB8>();
+	}
+
 	void TexCompressionETC2RGB8::EncodeBlock(void* output, void const * input, TexCompressionMethod method)
 	{
 		KFL_UNUSED(output);
@@ -2043,6 +2053,11 @@ namespace KlayGE
 		etc2_rgb8_codec_ = MakeSharedPtr<TexCompressionETC2RGB8>();
 	}
 
+	TexCompressionPtr TexCompressionETC2RGB8A1::Clone() const
+	{
+		return MakeSharedPtr<TexCompressionETC2RGB8A1>();
+	}
+
 	void TexCompressionETC2RGB8A1::EncodeBlock(void* output, void const * input, TexCompressionMethod method)
 	{
 		KFL_UNUSED(output);
@@ -43,9 +43,21 @@
 #include <KFL/Half.hpp>
 #include <KFL/Hash.hpp>
 
+#include <atomic>
 #include <cstring>
 #include <fstream>
 #include <system_error>
+#include <thread>
+
+#if defined(KLAYGE_SSE_SUPPORT)
+	#include <xmmintrin.h>
+#endif
+#if defined(KLAYGE_AVX_SUPPORT)
+	#include <immintrin.h>
+#endif
+#if defined(KLAYGE_NEON_SUPPORT)
+	#include <arm_neon.h>
+#endif
 
 #include <KlayGE/Texture.hpp>
 
@@ -914,12 +926,11 @@ namespace
 		}
 	}
 	
-	void DecodeTexture(std::vector<uint8_t>& dst_data_block, uint32_t& dst_row_pitch, uint32_t& dst_slice_pitch, ElementFormat& dst_format,
-		void const * src_data, uint32_t src_row_pitch, uint32_t src_slice_pitch, ElementFormat src_format,
-		uint32_t src_width, uint32_t src_height, uint32_t src_depth)
+	ElementFormat DecodedTexFormat(ElementFormat src_format)
 	{
 		BOOST_ASSERT(IsCompressedFormat(src_format));
 
+		ElementFormat dst_format;
 		switch (src_format)
 		{				
 		case EF_BC1:
@@ -979,6 +990,15 @@ namespace
 			KFL_UNREACHABLE("Invalid destination format");
 		}
 
+		return dst_format;
+	}
+
+	void DecodeTexture(void* dst_data, uint32_t dst_row_pitch, uint32_t dst_slice_pitch,
+		void const * src_data, uint32_t src_row_pitch, uint32_t src_slice_pitch, ElementFormat src_format,
+		uint32_t src_width, uint32_t src_height, uint32_t src_depth)
+	{
+		BOOST_ASSERT(IsCompressedFormat(src_format));
+
 		std::unique_ptr<TexCompression> codec;
 		switch (src_format)
 		{
@@ -1061,12 +1081,8 @@ namespace
 			KFL_UNREACHABLE("Invalid source format");
 		}
 
-		dst_row_pitch = src_width * NumFormatBytes(dst_format);
-		dst_slice_pitch = dst_row_pitch * src_height;
-		dst_data_block.resize(src_depth * dst_slice_pitch);
-
 		uint8_t const * src = static_cast<uint8_t const *>(src_data);
-		uint8_t* dst = static_cast<uint8_t*>(&dst_data_block[0]);
+		uint8_t* dst = static_cast<uint8_t*>(dst_data);
 		for (uint32_t z = 0; z < src_depth; ++ z)
 		{
 			codec->DecodeMem(src_width, src_height, dst, dst_row_pitch, dst_slice_pitch,
@@ -1077,6 +1093,20 @@ namespace
 		}
 	}
 
+	void DecodeTexture(std::vector<uint8_t>& dst_data_block, uint32_t& dst_row_pitch, uint32_t& dst_slice_pitch, ElementFormat& dst_format,
+		void const * src_data, uint32_t src_row_pitch, uint32_t src_slice_pitch, ElementFormat src_format,
+		uint32_t src_width, uint32_t src_height, uint32_t src_depth)
+	{
+		dst_format = DecodedTexFormat(src_format);
+
+		dst_row_pitch = src_width * NumFormatBytes(dst_format);
+		dst_slice_pitch = dst_row_pitch * src_height;
+		dst_data_block.resize(src_depth * dst_slice_pitch);
+
+		DecodeTexture(&dst_data_block[0], dst_row_pitch, dst_slice_pitch,
+			src_data, src_row_pitch, src_slice_pitch, src_format, src_width, src_height, src_depth);
+	}
+
 
 	class TextureLoadingDesc : public ResLoadingDesc
 	{
@@ -1308,6 +1338,15 @@ namespace
 			return true;
 		}
 
+		uint64_t Hash() const override
+		{
+			size_t seed = 0;
+			HashCombine(seed, this->Type());
+			HashRange(seed, tex_desc_.res_name.begin(), tex_desc_.res_name.end());
+			HashCombine(seed, tex_desc_.access_hint);
+			return seed;
+		}
+
 		bool Match(ResLoadingDesc const & rhs) const override
 		{
 			if (this->Type() == rhs.Type())
@@ -1347,6 +1386,12 @@ namespace
 
 			{
 				TexturePtr tex = LoadSoftwareTexture(tex_desc_.runtime_name);
+				if (!tex)
+				{
+					// Missing or truncated. Loads as a 1x1 black texture, so whatever binds it still has something to sample.
+					tex = MakeSharedPtr<SoftwareTexture>(Texture::TT_2D, 1, 1, 1, 1, 1, EF_ABGR8, false);
+					tex->CreateHWResource({}, nullptr);
+				}
 				tex_data.type = tex->Type();
 				tex_data.width = tex->Width(0);
 				tex_data.height = tex->Height(0);
@@ -1544,12 +1589,24 @@ namespace
 									sub_data_block = static_cast<uint8_t*>(
 										const_cast<void*>(tex_data.init_data[sub_res].data));
 								}
-								ResizeTexture(sub_data_block, row_pitch, slice_pitch,
-									convert_fmts[i][1], width, height, depth,
-									tex_data.init_data[sub_res].data,
-									tex_data.init_data[sub_res].row_pitch,
-									tex_data.init_data[sub_res].slice_pitch,
-									convert_fmts[i][0], width, height, depth, false);
+								if (IsCompressedFormat(convert_fmts[i][0]) && (DecodedTexFormat(convert_fmts[i][0]) == convert_fmts[i][1]))
+								{
+									// Decodes straight into the new data block, no need for an extra copy in ResizeTexture
+									DecodeTexture(sub_data_block, row_pitch, slice_pitch,
+										tex_data.init_data[sub_res].data,
+										tex_data.init_data[sub_res].row_pitch,
+										tex_data.init_data[sub_res].slice_pitch,
+										convert_fmts[i][0], width, height, depth);
+								}
+								else
+								{
+									ResizeTexture(sub_data_block, row_pitch, slice_pitch,
+										convert_fmts[i][1], width, height, depth,
+										tex_data.init_data[sub_res].data,
+										tex_data.init_data[sub_res].row_pitch,
+										tex_data.init_data[sub_res].slice_pitch,
+										convert_fmts[i][0], width, height, depth, false);
+								}
 
 								width = std::max<uint32_t>(1U, width / 2);
 								height = std::max<uint32_t>(1U, height / 2);
@@ -1633,6 +1690,386 @@ namespace
 		TexDesc tex_desc_;
 		std::mutex main_thread_stage_mutex_;
 	};
+
+	// Separable resampling used by ResizeTexture
+
+	// Weights of the source pixels contributing to every destination pixel along one axis
+	struct ResampleAxis
+	{
+		std::vector<uint32_t> first;
+		std::vector<uint32_t> count;
+		std::vector<uint32_t> weight_offset;
+		std::vector<float> weights;
+		bool identity;
+	};
+
+	float BesselI0(float x)
+	{
+		float const quarter_x_sq = x * x / 4;
+		float sum = 1;
+		float term = 1;
+		for (int k = 1; k < 32; ++ k)
+		{
+			term *= quarter_x_sq / (k * k);
+			sum += term;
+			if (term < sum * 1e-8f)
+			{
+				break;
+			}
+		}
+		return sum;
+	}
+
+	float Sinc(float x)
+	{
+		if (std::abs(x) < 1e-6f)
+		{
+			return 1;
+		}
+		else
+		{
+			x *= PI;
+			return std::sin(x) / x;
+		}
+	}
+
+	float ResampleFilterRadius(TextureResizeFilter filter)
+	{
+		switch (filter)
+		{
+		case TRF_Box:
+			return 0.5f;
+
+		case TRF_Kaiser:
+		case TRF_Lanczos:
+			return 3;
+
+		default:
+			KFL_UNREACHABLE("Invalid resize filter");
+		}
+	}
+
+	float ResampleFilterWeight(TextureResizeFilter filter, float x)
+	{
+		float const radius = ResampleFilterRadius(filter);
+		switch (filter)
+		{
+		case TRF_Box:
+			return ((x >= -radius) && (x < radius)) ? 1.0f : 0.0f;
+
+		case TRF_Kaiser:
+			if (std::abs(x) < radius)
+			{
+				float const KAISER_ALPHA = 4;
+				float const t = x / radius;
+				return Sinc(x) * BesselI0(KAISER_ALPHA * std::sqrt(1 - t * t)) / BesselI0(KAISER_ALPHA);
+			}
+			else
+			{
+				return 0;
+			}
+
+		case TRF_Lanczos:
+			return (std::abs(x) < radius) ? Sinc(x) * Sinc(x / radius) : 0;
+
+		default:
+			KFL_UNREACHABLE("Invalid resize filter");
+		}
+	}
+
+	ResampleAxis BuildResampleAxis(uint32_t dst_size, uint32_t src_size, TextureResizeFilter filter)
+	{
+		ResampleAxis axis;
+		axis.first.resize(dst_size);
+		axis.count.resize(dst_size);
+		axis.weight_offset.resize(dst_size);
+
+		std::vector<float> taps;
+		for (uint32_t i = 0; i < dst_size; ++ i)
+		{
+			float const center = (i + 0.5f) * src_size / dst_size;
+
+			int32_t lo;
+			taps.clear();
+			if (dst_size == src_size)
+			{
+				// Every filter samples exactly at the source pixel centers
+				lo = i;
+				taps.push_back(1);
+			}
+			else if (TRF_Point == filter)
+			{
+				lo = std::min(static_cast<int32_t>(center), static_cast<int32_t>(src_size - 1));
+				taps.push_back(1);
+			}
+			else if (TRF_Linear == filter)
+			{
+				// Same as the 2 tap bilinear ResizeTexture always had, regardless of the scale
+				lo = static_cast<int32_t>(static_cast<uint32_t>(center - 0.5f));
+				float const weight = center - lo - 0.5f;
+				taps.push_back(1 - weight);
+				if (static_cast<uint32_t>(lo + 1) >= src_size)
+				{
+					taps[0] += weight;
+				}
+				else if (weight != 0)
+				{
+					taps.push_back(weight);
+				}
+			}
+			else
+			{
+				// Stretches the kernel when minifying, so every source pixel contributes
+				float const filter_scale = std::max(static_cast<float>(src_size) / dst_size, 1.0f);
+				float const support = ResampleFilterRadius(filter) * filter_scale;
+				int32_t const left = static_cast<int32_t>(std::floor(center - support));
+				int32_t const right = static_cast<int32_t>(std::ceil(center + support));
+				lo = MathLib::clamp<int32_t>(left, 0, src_size - 1);
+				int32_t const hi = MathLib::clamp<int32_t>(right - 1, 0, src_size - 1);
+				taps.assign(hi - lo + 1, 0.0f);
+
+				float total = 0;
+				for (int32_t s = left; s < right; ++ s)
+				{
+					float const weight = ResampleFilterWeight(filter, (s + 0.5f - center) / filter_scale);
+					taps[MathLib::clamp<int32_t>(s, 0, src_size - 1) - lo] += weight;
+					total += weight;
+				}
+
+				// Trim the zero weights at both ends, sinc based kernels have them at integer offsets.
+				// The rest are normalized, so a 1:1 axis ends up as an exact copy.
+				size_t begin = 0;
+				size_t end = taps.size();
+				while ((end - begin > 1) && (std::abs(taps[begin]) < 1e-6f * std::abs(total)))
+				{
+					++ begin;
+				}
+				while ((end - begin > 1) && (std::abs(taps[end - 1]) < 1e-6f * std::abs(total)))
+				{
+					-- end;
+				}
+				taps.erase(taps.begin() + end, taps.end());
+				taps.erase(taps.begin(), taps.begin() + begin);
+				lo += static_cast<int32_t>(begin);
+
+				total = 0;
+				for (auto tap : taps)
+				{
+					total += tap;
+				}
+				float const inv_total = 1 / total;
+				for (auto& tap : taps)
+				{
+					tap *= inv_total;
+				}
+			}
+
+			axis.first[i] = lo;
+			axis.count[i] = static_cast<uint32_t>(taps.size());
+			axis.weight_offset[i] = static_cast<uint32_t>(axis.weights.size());
+			axis.weights.insert(axis.weights.end(), taps.begin(), taps.end());
+		}
+
+		axis.identity = (dst_size == src_size);
+		for (uint32_t i = 0; (i < dst_size) && axis.identity; ++ i)
+		{
+			axis.identity = (axis.first[i] == i) && (axis.count[i] == 1) && (axis.weights[axis.weight_offset[i]] == 1);
+		}
+
+		return axis;
+	}
+
+	void ResampleRow(Color const * src, ResampleAxis const & axis, Color* dst)
+	{
+		for (size_t x = 0; x < axis.first.size(); ++ x)
+		{
+			float const * weights = &axis.weights[axis.weight_offset[x]];
+			float const * src_p = &src[axis.first[x]].r();
+			uint32_t const count = axis.count[x];
+#if defined(KLAYGE_SSE_SUPPORT)
+			__m128 acc = _mm_setzero_ps();
+			for (uint32_t i = 0; i < count; ++ i, src_p += 4)
+			{
+				acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(weights[i]), _mm_loadu_ps(src_p)));
+			}
+			_mm_storeu_ps(&dst[x].r(), acc);
+#elif defined(KLAYGE_NEON_SUPPORT)
+			float32x4_t acc = vdupq_n_f32(0);
+			for (uint32_t i = 0; i < count; ++ i, src_p += 4)
+			{
+				acc = vmlaq_n_f32(acc, vld1q_f32(src_p), weights[i]);
+			}
+			vst1q_f32(&dst[x].r(), acc);
+#else
+			float acc[4] = { 0, 0, 0, 0 };
+			for (uint32_t i = 0; i < count; ++ i, src_p += 4)
+			{
+				for (int c = 0; c < 4; ++ c)
+				{
+					acc[c] += weights[i] * src_p[c];
+				}
+			}
+			dst[x] = Color(acc);
+#endif
+		}
+	}
+
+	// dst[i] += weight * src[i]
+	void AccumulateRow(float* dst, float const * src, float weight, size_t num)
+	{
+		size_t i = 0;
+#if defined(KLAYGE_AVX_SUPPORT)
+		__m256 const weight_8 = _mm256_set1_ps(weight);
+		for (; i + 8 <= num; i += 8)
+		{
+			_mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_mul_ps(weight_8, _mm256_loadu_ps(src + i))));
+		}
+#endif
+#if defined(KLAYGE_SSE_SUPPORT)
+		__m128 const weight_4 = _mm_set1_ps(weight);
+		for (; i + 4 <= num; i += 4)
+		{
+			_mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(weight_4, _mm_loadu_ps(src + i))));
+		}
+#elif defined(KLAYGE_NEON_SUPPORT)
+		for (; i + 4 <= num; i += 4)
+		{
+			vst1q_f32(dst + i, vmlaq_n_f32(vld1q_f32(dst + i), vld1q_f32(src + i), weight));
+		}
+#endif
+		for (; i < num; ++ i)
+		{
+			dst[i] += weight * src[i];
+		}
+	}
+
+	// Works on bands of destination rows. Each band only converts and horizontally filters the source rows it needs,
+	// so there is never a float copy of the whole image. Bands are spread over the thread pool.
+	void ResampleTexture(uint8_t* dst_ptr, uint32_t dst_row_pitch, uint32_t dst_slice_pitch, ElementFormat dst_format,
+		uint32_t dst_width, uint32_t dst_height, uint32_t dst_depth,
+		uint8_t const * src_ptr, uint32_t src_row_pitch, uint32_t src_slice_pitch, ElementFormat src_format,
+		uint32_t src_width, uint32_t src_height, uint32_t src_depth,
+		TextureResizeFilter filter)
+	{
+		uint32_t const BAND_ROWS = 32;
+		uint32_t const MIN_PIXELS_PER_TASK = 64 * 1024;
+
+		ResampleAxis const axis_x = BuildResampleAxis(dst_width, src_width, filter);
+		ResampleAxis const axis_y = BuildResampleAxis(dst_height, src_height, filter);
+		ResampleAxis const axis_z = BuildResampleAxis(dst_depth, src_depth, filter);
+
+		uint32_t const num_bands = (dst_height + BAND_ROWS - 1) / BAND_ROWS;
+		uint32_t const num_tiles = num_bands * dst_depth;
+
+		std::atomic<uint32_t> next_tile(0);
+		auto resample_tiles = [&]()
+		{
+			std::vector<Color> src_row(src_width);
+			std::vector<Color> h_rows;
+			std::vector<Color> dst_row(dst_width);
+
+			for (;;)
+			{
+				uint32_t const tile = next_tile.fetch_add(1);
+				if (tile >= num_tiles)
+				{
+					break;
+				}
+
+				uint32_t const z = tile / num_bands;
+				uint32_t const y_begin = tile % num_bands * BAND_ROWS;
+				uint32_t const y_end = std::min(y_begin + BAND_ROWS, dst_height);
+
+				if (axis_x.identity && axis_y.identity && axis_z.identity)
+				{
+					for (uint32_t y = y_begin; y < y_end; ++ y)
+					{
+						ConvertFormat(src_format, dst_format, src_ptr + z * src_slice_pitch + y * src_row_pitch, dst_width,
+							dst_ptr + z * dst_slice_pitch + y * dst_row_pitch);
+					}
+					continue;
+				}
+
+				uint32_t sy_begin = axis_y.first[y_begin];
+				uint32_t sy_end = sy_begin;
+				for (uint32_t y = y_begin; y < y_end; ++ y)
+				{
+					sy_begin = std::min(sy_begin, axis_y.first[y]);
+					sy_end = std::max(sy_end, axis_y.first[y] + axis_y.count[y]);
+				}
+				uint32_t const num_src_rows = sy_end - sy_begin;
+				uint32_t const sz_begin = axis_z.first[z];
+				uint32_t const num_src_slices = axis_z.count[z];
+
+				h_rows.resize(num_src_slices * num_src_rows * dst_width);
+				for (uint32_t zi = 0; zi < num_src_slices; ++ zi)
+				{
+					for (uint32_t yi = 0; yi < num_src_rows; ++ yi)
+					{
+						uint8_t const * src_p = src_ptr + (sz_begin + zi) * src_slice_pitch + (sy_begin + yi) * src_row_pitch;
+						Color* h_row = &h_rows[(zi * num_src_rows + yi) * dst_width];
+						if (axis_x.identity)
+						{
+							ConvertToABGR32F(src_format, src_p, src_width, h_row);
+						}
+						else
+						{
+							ConvertToABGR32F(src_format, src_p, src_width, src_row.data());
+							ResampleRow(src_row.data(), axis_x, h_row);
+						}
+					}
+				}
+
+				float const * weights_z = &axis_z.weights[axis_z.weight_offset[z]];
+				for (uint32_t y = y_begin; y < y_end; ++ y)
+				{
+					uint8_t* dst_p = dst_ptr + z * dst_slice_pitch + y * dst_row_pitch;
+					uint32_t const row_offset = axis_y.first[y] - sy_begin;
+					uint32_t const num_rows = axis_y.count[y];
+					if ((1 == num_src_slices) && (1 == num_rows))
+					{
+						ConvertFromABGR32F(dst_format, &h_rows[row_offset * dst_width], dst_width, dst_p);
+					}
+					else
+					{
+						float const * weights_y = &axis_y.weights[axis_y.weight_offset[y]];
+						std::fill(dst_row.begin(), dst_row.end(), Color(0, 0, 0, 0));
+						for (uint32_t zi = 0; zi < num_src_slices; ++ zi)
+						{
+							for (uint32_t yi = 0; yi < num_rows; ++ yi)
+							{
+								AccumulateRow(&dst_row[0].r(), &h_rows[(zi * num_src_rows + row_offset + yi) * dst_width].r(),
+									weights_z[zi] * weights_y[yi], dst_width * 4);
+							}
+						}
+						ConvertFromABGR32F(dst_format, dst_row.data(), dst_width, dst_p);
+					}
+				}
+			}
+		};
+
+		uint32_t const num_pixels = dst_width * dst_height * dst_depth;
+		uint32_t const num_tasks = std::min({ std::max(std::thread::hardware_concurrency(), 1U), num_tiles,
+			std::max(num_pixels / MIN_PIXELS_PER_TASK, 1U) });
+		if (num_tasks <= 1)
+		{
+			resample_tiles();
+		}
+		else
+		{
+			std::vector<joiner<void>> joiners;
+			joiners.reserve(num_tasks - 1);
+			for (uint32_t i = 1; i < num_tasks; ++ i)
+			{
+				joiners.push_back(Context::Instance().ThreadPool()(resample_tiles));
+			}
+			resample_tiles();
+			for (auto& task_joiner : joiners)
+			{
+				task_joiner();
+			}
+		}
+	}
 }
 
 namespace KlayGE
@@ -2170,6 +2607,7 @@ namespace KlayGE
 		}
 
 		std::vector<size_t> base;
+		size_t data_size = 0;
 		switch (type)
 		{
 		case Texture::TT_1D:
@@ -2193,14 +2631,11 @@ namespace KlayGE
 							image_size = (padding ? ((the_width + 3) & ~3) : the_width) * fmt_size;
 						}
 
-						base[index] = data_block.size();
-						data_block.resize(base[index] + image_size);
+						base[index] = data_size;
+						data_size += image_size;
 						init_data[index].row_pitch = image_size;
 						init_data[index].slice_pitch = image_size;
 
-						tex_res->read(&data_block[base[index]], static_cast<std::streamsize>(image_size));
-						BOOST_ASSERT(tex_res->gcount() == static_cast<int>(image_size));
-
 						the_width = std::max<uint32_t>(the_width / 2, 1);
 					}
 				}
@@ -2223,23 +2658,17 @@ namespace KlayGE
 							uint32_t const block_size = NumFormatBytes(format) * 4;
 							uint32_t image_size = ((the_width + 3) / 4) * ((the_height + 3) / 4) * block_size;
 
-							base[index] = data_block.size();
-							data_block.resize(base[index] + image_size);
+							base[index] = data_size;
+							data_size += image_size;
 							init_data[index].row_pitch = (the_width + 3) / 4 * block_size;
 							init_data[index].slice_pitch = image_size;
-
-							tex_res->read(&data_block[base[index]], static_cast<std::streamsize>(image_size));
-							BOOST_ASSERT(tex_res->gcount() == static_cast<int>(image_size));
 						}
 						else
 						{
 							init_data[index].row_pitch = (padding ? ((the_width + 3) & ~3) : the_width) * fmt_size;
 							init_data[index].slice_pitch = init_data[index].row_pitch * the_height;
-							base[index] = data_block.size();
-							data_block.resize(base[index] + init_data[index].slice_pitch);
-
-							tex_res->read(&data_block[base[index]], static_cast<std::streamsize>(init_data[index].slice_pitch));
-							BOOST_ASSERT(tex_res->gcount() == static_cast<int>(init_data[index].slice_pitch));
+							base[index] = data_size;
+							data_size += init_data[index].slice_pitch;
 						}
 
 						the_width = std::max<uint32_t>(the_width / 2, 1);
@@ -2266,23 +2695,17 @@ namespace KlayGE
 							uint32_t const block_size = NumFormatBytes(format) * 4;
 							uint32_t image_size = ((the_width + 3) / 4) * ((the_height + 3) / 4) * the_depth * block_size;
 
-							base[index] = data_block.size();
-							data_block.resize(base[index] + image_size);
+							base[index] = data_size;
+							data_size += image_size;
 							init_data[index].row_pitch = (the_width + 3) / 4 * block_size;
 							init_data[index].slice_pitch = ((the_width + 3) / 4) * ((the_height + 3) / 4) * block_size;
-
-							tex_res->read(&data_block[base[index]], static_cast<std::streamsize>(image_size));
-							BOOST_ASSERT(tex_res->gcount() == static_cast<int>(image_size));
 						}
 						else
 						{
 							init_data[index].row_pitch = (padding ? ((the_width + 3) & ~3) : the_width) * fmt_size;
 							init_data[index].slice_pitch = init_data[index].row_pitch * the_height;
-							base[index] = data_block.size();
-							data_block.resize(base[index] + init_data[index].slice_pitch * the_depth);
-
-							tex_res->read(&data_block[base[index]], static_cast<std::streamsize>(init_data[index].slice_pitch * the_depth));
-							BOOST_ASSERT(tex_res->gcount() == static_cast<int>(init_data[index].slice_pitch * the_depth));
+							base[index] = data_size;
+							data_size += init_data[index].slice_pitch * the_depth;
 						}
 
 						the_width = std::max<uint32_t>(the_width / 2, 1);
@@ -2311,23 +2734,17 @@ namespace KlayGE
 								uint32_t const block_size = NumFormatBytes(format) * 4;
 								uint32_t image_size = ((the_width + 3) / 4) * ((the_height + 3) / 4) * block_size;
 
-								base[index] = data_block.size();
-								data_block.resize(base[index] + image_size);
+								base[index] = data_size;
+								data_size += image_size;
 								init_data[index].row_pitch = (the_width + 3) / 4 * block_size;
 								init_data[index].slice_pitch = image_size;
-
-								tex_res->read(&data_block[base[index]], static_cast<std::streamsize>(image_size));
-								BOOST_ASSERT(tex_res->gcount() == static_cast<int>(image_size));
 							}
 							else
 							{
 								init_data[index].row_pitch = (padding ? ((the_width + 3) & ~3) : the_width) * fmt_size;
 								init_data[index].slice_pitch = init_data[index].row_pitch * the_width;
-								base[index] = data_block.size();
-								data_block.resize(base[index] + init_data[index].slice_pitch);
-
-								tex_res->read(&data_block[base[index]], static_cast<std::streamsize>(init_data[index].slice_pitch));
-								BOOST_ASSERT(tex_res->gcount() == static_cast<int>(init_data[index].slice_pitch));
+								base[index] = data_size;
+								data_size += init_data[index].slice_pitch;
 							}
 
 							the_width = std::max<uint32_t>(the_width / 2, 1);
@@ -2339,9 +2756,34 @@ namespace KlayGE
 			break;
 		}
 
+		uint8_t const * data;
+		ArrayRef<uint8_t> const mapped_data = tex_res->MappedData();
+		if (!mapped_data.empty())
+		{
+			// All subresources are stored back to back. Reference them in place, CreateHWResource makes the only copy.
+			int64_t const data_start = tex_res->tellg();
+			if ((data_start < 0) || (static_cast<uint64_t>(data_start) + data_size > mapped_data.size()))
+			{
+				LogError() << tex_name << " is truncated." << std::endl;
+				return TexturePtr();
+			}
+			data = mapped_data.data() + data_start;
+		}
+		else
+		{
+			data_block.resize(data_size);
+			tex_res->read(data_block.data(), data_size);
+			if (tex_res->gcount() != static_cast<int64_t>(data_size))
+			{
+				LogError() << tex_name << " is truncated." << std::endl;
+				return TexturePtr();
+			}
+			data = data_block.data();
+		}
+
 		for (size_t i = 0; i < base.size(); ++ i)
 		{
-			init_data[i].data = &data_block[base[i]];
+			init_data[i].data = data + base[i];
 		}
 
 		auto ret = MakeSharedPtr<SoftwareTexture>(type, width, height, depth,
@@ -3491,6 +3933,17 @@ namespace KlayGE
 		void const * src_data, uint32_t src_row_pitch, uint32_t src_slice_pitch, ElementFormat src_format,
 		uint32_t src_width, uint32_t src_height, uint32_t src_depth,
 		bool linear)
+	{
+		ResizeTexture(dst_data, dst_row_pitch, dst_slice_pitch, dst_format, dst_width, dst_height, dst_depth,
+			src_data, src_row_pitch, src_slice_pitch, src_format, src_width, src_height, src_depth,
+			linear ? TRF_Linear : TRF_Point);
+	}
+
+	void ResizeTexture(void* dst_data, uint32_t dst_row_pitch, uint32_t dst_slice_pitch, ElementFormat dst_format,
+		uint32_t dst_width, uint32_t dst_height, uint32_t dst_depth,
+		void const * src_data, uint32_t src_row_pitch, uint32_t src_slice_pitch, ElementFormat src_format,
+		uint32_t src_width, uint32_t src_height, uint32_t src_depth,
+		TextureResizeFilter filter)
 	{
 		std::vector<uint8_t> src_cpu_data_block;
 		void* src_cpu_data;
@@ -3577,7 +4030,7 @@ namespace KlayGE
 				KFL_UNREACHABLE("Invalid destination format");
 			}
 
-			dst_cpu_row_pitch = dst_width * NumFormatBytes(src_cpu_format);
+			dst_cpu_row_pitch = dst_width * NumFormatBytes(dst_cpu_format);
 			dst_cpu_slice_pitch = dst_cpu_row_pitch * dst_height;
 			dst_cpu_data_block.resize(dst_depth * dst_cpu_slice_pitch);
 			dst_cpu_data = &dst_cpu_data_block[0];
@@ -3595,7 +4048,7 @@ namespace KlayGE
 		uint32_t const src_elem_size = NumFormatBytes(src_cpu_format);
 		uint32_t const dst_elem_size = NumFormatBytes(dst_cpu_format);
 
-		if ((!linear || ((src_width == dst_width) && (src_height == dst_height) && (src_depth == dst_depth)))
+		if (((TRF_Point == filter) || ((src_width == dst_width) && (src_height == dst_height) && (src_depth == dst_depth)))
 			&& (src_cpu_format == dst_cpu_format))
 		{
 			for (uint32_t z = 0; z < dst_depth; ++ z)
@@ -3629,87 +4082,9 @@ namespace KlayGE
 		}
 		else
 		{
-			std::vector<Color> src_32f(src_width * src_height * src_depth);
-			{
-				for (uint32_t z = 0; z < src_depth; ++ z)
-				{
-					for (uint32_t y = 0; y < src_height; ++ y)
-					{
-						ConvertToABGR32F(src_cpu_format, src_ptr + z * src_cpu_slice_pitch + y * src_cpu_row_pitch,
-							src_width, &src_32f[(z * src_height + y) * src_width]);
-					}
-				}
-			}
-
-			std::vector<Color> dst_32f(dst_width * dst_height * dst_depth);
-			if (linear)
-			{
-				for (uint32_t z = 0; z < dst_depth; ++ z)
-				{
-					float fz = static_cast<float>(z + 0.5f) / dst_depth * src_depth;
-					uint32_t sz0 = static_cast<uint32_t>(fz - 0.5f);
-					uint32_t sz1 = MathLib::clamp<uint32_t>(sz0 + 1, 0, src_depth - 1);
-					float weight_z = fz - sz0 - 0.5f;
-							
-					for (uint32_t y = 0; y < dst_height; ++ y)
-					{
-						float fy = static_cast<float>(y + 0.5f) / dst_height * src_height;
-						uint32_t sy0 = static_cast<uint32_t>(fy - 0.5f);
-						uint32_t sy1 = MathLib::clamp<uint32_t>(sy0 + 1, 0, src_height - 1);
-						float weight_y = fy - sy0 - 0.5f;
-							
-						for (uint32_t x = 0; x < dst_width; ++ x)
-						{
-							float fx = static_cast<float>(x + 0.5f) / dst_width * src_width;
-							uint32_t sx0 = static_cast<uint32_t>(fx - 0.5f);
-							uint32_t sx1 = MathLib::clamp<uint32_t>(sx0 + 1, 0, src_width - 1);
-							float weight_x = fx - sx0 - 0.5f;
-							Color clr_x00 = MathLib::lerp(src_32f[(sz0 * src_height + sy0) * src_width + sx0],
-								src_32f[(sz0 * src_height + sy0) * src_width + sx1], weight_x);
-							Color clr_x01 = MathLib::lerp(src_32f[(sz0 * src_height + sy1) * src_width + sx0],
-								src_32f[(sz0 * src_height + sy1) * src_width + sx1], weight_x);
-							Color clr_y0 = MathLib::lerp(clr_x00, clr_x01, weight_y);
-							Color clr_x10 = MathLib::lerp(src_32f[(sz1 * src_height + sy0) * src_width + sx0],
-								src_32f[(sz1 * src_height + sy0) * src_width + sx1], weight_x);
-							Color clr_x11 = MathLib::lerp(src_32f[(sz1 * src_height + sy1) * src_width + sx0],
-								src_32f[(sz1 * src_height + sy1) * src_width + sx1], weight_x);
-							Color clr_y1 = MathLib::lerp(clr_x10, clr_x11, weight_y);
-							dst_32f[(z * dst_height + y) * dst_width + x] = MathLib::lerp(clr_y0, clr_y1, weight_z);
-						}
-					}
-				}
-			}
-			else
-			{
-				for (uint32_t z = 0; z < dst_depth; ++ z)
-				{
-					float fz = static_cast<float>(z + 0.5f) / dst_depth * src_depth;
-					uint32_t sz = std::min(static_cast<uint32_t>(fz), src_depth - 1);
-
-					for (uint32_t y = 0; y < dst_height; ++ y)
-					{
-						float fy = static_cast<float>(y + 0.5f) / dst_height * src_height;
-						uint32_t sy = std::min(static_cast<uint32_t>(fy), src_height - 1);
-
-						for (uint32_t x = 0; x < dst_width; ++ x)
-						{
-							float fx = static_cast<float>(x + 0.5f) / dst_width * src_width;
-							uint32_t sx = std::min(static_cast<uint32_t>(fx), src_width - 1);
-							dst_32f[(z * dst_height + y) * dst_width + x] = src_32f[(sz * src_height + sy) * src_width + sx];
-						}
-					}
-				}
-			}
-
-			{
-				for (uint32_t z = 0; z < dst_depth; ++ z)
-				{
-					for (uint32_t y = 0; y < dst_height; ++ y)
-					{
-						ConvertFromABGR32F(dst_cpu_format, &dst_32f[(z * dst_height + y) * dst_width], dst_width, dst_ptr + z * dst_cpu_slice_pitch + y * dst_cpu_row_pitch);
-					}
-				}
-			}
+			ResampleTexture(dst_ptr, dst_cpu_row_pitch, dst_cpu_slice_pitch, dst_cpu_format, dst_width, dst_height, dst_depth,
+				src_ptr, src_cpu_row_pitch, src_cpu_slice_pitch, src_cpu_format, src_width, src_height, src_depth,
+				filter);
 		}
 
 		if (IsCompressedFormat(dst_format))
@@ -4051,36 +4426,22 @@ namespace KlayGE
 
 	void SoftwareTexture::BuildMipSubLevels()
 	{
+		// Resamples the subresources in place with a Kaiser filter, instead of the bilinear CopyToSubTexture*
+		uint32_t const num_faces = (type_ == TT_Cube) ? 6 : 1;
 		for (uint32_t index = 0; index < this->ArraySize(); ++ index)
 		{
-			for (uint32_t level = 1; level < this->NumMipMaps(); ++ level)
+			for (uint32_t face = 0; face < num_faces; ++ face)
 			{
-				switch (type_)
+				for (uint32_t level = 1; level < this->NumMipMaps(); ++ level)
 				{
-				case TT_1D:
-					this->CopyToSubTexture1D(*this, index, level, 0, this->Width(level),
-						index, level - 1, 0, this->Width(level - 1));
-					break;
-
-				case TT_2D:
-					this->CopyToSubTexture2D(*this, index, level, 0, 0, this->Width(level), this->Height(level),
-						index, level - 1, 0, 0, this->Width(level - 1), this->Height(level - 1));
-					break;
-
-				case TT_3D:
-					this->CopyToSubTexture3D(*this, index, level, 0, 0, 0, this->Width(level), this->Height(level), this->Depth(level),
-						index, level - 1, 0, 0, 0, this->Width(level - 1), this->Height(level - 1), this->Depth(level - 1));
-					break;
-
-				case TT_Cube:
-					for (uint32_t face = 0; face < 6; ++ face)
-					{
-						this->CopyToSubTextureCube(*this, index, static_cast<CubeFaces>(face), level, 0, 0,
-							this->Width(level), this->Height(level),
-							index, static_cast<CubeFaces>(face), level - 1, 0, 0,
-							this->Width(level - 1), this->Height(level - 1));
-					}
-					break;
+					auto const & src_data = subres_data_[(index * num_faces + face) * num_mip_maps_ + level - 1];
+					auto const & dst_data = subres_data_[(index * num_faces + face) * num_mip_maps_ + level];
+
+					ResizeTexture(const_cast<void*>(dst_data.data), dst_data.row_pitch, dst_data.slice_pitch, format_,
+						this->Width(level), this->Height(level), this->Depth(level),
+						src_data.data, src_data.row_pitch, src_data.slice_pitch, format_,
+						this->Width(level - 1), this->Height(level - 1), this->Depth(level - 1),
+						TRF_Kaiser);
 				}
 			}
 		}
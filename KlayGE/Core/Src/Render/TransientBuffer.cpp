@@ -34,14 +34,33 @@
 #include <KlayGE/RenderEngine.hpp>
 #include <KlayGE/App3D.hpp>
 
+#include <algorithm>
 #include <cstring>
 
 #include <KlayGE/TransientBuffer.hpp>
 
+namespace
+{
+	uint64_t PackRingWindow(uint32_t offset, uint32_t end)
+	{
+		return (static_cast<uint64_t>(end) << 32) | offset;
+	}
+
+	uint32_t RingWindowOffset(uint64_t window)
+	{
+		return static_cast<uint32_t>(window & 0xFFFFFFFFU);
+	}
+
+	uint32_t RingWindowEnd(uint64_t window)
+	{
+		return static_cast<uint32_t>(window >> 32);
+	}
+}
+
 namespace KlayGE
 {
-	TransientBuffer::TransientBuffer(uint32_t size_in_byte, TransientBuffer::BindFlag bind_flag)
-		: bind_flag_(bind_flag)
+	TransientBuffer::TransientBuffer(uint32_t size_in_byte, TransientBuffer::BindFlag bind_flag, TransientBuffer::AllocMode mode)
+		: mode_(mode), bind_flag_(bind_flag)
 	{
 		RenderFactory& rf = Context::Instance().RenderFactoryInstance();
 		RenderEngine const & re = rf.RenderEngineInstance();
@@ -61,11 +80,33 @@ namespace KlayGE
 			valid_max_ = 0;
 		}
 
-		SubAlloc alloc(0, size_in_byte);
-		free_list_.push_back(alloc);
+		if (AM_Ring == mode_)
+		{
+			// The ring keeps its own CPU copy
+			simulate_buffer_.clear();
+			simulate_buffer_.shrink_to_fit();
 
-		App3DFramework const & app = Context::Instance().AppInstance();
-		retired_frames_.push_back(RetiredFrame(app.TotalNumFrames() + 1));
+			BOOST_ASSERT(size_in_byte < 0x80000000U);
+			ring_capacity_ = size_in_byte;
+			ring_chunks_[0].begin = 0;
+			ring_chunks_[0].end = size_in_byte;
+			ring_chunks_[0].data = MakeUniquePtr<uint8_t[]>(size_in_byte);
+			num_ring_chunks_ = 1;
+
+			ring_frame_windows_.push_back({ 0, size_in_byte });
+			ring_window_ = PackRingWindow(0, size_in_byte);
+			ring_head_ = 0;
+			ring_uploaded_windows_ = 0;
+			ring_uploaded_offset_ = 0;
+		}
+		else
+		{
+			SubAlloc alloc(0, size_in_byte);
+			free_list_.push_back(alloc);
+
+			App3DFramework const & app = Context::Instance().AppInstance();
+			retired_frames_.push_back(RetiredFrame(app.TotalNumFrames() + 1));
+		}
 	}
 
 	GraphicsBufferPtr TransientBuffer::DoCreateBuffer(TransientBuffer::BindFlag bind_flag, uint32_t size_in_byte)
@@ -90,6 +131,11 @@ namespace KlayGE
 
 	SubAlloc TransientBuffer::Alloc(uint32_t size_in_byte, void const * data)
 	{
+		if (AM_Ring == mode_)
+		{
+			return this->RingAlloc(size_in_byte, data);
+		}
+
 		SubAlloc ret;
 
 		// Use first fit method to find a free sub alloc
@@ -165,7 +211,7 @@ namespace KlayGE
 
 	void TransientBuffer::Dealloc(SubAlloc const & alloc)
 	{
-		if ((alloc.length_ > 0) && !retired_frames_.empty())
+		if ((AM_FreeList == mode_) && (alloc.length_ > 0) && !retired_frames_.empty())
 		{
 			RetiredFrame& frame = retired_frames_.back();
 			frame.pending_frees_.push_back(alloc);
@@ -186,7 +232,11 @@ namespace KlayGE
 
 	void TransientBuffer::OnPresent()
 	{
-		if (!retired_frames_.empty())
+		if (AM_Ring == mode_)
+		{
+			this->RingOnPresent();
+		}
+		else if (!retired_frames_.empty())
 		{
 			App3DFramework const & app = Context::Instance().AppInstance();
 			uint32_t const frame_id = app.TotalNumFrames();
@@ -284,11 +334,207 @@ namespace KlayGE
 
 	void TransientBuffer::EnsureDataReady()
 	{
-		if (!use_no_overwrite_)
+		if (AM_Ring == mode_)
+		{
+			this->RingEnsureDataReady();
+		}
+		else if (!use_no_overwrite_)
 		{
 			GraphicsBuffer::Mapper mapper(*buffer_, BA_Write_Only);
 			memcpy(mapper.Pointer<uint8_t>() + valid_min_, &simulate_buffer_[valid_min_],
 				valid_max_ - valid_min_);
 		}
 	}
+
+	SubAlloc TransientBuffer::RingAlloc(uint32_t size_in_byte, void const * data)
+	{
+		uint32_t offset;
+		for (;;)
+		{
+			uint64_t const window = ring_window_.fetch_add(size_in_byte, std::memory_order_acquire);
+			offset = RingWindowOffset(window);
+			uint32_t const end = RingWindowEnd(window);
+			if (offset + size_in_byte <= end)
+			{
+				break;
+			}
+
+			// Out of space. One thread grows the ring, the others try again in the new window.
+			if (this->RingGrow(end, size_in_byte, offset))
+			{
+				break;
+			}
+		}
+
+		if (size_in_byte > 0)
+		{
+			this->RingWrite(offset, data, size_in_byte);
+		}
+
+		return SubAlloc(offset, size_in_byte);
+	}
+
+	bool TransientBuffer::RingGrow(uint32_t seen_end, uint32_t size_in_byte, uint32_t& offset)
+	{
+		std::lock_guard<std::mutex> lock(ring_grow_mutex_);
+
+		if (RingWindowEnd(ring_window_.load(std::memory_order_relaxed)) != seen_end)
+		{
+			// Someone else has grown it
+			return false;
+		}
+
+		// The new space is appended after the current capacity. Nothing is copied, the data already written stays in
+		// its chunk and is uploaded from there.
+		uint32_t const old_capacity = ring_capacity_;
+		uint32_t const new_capacity = std::max(old_capacity * 2, old_capacity + size_in_byte);
+		BOOST_ASSERT(new_capacity < 0x80000000U);
+
+		uint32_t const chunk_index = num_ring_chunks_.load(std::memory_order_relaxed);
+		BOOST_ASSERT(chunk_index < ring_chunks_.size());
+		auto& chunk = ring_chunks_[chunk_index];
+		chunk.begin = old_capacity;
+		chunk.end = new_capacity;
+		chunk.data = MakeUniquePtr<uint8_t[]>(new_capacity - old_capacity);
+		num_ring_chunks_.store(chunk_index + 1, std::memory_order_release);
+
+		ring_capacity_ = new_capacity;
+		ring_frame_windows_.push_back({ old_capacity, new_capacity });
+
+		// Reserve the caller's space before publishing the window
+		offset = old_capacity;
+		ring_window_.store(PackRingWindow(old_capacity + size_in_byte, new_capacity), std::memory_order_release);
+
+		return true;
+	}
+
+	void TransientBuffer::RingWrite(uint32_t offset, void const * data, uint32_t size_in_byte)
+	{
+		uint8_t const * src = static_cast<uint8_t const *>(data);
+		uint32_t const num_chunks = num_ring_chunks_.load(std::memory_order_acquire);
+		for (uint32_t i = 0; (i < num_chunks) && (size_in_byte > 0); ++ i)
+		{
+			auto const & chunk = ring_chunks_[i];
+			if ((offset >= chunk.begin) && (offset < chunk.end))
+			{
+				uint32_t const copy_size = std::min(size_in_byte, chunk.end - offset);
+				memcpy(&chunk.data[offset - chunk.begin], src, copy_size);
+
+				src += copy_size;
+				offset += copy_size;
+				size_in_byte -= copy_size;
+			}
+		}
+		BOOST_ASSERT(0 == size_in_byte);
+	}
+
+	void TransientBuffer::RingEnsureDataReady()
+	{
+		if (buffer_->Size() < ring_capacity_)
+		{
+			// Frames in flight keep reading the old buffer, only this frame has to be in the new one
+			buffer_ = this->DoCreateBuffer(bind_flag_, ring_capacity_);
+			ring_in_flight_.clear();
+			ring_uploaded_windows_ = 0;
+			ring_uploaded_offset_ = ring_frame_windows_[0].begin;
+		}
+
+		if (!use_no_overwrite_)
+		{
+			// Mapping discards the buffer, so everything this frame has written goes up again
+			ring_uploaded_windows_ = 0;
+			ring_uploaded_offset_ = ring_frame_windows_[0].begin;
+		}
+
+		uint32_t const num_windows = static_cast<uint32_t>(ring_frame_windows_.size());
+		uint32_t const last_offset = std::min(RingWindowOffset(ring_window_.load(std::memory_order_acquire)),
+			ring_frame_windows_.back().end);
+		if ((ring_uploaded_windows_ + 1 == num_windows) && (ring_uploaded_offset_ == last_offset))
+		{
+			return;
+		}
+
+		GraphicsBuffer::Mapper mapper(*buffer_, use_no_overwrite_ ? BA_Write_No_Overwrite : BA_Write_Only);
+		uint8_t* buffer_data = mapper.Pointer<uint8_t>();
+		for (uint32_t i = ring_uploaded_windows_; i < num_windows; ++ i)
+		{
+			uint32_t const begin = (i == ring_uploaded_windows_) ? ring_uploaded_offset_ : ring_frame_windows_[i].begin;
+			// Earlier windows were abandoned when they overflowed, so how much of them is used is unknown
+			uint32_t const end = (i + 1 == num_windows) ? last_offset : ring_frame_windows_[i].end;
+
+			uint32_t const num_chunks = num_ring_chunks_.load(std::memory_order_relaxed);
+			for (uint32_t j = 0; j < num_chunks; ++ j)
+			{
+				auto const & chunk = ring_chunks_[j];
+				uint32_t const copy_begin = std::max(begin, chunk.begin);
+				uint32_t const copy_end = std::min(end, chunk.end);
+				if (copy_begin < copy_end)
+				{
+					memcpy(buffer_data + copy_begin, &chunk.data[copy_begin - chunk.begin], copy_end - copy_begin);
+				}
+			}
+		}
+
+		ring_uploaded_windows_ = num_windows - 1;
+		ring_uploaded_offset_ = last_offset;
+	}
+
+	void TransientBuffer::RingOnPresent()
+	{
+		// OnPresent can be called more than once a frame, so ranges are fenced on real frames, like the free list does
+		App3DFramework const & app = Context::Instance().AppInstance();
+		uint32_t const frame_id = app.TotalNumFrames();
+
+		uint32_t const used_end = std::min(RingWindowOffset(ring_window_.load(std::memory_order_acquire)),
+			ring_frame_windows_.back().end);
+		uint32_t const used_begin = ring_frame_windows_[0].begin;
+		if ((used_begin != used_end) || (ring_frame_windows_.size() > 1))
+		{
+			ring_in_flight_.push_back({ frame_id, used_begin, used_end });
+		}
+		ring_head_ = used_end;
+
+		// The GPU is done with frames that are old enough
+		while (!ring_in_flight_.empty() && (ring_in_flight_.front().frame_id + num_pre_frames_ <= frame_id))
+		{
+			ring_in_flight_.pop_front();
+		}
+
+		// The next frame gets the largest contiguous free range. Live data goes from the oldest frame in flight to the head,
+		// maybe wrapping around the end.
+		RingWindow window;
+		if (ring_in_flight_.empty())
+		{
+			window = { 0, ring_capacity_ };
+		}
+		else
+		{
+			uint32_t const oldest = ring_in_flight_.front().begin;
+			if (oldest < ring_head_)
+			{
+				if (ring_capacity_ - ring_head_ >= oldest)
+				{
+					window = { ring_head_, ring_capacity_ };
+				}
+				else
+				{
+					window = { 0, oldest };
+				}
+			}
+			else if (oldest > ring_head_)
+			{
+				window = { ring_head_, oldest };
+			}
+			else
+			{
+				// Full, the first Alloc grows it
+				window = { ring_head_, ring_head_ };
+			}
+		}
+
+		ring_frame_windows_.assign(1, window);
+		ring_uploaded_windows_ = 0;
+		ring_uploaded_offset_ = window.begin;
+		ring_window_.store(PackRingWindow(window.begin, window.end), std::memory_order_release);
+	}
 }
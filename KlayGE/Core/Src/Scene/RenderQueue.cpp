@@ -0,0 +1,229 @@
+/**
+* @file RenderQueue.cpp
+* @author Minmin Gong
+*
+* @section DESCRIPTION
+*
+* This source file is part of KlayGE
+* For the latest info, see http://www.klayge.org
+*
+* @section LICENSE
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published
+* by the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*
+* You may alternatively use this source under the terms of
+* the KlayGE Proprietary License (KPL). You can obtained such a license
+* from http://www.klayge.org/licensing/.
+*/
+
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Math.hpp>
+#include <KlayGE/Renderable.hpp>
+#include <KlayGE/RenderEffect.hpp>
+#include <KlayGE/SceneNode.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include <KlayGE/RenderQueue.hpp>
+
+namespace KlayGE
+{
+	void RenderQueue::Clear()
+	{
+		tech_slot_map_.clear();
+		tech_slots_.clear();
+		items_.clear();
+		sorted_items_.clear();
+	}
+
+	void RenderQueue::Add(RenderTechnique const * tech, Renderable* renderable)
+	{
+		BOOST_ASSERT(tech);
+
+		auto iter = tech_slot_map_.find(tech);
+		if (iter == tech_slot_map_.end())
+		{
+			BOOST_ASSERT(tech_slots_.size() < MAX_NUM_TECHNIQUES);
+
+			iter = tech_slot_map_.emplace(tech, static_cast<uint32_t>(tech_slots_.size())).first;
+			tech_slots_.push_back({ tech, 0, 0 });
+		}
+
+		++ tech_slots_[iter->second].num_items;
+		items_.push_back({ renderable, iter->second });
+	}
+
+	void RenderQueue::Sort(float4 const & view_mat_z)
+	{
+		// Techniques with the same weight keep the order they are first seen
+		ranked_slots_.resize(tech_slots_.size());
+		for (uint32_t i = 0; i < ranked_slots_.size(); ++ i)
+		{
+			ranked_slots_[i] = i;
+		}
+		std::stable_sort(ranked_slots_.begin(), ranked_slots_.end(),
+			[this](uint32_t lhs, uint32_t rhs)
+			{
+				return tech_slots_[lhs].tech->Weight() < tech_slots_[rhs].tech->Weight();
+			});
+		for (uint32_t i = 0; i < ranked_slots_.size(); ++ i)
+		{
+			tech_slots_[ranked_slots_[i]].rank = static_cast<uint16_t>(i);
+		}
+
+		keys_.resize(items_.size());
+		indices_.resize(items_.size());
+		for (size_t i = 0; i < items_.size(); ++ i)
+		{
+			Item const & item = items_[i];
+			TechniqueSlot const & slot = tech_slots_[item.tech_slot];
+			RenderTechnique const & tech = *slot.tech;
+
+			float depth = 0;
+			uint16_t material = 0;
+			if (!tech.Transparent())
+			{
+				// Transparent ones have to be drawn in the order they are submitted
+				if (!tech.HasDiscard() && (slot.num_items > 1))
+				{
+					depth = this->MinDepth(*item.renderable, view_mat_z);
+				}
+				material = MaterialBits(item.renderable->GetMaterial().get());
+			}
+
+			keys_[i] = MakeKey(slot.rank, depth, material);
+			indices_[i] = static_cast<uint32_t>(i);
+		}
+
+		RadixSort(keys_, indices_, tmp_keys_, tmp_indices_);
+
+		sorted_items_.resize(items_.size());
+		for (size_t i = 0; i < items_.size(); ++ i)
+		{
+			sorted_items_[i] = items_[indices_[i]].renderable;
+		}
+	}
+
+	float RenderQueue::MinDepth(Renderable const & renderable, float4 const & view_mat_z) const
+	{
+		AABBox const & box = renderable.PosBound();
+		uint32_t const num = renderable.NumInstances();
+		float md = 1e10f;
+		for (uint32_t i = 0; i < num; ++ i)
+		{
+			float4x4 const & mat = renderable.GetInstance(i)->TransformToWorld();
+			float4 const zvec(MathLib::dot(mat.Row(0), view_mat_z),
+				MathLib::dot(mat.Row(1), view_mat_z), MathLib::dot(mat.Row(2), view_mat_z),
+				MathLib::dot(mat.Row(3), view_mat_z));
+			for (int k = 0; k < 8; ++ k)
+			{
+				float3 const v = box.Corner(k);
+				md = std::min(md, v.x() * zvec.x() + v.y() * zvec.y() + v.z() * zvec.z() + zvec.w());
+			}
+		}
+		return md;
+	}
+
+	uint64_t RenderQueue::MakeKey(uint16_t tech_rank, float depth, uint16_t material)
+	{
+		// Flip the sign bit of positives and all bits of negatives, so the uint32s sort in the same order as the floats
+		uint32_t depth_bits;
+		std::memcpy(&depth_bits, &depth, sizeof(depth_bits));
+		depth_bits ^= (depth_bits & 0x80000000U) ? 0xFFFFFFFFU : 0x80000000U;
+
+		return (static_cast<uint64_t>(tech_rank) << 48) | (static_cast<uint64_t>(depth_bits) << 16) | material;
+	}
+
+	uint16_t RenderQueue::MaterialBits(void const * material)
+	{
+		uint64_t bits = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(material));
+		bits ^= bits >> 32;
+		bits ^= bits >> 16;
+		return static_cast<uint16_t>(bits);
+	}
+
+	void RenderQueue::RadixSort(std::vector<uint64_t>& keys, std::vector<uint32_t>& values,
+		std::vector<uint64_t>& tmp_keys, std::vector<uint32_t>& tmp_values)
+	{
+		BOOST_ASSERT(keys.size() == values.size());
+
+		size_t const num = keys.size();
+		if (num <= 1)
+		{
+			return;
+		}
+
+		uint32_t constexpr RADIX_BITS = 8;
+		uint32_t constexpr NUM_BUCKETS = 1UL << RADIX_BITS;
+		uint32_t constexpr NUM_PASSES = sizeof(uint64_t) * 8 / RADIX_BITS;
+
+		// Histograms of all passes in one read of the keys
+		std::array<std::array<uint32_t, NUM_BUCKETS>, NUM_PASSES> histograms{};
+		for (size_t i = 0; i < num; ++ i)
+		{
+			uint64_t const key = keys[i];
+			for (uint32_t pass = 0; pass < NUM_PASSES; ++ pass)
+			{
+				++ histograms[pass][(key >> (pass * RADIX_BITS)) & (NUM_BUCKETS - 1)];
+			}
+		}
+
+		tmp_keys.resize(num);
+		tmp_values.resize(num);
+
+		uint64_t* src_keys = keys.data();
+		uint32_t* src_values = values.data();
+		uint64_t* dst_keys = tmp_keys.data();
+		uint32_t* dst_values = tmp_values.data();
+		for (uint32_t pass = 0; pass < NUM_PASSES; ++ pass)
+		{
+			uint32_t const shift = pass * RADIX_BITS;
+			auto& histogram = histograms[pass];
+
+			// All keys share this digit, the pass wouldn't move anything. Depth bits of non-sorted techniques and
+			// the high bits of the technique rank hit this most of the time.
+			if (histogram[(src_keys[0] >> shift) & (NUM_BUCKETS - 1)] == num)
+			{
+				continue;
+			}
+
+			uint32_t offset = 0;
+			for (uint32_t b = 0; b < NUM_BUCKETS; ++ b)
+			{
+				uint32_t const count = histogram[b];
+				histogram[b] = offset;
+				offset += count;
+			}
+
+			for (size_t i = 0; i < num; ++ i)
+			{
+				uint32_t const dst = histogram[(src_keys[i] >> shift) & (NUM_BUCKETS - 1)] ++;
+				dst_keys[dst] = src_keys[i];
+				dst_values[dst] = src_values[i];
+			}
+
+			std::swap(src_keys, dst_keys);
+			std::swap(src_values, dst_values);
+		}
+
+		if (src_keys != keys.data())
+		{
+			keys.swap(tmp_keys);
+			values.swap(tmp_values);
+		}
+	}
+}
@@ -52,13 +52,36 @@
 #include <KlayGE/InputFactory.hpp>
 #include <KlayGE/FrameBuffer.hpp>
 #include <KlayGE/DeferredRenderingLayer.hpp>
+#include <KlayGE/PerfProfiler.hpp>
 #include <KFL/Hash.hpp>
 
 #include <map>
 #include <algorithm>
+#include <thread>
 
 #include <KlayGE/SceneManager.hpp>
 
+namespace
+{
+	using namespace KlayGE;
+
+	// Clears the flag even if a handler throws. Otherwise every later access on the update thread would go to the
+	// pending copies.
+	class SubThreadUpdatingScope : boost::noncopyable
+	{
+	public:
+		SubThreadUpdatingScope()
+		{
+			SceneNode::SubThreadUpdating(true);
+		}
+
+		~SubThreadUpdatingScope()
+		{
+			SceneNode::SubThreadUpdating(false);
+		}
+	};
+}
+
 namespace KlayGE
 {
 	// 캯
@@ -72,10 +95,20 @@ namespace KlayGE
 			num_objects_rendered_(0), num_renderables_rendered_(0),
 			num_primitives_rendered_(0), num_vertices_rendered_(0),
 			num_draw_calls_(0), num_dispatch_calls_(0),
-			quit_(false), deferred_mode_(false)
+			quit_(false), deferred_mode_(false),
+			scene_hierarchy_dirty_(true), num_transform_threads_(0),
+			visible_marks_generation_(1), visible_marks_clock_(0), visible_marks_hits_(0), visible_marks_misses_(0)
 	{
 		scene_root_.VisibleMark(BO_Partial);
 		overlay_root_.VisibleMark(BO_Partial);
+
+		for (auto& entry : visible_marks_cache_)
+		{
+			entry.seed = 0;
+			entry.num_nodes = 0;
+			entry.generation = 0;
+			entry.last_use = 0;
+		}
 	}
 
 	// 
@@ -110,6 +143,21 @@ namespace KlayGE
 		update_elapse_ = elapse;
 	}
 
+	void SceneManager::NumTransformThreads(uint32_t num_threads)
+	{
+		num_transform_threads_ = num_threads;
+	}
+
+	uint32_t SceneManager::NumTransformThreads() const
+	{
+		return num_transform_threads_;
+	}
+
+	void SceneManager::OnHierarchyChanged()
+	{
+		scene_hierarchy_dirty_ = true;
+	}
+
 	// ü
 	/////////////////////////////////////////////////////////////////////////////////
 	void SceneManager::ClipScene()
@@ -289,22 +337,7 @@ namespace KlayGE
 
 			if (add)
 			{
-				RenderTechnique const * obj_tech = obj->GetRenderTechnique();
-				BOOST_ASSERT(obj_tech);
-				bool found = false;
-				for (auto& items : render_queue_)
-				{
-					if (items.first == obj_tech)
-					{
-						items.second.push_back(obj);
-						found = true;
-						break;
-					}
-				}
-				if (!found)
-				{
-					render_queue_.emplace_back(obj_tech, std::vector<Renderable*>(1, obj));
-				}
+				render_queue_.Add(obj->GetRenderTechnique(), obj);
 			}
 		}
 	}
@@ -396,8 +429,23 @@ namespace KlayGE
 		{
 			std::lock_guard<std::mutex> lock(update_mutex_);
 
-			scene_root_.MainThreadUpdateSubtree(app_time, frame_time);
-			scene_root_.UpdatePosBoundSubtree();
+			// Changes from the sub thread update become visible here, before anything of this frame is computed
+			for (auto const & node : pending_sub_thread_nodes_)
+			{
+				node.first->ApplySubThreadUpdate();
+			}
+			pending_sub_thread_nodes_.clear();
+
+			// Update callbacks are user code that may edit the hierarchy, so they run in tree order on this thread. Transforms
+			// and bounds are propagated afterwards, one depth level at a time.
+			scene_root_.Traverse([app_time, frame_time](SceneNode& node)
+				{
+					node.MainThreadUpdate(app_time, frame_time);
+					return true;
+				});
+			this->FlattenScene();
+			this->PropagateTransforms();
+			this->PropagatePosBounds();
 
 			overlay_root_.ClearChildren();
 			for (auto iter = lights_.begin(); iter != lights_.end();)
@@ -443,6 +491,10 @@ namespace KlayGE
 	/////////////////////////////////////////////////////////////////////////////////
 	void SceneManager::Flush(uint32_t urt)
 	{
+#ifndef KLAYGE_SHIP
+		PerfZone zone("SceneManager::Flush");
+#endif
+
 		std::lock_guard<std::mutex> lock(update_mutex_);
 
 		urt_ = urt;
@@ -457,11 +509,7 @@ namespace KlayGE
 		num_primitives_rendered_ = 0;
 		num_vertices_rendered_ = 0;
 
-		scene_root_.Traverse([this](SceneNode& node)
-			{
-				all_scene_nodes_.push_back(&node);
-				return true;
-			});
+		this->FlattenScene();
 		overlay_root_.Traverse([this](SceneNode& node)
 			{
 				all_overlay_nodes_.push_back(&node);
@@ -477,16 +525,17 @@ namespace KlayGE
 		}
 		if (!(urt & App3DFramework::URV_Overlay))
 		{
-			scene_root_.Traverse([](SceneNode& node)
+			// Visible(false) is applied to the whole subtree, so testing each node gives the same marks as a traversal that
+			// stops at invisible nodes
+			for (auto* node : all_scene_nodes_)
+			{
+				uint32_t const attr = node->Attrib();
+				if ((node->Parent() == nullptr)
+					|| (node->Visible() && (!(attr & SceneNode::SOA_Cullable) || (attr & SceneNode::SOA_Moveable))))
 				{
-					uint32_t const attr = node.Attrib();
-					if ((node.Parent() == nullptr)
-						|| (node.Visible() && (!(attr & SceneNode::SOA_Cullable) || (attr & SceneNode::SOA_Moveable))))
-					{
-						node.VisibleMark(BO_Partial);
-					}
-					return node.Visible();
-				});
+					node->VisibleMark(BO_Partial);
+				}
+			}
 		}
 		if (urt & App3DFramework::URV_NeedFlush)
 		{
@@ -505,26 +554,7 @@ namespace KlayGE
 			HashCombine(seed, camera.OmniDirectionalMode());
 			HashCombine(seed, &camera);
 
-			auto vmiter = visible_marks_map_.find(seed);
-			if (vmiter == visible_marks_map_.end())
-			{
-				this->ClipScene();
-
-				auto visible_marks = MakeUniquePtr<BoundOverlap[]>(scene_nodes.size());
-				for (size_t i = 0; i < scene_nodes.size(); ++ i)
-				{
-					visible_marks[i] = scene_nodes[i]->VisibleMark();
-				}
-
-				visible_marks_map_.emplace(seed, std::move(visible_marks));
-			}
-			else
-			{
-				for (size_t i = 0; i < scene_nodes.size(); ++ i)
-				{
-					scene_nodes[i]->VisibleMark(vmiter->second[i]);
-				}
-			}
+			this->LoadVisibleMarks(scene_nodes, seed);
 		}
 		if (urt & App3DFramework::URV_Overlay)
 		{
@@ -566,69 +596,112 @@ namespace KlayGE
 			}
 		}
 
-		std::sort(render_queue_.begin(), render_queue_.end(),
-			[](std::pair<RenderTechnique const *, std::vector<Renderable*>> const & lhs,
-				std::pair<RenderTechnique const *, std::vector<Renderable*>> const & rhs)
-			{
-				BOOST_ASSERT(lhs.first);
-				BOOST_ASSERT(rhs.first);
+		render_queue_.Sort(camera.ViewMatrix().Col(2));
+		for (auto* item : render_queue_.SortedItems())
+		{
+			item->Render();
+		}
+		num_renderables_rendered_ += static_cast<uint32_t>(render_queue_.NumItems());
+		render_queue_.Clear();
 
-				return lhs.first->Weight() < rhs.first->Weight();
-			});
+		num_primitives_rendered_ += re.NumPrimitivesJustRendered();
+		num_vertices_rendered_ += re.NumVerticesJustRendered();
+
+		all_overlay_nodes_.clear();
 
-		float4 const & view_mat_z = camera.ViewMatrix().Col(2);
-		for (auto& items : render_queue_)
+		urt_ = 0;
+	}
+
+	// Breadth first, so parents always come before their children and each depth level is a contiguous range
+	void SceneManager::FlattenScene()
+	{
+		if (!scene_hierarchy_dirty_)
 		{
-			if (!items.first->Transparent() && !items.first->HasDiscard() && (items.second.size() > 1))
+			return;
+		}
+
+		all_scene_nodes_.clear();
+		scene_level_offsets_.clear();
+
+		all_scene_nodes_.push_back(&scene_root_);
+		size_t level_begin = 0;
+		while (level_begin < all_scene_nodes_.size())
+		{
+			size_t const level_end = all_scene_nodes_.size();
+			scene_level_offsets_.push_back(level_begin);
+			for (size_t i = level_begin; i < level_end; ++ i)
 			{
-				std::vector<std::pair<float, uint32_t>> min_depths(items.second.size());
-				for (size_t j = 0; j < min_depths.size(); ++ j)
+				for (auto const & child : all_scene_nodes_[i]->Children())
 				{
-					Renderable const * renderable = items.second[j];
-					AABBox const & box = renderable->PosBound();
-					uint32_t const num = renderable->NumInstances();
-					float md = 1e10f;
-					for (uint32_t i = 0; i < num; ++ i)
-					{
-						float4x4 const & mat = renderable->GetInstance(i)->TransformToWorld();
-						float4 const zvec(MathLib::dot(mat.Row(0), view_mat_z),
-							MathLib::dot(mat.Row(1), view_mat_z), MathLib::dot(mat.Row(2), view_mat_z),
-							MathLib::dot(mat.Row(3), view_mat_z));
-						for (int k = 0; k < 8; ++ k)
-						{
-							float3 const v = box.Corner(k);
-							md = std::min(md, v.x() * zvec.x() + v.y() * zvec.y() + v.z() * zvec.z() + zvec.w());
-						}
-					}
-
-					min_depths[j] = std::make_pair(md, static_cast<uint32_t>(j));
+					all_scene_nodes_.push_back(child.get());
 				}
+			}
+			level_begin = level_end;
+		}
+		scene_level_offsets_.push_back(all_scene_nodes_.size());
 
-				std::sort(min_depths.begin(), min_depths.end());
+		scene_hierarchy_dirty_ = false;
+	}
 
-				std::vector<Renderable*> sorted_items(min_depths.size());
-				for (size_t j = 0; j < min_depths.size(); ++ j)
+	void SceneManager::PropagateTransforms()
+	{
+		for (size_t level = 0; level + 1 < scene_level_offsets_.size(); ++ level)
+		{
+			this->ParallelForNodes(scene_level_offsets_[level], scene_level_offsets_[level + 1],
+				[this](size_t begin, size_t end)
 				{
-					sorted_items[j] = items.second[min_depths[j].second];
-				}
-				items.second.swap(sorted_items);
-			}
+					for (size_t i = begin; i < end; ++ i)
+					{
+						all_scene_nodes_[i]->UpdateTransforms();
+					}
+				});
+		}
+	}
 
-			for (auto const & item : items.second)
-			{
-				item->Render();
-			}
-			num_renderables_rendered_ += static_cast<uint32_t>(items.second.size());
+	void SceneManager::PropagatePosBounds()
+	{
+		for (size_t level = scene_level_offsets_.size() - 1; level > 0; -- level)
+		{
+			this->ParallelForNodes(scene_level_offsets_[level - 1], scene_level_offsets_[level],
+				[this](size_t begin, size_t end)
+				{
+					for (size_t i = begin; i < end; ++ i)
+					{
+						all_scene_nodes_[i]->UpdatePosBound();
+					}
+				});
 		}
-		render_queue_.resize(0);
+	}
 
-		num_primitives_rendered_ += re.NumPrimitivesJustRendered();
-		num_vertices_rendered_ += re.NumVerticesJustRendered();
+	void SceneManager::ParallelForNodes(size_t begin, size_t end, std::function<void(size_t, size_t)> const & func)
+	{
+		size_t const MIN_NODES_PER_TASK = 1024;
 
-		all_scene_nodes_.clear();
-		all_overlay_nodes_.clear();
+		size_t const num_nodes = end - begin;
+		size_t num_tasks = (num_transform_threads_ > 0) ? num_transform_threads_ : std::max(std::thread::hardware_concurrency(), 1U);
+		num_tasks = std::min(num_tasks, std::max<size_t>(num_nodes / MIN_NODES_PER_TASK, 1));
 
-		urt_ = 0;
+		if (num_tasks <= 1)
+		{
+			func(begin, end);
+		}
+		else
+		{
+			size_t const nodes_per_task = (num_nodes + num_tasks - 1) / num_tasks;
+
+			std::vector<joiner<void>> joiners;
+			joiners.reserve(num_tasks - 1);
+			for (size_t task_begin = begin + nodes_per_task; task_begin < end; task_begin += nodes_per_task)
+			{
+				size_t const task_end = std::min(task_begin + nodes_per_task, end);
+				joiners.push_back(Context::Instance().ThreadPool()([&func, task_begin, task_end] { func(task_begin, task_end); }));
+			}
+			func(begin, std::min(begin + nodes_per_task, end));
+			for (auto& task_joiner : joiners)
+			{
+				task_joiner();
+			}
+		}
 	}
 
 	// ȡȾ
@@ -669,11 +742,65 @@ namespace KlayGE
 		return num_dispatch_calls_;
 	}
 
+	uint64_t SceneManager::NumVisibleMarksCacheHits() const
+	{
+		return visible_marks_hits_;
+	}
+
+	uint64_t SceneManager::NumVisibleMarksCacheMisses() const
+	{
+		return visible_marks_misses_;
+	}
+
+	void SceneManager::LoadVisibleMarks(std::vector<SceneNode*> const & scene_nodes, size_t seed)
+	{
+		++ visible_marks_clock_;
+
+		size_t const num_nodes = scene_nodes.size();
+		VisibleMarksEntry* lru_entry = &visible_marks_cache_[0];
+		for (auto& entry : visible_marks_cache_)
+		{
+			if ((entry.generation == visible_marks_generation_) && (entry.seed == seed) && (entry.num_nodes == num_nodes))
+			{
+				for (size_t i = 0; i < num_nodes; ++ i)
+				{
+					scene_nodes[i]->VisibleMark(static_cast<BoundOverlap>((entry.marks[i / 4] >> ((i & 3) * 2)) & 3));
+				}
+
+				entry.last_use = visible_marks_clock_;
+				++ visible_marks_hits_;
+				return;
+			}
+
+			// Stale entries go first, then the least recently used one
+			if ((entry.generation != visible_marks_generation_)
+				? ((lru_entry->generation == visible_marks_generation_) || (entry.last_use < lru_entry->last_use))
+				: ((lru_entry->generation == visible_marks_generation_) && (entry.last_use < lru_entry->last_use)))
+			{
+				lru_entry = &entry;
+			}
+		}
+
+		++ visible_marks_misses_;
+
+		this->ClipScene();
+
+		lru_entry->seed = seed;
+		lru_entry->num_nodes = num_nodes;
+		lru_entry->generation = visible_marks_generation_;
+		lru_entry->last_use = visible_marks_clock_;
+		lru_entry->marks.assign((num_nodes + 3) / 4, 0);
+		for (size_t i = 0; i < num_nodes; ++ i)
+		{
+			lru_entry->marks[i / 4] |= static_cast<uint8_t>(scene_nodes[i]->VisibleMark() << ((i & 3) * 2));
+		}
+	}
+
 	void SceneManager::FlushScene()
 	{
 		RenderEngine& re = Context::Instance().RenderFactoryInstance().RenderEngineInstance();
 
-		visible_marks_map_.clear();
+		++ visible_marks_generation_;
 
 		uint32_t urt;
 		App3DFramework& app = Context::Instance().AppInstance();
@@ -713,6 +840,10 @@ namespace KlayGE
 
 	void SceneManager::UpdateThreadFunc()
 	{
+#ifndef KLAYGE_SHIP
+		PerfProfiler::Instance().ThreadName("Scene update");
+#endif
+
 		Timer timer;
 		float app_time = 0;
 		while (!quit_)
@@ -726,10 +857,7 @@ namespace KlayGE
 				WindowPtr const & win = Context::Instance().AppInstance().MainWnd();
 				if (win && win->Active())
 				{
-					std::lock_guard<std::mutex> lock(update_mutex_);
-
-					scene_root_.SubThreadUpdateSubtree(app_time, frame_time);
-					overlay_root_.SubThreadUpdateSubtree(app_time, frame_time);
+					this->SubThreadUpdate(app_time, frame_time);
 				}
 
 				if (frame_time < update_elapse_)
@@ -740,6 +868,74 @@ namespace KlayGE
 		}
 	}
 
+	void SceneManager::SubThreadUpdate(float app_time, float elapsed_time)
+	{
+#ifndef KLAYGE_SHIP
+		PerfZone zone("SceneManager::SubThreadUpdate");
+#endif
+
+		std::lock_guard<std::mutex> sub_thread_lock(sub_thread_update_mutex_);
+
+		{
+			std::lock_guard<std::mutex> lock(update_mutex_);
+
+			for (auto* root : { &scene_root_, &overlay_root_ })
+			{
+				if (!root->OnSubThreadUpdate().Empty())
+				{
+					sub_thread_nodes_.emplace_back(root, SceneNodePtr());
+				}
+				root->Traverse([this](SceneNode& node)
+					{
+						for (auto const & child : node.Children())
+						{
+							if (!child->OnSubThreadUpdate().Empty())
+							{
+								sub_thread_nodes_.emplace_back(child.get(), child);
+							}
+						}
+						return true;
+					});
+			}
+
+			for (auto const & node : sub_thread_nodes_)
+			{
+				node.first->BeginSubThreadUpdate();
+			}
+		}
+
+		// Handlers can add the nodes they touch, so only the ones collected above are run
+		{
+			SubThreadUpdatingScope updating_scope;
+			for (size_t i = 0, num = sub_thread_nodes_.size(); i < num; ++ i)
+			{
+				sub_thread_nodes_[i].first->SubThreadUpdate(app_time, elapsed_time);
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(update_mutex_);
+
+			// A node already in the pending list is referenced there, so this reference is never the last one
+			for (auto& node : sub_thread_nodes_)
+			{
+				if (node.first->EndSubThreadUpdate())
+				{
+					pending_sub_thread_nodes_.push_back(std::move(node));
+				}
+			}
+			sub_thread_nodes_.clear();
+		}
+	}
+
+	void SceneManager::AddToSubThreadUpdate(SceneNode& node)
+	{
+		std::lock_guard<std::mutex> lock(update_mutex_);
+
+		node.BeginSubThreadUpdate();
+		sub_thread_nodes_.emplace_back(&node, node.weak_from_this().lock());
+	}
+
 	BoundOverlap SceneManager::VisibleTestFromParent(SceneNode const & node, float3 const & view_dir, float3 const & eye_pos,
 		float4x4 const & view_proj)
 	{
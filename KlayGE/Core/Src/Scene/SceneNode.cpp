@@ -39,6 +39,12 @@
 
 #include <KlayGE/SceneNode.hpp>
 
+namespace
+{
+	// Set while the sub thread update handlers run on this thread
+	thread_local bool in_sub_thread_update = false;
+}
+
 namespace KlayGE
 {
 	SceneNode::SceneNode(uint32_t attrib)
@@ -164,6 +170,8 @@ namespace KlayGE
 			pos_aabb_dirty_ = true;
 			node->Parent(this);
 			children_.push_back(node);
+
+			this->EmitSceneChanged(true);
 		}
 	}
 
@@ -176,7 +184,7 @@ namespace KlayGE
 			node->Parent(nullptr);
 			children_.erase(iter);
 
-			this->EmitSceneChanged();
+			this->EmitSceneChanged(true);
 		}
 	}
 
@@ -190,7 +198,7 @@ namespace KlayGE
 		pos_aabb_dirty_ = true;
 		children_.clear();
 
-		this->EmitSceneChanged();
+		this->EmitSceneChanged(true);
 	}
 
 	void SceneNode::MainThreadUpdateSubtree(float app_time, float elapsed_time)
@@ -275,41 +283,71 @@ namespace KlayGE
 
 	void SceneNode::TransformToParent(float4x4 const & mat)
 	{
-		xform_to_parent_ = mat;
-		pos_aabb_dirty_ = true;
+		if (auto* state = this->CurrentSubThreadState())
+		{
+			state->xform_to_parent = mat;
+			state->xform_to_world = mat * state->parent_xform_to_world;
+			if (pos_aabb_os_)
+			{
+				state->pos_aabb_ws = MathLib::transform_aabb(state->pos_aabb_os, state->xform_to_world);
+			}
+			state->xform_dirty = true;
+		}
+		else
+		{
+			xform_to_parent_ = mat;
+			pos_aabb_dirty_ = true;
+		}
 	}
 
 	void SceneNode::TransformToWorld(float4x4 const & mat)
 	{
-		if (parent_)
+		if (auto* state = this->CurrentSubThreadState())
 		{
-			xform_to_parent_ = mat * MathLib::inverse(parent_->TransformToWorld());
+			state->xform_to_parent = mat * MathLib::inverse(state->parent_xform_to_world);
+			state->xform_to_world = mat;
+			if (pos_aabb_os_)
+			{
+				state->pos_aabb_ws = MathLib::transform_aabb(state->pos_aabb_os, state->xform_to_world);
+			}
+			state->xform_dirty = true;
 		}
 		else
 		{
-			xform_to_parent_ = mat;
+			if (parent_)
+			{
+				xform_to_parent_ = mat * MathLib::inverse(parent_->TransformToWorld());
+			}
+			else
+			{
+				xform_to_parent_ = mat;
+			}
+			pos_aabb_dirty_ = true;
 		}
-		pos_aabb_dirty_ = true;
 	}
 
 	float4x4 const & SceneNode::TransformToParent() const
 	{
-		return xform_to_parent_;
+		auto const * state = this->CurrentSubThreadState();
+		return state ? state->xform_to_parent : xform_to_parent_;
 	}
 
 	float4x4 const & SceneNode::TransformToWorld() const
 	{
-		return xform_to_world_;
+		auto const * state = this->CurrentSubThreadState();
+		return state ? state->xform_to_world : xform_to_world_;
 	}
 
 	AABBox const & SceneNode::PosBoundOS() const
 	{
-		return *pos_aabb_os_;
+		auto const * state = this->CurrentSubThreadState();
+		return state ? state->pos_aabb_os : *pos_aabb_os_;
 	}
 
 	AABBox const & SceneNode::PosBoundWS() const
 	{
-		return *pos_aabb_ws_;
+		auto const * state = this->CurrentSubThreadState();
+		return state ? state->pos_aabb_ws : *pos_aabb_ws_;
 	}
 
 	void SceneNode::UpdateTransforms()
@@ -346,13 +384,103 @@ namespace KlayGE
 		sub_thread_update_event_(app_time, elapsed_time);
 	}
 
+	void SceneNode::BeginSubThreadUpdate()
+	{
+		if (!sub_thread_state_)
+		{
+			sub_thread_state_ = MakeUniquePtr<SubThreadState>();
+		}
+
+		// Changes the main thread hasn't applied yet are newer than the node's own state
+		auto& state = *sub_thread_state_;
+		state.parent_xform_to_world = parent_ ? parent_->xform_to_world_ : float4x4::Identity();
+		if (state.pending_xform)
+		{
+			state.xform_to_parent = state.pending_xform_to_parent;
+			state.xform_to_world = state.xform_to_parent * state.parent_xform_to_world;
+		}
+		else
+		{
+			state.xform_to_parent = xform_to_parent_;
+			state.xform_to_world = xform_to_world_;
+		}
+		if (pos_aabb_os_)
+		{
+			state.pos_aabb_os = *pos_aabb_os_;
+			state.pos_aabb_ws = *pos_aabb_ws_;
+		}
+		state.attrib = state.pending_attrib_dirty ? state.pending_attrib : attrib_;
+		state.xform_dirty = false;
+		state.attrib_dirty = false;
+		state.active = true;
+	}
+
+	bool SceneNode::EndSubThreadUpdate()
+	{
+		auto& state = *sub_thread_state_;
+		state.active = false;
+
+		if (state.xform_dirty)
+		{
+			state.pending_xform_to_parent = state.xform_to_parent;
+			state.pending_xform = true;
+		}
+		if (state.attrib_dirty)
+		{
+			state.pending_attrib = state.attrib;
+			state.pending_attrib_dirty = true;
+		}
+
+		bool const need_listing = !state.pending_listed;
+		state.pending_listed = true;
+		return need_listing;
+	}
+
+	void SceneNode::ApplySubThreadUpdate()
+	{
+		auto& state = *sub_thread_state_;
+		if (state.pending_xform)
+		{
+			xform_to_parent_ = state.pending_xform_to_parent;
+			pos_aabb_dirty_ = true;
+			state.pending_xform = false;
+		}
+		if (state.pending_attrib_dirty)
+		{
+			this->Visible(0 == (state.pending_attrib & SOA_Invisible));
+			state.pending_attrib_dirty = false;
+		}
+		state.pending_listed = false;
+	}
+
+	void SceneNode::SubThreadUpdating(bool updating)
+	{
+		in_sub_thread_update = updating;
+	}
+
+	// Null outside the sub thread update handlers. A node they touch for the first time in a pass joins it, so every change
+	// they make goes through the pending list.
+	SceneNode::SubThreadState* SceneNode::CurrentSubThreadState() const
+	{
+		if (!in_sub_thread_update)
+		{
+			return nullptr;
+		}
+
+		if (!sub_thread_state_ || !sub_thread_state_->active)
+		{
+			Context::Instance().SceneManagerInstance().AddToSubThreadUpdate(const_cast<SceneNode&>(*this));
+		}
+		return sub_thread_state_.get();
+	}
+
 	void SceneNode::MainThreadUpdate(float app_time, float elapsed_time)
 	{
 		main_thread_update_event_(app_time, elapsed_time);
 
 		if (!updated_)
 		{
-			this->EmitSceneChanged();
+			this->EmitSceneChanged(false);
 
 			updated_ = true;
 		}
@@ -360,28 +488,45 @@ namespace KlayGE
 
 	uint32_t SceneNode::Attrib() const
 	{
-		return attrib_;
+		auto const * state = this->CurrentSubThreadState();
+		return state ? state->attrib : attrib_;
 	}
 
 	bool SceneNode::Visible() const
 	{
-		return (0 == (attrib_ & SOA_Invisible));
+		return (0 == (this->Attrib() & SOA_Invisible));
 	}
 
 	void SceneNode::Visible(bool vis)
 	{
-		if (vis)
+		if (auto* state = this->CurrentSubThreadState())
 		{
-			attrib_ &= ~SOA_Invisible;
+			// Children follow when it's written back
+			if (vis)
+			{
+				state->attrib &= ~SOA_Invisible;
+			}
+			else
+			{
+				state->attrib |= SOA_Invisible;
+			}
+			state->attrib_dirty = true;
 		}
 		else
 		{
-			attrib_ |= SOA_Invisible;
-		}
+			if (vis)
+			{
+				attrib_ &= ~SOA_Invisible;
+			}
+			else
+			{
+				attrib_ |= SOA_Invisible;
+			}
 
-		for (auto const & child : children_)
-		{
-			child->Visible(vis);
+			for (auto const & child : children_)
+			{
+				child->Visible(vis);
+			}
 		}
 	}
 
@@ -515,6 +660,12 @@ namespace KlayGE
 			child->UpdatePosBoundSubtree();
 		}
 
+		this->UpdatePosBound();
+	}
+
+	// Children's bounds have to be up to date
+	void SceneNode::UpdatePosBound()
+	{
 		if (pos_aabb_dirty_)
 		{
 			if (pos_aabb_os_)
@@ -551,7 +702,7 @@ namespace KlayGE
 		}
 	}
 
-	void SceneNode::EmitSceneChanged()
+	void SceneNode::EmitSceneChanged(bool hierarchy_changed)
 	{
 		auto& context = Context::Instance();
 		if (context.SceneManagerValid())
@@ -565,6 +716,10 @@ namespace KlayGE
 			auto& scene_mgr = context.SceneManagerInstance();
 			if (node == &scene_mgr.SceneRootNode())
 			{
+				if (hierarchy_changed)
+				{
+					scene_mgr.OnHierarchyChanged();
+				}
 				scene_mgr.OnSceneChanged();
 			}
 		}
@@ -37,6 +37,7 @@
 #include <KlayGE/App3D.hpp>
 #include <KlayGE/Window.hpp>
 
+#include <algorithm>
 #include <cstring>
 #include <fstream>
 #include <mutex>
@@ -96,26 +97,8 @@ namespace KlayGE
 		{
 			RenderFactory& rf = Context::Instance().RenderFactoryInstance();
 
-			restart_ = rf.RenderEngineInstance().DeviceCaps().primitive_restart_support;
-
 			rls_[0] = rf.MakeRenderLayout();
-			if (restart_)
-			{
-				rls_[0]->TopologyType(RenderLayout::TT_TriangleStrip);
-			}
-			else
-			{
-				rls_[0]->TopologyType(RenderLayout::TT_TriangleList);
-			}
-
-			uint32_t const INDEX_PER_QUAD = restart_ ? 5 : 6;
-			uint32_t const INIT_NUM_QUAD = 1024;
-			tb_vb_ = MakeUniquePtr<TransientBuffer>(static_cast<uint32_t>(INIT_NUM_QUAD * 4 * sizeof(UIManager::VertexFormat)), TransientBuffer::BF_Vertex);
-			tb_ib_ = MakeUniquePtr<TransientBuffer>(static_cast<uint32_t>(INIT_NUM_QUAD * INDEX_PER_QUAD * sizeof(uint16_t)), TransientBuffer::BF_Index);
-
-			rls_[0]->BindVertexStream(tb_vb_->GetBuffer(), { VertexElement(VEU_Position, 0, EF_BGR32F),
-				VertexElement(VEU_Diffuse, 0, EF_ABGR32F), VertexElement(VEU_TextureCoord, 0, EF_GR32F) });
-			rls_[0]->BindIndexStream(tb_ib_->GetBuffer(), EF_R16UI);
+			rls_[0]->TopologyType(RenderLayout::TT_TriangleList);
 
 			effect_ = effect;
 			if (texture)
@@ -132,9 +115,35 @@ namespace KlayGE
 			dpi_scale_ep_ = effect->ParameterByName("dpi_scale");
 		}
 
-		bool Empty() const
+		// Only called when the owner's geometry has changed. The vertex buffer grows but never shrinks.
+		void UpdateQuads(std::vector<UIManager::VertexFormat> const & vertices, GraphicsBufferPtr const & quad_ib)
 		{
-			return tb_ib_sub_allocs_.empty();
+			BOOST_ASSERT(vertices.size() % 4 == 0);
+
+			uint32_t const size = static_cast<uint32_t>(vertices.size() * sizeof(vertices[0]));
+			if (!vb_ || (vb_->Size() < size))
+			{
+				uint32_t const INIT_NUM_QUAD = 64;
+				uint32_t new_size = std::max(vb_ ? vb_->Size() : 0U, static_cast<uint32_t>(INIT_NUM_QUAD * 4 * sizeof(vertices[0])));
+				while (new_size < size)
+				{
+					new_size *= 2;
+				}
+
+				RenderFactory& rf = Context::Instance().RenderFactoryInstance();
+				vb_ = rf.MakeVertexBuffer(BU_Dynamic, EAH_CPU_Write | EAH_GPU_Read, new_size, nullptr);
+				rls_[0]->BindVertexStream(vb_, { VertexElement(VEU_Position, 0, EF_BGR32F),
+					VertexElement(VEU_Diffuse, 0, EF_ABGR32F), VertexElement(VEU_TextureCoord, 0, EF_GR32F) });
+			}
+			{
+				GraphicsBuffer::Mapper mapper(*vb_, BA_Write_Only);
+				std::copy(vertices.begin(), vertices.end(), mapper.Pointer<UIManager::VertexFormat>());
+			}
+
+			rls_[0]->BindIndexStream(quad_ib, EF_R32UI);
+			rls_[0]->NumVertices(static_cast<uint32_t>(vertices.size()));
+			rls_[0]->StartIndexLocation(0);
+			rls_[0]->NumIndices(static_cast<uint32_t>(vertices.size() / 4 * 6));
 		}
 
 		void OnRenderBegin()
@@ -149,21 +158,6 @@ namespace KlayGE
 
 			*half_width_height_ep_ = float2(half_width, half_height);
 			*dpi_scale_ep_ = Context::Instance().AppInstance().MainWnd()->DPIScale();
-
-			tb_vb_->EnsureDataReady();
-			tb_ib_->EnsureDataReady();
-
-			rls_[0]->SetVertexStream(0, tb_vb_->GetBuffer());
-			rls_[0]->BindIndexStream(tb_ib_->GetBuffer(), EF_R16UI);
-		}
-		
-		void OnRenderEnd()
-		{
-			tb_vb_->OnPresent();
-			tb_ib_->OnPresent();
-
-			tb_vb_sub_allocs_.clear();
-			tb_ib_sub_allocs_.clear();
 		}
 
 		void Render()
@@ -171,80 +165,141 @@ namespace KlayGE
 			RenderEngine& re = Context::Instance().RenderFactoryInstance().RenderEngineInstance();
 
 			this->OnRenderBegin();
+			re.Render(*this->GetRenderEffect(), *this->GetRenderTechnique(), *rls_[0]);
+		}
 
-			BOOST_ASSERT(tb_vb_sub_allocs_.size() == tb_ib_sub_allocs_.size());
+	private:
+		RenderEffectParameter* dpi_scale_ep_;
+		RenderEffectParameter* ui_tex_ep_;
+		RenderEffectParameter* half_width_height_ep_;
 
-			for (size_t i = 0; i < tb_vb_sub_allocs_.size(); ++ i)
-			{
-				uint32_t vert_length = tb_vb_sub_allocs_[i].length_;
-				uint32_t const ind_offset = tb_ib_sub_allocs_[i].offset_;
-				uint32_t ind_length = tb_ib_sub_allocs_[i].length_;
+		TexturePtr texture_;
 
-				while ((i + 1 < tb_vb_sub_allocs_.size())
-					&& (tb_vb_sub_allocs_[i].offset_ + tb_vb_sub_allocs_[i].length_ == tb_vb_sub_allocs_[i + 1].offset_)
-					&& (tb_ib_sub_allocs_[i].offset_ + tb_ib_sub_allocs_[i].length_ == tb_ib_sub_allocs_[i + 1].offset_))
-				{
-					vert_length += tb_vb_sub_allocs_[i + 1].length_;
-					ind_length += tb_ib_sub_allocs_[i + 1].length_;
-					++ i;
-				}
+		GraphicsBufferPtr vb_;
+	};
+
+	// Everything a dialog draws in UIDialog::Render. It's kept across frames, and re-emitted only when the dialog is
+	// invalidated or has an animating control. Each batch keeps its renderable and overlay scene node alive.
+	class UIGeometry : boost::noncopyable
+	{
+		struct Batch
+		{
+			TexturePtr texture;
+			std::vector<UIManager::VertexFormat> vertices;
+			std::shared_ptr<UIRectRenderable> renderable;
+			SceneNodePtr node;
+		};
 
-				rls_[0]->NumVertices(vert_length / sizeof(UIManager::VertexFormat));
-				rls_[0]->StartIndexLocation(ind_offset / sizeof(uint16_t));
-				rls_[0]->NumIndices(ind_length / sizeof(uint16_t));
+		struct StringCache
+		{
+			Rect rc;
+			float depth;
+			Color clr;
+			std::wstring text;
+			uint32_t align;
+			uint32_t font_index;
+		};
+
+	public:
+		UIGeometry()
+			: dirty_(true)
+		{
+		}
 
-				re.Render(*this->GetRenderEffect(), *this->GetRenderTechnique(), *rls_[0]);
+		void Clear()
+		{
+			for (auto& batch : batches_)
+			{
+				batch.vertices.clear();
 			}
+			strings_.clear();
+			dirty_ = true;
+		}
 
-			for (size_t i = 0; i < tb_vb_sub_allocs_.size(); ++ i)
+		// Returns the 4 vertices to fill
+		UIManager::VertexFormat* AddQuad(TexturePtr const & texture)
+		{
+			auto iter = std::find_if(batches_.begin(), batches_.end(),
+				[&texture](Batch const & batch)
+				{
+					return batch.texture == texture;
+				});
+			if (iter == batches_.end())
 			{
-				tb_vb_->Dealloc(tb_vb_sub_allocs_[i]);
-				tb_ib_->Dealloc(tb_ib_sub_allocs_[i]);
+				batches_.emplace_back();
+				batches_.back().texture = texture;
+				iter = batches_.end() - 1;
 			}
 
-			this->OnRenderEnd();
+			auto& vertices = iter->vertices;
+			vertices.resize(vertices.size() + 4);
+			return &vertices[vertices.size() - 4];
 		}
 
-		void AddQuad(std::vector<UIManager::VertexFormat> const & vertices)
+		void AddString(std::wstring const & text, uint32_t font_index, Rect const & rc, float depth, Color const & clr, uint32_t align)
 		{
-			tb_vb_sub_allocs_.push_back(tb_vb_->Alloc(static_cast<uint32_t>(vertices.size() * sizeof(vertices[0])), &vertices[0]));
-			
-			uint16_t const last_index = static_cast<uint16_t>(tb_vb_sub_allocs_.back().offset_ / sizeof(UIManager::VertexFormat));
-			std::vector<uint16_t> indices;
-			indices.resize(restart_ ? 5 : 6);
-			indices[0] = last_index + 0;
-			indices[1] = last_index + 1;
-			if (restart_)
+			strings_.emplace_back();
+			auto& sc = strings_.back();
+			sc.rc = rc;
+			sc.depth = depth;
+			sc.clr = clr;
+			sc.text = text;
+			sc.align = align;
+			sc.font_index = font_index;
+		}
+
+		uint32_t MaxBatchQuads() const
+		{
+			size_t num_quads = 0;
+			for (auto const & batch : batches_)
 			{
-				indices[2] = last_index + 3;
-				indices[3] = last_index + 2;
-				indices[4] = 0xFFFF;
+				num_quads = std::max(num_quads, batch.vertices.size() / 4);
 			}
-			else
+			return static_cast<uint32_t>(num_quads);
+		}
+
+		// Uploads the quads if they have changed since the last call, and adds this frame's overlay nodes and text
+		void Submit(RenderEffectPtr const & effect, GraphicsBufferPtr const & quad_ib,
+			std::vector<std::pair<FontPtr, float>> const & fonts)
+		{
+			if (dirty_)
 			{
-				indices[2] = last_index + 2;
-				indices[3] = last_index + 2;
-				indices[4] = last_index + 3;
-				indices[5] = last_index + 0;
-			}
-			BOOST_ASSERT(last_index + 3 <= 0xFFFF);
+				batches_.erase(std::remove_if(batches_.begin(), batches_.end(),
+					[](Batch const & batch)
+					{
+						return batch.vertices.empty();
+					}), batches_.end());
 
-			tb_ib_sub_allocs_.push_back(tb_ib_->Alloc(static_cast<uint32_t>(indices.size() * sizeof(indices[0])), &indices[0]));
-		}
+				for (auto& batch : batches_)
+				{
+					if (!batch.renderable)
+					{
+						batch.renderable = MakeSharedPtr<UIRectRenderable>(batch.texture, effect);
+						batch.node = MakeSharedPtr<SceneNode>(batch.renderable, SceneNode::SOA_Overlay);
+					}
+					batch.renderable->UpdateQuads(batch.vertices, quad_ib);
+				}
 
-	private:
-		bool restart_;
+				dirty_ = false;
+			}
 
-		RenderEffectParameter* dpi_scale_ep_;
-		RenderEffectParameter* ui_tex_ep_;
-		RenderEffectParameter* half_width_height_ep_;
+			auto& overlay_root = Context::Instance().SceneManagerInstance().OverlayRootNode();
+			for (auto const & batch : batches_)
+			{
+				overlay_root.AddChild(batch.node);
+			}
 
-		TexturePtr texture_;
+			for (auto const & s : strings_)
+			{
+				auto const & font = fonts[s.font_index];
+				font.first->RenderText(s.rc, s.depth, 1, 1, s.clr, s.text, font.second, s.align);
+			}
+		}
 
-		std::unique_ptr<TransientBuffer> tb_vb_;
-		std::unique_ptr<TransientBuffer> tb_ib_;
-		std::vector<SubAlloc> tb_vb_sub_allocs_;
-		std::vector<SubAlloc> tb_ib_sub_allocs_;
+	private:
+		std::vector<Batch> batches_;
+		std::vector<StringCache> strings_;
+		bool dirty_;
 	};
 
 
@@ -300,7 +355,9 @@ namespace KlayGE
 
 
 	UIManager::UIManager()
-		: mouse_on_ui_(false),
+		: atlas_cursor_(0, 0), atlas_shelf_height_(0),
+			quad_ib_capacity_(0), curr_geometry_(nullptr),
+			mouse_on_ui_(false),
 			inited_(false)
 	{
 	}
@@ -920,31 +977,153 @@ namespace KlayGE
 
 	void UIManager::Render()
 	{
-		for (auto& str : strings_)
+		for (auto const & dialog : dialogs_)
 		{
-			str.second.clear();
+			UIGeometry& geometry = *dialog->geometry_;
+			if (dialog->geometry_dirty_ || dialog->IsAnimating())
+			{
+				geometry.Clear();
+
+				curr_geometry_ = &geometry;
+				dialog->Render();
+				curr_geometry_ = nullptr;
+
+				dialog->geometry_dirty_ = false;
+			}
+
+			geometry.Submit(effect_, this->QuadIndices(geometry.MaxBatchQuads()), font_cache_);
 		}
 
-		for (auto const & dialog : dialogs_)
+		if (immediate_geometry_)
 		{
-			dialog->Render();
+			immediate_geometry_->Submit(effect_, this->QuadIndices(immediate_geometry_->MaxBatchQuads()), font_cache_);
+			immediate_geometry_->Clear();
 		}
+	}
 
-		for (auto const & rect : rects_)
+	UIGeometry& UIManager::CurrGeometry()
+	{
+		if (curr_geometry_)
+		{
+			return *curr_geometry_;
+		}
+		else
 		{
-			if (!checked_pointer_cast<UIRectRenderable>(rect.second)->Empty())
+			if (!immediate_geometry_)
 			{
-				auto ui_rect_obj = MakeSharedPtr<SceneNode>(rect.second, SceneNode::SOA_Overlay);
-				Context::Instance().SceneManagerInstance().OverlayRootNode().AddChild(ui_rect_obj);
+				immediate_geometry_ = MakeUniquePtr<UIGeometry>();
 			}
+			return *immediate_geometry_;
 		}
-		for (auto const & str : strings_)
+	}
+
+	GraphicsBufferPtr const & UIManager::QuadIndices(uint32_t num_quads)
+	{
+		if (num_quads > quad_ib_capacity_)
 		{
-			auto const & font = font_cache_[str.first];
-			for (auto const & s : str.second)
+			uint32_t capacity = std::max(quad_ib_capacity_, 1024U);
+			while (capacity < num_quads)
 			{
-				font.first->RenderText(s.rc, s.depth, 1, 1, s.clr, s.text, font.second, s.align);
+				capacity *= 2;
+			}
+
+			std::vector<uint32_t> indices(capacity * 6);
+			for (uint32_t i = 0; i < capacity; ++ i)
+			{
+				uint32_t const base = i * 4;
+				indices[i * 6 + 0] = base + 0;
+				indices[i * 6 + 1] = base + 1;
+				indices[i * 6 + 2] = base + 2;
+				indices[i * 6 + 3] = base + 2;
+				indices[i * 6 + 4] = base + 3;
+				indices[i * 6 + 5] = base + 0;
+			}
+
+			RenderFactory& rf = Context::Instance().RenderFactoryInstance();
+			quad_ib_ = rf.MakeIndexBuffer(BU_Static, EAH_GPU_Read | EAH_Immutable,
+				static_cast<uint32_t>(indices.size() * sizeof(indices[0])), &indices[0]);
+			quad_ib_capacity_ = capacity;
+		}
+
+		return quad_ib_;
+	}
+
+	UIManager::AtlasRegion const & UIManager::PackIntoAtlas(TexturePtr const & texture)
+	{
+		uint32_t const ATLAS_GUTTER = 2;
+		uint32_t const WHITE_SIZE = 4;
+
+		if (!atlas_tex_)
+		{
+			RenderFactory& rf = Context::Instance().RenderFactoryInstance();
+			RenderDeviceCaps const & caps = rf.RenderEngineInstance().DeviceCaps();
+			uint32_t const size = std::min(2048U, std::min(caps.max_texture_width, caps.max_texture_height));
+			ElementFormat const fmt = caps.TextureFormatSupport(EF_ABGR8) ? EF_ABGR8 : EF_ARGB8;
+			atlas_tex_ = rf.MakeTexture2D(size, size, 1, 1, fmt, 1, 0, EAH_GPU_Read);
+
+			// A white block in the corner, for the quads without texture
+			std::array<uint32_t, WHITE_SIZE * WHITE_SIZE> white;
+			white.fill(0xFFFFFFFF);
+			atlas_tex_->UpdateSubresource2D(0, 0, 0, 0, WHITE_SIZE, WHITE_SIZE, &white[0], WHITE_SIZE * sizeof(white[0]));
+			atlas_white_tc_ = float2(WHITE_SIZE / 2.0f / size, WHITE_SIZE / 2.0f / size);
+			atlas_regions_.emplace(TexturePtr(), AtlasRegion{ true, int2(0, 0) });
+
+			atlas_cursor_ = int2(WHITE_SIZE + ATLAS_GUTTER, 0);
+			atlas_shelf_height_ = WHITE_SIZE + ATLAS_GUTTER;
+		}
+
+		auto iter = atlas_regions_.find(texture);
+		if (iter == atlas_regions_.end())
+		{
+			AtlasRegion region = { false, int2(0, 0) };
+
+			// Only immutable textures are copied, the contents of the others can change after packing
+			uint32_t const atlas_size = atlas_tex_->Width(0);
+			if ((Texture::TT_2D == texture->Type()) && (1 == texture->ArraySize()) && (texture->AccessHint() & EAH_Immutable)
+				&& (texture->Width(0) <= atlas_size / 2) && (texture->Height(0) <= atlas_size / 2))
+			{
+				int const width = static_cast<int>(texture->Width(0) + ATLAS_GUTTER);
+				int const height = static_cast<int>(texture->Height(0) + ATLAS_GUTTER);
+
+				// Shelf packing. Skins are added rarely, so nothing smarter is needed.
+				if (atlas_cursor_.x() + width > static_cast<int>(atlas_size))
+				{
+					atlas_cursor_ = int2(0, atlas_cursor_.y() + atlas_shelf_height_);
+					atlas_shelf_height_ = 0;
+				}
+				if (atlas_cursor_.y() + height <= static_cast<int>(atlas_size))
+				{
+					region.packed = true;
+					region.offset = atlas_cursor_;
+
+					texture->CopyToSubTexture2D(*atlas_tex_, 0, 0, region.offset.x(), region.offset.y(),
+						texture->Width(0), texture->Height(0),
+						0, 0, 0, 0, texture->Width(0), texture->Height(0));
+
+					atlas_cursor_.x() += width;
+					atlas_shelf_height_ = std::max(atlas_shelf_height_, height);
+				}
 			}
+
+			iter = atlas_regions_.emplace(texture, region).first;
+		}
+
+		return iter->second;
+	}
+
+	float2 UIManager::AtlasTexcoord(TexturePtr const & texture, AtlasRegion const & region, float2 const & tc) const
+	{
+		BOOST_ASSERT(region.packed);
+
+		if (texture)
+		{
+			float const atlas_size = static_cast<float>(atlas_tex_->Width(0));
+			return float2((region.offset.x() + tc.x() * texture->Width(0)) / atlas_size,
+				(region.offset.y() + tc.y() * texture->Height(0)) / atlas_size);
+		}
+		else
+		{
+			return atlas_white_tc_;
 		}
 	}
 
@@ -964,19 +1143,15 @@ namespace KlayGE
 			texcoord = Rect(0, 0, 0, 0);
 		}
 
-		std::shared_ptr<UIRectRenderable> renderable;
-		if (rects_.find(texture) == rects_.end())
-		{
-			renderable = MakeSharedPtr<UIRectRenderable>(texture, effect_);
-			rects_[texture] = renderable;
-		}
-		else
+		AtlasRegion const & region = this->PackIntoAtlas(texture);
+		if (region.packed)
 		{
-			renderable = checked_pointer_cast<UIRectRenderable>(rects_[texture]);
+			float2 const left_top = this->AtlasTexcoord(texture, region, float2(texcoord.left(), texcoord.top()));
+			float2 const right_bottom = this->AtlasTexcoord(texture, region, float2(texcoord.right(), texcoord.bottom()));
+			texcoord = Rect(left_top.x(), left_top.y(), right_bottom.x(), right_bottom.y());
 		}
-		BOOST_ASSERT(renderable);
 
-		std::vector<VertexFormat> vertices(4);
+		VertexFormat* vertices = this->CurrGeometry().AddQuad(region.packed ? atlas_tex_ : texture);
 		vertices[0] = VertexFormat(pos + float3(0, 0, 0),
 			clrs[0], float2(texcoord.left(), texcoord.top()));
 		vertices[1] = VertexFormat(pos + float3(width, 0, 0),
@@ -985,47 +1160,24 @@ namespace KlayGE
 			clrs[2], float2(texcoord.right(), texcoord.bottom()));
 		vertices[3] = VertexFormat(pos + float3(0, height, 0),
 			clrs[3], float2(texcoord.left(), texcoord.bottom()));
-
-		renderable->AddQuad(vertices);
 	}
 
 	void UIManager::DrawQuad(float3 const & offset, VertexFormat const * vertices, TexturePtr const & texture)
 	{
-		std::shared_ptr<UIRectRenderable> renderable;
-		if (rects_.find(texture) == rects_.end())
-		{
-			renderable = MakeSharedPtr<UIRectRenderable>(texture, effect_);
-			rects_[texture] = renderable;
-		}
-		else
+		AtlasRegion const & region = this->PackIntoAtlas(texture);
+
+		VertexFormat* verts = this->CurrGeometry().AddQuad(region.packed ? atlas_tex_ : texture);
+		for (uint32_t i = 0; i < 4; ++ i)
 		{
-			renderable = checked_pointer_cast<UIRectRenderable>(rects_[texture]);
+			verts[i] = VertexFormat(offset + vertices[i].pos, vertices[i].clr,
+				region.packed ? this->AtlasTexcoord(texture, region, vertices[i].tex) : vertices[i].tex);
 		}
-		BOOST_ASSERT(renderable);
-
-		std::vector<VertexFormat> verts(4);
-		verts[0] = VertexFormat(offset + vertices[0].pos,
-			vertices[0].clr, vertices[0].tex);
-		verts[1] = VertexFormat(offset + vertices[1].pos,
-			vertices[1].clr, vertices[1].tex);
-		verts[2] = VertexFormat(offset + vertices[2].pos,
-			vertices[2].clr, vertices[2].tex);
-		verts[3] = VertexFormat(offset + vertices[3].pos,
-			vertices[3].clr, vertices[3].tex);
-
-		renderable->AddQuad(verts);
 	}
 
 	void UIManager::DrawString(std::wstring const & strText, uint32_t font_index,
 		IRect const & rc, float depth, Color const & clr, uint32_t align)
 	{
-		strings_[font_index].push_back(string_cache());
-		string_cache& sc = strings_[font_index].back();
-		sc.rc = rc;
-		sc.depth = depth;
-		sc.clr = clr;
-		sc.text = strText;
-		sc.align = align;
+		this->CurrGeometry().AddString(strText, font_index, Rect(rc), depth, clr, align);
 	}
 
 	Size_T<float> UIManager::CalcSize(std::wstring const & strText, uint32_t font_index,
@@ -1224,6 +1376,16 @@ namespace KlayGE
 	}
 
 
+	void UIControl::Invalidate()
+	{
+		UIDialogPtr dialog = dialog_.lock();
+		if (dialog)
+		{
+			dialog->Invalidate();
+		}
+	}
+
+
 	UIDialog::UIDialog(TexturePtr const & control_tex)
 			: keyboard_input_(false), mouse_input_(true),
 					visible_(true), show_caption_(true),
@@ -1232,7 +1394,8 @@ namespace KlayGE
 					caption_height_(18),
 					top_left_clr_(0, 0, 0, 0), top_right_clr_(0, 0, 0, 0),
 					bottom_left_clr_(0, 0, 0, 0), bottom_right_clr_(0, 0, 0, 0),
-					opacity_(0.5f)
+					opacity_(0.5f),
+					geometry_(MakeUniquePtr<UIGeometry>()), geometry_dirty_(true)
 	{
 		TexturePtr ct;
 		if (control_tex)
@@ -1270,6 +1433,7 @@ namespace KlayGE
 
 		// Add to the list
 		controls_.push_back(control);
+		this->Invalidate();
 	}
 
 	void UIDialog::InitControl(UIControl& control)
@@ -1355,6 +1519,20 @@ namespace KlayGE
 		control->SetEnabled(enabled);
 	}
 
+	bool UIDialog::IsAnimating() const
+	{
+		if (!visible_ || minimized_)
+		{
+			return false;
+		}
+
+		return std::any_of(controls_.begin(), controls_.end(),
+			[](UIControlPtr const & control)
+			{
+				return control->GetVisible() && control->IsAnimating();
+			});
+	}
+
 	void UIDialog::Render()
 	{
 		// For invisible dialog, out now.
@@ -1508,6 +1686,8 @@ namespace KlayGE
 
 			control.OnFocusIn();
 			control_focus_ = control.shared_from_this();
+
+			this->Invalidate();
 		}
 	}
 
@@ -1523,6 +1703,7 @@ namespace KlayGE
 		top_right_clr_ = colorTopRight;
 		bottom_left_clr_ = colorBottomLeft;
 		bottom_right_clr_ = colorBottomRight;
+		this->Invalidate();
 	}
 
 	bool UIDialog::ContainsPoint(int2 const & pt) const
@@ -1553,6 +1734,8 @@ namespace KlayGE
 		{
 			control_focus_.lock()->OnFocusOut();
 			control_focus_.reset();
+
+			this->Invalidate();
 		}
 	}
 
@@ -1632,6 +1815,7 @@ namespace KlayGE
 				}
 
 				controls_.erase(controls_.begin() + i);
+				this->Invalidate();
 
 				return;
 			}
@@ -1647,6 +1831,7 @@ namespace KlayGE
 		control_mouse_over_.reset();
 
 		controls_.clear();
+		this->Invalidate();
 	}
 
 	// Device state notification
@@ -1671,6 +1856,8 @@ namespace KlayGE
 		{
 			this->FocusDefaultControl();
 		}
+
+		this->Invalidate();
 	}
 
 	// Shared resource access. Indexed fonts and textures are shared among
@@ -1683,6 +1870,7 @@ namespace KlayGE
 			fonts_.resize(index + 1, -1);
 		}
 		fonts_[index] = static_cast<int>(UIManager::Instance().AddFont(font, font_size));
+		this->Invalidate();
 	}
 
 	FontPtr const & UIDialog::GetFont(size_t index) const
@@ -1708,6 +1896,7 @@ namespace KlayGE
 				// Give focus to the default control
 				control_focus_ = control;
 				control->OnFocusIn();
+				this->Invalidate();
 
 				break;
 			}
@@ -1957,6 +2146,7 @@ namespace KlayGE
 		if (control_focus_.lock() && control_focus_.lock()->GetEnabled())
 		{
 			control_focus_.lock()->KeyDownHandler(*this, key);
+			this->Invalidate();
 		}
 		else
 		{
@@ -1971,6 +2161,7 @@ namespace KlayGE
 					if (control->GetHotkey() == static_cast<uint8_t>(key & 0xFF))
 					{
 						control->OnHotkey();
+						this->Invalidate();
 						handled = true;
 						break;
 					}
@@ -2004,14 +2195,7 @@ namespace KlayGE
 			}
 		}
 
-		if (control_focus_.lock() || control_mouse_over_.lock())
-		{
-			opacity_ = 1.0f;
-		}
-		else
-		{
-			opacity_ = 0.5f;
-		}
+		this->UpdateOpacity(control_focus_.lock() || control_mouse_over_.lock());
 	}
 
 	void UIDialog::KeyUpHandler(uint32_t key)
@@ -2019,16 +2203,10 @@ namespace KlayGE
 		if (control_focus_.lock() && control_focus_.lock()->GetEnabled())
 		{
 			control_focus_.lock()->KeyUpHandler(*this, key);
+			this->Invalidate();
 		}
 
-		if (control_focus_.lock() || control_mouse_over_.lock())
-		{
-			opacity_ = 1.0f;
-		}
-		else
-		{
-			opacity_ = 0.5f;
-		}
+		this->UpdateOpacity(control_focus_.lock() || control_mouse_over_.lock());
 	}
 
 	void UIDialog::MouseDownHandler(uint32_t buttons, int2 const & pt)
@@ -2050,6 +2228,7 @@ namespace KlayGE
 		if (control)
 		{
 			control->MouseDownHandler(*this, buttons, local_pt);
+			this->Invalidate();
 		}
 		else
 		{
@@ -2057,17 +2236,11 @@ namespace KlayGE
 			{
 				control_focus_.lock()->OnFocusOut();
 				control_focus_.reset();
+				this->Invalidate();
 			}
 		}
 
-		if (this->ContainsPoint(pt) || control_focus_.lock() || control_mouse_over_.lock())
-		{
-			opacity_ = 1.0f;
-		}
-		else
-		{
-			opacity_ = 0.5f;
-		}
+		this->UpdateOpacity(this->ContainsPoint(pt) || control_focus_.lock() || control_mouse_over_.lock());
 	}
 
 	void UIDialog::MouseUpHandler(uint32_t buttons, int2 const & pt)
@@ -2089,6 +2262,7 @@ namespace KlayGE
 		if (control)
 		{
 			control->MouseUpHandler(*this, buttons, local_pt);
+			this->Invalidate();
 		}
 		else
 		{
@@ -2096,17 +2270,11 @@ namespace KlayGE
 			{
 				control_focus_.lock()->OnFocusOut();
 				control_focus_.reset();
+				this->Invalidate();
 			}
 		}
 
-		if (this->ContainsPoint(pt) || control_focus_.lock() || control_mouse_over_.lock())
-		{
-			opacity_ = 1.0f;
-		}
-		else
-		{
-			opacity_ = 0.5f;
-		}
+		this->UpdateOpacity(this->ContainsPoint(pt) || control_focus_.lock() || control_mouse_over_.lock());
 	}
 
 	void UIDialog::MouseWheelHandler(uint32_t buttons, int2 const & pt, int32_t z_delta)
@@ -2128,6 +2296,7 @@ namespace KlayGE
 		if (control)
 		{
 			control->MouseWheelHandler(*this, buttons, local_pt, z_delta);
+			this->Invalidate();
 		}
 		else
 		{
@@ -2135,17 +2304,11 @@ namespace KlayGE
 			{
 				control_focus_.lock()->OnFocusOut();
 				control_focus_.reset();
+				this->Invalidate();
 			}
 		}
 
-		if (this->ContainsPoint(pt) || control_focus_.lock() || control_mouse_over_.lock())
-		{
-			opacity_ = 1.0f;
-		}
-		else
-		{
-			opacity_ = 0.5f;
-		}
+		this->UpdateOpacity(this->ContainsPoint(pt) || control_focus_.lock() || control_mouse_over_.lock());
 	}
 
 	void UIDialog::MouseOverHandler(uint32_t buttons, int2 const & pt)
@@ -2177,21 +2340,30 @@ namespace KlayGE
 				{
 					control->OnMouseEnter();
 				}
+
+				this->Invalidate();
 			}
 		}
 
 		if (control)
 		{
 			control->MouseOverHandler(*this, buttons, local_pt);
+			this->Invalidate();
 		}
 
-		if (this->ContainsPoint(pt) || control_focus_.lock() || control_mouse_over_.lock())
-		{
-			opacity_ = 1.0f;
-		}
-		else
+		this->UpdateOpacity(this->ContainsPoint(pt) || control_focus_.lock() || control_mouse_over_.lock());
+	}
+
+	void UIDialog::UpdateOpacity(bool active)
+	{
+		float const opacity = active ? 1.0f : 0.5f;
+		if (opacity_ != opacity)
 		{
-			opacity_ = 0.5f;
+			opacity_ = opacity;
+			if (!always_in_opacity_)
+			{
+				this->Invalidate();
+			}
 		}
 	}
 }
@@ -179,6 +179,8 @@ namespace KlayGE
 
 	void UIButton::SetText(std::wstring const & strText)
 	{
+		this->Invalidate();
+
 		text_ = strText;
 	}
 
@@ -115,6 +115,8 @@ namespace KlayGE
 
 	void UICheckBox::SetCheckedInternal(bool bChecked)
 	{
+		this->Invalidate();
+
 		checked_ = bChecked;
 
 		this->OnChangedEvent()(*this);
@@ -186,6 +188,8 @@ namespace KlayGE
 
 	void UICheckBox::SetText(std::wstring const & strText)
 	{
+		this->Invalidate();
+
 		text_ = strText;
 	}
 
@@ -96,6 +96,8 @@ namespace KlayGE
 
 	void UIComboBox::SetTextColor(Color const & color)
 	{
+		this->Invalidate();
+
 		auto main_element = elements_[0].get();
 		if (main_element)
 		{
@@ -572,11 +574,15 @@ namespace KlayGE
 	
 	void UIComboBox::SetItemData(int nIndex, std::any const & data)
 	{
+		this->Invalidate();
+
 		items_[nIndex]->data = data;
 	}
 
 	int UIComboBox::AddItem(std::wstring const & strText, std::any const & data)
 	{
+		this->Invalidate();
+
 		BOOST_ASSERT(!strText.empty());
 
 		// Create a new item and set the data
@@ -606,6 +612,8 @@ namespace KlayGE
 
 	void UIComboBox::RemoveItem(uint32_t index)
 	{
+		this->Invalidate();
+
 		items_.erase(items_.begin() + index);
 		scroll_bar_.SetTrackRange(0, items_.size());
 		if (selected_ >= static_cast<int>(items_.size()))
@@ -616,6 +624,8 @@ namespace KlayGE
 
 	void UIComboBox::RemoveAllItems()
 	{
+		this->Invalidate();
+
 		items_.clear();
 		scroll_bar_.SetTrackRange(0, 1);
 		focused_ = selected_ = -1;
@@ -695,6 +705,8 @@ namespace KlayGE
 
 	void UIComboBox::SetSelectedByIndex(uint32_t index)
 	{
+		this->Invalidate();
+
 		BOOST_ASSERT(index < this->GetNumItems());
 
 		focused_ = selected_ = index;
@@ -703,6 +715,8 @@ namespace KlayGE
 
 	void UIComboBox::SetSelectedByText(std::wstring const & strText)
 	{
+		this->Invalidate();
+
 		BOOST_ASSERT(!strText.empty());
 
 		int index = this->FindItem(strText);
@@ -348,6 +348,8 @@ namespace KlayGE
 
 	void UIEditBox::ClearText()
 	{
+		this->Invalidate();
+
 		buffer_.Clear();
 		first_visible_ = 0;
 		this->PlaceCaret(0);
@@ -356,6 +358,8 @@ namespace KlayGE
 
 	void UIEditBox::SetText(std::wstring const & wszText, bool bSelected)
 	{
+		this->Invalidate();
+
 		buffer_.SetText(wszText);
 		first_visible_ = 0;
 		// Move the caret to the end of the text
@@ -365,6 +369,8 @@ namespace KlayGE
 
 	void UIEditBox::DeleteSelectionText()
 	{
+		this->Invalidate();
+
 		int nFirst = std::min(caret_pos_, sel_start_);
 		int nLast = std::max(caret_pos_, sel_start_);
 		// Update caret and selection
@@ -420,6 +426,8 @@ namespace KlayGE
 
 	void UIEditBox::PasteFromClipboard()
 	{
+		this->Invalidate();
+
 	}
 
 	void UIEditBox::KeyDownHandler(UIDialog const & /*sender*/, uint32_t key)
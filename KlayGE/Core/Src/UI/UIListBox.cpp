@@ -117,11 +117,15 @@ namespace KlayGE
 
 	void UIListBox::SetItemData(int nIndex, std::any const & data)
 	{
+		this->Invalidate();
+
 		items_[nIndex]->data = data;
 	}
 
 	int UIListBox::AddItem(std::wstring const & strText, std::any const & data)
 	{
+		this->Invalidate();
+
 		std::shared_ptr<UIListBoxItem> pNewItem = MakeSharedPtr<UIListBoxItem>();
 		pNewItem->strText = strText;
 		pNewItem->data = data;
@@ -138,6 +142,8 @@ namespace KlayGE
 
 	void UIListBox::InsertItem(int nIndex, std::wstring const & strText, std::any const & data)
 	{
+		this->Invalidate();
+
 		std::shared_ptr<UIListBoxItem> pNewItem = MakeSharedPtr<UIListBoxItem>();
 		pNewItem->strText = strText;
 		pNewItem->data = data;
@@ -150,6 +156,8 @@ namespace KlayGE
 
 	void UIListBox::RemoveItem(int nIndex)
 	{
+		this->Invalidate();
+
 		BOOST_ASSERT((nIndex >= 0) && (nIndex < static_cast<int>(items_.size())));
 
 		items_.erase(items_.begin() + nIndex);
@@ -164,6 +172,8 @@ namespace KlayGE
 
 	void UIListBox::RemoveAllItems()
 	{
+		this->Invalidate();
+
 		items_.clear();
 		scroll_bar_.SetTrackRange(0, 1);
 	}
@@ -210,6 +220,8 @@ namespace KlayGE
 
 	void UIListBox::SelectItem(int nNewIndex)
 	{
+		this->Invalidate();
+
 		// If no item exists, do nothing.
 		if (items_.empty())
 		{
@@ -88,6 +88,8 @@ namespace KlayGE
 
 	void UIPolylineEditBox::ClearCtrlPoints()
 	{
+		this->Invalidate();
+
 		active_pt_ = -1;
 		ctrl_points_.clear();
 		move_point_ = false;
@@ -95,6 +97,8 @@ namespace KlayGE
 
 	int UIPolylineEditBox::AddCtrlPoint(float pos, float value)
 	{
+		this->Invalidate();
+
 		pos = MathLib::clamp(pos, 0.0f, 1.0f);
 		value = MathLib::clamp(pos, 0.0f, 1.0f);
 
@@ -142,16 +146,22 @@ namespace KlayGE
 
 	void UIPolylineEditBox::SetCtrlPoint(int index, float pos, float value)
 	{
+		this->Invalidate();
+
 		ctrl_points_[index] = float2(pos, value);
 	}
 
 	void UIPolylineEditBox::SetCtrlPoints(std::vector<float2> const & ctrl_points)
 	{
+		this->Invalidate();
+
 		ctrl_points_ = ctrl_points;
 	}
 
 	void UIPolylineEditBox::SetColor(Color const & clr)
 	{
+		this->Invalidate();
+
 		elements_[POLYLINE_INDEX]->TextureColor().States[UICS_Normal] = clr;
 	}
 
@@ -62,6 +62,8 @@ namespace KlayGE
 
 	void UIProgressBar::SetValue(int value)
 	{
+		this->Invalidate();
+
 		progress_ = value;
 	}
 	
@@ -123,6 +123,8 @@ namespace KlayGE
 
 	void UIRadioButton::SetCheckedInternal(bool bChecked, bool bClearGroup)
 	{
+		this->Invalidate();
+
 		if (bChecked && bClearGroup)
 		{
 			this->GetDialog()->ClearRadioButtonGroup(button_group_);
@@ -202,6 +204,8 @@ namespace KlayGE
 
 	void UIRadioButton::SetText(std::wstring const & strText)
 	{
+		this->Invalidate();
+
 		text_ = strText;
 	}
 
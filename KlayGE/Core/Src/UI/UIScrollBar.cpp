@@ -145,6 +145,8 @@ namespace KlayGE
 	// value scrolls up.
 	void UIScrollBar::Scroll(int nDelta)
 	{
+		this->Invalidate();
+
 		// Perform scroll
 		int new_pos = static_cast<int>(position_) + nDelta;
 		position_ = MathLib::clamp(new_pos, 0, static_cast<int>(end_) - 1);
@@ -158,6 +160,8 @@ namespace KlayGE
 
 	void UIScrollBar::ShowItem(size_t nIndex)
 	{
+		this->Invalidate();
+
 		// Cap the index
 
 		if (nIndex >= end_)
@@ -397,6 +401,8 @@ namespace KlayGE
 
 	void UIScrollBar::SetTrackRange(size_t nStart, size_t nEnd)
 	{
+		this->Invalidate();
+
 		start_ = nStart;
 		end_ = nEnd;
 		this->Cap();
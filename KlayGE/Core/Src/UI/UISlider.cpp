@@ -195,6 +195,8 @@ namespace KlayGE
 
 	void UISlider::SetRange(int nMin, int nMax)
 	{
+		this->Invalidate();
+
 		min_ = nMin;
 		max_ = nMax;
 
@@ -203,6 +205,8 @@ namespace KlayGE
 
 	void UISlider::SetValueInternal(int nValue)
 	{
+		this->Invalidate();
+
 		// Clamp to range
 		nValue = std::max(min_, nValue);
 		nValue = std::min(max_, nValue);
@@ -70,6 +70,8 @@ namespace KlayGE
 
 	void UIStatic::SetText(std::wstring const & strText)
 	{
+		this->Invalidate();
+
 		text_ = strText;
 	}
 }
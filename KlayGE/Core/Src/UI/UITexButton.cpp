@@ -214,6 +214,8 @@ namespace KlayGE
 
 	void UITexButton::SetTexture(TexturePtr const & tex)
 	{
+		this->Invalidate();
+
 		tex_index_ = UIManager::Instance().AddTexture(tex);
 		if (tex)
 		{
@@ -35,6 +35,8 @@
 
 #include <KlayGE/PreDeclare.hpp>
 
+#include <atomic>
+
 #include <KlayGE/Audio.hpp>
 
 namespace KlayGE
@@ -89,8 +91,11 @@ namespace KlayGE
 		void DoReset() override;
 		void DoPlay(bool loop) override;
 		void DoStop() override;
+		bool DoUpdate(std::chrono::milliseconds& next_update) override;
 
 	private:
+		std::atomic<bool> playing_;
+
 		float3 pos_;
 		float3 vel_;
 		float3 dir_;
@@ -28,7 +28,9 @@
 #include <KlayGE/SceneNode.hpp>
 #include <KlayGE/SceneManager.hpp>
 #include <KFL/AABBox.hpp>
+#include <KFL/AABBoxSoA.hpp>
 
+#include <unordered_map>
 #include <vector>
 
 namespace KlayGE
@@ -55,9 +57,23 @@ namespace KlayGE
 		void DoSuspend() override;
 		void DoResume() override;
 
-		void DivideNode(size_t index, uint32_t curr_depth);
-		void NodeVisible(size_t index);
+		void SyncObjects();
+		void RebuildTree();
+
+		void InsertObj(SceneNode* node);
+		void RemoveObj(uint32_t obj_index);
+		void RelocateObj(uint32_t obj_index, AABBox const & aabb);
+		void PlaceObj(uint32_t obj_index, int cell_index);
+		void UnplaceObj(uint32_t obj_index);
+		void TrackMoveable(uint32_t obj_index, bool moveable);
+
+		int FindCell(AABBox const & aabb);
+		void DivideCell(size_t index);
+		BoundOverlap CellVisible(int index) const;
+
+		void NodeVisible(size_t first, size_t num);
 		void MarkNodeObjs(size_t index, bool force);
+		void MarkObj(SceneNode& node, Camera const & camera, BoundOverlap frustum_visible);
 
 		BoundOverlap BoundVisible(size_t index, AABBox const & aabb) const;
 		BoundOverlap BoundVisible(size_t index, OBBox const & obb) const;
@@ -69,20 +85,50 @@ namespace KlayGE
 		OCTree& operator=(OCTree const & rhs);
 
 	private:
+		// A loose octree. Objects live in the deepest cell whose loose bound (twice the size of the cell) contains them,
+		// so insert, remove and relocate only touch one cell and its ancestors' counters.
 		struct octree_node_t
 		{
 			AABBox bb;
+			AABBox loose_bb;
+			int parent_index;
 			int first_child_index;
 			BoundOverlap visible;
+			uint32_t num_subtree_objs;
 
-			std::vector<SceneNode*> node_ptrs;
+			std::vector<uint32_t> obj_indices;
+			AABBoxSoA obj_bbs;
 		};
 
+		struct octree_obj_t
+		{
+			SceneNode* node;
+			AABBox aabb;
+			int cell_index;			// -1 means out of the root cell
+			uint32_t cell_slot;		// Index in the cell's obj_indices, or in outside_obj_indices_
+			uint32_t moveable_slot;	// Index in moveable_obj_indices_, or INVALID_SLOT
+			uint32_t sync_stamp;
+		};
+
+		static uint32_t constexpr INVALID_SLOT = 0xFFFFFFFFU;
+
 		std::vector<octree_node_t> octree_;
+		AABBoxSoA cell_bbs_;	// Loose bounds of all cells, to test 8 children at once
+
+		std::vector<octree_obj_t> objs_;
+		std::vector<uint32_t> free_obj_indices_;
+		std::unordered_map<SceneNode const *, uint32_t> obj_lookup_;
+		std::vector<uint32_t> outside_obj_indices_;
+		std::vector<uint32_t> moveable_obj_indices_;
+		uint32_t sync_stamp_;
 
 		uint32_t max_tree_depth_;
 
 		bool rebuild_tree_;
+		bool scene_changed_;
+
+		float4x4 view_proj_;
+		std::vector<BoundOverlap> cull_results_;
 
 #ifdef KLAYGE_DRAW_NODES
 		RenderablePtr node_renderable_;
@@ -34,7 +34,6 @@
 #pragma once
 
 #include <KlayGE/PreDeclare.hpp>
-#include <KFL/Thread.hpp>
 
 #if (defined KLAYGE_PLATFORM_DARWIN) || (defined KLAYGE_PLATFORM_IOS)
 #include <OpenAL/al.h>
@@ -42,6 +41,7 @@
 #else
 #include <AL/al.h>
 #include <AL/alc.h>
+#include <AL/alext.h>
 #endif
 
 #include <vector>
@@ -104,24 +104,16 @@ namespace KlayGE
 		float3 Direction() const override;
 		void Direction(float3 const & v) override;
 
-		void LoopUpdateBuffer();
-
 	private:
 		void DoReset() override;
 		void DoPlay(bool loop) override;
 		void DoStop() override;
+		bool DoUpdate(std::chrono::milliseconds& next_update) override;
 
 	private:
 		ALuint source_;
 		std::vector<ALuint> buffer_queue_;
-
-		bool loop_;
-
-		bool played_;
-		bool stopped_;
-		std::condition_variable play_cond_;
-		std::mutex play_mutex_;
-		joiner<void> play_thread_;
+		std::vector<uint8_t> buffer_data_;
 	};
 
 	class OALAudioEngine : public AudioEngine
@@ -139,9 +131,18 @@ namespace KlayGE
 		void GetListenerOri(float3& face, float3& up) const override;
 		void SetListenerOri(float3 const & face, float3 const & up) override;
 
+		// True if there is no output device, and the mix goes to a loopback device instead
+		bool Loopback() const;
+		// Mixes the playing buffers into 16-bit stereo samples. Only valid on a loopback device.
+		void RenderLoopback(void* samples, uint32_t num_frames);
+
 	private:
 		void DoSuspend() override;
 		void DoResume() override;
+
+	private:
+		ALCdevice* device_;
+		bool loopback_;
 	};
 }
 
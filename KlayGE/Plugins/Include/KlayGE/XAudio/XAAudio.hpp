@@ -34,7 +34,6 @@
 #pragma once
 
 #include <KlayGE/PreDeclare.hpp>
-#include <KFL/Thread.hpp>
 
 #include <vector>
 #include <windows.h>
@@ -133,30 +132,18 @@ namespace KlayGE
 		void Direction(float3 const & v) override;
 
 	private:
-		void LoopUpdateBuffer();
-
 		void DoReset() override;
 		void DoPlay(bool loop) override;
-		void DoStop();
-
-		bool FillData(uint32_t size);
+		void DoStop() override;
+		bool DoUpdate(std::chrono::milliseconds& next_update) override;
 
 	private:
 		IXAudio2SourceVoicePtr source_voice_;
 		std::unique_ptr<IXAudio2VoiceCallback> voice_call_back_;
 		std::vector<uint8_t> audio_data_;
-		uint32_t buffer_size_;
 		uint32_t buffer_count_;
 		uint32_t curr_buffer_index_;
 
-		bool loop_;
-
-		bool played_;
-		bool stopped_;
-		std::condition_variable play_cond_;
-		std::mutex play_mutex_;
-		joiner<void> play_thread_;
-
 		X3DAUDIO_EMITTER emitter_;
 		X3DAUDIO_DSP_SETTINGS dsp_settings_;
 		std::vector<float> output_matrix_;
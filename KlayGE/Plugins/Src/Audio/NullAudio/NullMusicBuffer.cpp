@@ -35,10 +35,9 @@
 namespace KlayGE
 {
 	NullMusicBuffer::NullMusicBuffer(AudioDataSourcePtr const & data_source, uint32_t buffer_seconds, float volume)
-					: MusicBuffer(data_source)
+					: MusicBuffer(data_source, buffer_seconds),
+						playing_(false)
 	{
-		KFL_UNUSED(buffer_seconds);
-
 		this->Position(float3::Zero());
 		this->Velocity(float3::Zero());
 		this->Direction(float3::Zero());
@@ -55,21 +54,37 @@ namespace KlayGE
 
 	void NullMusicBuffer::DoReset()
 	{
-		data_source_->Reset();
+		this->ResetDecoded();
 	}
 
 	void NullMusicBuffer::DoPlay(bool loop)
 	{
 		KFL_UNUSED(loop);
+
+		playing_ = true;
 	}
 
 	void NullMusicBuffer::DoStop()
 	{
+		playing_ = false;
+	}
+
+	bool NullMusicBuffer::DoUpdate(std::chrono::milliseconds& next_update)
+	{
+		// Consumes the data as fast as a device would play it
+		if (0 == this->ReadDecoded(nullptr, buffer_size_))
+		{
+			playing_ = false;
+			return false;
+		}
+
+		next_update = std::chrono::milliseconds(1000 / BUFFERS_PER_SECOND);
+		return true;
 	}
 
 	bool NullMusicBuffer::IsPlaying() const
 	{
-		return false;
+		return playing_;
 	}
 
 	void NullMusicBuffer::Volume(float vol)
@@ -78,9 +78,33 @@ namespace KlayGE
 	}
 
 	OALAudioEngine::OALAudioEngine()
+		: loopback_(false)
 	{
-		ALCdevice* device = alcOpenDevice(nullptr);
-		ALCcontext* context = alcCreateContext(device, 0);
+		device_ = alcOpenDevice(nullptr);
+		ALCint const* attrs = nullptr;
+#ifdef ALC_SOFT_loopback
+		// Headless machines have no output device. Mixes into a loopback device, so the buffers still play and stream.
+		static ALCint const loopback_attrs[] =
+		{
+			ALC_FORMAT_CHANNELS_SOFT, ALC_STEREO_SOFT,
+			ALC_FORMAT_TYPE_SOFT, ALC_SHORT_SOFT,
+			ALC_FREQUENCY, 44100,
+			0
+		};
+		if (!device_ && alcIsExtensionPresent(nullptr, "ALC_SOFT_loopback"))
+		{
+			auto loopback_open_device
+				= reinterpret_cast<LPALCLOOPBACKOPENDEVICESOFT>(alcGetProcAddress(nullptr, "alcLoopbackOpenDeviceSOFT"));
+			device_ = loopback_open_device(nullptr);
+			if (device_)
+			{
+				attrs = loopback_attrs;
+				loopback_ = true;
+			}
+		}
+#endif
+
+		ALCcontext* context = alcCreateContext(device_, attrs);
 
 		alcMakeContextCurrent(context);
 
@@ -99,12 +123,29 @@ namespace KlayGE
 		audio_buffs_.clear();
 
 		ALCcontext* context = alcGetCurrentContext();
-		ALCdevice* device = alcGetContextsDevice(context);
 
 		alcMakeContextCurrent(0);
 
 		alcDestroyContext(context);
-		alcCloseDevice(device);
+		alcCloseDevice(device_);
+	}
+
+	bool OALAudioEngine::Loopback() const
+	{
+		return loopback_;
+	}
+
+	void OALAudioEngine::RenderLoopback(void* samples, uint32_t num_frames)
+	{
+		BOOST_ASSERT(loopback_);
+
+#ifdef ALC_SOFT_loopback
+		auto render_samples = reinterpret_cast<LPALCRENDERSAMPLESSOFT>(alcGetProcAddress(device_, "alcRenderSamplesSOFT"));
+		render_samples(device_, samples, num_frames);
+#else
+		KFL_UNUSED(samples);
+		KFL_UNUSED(num_frames);
+#endif
 	}
 
 	void OALAudioEngine::DoSuspend()
@@ -34,14 +34,12 @@
 
 #include <KlayGE/OpenAL/OALAudio.hpp>
 
-size_t constexpr READ_SIZE = 88200;
-
 namespace KlayGE
 {
 	OALMusicBuffer::OALMusicBuffer(AudioDataSourcePtr const & data_source, uint32_t buffer_seconds, float volume)
-							: MusicBuffer(data_source),
+							: MusicBuffer(data_source, buffer_seconds),
 								buffer_queue_(buffer_seconds * BUFFERS_PER_SECOND),
-								played_(false), stopped_(true)
+								buffer_data_(buffer_size_)
 	{
 		alGenBuffers(static_cast<ALsizei>(buffer_queue_.size()), buffer_queue_.data());
 
@@ -65,56 +63,38 @@ namespace KlayGE
 		alDeleteSources(1, &source_);
 	}
 
-	void OALMusicBuffer::LoopUpdateBuffer()
+	bool OALMusicBuffer::DoUpdate(std::chrono::milliseconds& next_update)
 	{
-		std::unique_lock<std::mutex> lock(play_mutex_);
-		while (!played_)
+		ALint processed;
+		alGetSourcei(source_, AL_BUFFERS_PROCESSED, &processed);
+		while ((processed > 0) && !this->EndOfStream())
 		{
-			play_cond_.wait(lock);
+			-- processed;
+
+			ALuint buf;
+			alSourceUnqueueBuffers(source_, 1, &buf);
+
+			size_t const size = this->ReadDecoded(buffer_data_.data(), buffer_data_.size());
+			alBufferData(buf, Convert(format_), buffer_data_.data(), static_cast<ALsizei>(size), freq_);
+			alSourceQueueBuffers(source_, 1, &buf);
 		}
-		played_ = false;
 
-		while (!stopped_)
+		ALint state;
+		alGetSourcei(source_, AL_SOURCE_STATE, &state);
+		if (state != AL_PLAYING)
 		{
-			ALint processed;
-			alGetSourcei(source_, AL_BUFFERS_PROCESSED, &processed);
-			if (processed > 0)
-			{
-				while (processed > 0)
-				{
-					-- processed;
-
-					ALuint buf;
-					alSourceUnqueueBuffers(source_, 1, &buf);
-
-					std::vector<uint8_t> data(READ_SIZE);
-					data.resize(data_source_->Read(data.data(), data.size()));
-					if (data.empty())
-					{
-						if (loop_)
-						{
-							stopped_ = false;
-							alSourceStopv(1, &source_);
-							this->DoReset();
-							alSourcePlay(source_);
-						}
-						else
-						{
-							stopped_ = true;
-						}
-					}
-					else
-					{
-						alBufferData(buf, Convert(format_), data.data(), static_cast<ALsizei>(data.size()), freq_);
-						alSourceQueueBuffers(source_, 1, &buf);
-					}
-				}
-			}
-			else
+			if (this->EndOfStream())
 			{
-				Sleep(1000 / BUFFERS_PER_SECOND);
+				return false;
 			}
+
+			// The source ran out of queued data before this update, keeps it going
+			alSourcePlay(source_);
 		}
+
+		// OpenAL has no callback when a buffer is processed, so checks twice per buffer
+		next_update = std::chrono::milliseconds(1000 / BUFFERS_PER_SECOND / 2);
+		return true;
 	}
 
 	void OALMusicBuffer::DoReset()
@@ -128,24 +108,24 @@ namespace KlayGE
 		}
 
 		ALenum const format(Convert(format_));
-		std::vector<uint8_t> data(READ_SIZE);
 
-		data_source_->Reset();
+		this->ResetDecoded();
+		this->Decode();
 
 		ALsizei non_empty_buf = 0;
 		// Load 1 / BUFFERS_PER_SECOND second data to each buffer
 		for (auto const & buf : buffer_queue_)
 		{
-			data.resize(data_source_->Read(data.data(), data.size()));
-			if (data.empty())
+			size_t const size = this->ReadDecoded(buffer_data_.data(), buffer_data_.size());
+			if (0 == size)
 			{
 				break;
 			}
 			else
 			{
 				++ non_empty_buf;
-				alBufferData(buf, format, data.data(),
-					static_cast<ALuint>(data.size()), static_cast<ALuint>(freq_));
+				alBufferData(buf, format, buffer_data_.data(),
+					static_cast<ALuint>(size), static_cast<ALuint>(freq_));
 			}
 		}
 
@@ -156,16 +136,7 @@ namespace KlayGE
 
 	void OALMusicBuffer::DoPlay(bool loop)
 	{
-		play_thread_ = Context::Instance().ThreadPool()([this] { this->LoopUpdateBuffer(); });
-
-		loop_ = loop;
-
-		stopped_ = false;
-		{
-			std::lock_guard<std::mutex> lock(play_mutex_);
-			played_ = true;
-		}
-		play_cond_.notify_one();
+		KFL_UNUSED(loop);
 
 		alSourcei(source_, AL_LOOPING, false);
 		alSourcePlay(source_);
@@ -173,12 +144,6 @@ namespace KlayGE
 
 	void OALMusicBuffer::DoStop()
 	{
-		if (!stopped_)
-		{
-			stopped_ = true;
-			play_thread_();
-		}
-
 		alSourceStopv(1, &source_);
 	}
 
@@ -47,18 +47,12 @@ namespace KlayGE
 	class MusicVoiceContext : public IXAudio2VoiceCallback
 	{
 	public:
-		MusicVoiceContext()
-			: buffer_end_event_(::CreateEventEx(nullptr, nullptr, 0, EVENT_ALL_ACCESS))
+		MusicVoiceContext(AudioStreamer& streamer, MusicBuffer& buffer)
+			: streamer_(streamer), buffer_(buffer)
 		{
 		}
 		virtual ~MusicVoiceContext()
 		{
-			::CloseHandle(buffer_end_event_);
-		}
-
-		HANDLE GetBufferEndEvent() const
-		{
-			return buffer_end_event_;
 		}
 
 		STDMETHOD_(void, OnVoiceProcessingPassStart)(UINT32)
@@ -75,7 +69,7 @@ namespace KlayGE
 		}
 		STDMETHOD_(void, OnBufferEnd)(void*)
 		{
-			::SetEvent(buffer_end_event_);
+			streamer_.Wake(buffer_);
 		}
 		STDMETHOD_(void, OnLoopEnd)(void*)
 		{
@@ -85,19 +79,18 @@ namespace KlayGE
 		}
 
 	private:
-		HANDLE buffer_end_event_;
+		AudioStreamer& streamer_;
+		MusicBuffer& buffer_;
 	};
 
 	XAMusicBuffer::XAMusicBuffer(AudioDataSourcePtr const & data_source, uint32_t buffer_seconds, float volume)
-					: MusicBuffer(data_source),
-						voice_call_back_(MakeUniquePtr<MusicVoiceContext>()),
+					: MusicBuffer(data_source, buffer_seconds),
+						voice_call_back_(MakeUniquePtr<MusicVoiceContext>(this->Streamer(), *this)),
 						buffer_count_(buffer_seconds * BUFFERS_PER_SECOND), curr_buffer_index_(0),
-						played_(false), stopped_(true),
 						emitter_{}, dsp_settings_{}
 	{
 		WAVEFORMATEX wfx = WaveFormatEx(data_source);
-		audio_data_.resize(wfx.nAvgBytesPerSec * buffer_seconds);
-		buffer_size_ = wfx.nAvgBytesPerSec / BUFFERS_PER_SECOND;
+		audio_data_.resize(buffer_count_ * buffer_size_);
 
 		auto const & ae = *checked_cast<XAAudioEngine const *>(&Context::Instance().AudioFactoryInstance().AudioEngineInstance());
 
@@ -130,58 +123,48 @@ namespace KlayGE
 		this->Stop();
 	}
 
-	void XAMusicBuffer::LoopUpdateBuffer()
+	bool XAMusicBuffer::DoUpdate(std::chrono::milliseconds& next_update)
 	{
-		std::unique_lock<std::mutex> lock(play_mutex_);
-		while (!played_)
-		{
-			play_cond_.wait(lock);
-		}
-		played_ = false;
+		XAUDIO2_VOICE_STATE state;
+		source_voice_->GetState(&state);
 
-		while (!stopped_)
+		// Leaves one buffer out of the queue, it's the one being refilled
+		while ((state.BuffersQueued < buffer_count_ - 1) && !this->EndOfStream())
 		{
-			XAUDIO2_VOICE_STATE state;
-			for (;;)
-			{
-				source_voice_->GetState(&state);
-				if (state.BuffersQueued < buffer_count_ - 1)
-				{
-					break;
-				}
-
-				::WaitForSingleObjectEx(checked_cast<MusicVoiceContext*>(voice_call_back_.get())->GetBufferEndEvent(),
-					INFINITE, FALSE);
-			}
+			uint8_t* data = &audio_data_[curr_buffer_index_ * buffer_size_];
 
-			if (this->FillData(buffer_size_))
+			XAUDIO2_BUFFER buf{};
+			buf.AudioBytes = static_cast<uint32_t>(this->ReadDecoded(data, buffer_size_));
+			buf.pAudioData = data;
+			if (this->EndOfStream())
 			{
-				if (loop_)
-				{
-					stopped_ = false;
-					this->DoReset();
-				}
-				else
-				{
-					stopped_ = true;
-
-					HRESULT hr = source_voice_->Stop();
-					if (SUCCEEDED(hr))
-					{
-						source_voice_->FlushSourceBuffers();
-					}
-				}
+				buf.Flags = XAUDIO2_END_OF_STREAM;
 			}
+
+			source_voice_->SubmitSourceBuffer(&buf);
+			curr_buffer_index_ = (curr_buffer_index_ + 1) % buffer_count_;
+			++ state.BuffersQueued;
 		}
+
+		if ((0 == state.BuffersQueued) && this->EndOfStream())
+		{
+			return false;
+		}
+
+		// OnBufferEnd wakes it up earlier, this is only a fallback
+		next_update = std::chrono::milliseconds(1000 / BUFFERS_PER_SECOND);
+		return true;
 	}
 
 	void XAMusicBuffer::DoReset()
 	{
-		data_source_->Reset();
+		this->ResetDecoded();
 	}
 
 	void XAMusicBuffer::DoPlay(bool loop)
 	{
+		KFL_UNUSED(loop);
+
 		auto const & ae = *checked_cast<XAAudioEngine const *>(&Context::Instance().AudioFactoryInstance().AudioEngineInstance());
 
 		ae.X3DAudioCalculate(&emitter_, X3DAUDIO_CALCULATE_MATRIX | X3DAUDIO_CALCULATE_DOPPLER, &dsp_settings_);
@@ -190,29 +173,16 @@ namespace KlayGE
 		source_voice_->SetFrequencyRatio(dsp_settings_.DopplerFactor);
 
 		curr_buffer_index_ = 0;
-		loop_ = loop;
 
-		play_thread_ = Context::Instance().ThreadPool()([this] { this->LoopUpdateBuffer(); });
-
-		stopped_ = false;
-		{
-			std::lock_guard<std::mutex> lock(play_mutex_);
-			played_ = true;
-		}
-		play_cond_.notify_one();
+		// Queues the first buffers here, the streamer takes over after it starts
+		std::chrono::milliseconds next_update;
+		this->DoUpdate(next_update);
 
 		source_voice_->Start(0, 0);
 	}
 
 	void XAMusicBuffer::DoStop()
 	{
-		if (!stopped_)
-		{
-			stopped_ = true;
-			::SetEvent(checked_cast<MusicVoiceContext*>(voice_call_back_.get())->GetBufferEndEvent());
-			play_thread_();
-		}
-
 		HRESULT hr = source_voice_->Stop();
 		if (SUCCEEDED(hr))
 		{
@@ -220,26 +190,6 @@ namespace KlayGE
 		}
 	}
 
-	bool XAMusicBuffer::FillData(uint32_t size)
-	{
-		bool ret = false;
-
-		size_t read_size = data_source_->Read(&audio_data_[curr_buffer_index_ * buffer_size_], size);
-		XAUDIO2_BUFFER buf{};
-		buf.AudioBytes = static_cast<uint32_t>(read_size);
-		buf.pAudioData = &audio_data_[curr_buffer_index_ * buffer_size_];
-		if (curr_buffer_index_ * buffer_size_ + read_size >= data_source_->Size())
-		{
-			buf.Flags = XAUDIO2_END_OF_STREAM;
-			ret = true;
-		}
-
-		source_voice_->SubmitSourceBuffer(&buf);
-		curr_buffer_index_ = (curr_buffer_index_ + 1) % buffer_count_;
-
-		return ret;
-	}
-
 	bool XAMusicBuffer::IsPlaying() const
 	{
 		if (source_voice_)
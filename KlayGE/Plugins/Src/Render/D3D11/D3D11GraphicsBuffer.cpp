@@ -43,6 +43,8 @@ namespace KlayGE
 		D3D11RenderEngine const & renderEngine(*checked_cast<D3D11RenderEngine const *>(&Context::Instance().RenderFactoryInstance().RenderEngineInstance()));
 		d3d_device_ = renderEngine.D3DDevice();
 		d3d_imm_ctx_ = renderEngine.D3DDeviceImmContext();
+		// Only for updating a part of a cbuffer
+		d3d_imm_ctx_1_ = renderEngine.DeviceCaps().partial_cbuffer_update_support ? renderEngine.D3DDeviceImmContext1() : nullptr;
 	}
 
 	ID3D11ShaderResourceViewPtr const & D3D11GraphicsBuffer::RetrieveD3DShaderResourceView(ElementFormat pf, uint32_t first_elem,
@@ -345,9 +347,12 @@ namespace KlayGE
 
 	void D3D11GraphicsBuffer::UpdateSubresource(uint32_t offset, uint32_t size, void const * data)
 	{
+		bool const partial_cbuffer = (bind_flags_ & D3D11_BIND_CONSTANT_BUFFER) && ((offset != 0) || (size != size_in_byte_))
+			&& (d3d_imm_ctx_1_ != nullptr);
+
 		D3D11_BOX* p = nullptr;
 		D3D11_BOX box;
-		if (!(bind_flags_ & D3D11_BIND_CONSTANT_BUFFER))
+		if (!(bind_flags_ & D3D11_BIND_CONSTANT_BUFFER) || partial_cbuffer)
 		{
 			p = &box;
 			box.left = offset;
@@ -357,6 +362,13 @@ namespace KlayGE
 			box.bottom = 1;
 			box.back = 1;
 		}
-		d3d_imm_ctx_->UpdateSubresource(d3d_buffer_.get(), 0, p, data, size, size);
+		if (partial_cbuffer)
+		{
+			d3d_imm_ctx_1_->UpdateSubresource1(d3d_buffer_.get(), 0, p, data, size, size, 0);
+		}
+		else
+		{
+			d3d_imm_ctx_->UpdateSubresource(d3d_buffer_.get(), 0, p, data, size, size);
+		}
 	}
 }
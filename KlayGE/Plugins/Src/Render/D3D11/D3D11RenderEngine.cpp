@@ -1023,10 +1023,12 @@ namespace KlayGE
 			D3D11_FEATURE_DATA_D3D11_OPTIONS d3d11_feature;
 			d3d_device_->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &d3d11_feature, sizeof(d3d11_feature));
 			caps_.logic_op_support = d3d11_feature.OutputMergerLogicOp ? true : false;
+			caps_.partial_cbuffer_update_support = d3d11_feature.ConstantBufferPartialUpdate ? true : false;
 		}
 		else
 		{
 			caps_.logic_op_support = false;
+			caps_.partial_cbuffer_update_support = false;
 		}
 		caps_.independent_blend_support = true;
 		caps_.draw_indirect_support = true;
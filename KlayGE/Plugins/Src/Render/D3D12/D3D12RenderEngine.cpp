@@ -1212,6 +1212,8 @@ namespace KlayGE
 		caps_.independent_blend_support = true;
 		caps_.draw_indirect_support = true;
 		caps_.no_overwrite_support = true;
+		// Updating a dynamic buffer renames the whole of it
+		caps_.partial_cbuffer_update_support = false;
 		caps_.full_npot_texture_support = true;
 		caps_.render_to_texture_array_support = true;
 		caps_.explicit_multi_sample_support = true;
@@ -1526,6 +1526,7 @@ namespace KlayGE
 		caps_.independent_blend_support = true;
 		caps_.draw_indirect_support = true;
 		caps_.no_overwrite_support = false;
+		caps_.partial_cbuffer_update_support = true;
 		caps_.full_npot_texture_support = true;
 		if (caps_.max_texture_array_length > 1)
 		{
@@ -1486,6 +1486,7 @@ namespace KlayGE
 			caps_.draw_indirect_support = false;
 		}
 		caps_.no_overwrite_support = false;
+		caps_.partial_cbuffer_update_support = true;
 		if (this->HackForAndroidEmulator())
 		{
 			caps_.full_npot_texture_support = false;
@@ -34,6 +34,7 @@
 #include <KlayGE/DeferredRenderingLayer.hpp>
 
 #include <algorithm>
+#include <array>
 #include <boost/assert.hpp>
 
 #ifdef KLAYGE_DRAW_NODES
@@ -97,13 +98,14 @@ namespace
 namespace KlayGE
 {
 	OCTree::OCTree()
-		: max_tree_depth_(4), rebuild_tree_(false)
+		: sync_stamp_(0), max_tree_depth_(4), rebuild_tree_(false), scene_changed_(true)
 	{
 	}
 
 	void OCTree::MaxTreeDepth(uint32_t max_tree_depth)
 	{
 		max_tree_depth_ = std::min<uint32_t>(max_tree_depth, 16UL);
+		rebuild_tree_ = true;
 	}
 
 	uint32_t OCTree::MaxTreeDepth() const
@@ -113,31 +115,27 @@ namespace KlayGE
 
 	void OCTree::ClipScene()
 	{
-		if (rebuild_tree_)
+		if (scene_changed_)
 		{
-			octree_.resize(1);
-			AABBox bb_root(float3(0, 0, 0), float3(0, 0, 0));
-			octree_[0].first_child_index = -1;
-			octree_[0].visible = BO_No;
-			for (auto* sn : all_scene_nodes_)
+			this->SyncObjects();
+		}
+
+		for (auto const obj_index : moveable_obj_indices_)
+		{
+			auto const & node = *objs_[obj_index].node;
+			if (node.Updated())
 			{
-				auto const & node = *sn;
-				uint32_t const attr = node.Attrib();
-				if (node.Updated() && (attr & SceneNode::SOA_Cullable) && !(attr & SceneNode::SOA_Moveable))
+				AABBox const & aabb = node.PosBoundWS();
+				if (!(aabb == objs_[obj_index].aabb))
 				{
-					bb_root |= node.PosBoundWS();
-					octree_[0].node_ptrs.push_back(sn);
+					this->RelocateObj(obj_index, aabb);
 				}
 			}
-			float3 const & center = bb_root.Center();
-			float3 const & extent = bb_root.HalfSize();
-			float longest_dim = std::max(std::max(extent.x(), extent.y()), extent.z());
-			float3 new_extent(longest_dim, longest_dim, longest_dim);
-			octree_[0].bb = AABBox(center - new_extent, center + new_extent);
-
-			this->DivideNode(0, 1);
+		}
 
-			rebuild_tree_ = false;
+		if (rebuild_tree_)
+		{
+			this->RebuildTree();
 		}
 
 #ifdef KLAYGE_DRAW_NODES
@@ -148,25 +146,25 @@ namespace KlayGE
 		checked_pointer_cast<NodeRenderable>(node_renderable_)->ClearInstances();
 #endif
 
-		if (!octree_.empty())
-		{
-			this->NodeVisible(0);
-		}
-
 		App3DFramework& app = Context::Instance().AppInstance();
 		Camera& camera = app.ActiveCamera();
 
-		float4x4 view_proj = camera.ViewProjMatrix();
+		view_proj_ = camera.ViewProjMatrix();
 		auto drl = Context::Instance().DeferredRenderingLayerInstance();
 		if (drl)
 		{
 			int32_t cas_index = drl->CurrCascadeIndex();
 			if (cas_index >= 0)
 			{
-				view_proj *= drl->GetCascadedShadowLayer()->CascadeCropMatrix(cas_index);
+				view_proj_ *= drl->GetCascadedShadowLayer()->CascadeCropMatrix(cas_index);
 			}
 		}
 
+		if (!octree_.empty())
+		{
+			this->NodeVisible(0, 1);
+		}
+
 		if (camera.OmniDirectionalMode())
 		{
 			for (auto* sn : all_scene_nodes_)
@@ -182,7 +180,7 @@ namespace KlayGE
 						{
 							AABBox const & aabb_ws = node.PosBoundWS();
 							visible = ((MathLib::ortho_area(camera.ForwardVec(), aabb_ws) > small_obj_threshold_)
-								&& (MathLib::perspective_area(camera.EyePos(), view_proj, aabb_ws) > small_obj_threshold_))
+								&& (MathLib::perspective_area(camera.EyePos(), view_proj_, aabb_ws) > small_obj_threshold_))
 								? BO_Yes : BO_No;
 						}
 						else
@@ -205,10 +203,29 @@ namespace KlayGE
 		}
 		else
 		{
+			// Moveable objects in an invisible cell are culled before the static ones, so a visible static child can still
+			// override its moveable parent.
+			for (auto const obj_index : moveable_obj_indices_)
+			{
+				auto const & obj = objs_[obj_index];
+				if ((obj.node->VisibleMark() != BO_No) && (BO_No == this->CellVisible(obj.cell_index)))
+				{
+					obj.node->VisibleMark(BO_No);
+				}
+			}
+
 			if (!octree_.empty())
 			{
 				this->MarkNodeObjs(0, false);
 			}
+			for (auto const obj_index : outside_obj_indices_)
+			{
+				auto const & obj = objs_[obj_index];
+				if (INVALID_SLOT == obj.moveable_slot)
+				{
+					this->MarkObj(*obj.node, camera, frustum_->Intersect(obj.aabb));
+				}
+			}
 
 			for (auto* sn : all_scene_nodes_)
 			{
@@ -216,7 +233,7 @@ namespace KlayGE
 				BoundOverlap visible = node.VisibleMark();
 				if (node.Visible() && (visible != BO_No))
 				{
-					visible = this->VisibleTestFromParent(node, camera.ForwardVec(), camera.EyePos(), view_proj);
+					visible = this->VisibleTestFromParent(node, camera.ForwardVec(), camera.EyePos(), view_proj_);
 					if (BO_Partial == visible)
 					{
 						uint32_t const attr = node.Attrib();
@@ -224,7 +241,8 @@ namespace KlayGE
 						{
 							if (attr & SceneNode::SOA_Moveable)
 							{
-								visible = this->AABBVisible(node.PosBoundWS());
+								// The cell test has been done above
+								visible = frustum_->Intersect(node.PosBoundWS());
 							}
 						}
 						else
@@ -248,12 +266,19 @@ namespace KlayGE
 		SceneManager::ClearObject();
 
 		octree_.clear();
-		rebuild_tree_ = true;
+		cell_bbs_.clear();
+		objs_.clear();
+		free_obj_indices_.clear();
+		obj_lookup_.clear();
+		outside_obj_indices_.clear();
+		moveable_obj_indices_.clear();
+		rebuild_tree_ = false;
+		scene_changed_ = true;
 	}
 
 	void OCTree::OnSceneChanged()
 	{
-		rebuild_tree_ = true;
+		scene_changed_ = true;
 	}
 
 	void OCTree::DoSuspend()
@@ -266,159 +291,393 @@ namespace KlayGE
 		// TODO
 	}
 
-	void OCTree::DivideNode(size_t index, uint32_t curr_depth)
+	// Diffs all_scene_nodes_ against the tracked objects. New nodes are inserted, nodes whose bound changed are relocated,
+	// and objects whose node has left the scene are removed without touching the node, which may already be destroyed.
+	void OCTree::SyncObjects()
 	{
-		if (octree_[index].node_ptrs.size() > 1)
-		{
-			size_t const this_size = octree_.size();
-			AABBox const parent_bb = octree_[index].bb;
-			float3 const parent_center = parent_bb.Center();
-			octree_[index].first_child_index = static_cast<int>(this_size);
-			octree_[index].visible = BO_No;
-
-			octree_.resize(this_size + 8);
-			for (auto* node : octree_[index].node_ptrs)
-			{
-				AABBox const & aabb = node->PosBoundWS();
-				int mark[6];
-				mark[0] = aabb.Min().x() >= parent_center.x() ? 1 : 0;
-				mark[1] = aabb.Min().y() >= parent_center.y() ? 2 : 0;
-				mark[2] = aabb.Min().z() >= parent_center.z() ? 4 : 0;
-				mark[3] = aabb.Max().x() >= parent_center.x() ? 1 : 0;
-				mark[4] = aabb.Max().y() >= parent_center.y() ? 2 : 0;
-				mark[5] = aabb.Max().z() >= parent_center.z() ? 4 : 0;
-				for (int j = 0; j < 8; ++ j)
+		++ sync_stamp_;
+
+		bool pending = false;
+		for (auto* sn : all_scene_nodes_)
+		{
+			auto const & node = *sn;
+			uint32_t const attr = node.Attrib();
+			if (attr & SceneNode::SOA_Cullable)
+			{
+				auto iter = obj_lookup_.find(sn);
+				if (iter != obj_lookup_.end())
 				{
-					if (j == ((j & 1) ? mark[3] : mark[0])
-						+ ((j & 2) ? mark[4] : mark[1])
-						+ ((j & 4) ? mark[5] : mark[2]))
+					uint32_t const obj_index = iter->second;
+					objs_[obj_index].sync_stamp = sync_stamp_;
+					this->TrackMoveable(obj_index, (attr & SceneNode::SOA_Moveable) != 0);
+					if (node.Updated() && !(node.PosBoundWS() == objs_[obj_index].aabb))
 					{
-						octree_[this_size + j].node_ptrs.push_back(node);
+						this->RelocateObj(obj_index, node.PosBoundWS());
 					}
 				}
+				else if (node.Updated())
+				{
+					this->InsertObj(sn);
+				}
+				else
+				{
+					pending = true;
+				}
+			}
+		}
+
+		for (uint32_t i = 0; i < objs_.size(); ++ i)
+		{
+			if (objs_[i].node && (objs_[i].sync_stamp != sync_stamp_))
+			{
+				this->RemoveObj(i);
 			}
+		}
 
-			for (size_t j = 0; j < 8; ++ j)
+		// Objects outside of the root cell are tested one by one. Grow the root only when too many static ones pile up there.
+		size_t num_outside_statics = 0;
+		for (auto const obj_index : outside_obj_indices_)
+		{
+			if (INVALID_SLOT == objs_[obj_index].moveable_slot)
 			{
-				octree_node_t& new_node = octree_[this_size + j];
-				new_node.first_child_index = -1;
-				new_node.bb = AABBox(float3((j & 1) ? parent_center.x() : parent_bb.Min().x(),
-						(j & 2) ? parent_center.y() : parent_bb.Min().y(),
-						(j & 4) ? parent_center.z() : parent_bb.Min().z()),
-					float3((j & 1) ? parent_bb.Max().x() : parent_center.x(),
-						(j & 2) ? parent_bb.Max().y() : parent_center.y(),
-						(j & 4) ? parent_bb.Max().z() : parent_center.z()));
+				++ num_outside_statics;
+			}
+		}
+		if ((octree_.empty() && !obj_lookup_.empty())
+			|| (num_outside_statics > std::max<size_t>(16, obj_lookup_.size() / 8)))
+		{
+			rebuild_tree_ = true;
+		}
 
-				if (curr_depth < max_tree_depth_)
+		scene_changed_ = pending;
+	}
+
+	void OCTree::RebuildTree()
+	{
+		AABBox bb_root(float3(0, 0, 0), float3(0, 0, 0));
+		bool has_static = false;
+		for (auto const & obj : objs_)
+		{
+			if (obj.node && (INVALID_SLOT == obj.moveable_slot))
+			{
+				bb_root |= obj.aabb;
+				has_static = true;
+			}
+		}
+		if (!has_static)
+		{
+			for (auto const & obj : objs_)
+			{
+				if (obj.node)
 				{
-					this->DivideNode(this_size + j, curr_depth + 1);
+					bb_root |= obj.aabb;
 				}
 			}
+		}
 
-			octree_[index].node_ptrs.clear();
-			octree_[index].node_ptrs.shrink_to_fit();
+		float3 const & center = bb_root.Center();
+		float3 const & extent = bb_root.HalfSize();
+		float longest_dim = std::max(std::max(extent.x(), extent.y()), extent.z());
+		float3 new_extent(longest_dim, longest_dim, longest_dim);
+
+		octree_.resize(1);
+		auto& root = octree_[0];
+		root.bb = AABBox(center - new_extent, center + new_extent);
+		root.loose_bb = AABBox(center - new_extent * 2.0f, center + new_extent * 2.0f);
+		root.parent_index = -1;
+		root.first_child_index = -1;
+		root.visible = BO_No;
+		root.num_subtree_objs = 0;
+		root.obj_indices.clear();
+		root.obj_bbs.clear();
+
+		cell_bbs_.resize(1);
+		cell_bbs_.Box(0, root.loose_bb);
+
+		outside_obj_indices_.clear();
+		for (uint32_t i = 0; i < objs_.size(); ++ i)
+		{
+			if (objs_[i].node)
+			{
+				this->PlaceObj(i, this->FindCell(objs_[i].aabb));
+			}
 		}
+
+		rebuild_tree_ = false;
 	}
 
-	void OCTree::NodeVisible(size_t index)
+	void OCTree::InsertObj(SceneNode* node)
 	{
-		BOOST_ASSERT(index < octree_.size());
+		uint32_t obj_index;
+		if (free_obj_indices_.empty())
+		{
+			obj_index = static_cast<uint32_t>(objs_.size());
+			objs_.emplace_back();
+		}
+		else
+		{
+			obj_index = free_obj_indices_.back();
+			free_obj_indices_.pop_back();
+		}
 
-		App3DFramework& app = Context::Instance().AppInstance();
-		Camera& camera = app.ActiveCamera();
+		auto& obj = objs_[obj_index];
+		obj.node = node;
+		obj.aabb = node->PosBoundWS();
+		obj.moveable_slot = INVALID_SLOT;
+		obj.sync_stamp = sync_stamp_;
+		obj_lookup_.emplace(node, obj_index);
 
-		float4x4 view_proj = camera.ViewProjMatrix();
-		auto drl = Context::Instance().DeferredRenderingLayerInstance();
-		if (drl)
+		this->TrackMoveable(obj_index, (node->Attrib() & SceneNode::SOA_Moveable) != 0);
+		this->PlaceObj(obj_index, this->FindCell(obj.aabb));
+	}
+
+	void OCTree::RemoveObj(uint32_t obj_index)
+	{
+		this->UnplaceObj(obj_index);
+		this->TrackMoveable(obj_index, false);
+
+		auto& obj = objs_[obj_index];
+		obj_lookup_.erase(obj.node);
+		obj.node = nullptr;
+		free_obj_indices_.push_back(obj_index);
+	}
+
+	void OCTree::RelocateObj(uint32_t obj_index, AABBox const & aabb)
+	{
+		objs_[obj_index].aabb = aabb;
+
+		int const cell_index = this->FindCell(aabb);
+		if (cell_index != objs_[obj_index].cell_index)
 		{
-			int32_t cas_index = drl->CurrCascadeIndex();
-			if (cas_index >= 0)
+			this->UnplaceObj(obj_index);
+			this->PlaceObj(obj_index, cell_index);
+		}
+		else if (cell_index >= 0)
+		{
+			octree_[cell_index].obj_bbs.Box(objs_[obj_index].cell_slot, aabb);
+		}
+	}
+
+	void OCTree::PlaceObj(uint32_t obj_index, int cell_index)
+	{
+		auto& obj = objs_[obj_index];
+		obj.cell_index = cell_index;
+		if (cell_index >= 0)
+		{
+			auto& cell = octree_[cell_index];
+			obj.cell_slot = static_cast<uint32_t>(cell.obj_indices.size());
+			cell.obj_indices.push_back(obj_index);
+			cell.obj_bbs.push_back(obj.aabb);
+
+			for (int i = cell_index; i >= 0; i = octree_[i].parent_index)
 			{
-				view_proj *= drl->GetCascadedShadowLayer()->CascadeCropMatrix(cas_index);
+				++ octree_[i].num_subtree_objs;
 			}
 		}
+		else
+		{
+			obj.cell_slot = static_cast<uint32_t>(outside_obj_indices_.size());
+			outside_obj_indices_.push_back(obj_index);
+		}
+	}
+
+	void OCTree::UnplaceObj(uint32_t obj_index)
+	{
+		auto const & obj = objs_[obj_index];
+		int const cell_index = obj.cell_index;
+		auto& obj_indices = (cell_index >= 0) ? octree_[cell_index].obj_indices : outside_obj_indices_;
+
+		uint32_t const last_index = obj_indices.back();
+		obj_indices[obj.cell_slot] = last_index;
+		if (cell_index >= 0)
+		{
+			auto& obj_bbs = octree_[cell_index].obj_bbs;
+			obj_bbs.Box(obj.cell_slot, obj_bbs.Box(obj_bbs.size() - 1));
+			obj_bbs.pop_back();
+		}
+		objs_[last_index].cell_slot = obj.cell_slot;
+		obj_indices.pop_back();
+
+		for (int i = cell_index; i >= 0; i = octree_[i].parent_index)
+		{
+			BOOST_ASSERT(octree_[i].num_subtree_objs > 0);
+			-- octree_[i].num_subtree_objs;
+		}
+	}
+
+	void OCTree::TrackMoveable(uint32_t obj_index, bool moveable)
+	{
+		auto& obj = objs_[obj_index];
+		if (moveable && (INVALID_SLOT == obj.moveable_slot))
+		{
+			obj.moveable_slot = static_cast<uint32_t>(moveable_obj_indices_.size());
+			moveable_obj_indices_.push_back(obj_index);
+		}
+		else if (!moveable && (obj.moveable_slot != INVALID_SLOT))
+		{
+			uint32_t const last_index = moveable_obj_indices_.back();
+			moveable_obj_indices_[obj.moveable_slot] = last_index;
+			objs_[last_index].moveable_slot = obj.moveable_slot;
+			moveable_obj_indices_.pop_back();
+			obj.moveable_slot = INVALID_SLOT;
+		}
+	}
+
+	// Finds the deepest cell whose loose bound contains the AABB, creating cells on the way. Returns -1 if it's out of
+	// the root cell.
+	int OCTree::FindCell(AABBox const & aabb)
+	{
+		if (octree_.empty())
+		{
+			return -1;
+		}
+
+		float3 const center = aabb.Center();
+		float3 const half_size = aabb.HalfSize();
+		float const extent = std::max(std::max(std::max(half_size.x(), half_size.y()), half_size.z()), 0.0f);
+
+		float cell_half_size = octree_[0].bb.HalfSize().x();
+		if ((extent > cell_half_size) || !MathLib::intersect_point_aabb(center, octree_[0].bb))
+		{
+			return -1;
+		}
 
-		auto& octree_node = octree_[index];
-		if ((small_obj_threshold_ <= 0)
-			|| ((MathLib::ortho_area(camera.ForwardVec(), octree_node.bb) > small_obj_threshold_)
-				&& (MathLib::perspective_area(camera.EyePos(), view_proj, octree_node.bb) > small_obj_threshold_)))
+		int index = 0;
+		for (uint32_t depth = 1; (depth <= max_tree_depth_) && (extent <= cell_half_size * 0.5f); ++ depth)
 		{
-			BoundOverlap const vis = frustum_->Intersect(octree_node.bb);
-			octree_node.visible = vis;
-			if (BO_Partial == vis)
+			if (-1 == octree_[index].first_child_index)
 			{
-				if (octree_node.first_child_index != -1)
-				{
-					for (int i = 0; i < 8; ++ i)
-					{
-						this->NodeVisible(octree_node.first_child_index + i);
-					}
-				}
+				this->DivideCell(index);
 			}
+
+			float3 const cell_center = octree_[index].bb.Center();
+			int const child = (center.x() >= cell_center.x() ? 1 : 0)
+				+ (center.y() >= cell_center.y() ? 2 : 0)
+				+ (center.z() >= cell_center.z() ? 4 : 0);
+			index = octree_[index].first_child_index + child;
+			cell_half_size *= 0.5f;
 		}
-		else
+
+		return index;
+	}
+
+	void OCTree::DivideCell(size_t index)
+	{
+		size_t const this_size = octree_.size();
+		AABBox const parent_bb = octree_[index].bb;
+		float3 const parent_center = parent_bb.Center();
+		float3 const child_half_size = parent_bb.HalfSize() * 0.5f;
+		octree_[index].first_child_index = static_cast<int>(this_size);
+
+		octree_.resize(this_size + 8);
+		cell_bbs_.resize(this_size + 8);
+		for (size_t j = 0; j < 8; ++ j)
 		{
-			octree_node.visible = BO_No;
+			octree_node_t& new_node = octree_[this_size + j];
+			new_node.bb = AABBox(float3((j & 1) ? parent_center.x() : parent_bb.Min().x(),
+					(j & 2) ? parent_center.y() : parent_bb.Min().y(),
+					(j & 4) ? parent_center.z() : parent_bb.Min().z()),
+				float3((j & 1) ? parent_bb.Max().x() : parent_center.x(),
+					(j & 2) ? parent_bb.Max().y() : parent_center.y(),
+					(j & 4) ? parent_bb.Max().z() : parent_center.z()));
+			new_node.loose_bb = AABBox(new_node.bb.Min() - child_half_size, new_node.bb.Max() + child_half_size);
+			new_node.parent_index = static_cast<int>(index);
+			new_node.first_child_index = -1;
+			new_node.visible = BO_No;
+			new_node.num_subtree_objs = 0;
+
+			cell_bbs_.Box(this_size + j, new_node.loose_bb);
 		}
+	}
 
-#ifdef KLAYGE_DRAW_NODES
-		if ((vis != BO_No) && (-1 == node.first_child_index))
+	// The visibility of a cell is only valid if all its ancestors are BO_Partial. Otherwise the topmost non-partial
+	// ancestor decides.
+	BoundOverlap OCTree::CellVisible(int index) const
+	{
+		BoundOverlap visible = BO_Partial;
+		while (index >= 0)
 		{
-			checked_pointer_cast<NodeRenderable>(node_renderable_)->AddInstance(MathLib::scaling(node.bb.HalfSize()) * MathLib::translation(node.bb.Center()));
+			auto const & octree_node = octree_[index];
+			if (octree_node.visible != BO_Partial)
+			{
+				visible = octree_node.visible;
+			}
+			index = octree_node.parent_index;
 		}
-#endif
+		return visible;
 	}
 
-	void OCTree::MarkNodeObjs(size_t index, bool force)
+	// Tests cells [first, first + num) in one batch, then goes down into the partially visible ones. Siblings are
+	// contiguous, so all 8 children of a cell are tested together.
+	void OCTree::NodeVisible(size_t first, size_t num)
 	{
-		BOOST_ASSERT(index < octree_.size());
+		BOOST_ASSERT(first + num <= octree_.size());
+		BOOST_ASSERT(num <= 8);
+
+		std::array<BoundOverlap, 8> visibles;
+		cell_bbs_.Intersect(*frustum_, first, num, visibles.data());
 
 		App3DFramework& app = Context::Instance().AppInstance();
 		Camera& camera = app.ActiveCamera();
 
-		float4x4 view_proj = camera.ViewProjMatrix();
-		auto drl = Context::Instance().DeferredRenderingLayerInstance();
-		if (drl)
+		for (size_t i = 0; i < num; ++ i)
 		{
-			int32_t cas_index = drl->CurrCascadeIndex();
-			if (cas_index >= 0)
+			auto& octree_node = octree_[first + i];
+			if ((small_obj_threshold_ <= 0)
+				|| ((MathLib::ortho_area(camera.ForwardVec(), octree_node.loose_bb) > small_obj_threshold_)
+					&& (MathLib::perspective_area(camera.EyePos(), view_proj_, octree_node.loose_bb) > small_obj_threshold_)))
+			{
+				BoundOverlap const vis = visibles[i];
+				octree_node.visible = vis;
+				if ((BO_Partial == vis) && (octree_node.num_subtree_objs > 0))
+				{
+					if (octree_node.first_child_index != -1)
+					{
+						this->NodeVisible(octree_node.first_child_index, 8);
+					}
+				}
+			}
+			else
 			{
-				view_proj *= drl->GetCascadedShadowLayer()->CascadeCropMatrix(cas_index);
+				octree_node.visible = BO_No;
 			}
+
+#ifdef KLAYGE_DRAW_NODES
+			if ((vis != BO_No) && (-1 == node.first_child_index))
+			{
+				checked_pointer_cast<NodeRenderable>(node_renderable_)->AddInstance(MathLib::scaling(node.bb.HalfSize()) * MathLib::translation(node.bb.Center()));
+			}
+#endif
 		}
+	}
+
+	void OCTree::MarkNodeObjs(size_t index, bool force)
+	{
+		BOOST_ASSERT(index < octree_.size());
 
 		auto const & octree_node = octree_[index];
-		if ((octree_node.visible != BO_No) || force)
+		if (((octree_node.visible != BO_No) || force) && (octree_node.num_subtree_objs > 0))
 		{
-			for (auto* node : octree_node.node_ptrs)
+			App3DFramework& app = Context::Instance().AppInstance();
+			Camera const & camera = app.ActiveCamera();
+
+			size_t const num_objs = octree_node.obj_indices.size();
+			if (num_objs > 0)
 			{
-				if ((BO_No == node->VisibleMark()) && node->Visible())
+				// Objects in a fully visible cell are fully visible too. Otherwise test all of them in one batch.
+				bool const cell_partial = !force && (BO_Partial == octree_node.visible);
+				if (cell_partial)
 				{
-					auto visible = this->VisibleTestFromParent(*node, camera.ForwardVec(), camera.EyePos(), view_proj);
-					if (BO_Partial == visible)
-					{
-						AABBox const & aabb_ws = node->PosBoundWS();
-						if (node->Parent() || (small_obj_threshold_ <= 0)
-							|| ((MathLib::ortho_area(camera.ForwardVec(), octree_node.bb) > small_obj_threshold_)
-								&& (MathLib::perspective_area(camera.EyePos(), view_proj, aabb_ws) > small_obj_threshold_)))
-						{
-							visible = frustum_->Intersect(aabb_ws);
-						}
-						else
-						{
-							visible = BO_No;
-						}
-					}
-					node->VisibleMark(visible);
+					cull_results_.resize(num_objs);
+					octree_node.obj_bbs.Intersect(*frustum_, 0, num_objs, cull_results_.data());
+				}
 
-					if (visible != BO_No)
+				for (size_t i = 0; i < num_objs; ++ i)
+				{
+					auto const & obj = objs_[octree_node.obj_indices[i]];
+					if (INVALID_SLOT == obj.moveable_slot)
 					{
-						auto* override_node = node->Parent();
-						while ((override_node != nullptr) && (override_node->VisibleMark() == BO_No))
-						{
-							override_node->VisibleMark(BO_Partial);
-							override_node = override_node->Parent();
-						}
+						this->MarkObj(*obj.node, camera, cell_partial ? cull_results_[i] : BO_Yes);
 					}
 				}
 			}
@@ -433,6 +692,39 @@ namespace KlayGE
 		}
 	}
 
+	void OCTree::MarkObj(SceneNode& node, Camera const & camera, BoundOverlap frustum_visible)
+	{
+		if ((BO_No == node.VisibleMark()) && node.Visible())
+		{
+			auto visible = this->VisibleTestFromParent(node, camera.ForwardVec(), camera.EyePos(), view_proj_);
+			if (BO_Partial == visible)
+			{
+				AABBox const & aabb_ws = node.PosBoundWS();
+				if (node.Parent() || (small_obj_threshold_ <= 0)
+					|| ((MathLib::ortho_area(camera.ForwardVec(), aabb_ws) > small_obj_threshold_)
+						&& (MathLib::perspective_area(camera.EyePos(), view_proj_, aabb_ws) > small_obj_threshold_)))
+				{
+					visible = frustum_visible;
+				}
+				else
+				{
+					visible = BO_No;
+				}
+			}
+			node.VisibleMark(visible);
+
+			if (visible != BO_No)
+			{
+				auto* override_node = node.Parent();
+				while ((override_node != nullptr) && (override_node->VisibleMark() == BO_No))
+				{
+					override_node->VisibleMark(BO_Partial);
+					override_node = override_node->Parent();
+				}
+			}
+		}
+	}
+
 	BoundOverlap OCTree::AABBVisible(AABBox const & aabb) const
 	{
 		// Frustum VS node
@@ -541,7 +833,7 @@ namespace KlayGE
 			{
 				BOOST_ASSERT(BO_Partial == node.visible);
 
-				if (node.first_child_index != -1)
+				if ((node.first_child_index != -1) && (node.num_subtree_objs > 0))
 				{
 					float3 const center = node.bb.Center();
 					int mark[6];
@@ -594,7 +886,7 @@ namespace KlayGE
 			{
 				BOOST_ASSERT(BO_Partial == node.visible);
 
-				if (node.first_child_index != -1)
+				if ((node.first_child_index != -1) && (node.num_subtree_objs > 0))
 				{
 					for (int i = 0; i < 8; ++ i)
 					{
@@ -634,7 +926,7 @@ namespace KlayGE
 			{
 				BOOST_ASSERT(BO_Partial == node.visible);
 
-				if (node.first_child_index != -1)
+				if ((node.first_child_index != -1) && (node.num_subtree_objs > 0))
 				{
 					for (int i = 0; i < 8; ++ i)
 					{
@@ -674,7 +966,7 @@ namespace KlayGE
 			{
 				BOOST_ASSERT(BO_Partial == node.visible);
 
-				if (node.first_child_index != -1)
+				if ((node.first_child_index != -1) && (node.num_subtree_objs > 0))
 				{
 					for (int i = 0; i < 8; ++ i)
 					{
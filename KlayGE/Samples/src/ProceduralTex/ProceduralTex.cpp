@@ -212,7 +212,8 @@ uint32_t ProceduralTexApp::DoUpdate(uint32_t /*pass*/)
 			polygon_model_ = SyncLoadModel("teapot.glb", EAH_GPU_Read | EAH_Immutable,
 				SceneNode::SOA_Cullable, AddToSceneRootHelper,
 				CreateModelFactory<RenderModel>, CreateMeshFactory<RenderPolygon>);
-			polygon_model_->RootNode()->OnSubThreadUpdate().Connect([this](float app_time, float elapsed_time)
+			// Effect parameters are render state, so they're updated on the main thread
+			polygon_model_->RootNode()->OnMainThreadUpdate().Connect([this](float app_time, float elapsed_time)
 				{
 					KFL_UNUSED(elapsed_time);
 
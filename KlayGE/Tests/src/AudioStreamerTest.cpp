@@ -0,0 +1,284 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KlayGE/Audio.hpp>
+#include <KlayGE/AudioDataSource.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "KlayGETests.hpp"
+
+using namespace KlayGE;
+
+namespace
+{
+	uint8_t Pattern(uint32_t id, size_t i)
+	{
+		return static_cast<uint8_t>((id * 31 + i) & 0xFF);
+	}
+
+	// 8-bit mono, every byte is derived from the source id and its offset
+	class PatternAudioDataSource : public AudioDataSource
+	{
+	public:
+		PatternAudioDataSource(uint32_t id, size_t size)
+			: id_(id), size_(size), pos_(0)
+		{
+			format_ = AF_Mono8;
+			freq_ = 2000;
+		}
+
+		void Open(ResIdentifierPtr const & file) override
+		{
+			KFL_UNUSED(file);
+		}
+
+		void Close() override
+		{
+		}
+
+		size_t Size() override
+		{
+			return size_;
+		}
+
+		size_t Read(void* data, size_t size) override
+		{
+			size = std::min(size, size_ - pos_);
+			uint8_t* p = static_cast<uint8_t*>(data);
+			for (size_t i = 0; i < size; ++ i)
+			{
+				p[i] = Pattern(id_, pos_ + i);
+			}
+			pos_ += size;
+			return size;
+		}
+
+		void Reset() override
+		{
+			pos_ = 0;
+		}
+
+	private:
+		uint32_t id_;
+		size_t size_;
+		size_t pos_;
+	};
+
+	// Stands in for a device, one buffer is consumed each update
+	class RecordingMusicBuffer : public MusicBuffer
+	{
+	public:
+		RecordingMusicBuffer(AudioDataSourcePtr const & data_source, AudioStreamer& streamer, std::chrono::milliseconds interval)
+			: MusicBuffer(data_source, 1, &streamer),
+				interval_(interval), playing_(false), num_updates_(0)
+		{
+			this->Reset();
+		}
+
+		~RecordingMusicBuffer() override
+		{
+			this->Stop();
+		}
+
+		void Volume(float vol) override
+		{
+			KFL_UNUSED(vol);
+		}
+
+		bool IsPlaying() const override
+		{
+			return playing_;
+		}
+
+		float3 Position() const override
+		{
+			return float3::Zero();
+		}
+		void Position(float3 const & v) override
+		{
+			KFL_UNUSED(v);
+		}
+		float3 Velocity() const override
+		{
+			return float3::Zero();
+		}
+		void Velocity(float3 const & v) override
+		{
+			KFL_UNUSED(v);
+		}
+		float3 Direction() const override
+		{
+			return float3::Zero();
+		}
+		void Direction(float3 const & v) override
+		{
+			KFL_UNUSED(v);
+		}
+
+		std::vector<uint8_t> const & Received() const
+		{
+			return received_;
+		}
+
+		std::vector<std::thread::id> const & UpdateThreads() const
+		{
+			return update_threads_;
+		}
+
+		uint32_t NumUpdates() const
+		{
+			return num_updates_;
+		}
+
+	private:
+		void DoReset() override
+		{
+			this->ResetDecoded();
+		}
+
+		void DoPlay(bool loop) override
+		{
+			KFL_UNUSED(loop);
+			playing_ = true;
+		}
+
+		void DoStop() override
+		{
+			playing_ = false;
+		}
+
+		bool DoUpdate(std::chrono::milliseconds& next_update) override
+		{
+			update_threads_.push_back(std::this_thread::get_id());
+			++ num_updates_;
+
+			size_t const offset = received_.size();
+			received_.resize(offset + buffer_size_);
+			received_.resize(offset + this->ReadDecoded(&received_[offset], buffer_size_));
+			if (this->EndOfStream())
+			{
+				playing_ = false;
+				return false;
+			}
+
+			next_update = interval_;
+			return true;
+		}
+
+	private:
+		std::chrono::milliseconds interval_;
+		std::atomic<bool> playing_;
+		std::atomic<uint32_t> num_updates_;
+
+		std::vector<uint8_t> received_;
+		std::vector<std::thread::id> update_threads_;
+	};
+
+	bool WaitFor(std::function<bool()> const & pred)
+	{
+		auto const end = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+		while (!pred())
+		{
+			if (std::chrono::steady_clock::now() > end)
+			{
+				return false;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		return true;
+	}
+}
+
+TEST(AudioStreamerTest, ManyBuffersOneThread)
+{
+	uint32_t const NUM_BUFFERS = 32;
+	size_t const SOURCE_SIZE = 10007;
+
+	AudioStreamer streamer;
+	std::vector<std::unique_ptr<RecordingMusicBuffer>> buffers;
+	for (uint32_t i = 0; i < NUM_BUFFERS; ++ i)
+	{
+		buffers.push_back(MakeUniquePtr<RecordingMusicBuffer>(MakeSharedPtr<PatternAudioDataSource>(i, SOURCE_SIZE),
+			streamer, std::chrono::milliseconds(1 + i % 3)));
+	}
+	for (auto const & buffer : buffers)
+	{
+		buffer->Play();
+	}
+
+	ASSERT_TRUE(WaitFor([&streamer] { return 0 == streamer.NumBuffers(); }));
+
+	std::thread::id const update_thread = buffers[0]->UpdateThreads()[0];
+	EXPECT_NE(update_thread, std::this_thread::get_id());
+	for (uint32_t i = 0; i < NUM_BUFFERS; ++ i)
+	{
+		EXPECT_FALSE(buffers[i]->IsPlaying());
+
+		for (auto const & id : buffers[i]->UpdateThreads())
+		{
+			EXPECT_EQ(id, update_thread);
+		}
+
+		auto const & received = buffers[i]->Received();
+		ASSERT_EQ(received.size(), SOURCE_SIZE);
+		for (size_t j = 0; j < received.size(); ++ j)
+		{
+			if (received[j] != Pattern(i, j))
+			{
+				ADD_FAILURE() << "Buffer " << i << " is wrong at byte " << j;
+				break;
+			}
+		}
+	}
+}
+
+TEST(AudioStreamerTest, LoopWithoutGap)
+{
+	size_t const SOURCE_SIZE = 3001;
+
+	AudioStreamer streamer;
+	RecordingMusicBuffer buffer(MakeSharedPtr<PatternAudioDataSource>(7, SOURCE_SIZE), streamer, std::chrono::milliseconds(1));
+	buffer.Play(true);
+
+	ASSERT_TRUE(WaitFor([&buffer] { return buffer.NumUpdates() > 10; }));
+	buffer.Stop();
+	EXPECT_EQ(streamer.NumBuffers(), 0U);
+	EXPECT_FALSE(buffer.IsPlaying());
+
+	// Wraps around in the middle of a device buffer, without dropping anything
+	auto const & received = buffer.Received();
+	ASSERT_GT(received.size(), SOURCE_SIZE * 3);
+	for (size_t j = 0; j < received.size(); ++ j)
+	{
+		if (received[j] != Pattern(7, j % SOURCE_SIZE))
+		{
+			ADD_FAILURE() << "Wrong at byte " << j;
+			break;
+		}
+	}
+}
+
+TEST(AudioStreamerTest, WakeUpdatesEarly)
+{
+	AudioStreamer streamer;
+	RecordingMusicBuffer buffer(MakeSharedPtr<PatternAudioDataSource>(3, 100000), streamer, std::chrono::hours(1));
+	buffer.Play();
+
+	// The first update comes right after playing, and the next one not before an hour, unless it's woken up
+	ASSERT_TRUE(WaitFor([&buffer] { return buffer.NumUpdates() == 1; }));
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	EXPECT_EQ(buffer.NumUpdates(), 1U);
+
+	for (uint32_t i = 2; i <= 5; ++ i)
+	{
+		streamer.Wake(buffer);
+		ASSERT_TRUE(WaitFor([&buffer, i] { return buffer.NumUpdates() == i; }));
+	}
+
+	buffer.Stop();
+}
@@ -0,0 +1,248 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Half.hpp>
+#include <KFL/Math.hpp>
+#include <KFL/Timer.hpp>
+#include <KlayGE/ElementFormat.hpp>
+
+#include "KlayGETests.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace KlayGE;
+
+namespace
+{
+	bool SameBits(float lhs, float rhs)
+	{
+		return std::memcmp(&lhs, &rhs, sizeof(lhs)) == 0;
+	}
+
+	bool SameBits(Color const & lhs, Color const & rhs)
+	{
+		return std::memcmp(&lhs, &rhs, sizeof(lhs)) == 0;
+	}
+
+	std::vector<uint8_t> RandomBytes(size_t num, uint32_t seed)
+	{
+		std::ranlux24_base gen(seed);
+		std::vector<uint8_t> ret(num);
+		for (auto& b : ret)
+		{
+			b = static_cast<uint8_t>(gen());
+		}
+		return ret;
+	}
+
+	float SmallFloatValue(uint32_t bits, uint32_t mantissa_bits)
+	{
+		uint32_t const exponent = bits >> mantissa_bits;
+		uint32_t const mantissa = bits & ((1UL << mantissa_bits) - 1);
+		float const fraction = static_cast<float>(mantissa) / (1UL << mantissa_bits);
+		if (0 == exponent)
+		{
+			return std::ldexp(fraction, -14);
+		}
+		else
+		{
+			return std::ldexp(1 + fraction, static_cast<int>(exponent) - 15);
+		}
+	}
+}
+
+TEST(ElementFormatTest, UNorm8ToFloat)
+{
+	auto const bytes = RandomBytes(4 * 1027, 0);
+	uint32_t const num_texels = static_cast<uint32_t>(bytes.size() / 4);
+
+	std::vector<Color> abgr(num_texels);
+	std::vector<Color> argb(num_texels);
+	ConvertToABGR32F(EF_ABGR8, bytes.data(), num_texels, abgr.data());
+	ConvertToABGR32F(EF_ARGB8, bytes.data(), num_texels, argb.data());
+	for (uint32_t i = 0; i < num_texels; ++ i)
+	{
+		uint8_t const * p = &bytes[i * 4];
+		EXPECT_TRUE(SameBits(abgr[i], Color(p[0] / 255.0f, p[1] / 255.0f, p[2] / 255.0f, p[3] / 255.0f)));
+		EXPECT_TRUE(SameBits(argb[i], Color(p[2] / 255.0f, p[1] / 255.0f, p[0] / 255.0f, p[3] / 255.0f)));
+	}
+
+	std::vector<Color> gr(num_texels * 2);
+	ConvertToABGR32F(EF_GR8, bytes.data(), num_texels * 2, gr.data());
+	for (uint32_t i = 0; i < num_texels * 2; ++ i)
+	{
+		EXPECT_TRUE(SameBits(gr[i], Color(bytes[i * 2 + 0] / 255.0f, bytes[i * 2 + 1] / 255.0f, 0, 1)));
+	}
+
+	for (uint32_t i = 0; i < 256; ++ i)
+	{
+		uint8_t const byte = static_cast<uint8_t>(i);
+		Color r;
+		ConvertToABGR32F(EF_R8, &byte, 1, &r);
+		EXPECT_TRUE(SameBits(r, Color(byte / 255.0f, 0, 0, 1)));
+
+		uint8_t const texel[] = { byte, byte, byte, byte };
+		Color srgb;
+		ConvertToABGR32F(EF_ABGR8_SRGB, texel, 1, &srgb);
+		EXPECT_TRUE(SameBits(srgb.r(), MathLib::srgb_to_linear(byte / 255.0f)));
+		EXPECT_TRUE(SameBits(srgb.a(), MathLib::srgb_to_linear(byte / 255.0f)));
+	}
+}
+
+TEST(ElementFormatTest, FloatToUNorm8)
+{
+	std::ranlux24_base gen(1);
+	std::uniform_real_distribution<float> dis(-0.5f, 1.5f);
+
+	uint32_t const NUM_TEXELS = 1027;
+	std::vector<Color> input(NUM_TEXELS);
+	for (uint32_t i = 0; i < NUM_TEXELS; ++ i)
+	{
+		// Every exact step, plus random values out of [0, 1] to hit the clamp
+		input[i] = (i < 256) ? Color(i / 255.0f, (i + 0.5f) / 255.0f, (255 - i) / 255.0f, (i - 0.5f) / 255.0f)
+			: Color(dis(gen), dis(gen), dis(gen), dis(gen));
+	}
+
+	auto encode = [](float v)
+	{
+		return static_cast<uint8_t>(MathLib::clamp(static_cast<int>(v * 255.0f + 0.5f), 0, 255));
+	};
+
+	std::vector<uint8_t> abgr(NUM_TEXELS * 4);
+	std::vector<uint8_t> argb(NUM_TEXELS * 4);
+	ConvertFromABGR32F(EF_ABGR8, input.data(), NUM_TEXELS, abgr.data());
+	ConvertFromABGR32F(EF_ARGB8, input.data(), NUM_TEXELS, argb.data());
+	for (uint32_t i = 0; i < NUM_TEXELS; ++ i)
+	{
+		EXPECT_EQ(abgr[i * 4 + 0], encode(input[i].r()));
+		EXPECT_EQ(abgr[i * 4 + 1], encode(input[i].g()));
+		EXPECT_EQ(abgr[i * 4 + 2], encode(input[i].b()));
+		EXPECT_EQ(abgr[i * 4 + 3], encode(input[i].a()));
+
+		EXPECT_EQ(argb[i * 4 + 0], encode(input[i].b()));
+		EXPECT_EQ(argb[i * 4 + 1], encode(input[i].g()));
+		EXPECT_EQ(argb[i * 4 + 2], encode(input[i].r()));
+		EXPECT_EQ(argb[i * 4 + 3], encode(input[i].a()));
+	}
+}
+
+TEST(ElementFormatTest, FloatFormatsToFloat)
+{
+	for (uint32_t i = 0; i < 65536; ++ i)
+	{
+		uint16_t const bits = static_cast<uint16_t>(i);
+		half const h = half::from_bits(bits);
+
+		Color clr;
+		ConvertToABGR32F(EF_R16F, &bits, 1, &clr);
+		EXPECT_TRUE(SameBits(clr.r(), static_cast<float>(h)));
+	}
+
+	// Finite values only, every exponent and mantissa of the 3 channels
+	for (uint32_t i = 0; i < 0x1F << 6; ++ i)
+	{
+		uint32_t const b = i & 0x3FF;
+		uint32_t const texel = i | ((0x7BF - i) << 11) | (b << 22);
+		if ((b >> 5) == 0x1F)
+		{
+			continue;
+		}
+
+		Color clr;
+		ConvertToABGR32F(EF_B10G11R11F, &texel, 1, &clr);
+		EXPECT_EQ(clr.r(), SmallFloatValue(i, 6));
+		EXPECT_EQ(clr.g(), SmallFloatValue(0x7BF - i, 6));
+		EXPECT_EQ(clr.b(), SmallFloatValue(b, 5));
+		EXPECT_EQ(clr.a(), 1);
+	}
+}
+
+TEST(ElementFormatTest, ConvertFormatMatchesFloatPath)
+{
+	ElementFormat const formats[] = { EF_A8, EF_R8, EF_GR8, EF_BGR8, EF_ARGB8, EF_ABGR8, EF_ARGB8_SRGB, EF_ABGR8_SRGB,
+		EF_R16F, EF_ABGR16F, EF_B10G11R11F, EF_ABGR32F };
+	uint32_t const NUM_TEXELS = 300;
+
+	for (auto src_fmt : formats)
+	{
+		auto input = RandomBytes(NUM_TEXELS * NumFormatBytes(src_fmt), src_fmt);
+		if (IsFloatFormat(src_fmt))
+		{
+			// Random bits make NaNs, which don't have to survive a round trip
+			std::vector<Color> clrs(NUM_TEXELS);
+			ConvertToABGR32F(EF_ABGR8, RandomBytes(NUM_TEXELS * 4, src_fmt).data(), NUM_TEXELS, clrs.data());
+			ConvertFromABGR32F(src_fmt, clrs.data(), NUM_TEXELS, input.data());
+		}
+
+		std::vector<Color> clrs(NUM_TEXELS);
+		ConvertToABGR32F(src_fmt, input.data(), NUM_TEXELS, clrs.data());
+
+		for (auto dst_fmt : formats)
+		{
+			std::vector<uint8_t> expected(NUM_TEXELS * NumFormatBytes(dst_fmt));
+			std::vector<uint8_t> output(expected.size());
+			ConvertFromABGR32F(dst_fmt, clrs.data(), NUM_TEXELS, expected.data());
+			ConvertFormat(src_fmt, dst_fmt, input.data(), NUM_TEXELS, output.data());
+			EXPECT_TRUE(output == expected);
+		}
+	}
+}
+
+TEST(ElementFormatTest, Benchmark)
+{
+	uint32_t const NUM_TEXELS = 4 * 1024 * 1024;
+	uint32_t const NUM_ITERATIONS = 5;
+
+	auto const input = RandomBytes(NUM_TEXELS * 4, 2);
+	std::vector<Color> clrs(NUM_TEXELS);
+	std::vector<uint8_t> output(NUM_TEXELS * 4);
+
+	struct Case
+	{
+		char const * name;
+		ElementFormat fmt;
+	};
+	Case const cases[] = { { "ARGB8", EF_ARGB8 }, { "ABGR8", EF_ABGR8 }, { "ARGB8_SRGB", EF_ARGB8_SRGB }, { "R8", EF_R8 },
+		{ "GR8", EF_GR8 }, { "R16F", EF_R16F }, { "ABGR16F", EF_ABGR16F }, { "B10G11R11F", EF_B10G11R11F } };
+	for (auto const & c : cases)
+	{
+		uint32_t const num_texels = NUM_TEXELS * 4 / NumFormatBytes(c.fmt) / 4;
+
+		Timer timer;
+		for (uint32_t i = 0; i < NUM_ITERATIONS; ++ i)
+		{
+			ConvertToABGR32F(c.fmt, input.data(), num_texels, clrs.data());
+		}
+		double const to_time = timer.elapsed() / NUM_ITERATIONS;
+
+		timer.restart();
+		for (uint32_t i = 0; i < NUM_ITERATIONS; ++ i)
+		{
+			ConvertFromABGR32F(c.fmt, clrs.data(), num_texels, output.data());
+		}
+		double const from_time = timer.elapsed() / NUM_ITERATIONS;
+
+		std::cout << c.name << ": to ABGR32F " << num_texels / to_time / 1e6 << " MTexel/s, from ABGR32F "
+			<< num_texels / from_time / 1e6 << " MTexel/s" << std::endl;
+	}
+
+	Timer timer;
+	for (uint32_t i = 0; i < NUM_ITERATIONS; ++ i)
+	{
+		ConvertFormat(EF_ARGB8, EF_ABGR8, input.data(), NUM_TEXELS, output.data());
+	}
+	double const direct_time = timer.elapsed() / NUM_ITERATIONS;
+
+	timer.restart();
+	for (uint32_t i = 0; i < NUM_ITERATIONS; ++ i)
+	{
+		ConvertToABGR32F(EF_ARGB8, input.data(), NUM_TEXELS, clrs.data());
+		ConvertFromABGR32F(EF_ABGR8, clrs.data(), NUM_TEXELS, output.data());
+	}
+	double const float_time = timer.elapsed() / NUM_ITERATIONS;
+
+	std::cout << "ARGB8 -> ABGR8: ConvertFormat " << NUM_TEXELS / direct_time / 1e6 << " MTexel/s, through ABGR32F "
+		<< NUM_TEXELS / float_time / 1e6 << " MTexel/s" << std::endl;
+}
@@ -5,25 +5,23 @@
 #include <KlayGE/Texture.hpp>
 #include <KlayGE/ResLoader.hpp>
 #include <KFL/Half.hpp>
+#include <KFL/Timer.hpp>
 
+#include <algorithm>
+#include <cstring>
 #include <vector>
 #include <string>
 #include <iostream>
+#include <random>
+#include <thread>
 
 #include "KlayGETests.hpp"
 
 using namespace std;
 using namespace KlayGE;
 
-void TestEncodeDecodeTex(std::string_view input_name, std::string_view tc_name,
-		ElementFormat bc_fmt, float threshold)
+std::unique_ptr<TexCompression> CreateTexCodec(ElementFormat bc_fmt)
 {
-	ResLoader::Instance().AddPath("../../Tests/media/EncodeDecodeTex");
-
-	std::vector<uint8_t> input_argb;
-	std::vector<uint8_t> bc_blocks;
-	uint32_t width, height;
-
 	std::unique_ptr<TexCompression> codec;
 	switch (bc_fmt)
 	{
@@ -39,6 +37,14 @@ void TestEncodeDecodeTex(std::string_view input_name, std::string_view tc_name,
 		codec = MakeUniquePtr<TexCompressionBC3>();
 		break;
 
+	case EF_BC4:
+		codec = MakeUniquePtr<TexCompressionBC4>();
+		break;
+
+	case EF_BC5:
+		codec = MakeUniquePtr<TexCompressionBC5>();
+		break;
+
 	case EF_BC6:
 		codec = MakeUniquePtr<TexCompressionBC6U>();
 		break;
@@ -55,10 +61,28 @@ void TestEncodeDecodeTex(std::string_view input_name, std::string_view tc_name,
 		codec = MakeUniquePtr<TexCompressionETC1>();
 		break;
 
+	case EF_ETC2_BGR8:
+		codec = MakeUniquePtr<TexCompressionETC2RGB8>();
+		break;
+
 	default:
 		KFL_UNREACHABLE("Unsupported compression format");
 	}
 
+	return codec;
+}
+
+void TestEncodeDecodeTex(std::string_view input_name, std::string_view tc_name,
+		ElementFormat bc_fmt, float threshold)
+{
+	ResLoader::Instance().AddPath("../../Tests/media/EncodeDecodeTex");
+
+	std::vector<uint8_t> input_argb;
+	std::vector<uint8_t> bc_blocks;
+	uint32_t width, height;
+
+	std::unique_ptr<TexCompression> codec = CreateTexCodec(bc_fmt);
+
 	ElementFormat const decoded_fmt = DecodedFormat(bc_fmt);
 	uint32_t const pixel_size = NumFormatBytes(decoded_fmt);
 
@@ -293,3 +317,199 @@ TEST(EncodeDecodeTexTest, EncodeDecodeETC1)
 {
 	TestEncodeDecodeTex("Lenna.dds", "", EF_ETC1, 4.8f);
 }
+
+void LoadARGB8Tex(std::string_view input_name, uint32_t max_height,
+		std::vector<uint8_t>& input_argb, uint32_t& width, uint32_t& height)
+{
+	ResLoader::Instance().AddPath("../../Tests/media/EncodeDecodeTex");
+
+	TexturePtr in_tex = LoadSoftwareTexture(input_name);
+	width = in_tex->Width(0);
+	height = std::min(in_tex->Height(0), max_height);
+	auto const & init_data = checked_cast<SoftwareTexture*>(in_tex.get())->SubresourceData();
+
+	BOOST_ASSERT(4 == NumFormatBytes(in_tex->Format()));
+
+	input_argb.resize(width * height * 4);
+	uint8_t const * src = static_cast<uint8_t const *>(init_data[0].data);
+	for (uint32_t y = 0; y < height; ++ y)
+	{
+		memcpy(&input_argb[y * width * 4], src, width * 4);
+		src += init_data[0].row_pitch;
+	}
+}
+
+void TestParallelEncodeDecodeMem(std::string_view input_name, ElementFormat bc_fmt, TexCompressionMethod method)
+{
+	std::vector<uint8_t> input_argb;
+	uint32_t width, height;
+	LoadARGB8Tex(input_name, 64, input_argb, width, height);
+
+	uint32_t const block_width = BlockWidth(bc_fmt);
+	uint32_t const block_height = BlockHeight(bc_fmt);
+	uint32_t const block_bytes = BlockBytes(bc_fmt);
+	uint32_t const blocks_row_pitch = (width + block_width - 1) / block_width * block_bytes;
+	uint32_t const blocks_slice_pitch = (height + block_height - 1) / block_height * blocks_row_pitch;
+
+	std::vector<uint8_t> serial_blocks(blocks_slice_pitch);
+	std::vector<uint8_t> parallel_blocks(blocks_slice_pitch);
+	std::vector<uint8_t> serial_argb(input_argb.size());
+	std::vector<uint8_t> parallel_argb(input_argb.size());
+
+	std::unique_ptr<TexCompression> codec = CreateTexCodec(bc_fmt);
+
+	codec->NumThreads(1);
+	codec->EncodeMem(width, height, &serial_blocks[0], blocks_row_pitch, blocks_slice_pitch,
+		&input_argb[0], width * 4, width * height * 4, method);
+	codec->DecodeMem(width, height, &serial_argb[0], width * 4, width * height * 4,
+		&serial_blocks[0], blocks_row_pitch, blocks_slice_pitch);
+
+	codec->NumThreads(std::max(4U, std::thread::hardware_concurrency()));
+	codec->EncodeMem(width, height, &parallel_blocks[0], blocks_row_pitch, blocks_slice_pitch,
+		&input_argb[0], width * 4, width * height * 4, method);
+	codec->DecodeMem(width, height, &parallel_argb[0], width * 4, width * height * 4,
+		&parallel_blocks[0], blocks_row_pitch, blocks_slice_pitch);
+
+	EXPECT_EQ(0, memcmp(&serial_blocks[0], &parallel_blocks[0], serial_blocks.size()));
+	EXPECT_EQ(0, memcmp(&serial_argb[0], &parallel_argb[0], serial_argb.size()));
+}
+
+TEST(EncodeDecodeTexTest, ParallelEncodeDecodeMemBC1)
+{
+	TestParallelEncodeDecodeMem("Lenna.dds", EF_BC1, TCM_Balanced);
+}
+
+TEST(EncodeDecodeTexTest, ParallelEncodeDecodeMemBC3)
+{
+	TestParallelEncodeDecodeMem("leaf_v3_green_tex.dds", EF_BC3, TCM_Balanced);
+}
+
+TEST(EncodeDecodeTexTest, ParallelEncodeDecodeMemBC7)
+{
+	TestParallelEncodeDecodeMem("leaf_v3_green_tex.dds", EF_BC7, TCM_Speed);
+}
+
+TEST(EncodeDecodeTexTest, ParallelEncodeDecodeMemETC1)
+{
+	TestParallelEncodeDecodeMem("Lenna.dds", EF_ETC1, TCM_Balanced);
+}
+
+TEST(EncodeDecodeTexTest, EncodeDecodeMemBenchmark)
+{
+	std::vector<uint8_t> input_argb;
+	uint32_t width, height;
+	LoadARGB8Tex("Lenna.dds", 0xFFFFFFFFU, input_argb, width, height);
+
+	uint32_t const hw_threads = std::max(1U, std::thread::hardware_concurrency());
+	uint32_t const thread_counts[] = { 1, std::min(4U, hw_threads), hw_threads };
+
+	for (auto bc_fmt : { EF_BC1, EF_BC3, EF_BC7, EF_ETC1, EF_ETC2_BGR8 })
+	{
+		uint32_t const block_width = BlockWidth(bc_fmt);
+		uint32_t const block_height = BlockHeight(bc_fmt);
+		uint32_t const blocks_row_pitch = (width + block_width - 1) / block_width * BlockBytes(bc_fmt);
+		uint32_t const blocks_slice_pitch = (height + block_height - 1) / block_height * blocks_row_pitch;
+
+		std::vector<uint8_t> blocks(blocks_slice_pitch);
+		std::vector<uint8_t> restored_argb(input_argb.size());
+
+		std::unique_ptr<TexCompression> codec = CreateTexCodec(bc_fmt);
+		for (uint32_t num_threads : thread_counts)
+		{
+			codec->NumThreads(num_threads);
+
+			Timer timer;
+			codec->EncodeMem(width, height, &blocks[0], blocks_row_pitch, blocks_slice_pitch,
+				&input_argb[0], width * 4, width * height * 4, TCM_Speed);
+			double const encode_time = timer.elapsed();
+
+			timer.restart();
+			codec->DecodeMem(width, height, &restored_argb[0], width * 4, width * height * 4,
+				&blocks[0], blocks_row_pitch, blocks_slice_pitch);
+			double const decode_time = timer.elapsed();
+
+			double const mpix = width * height / 1e6;
+			std::cout << "Format " << static_cast<uint64_t>(bc_fmt) << ", " << num_threads << " thread(s): encode "
+				<< mpix / std::max(encode_time, 1e-9) << " MPix/s, decode "
+				<< mpix / std::max(decode_time, 1e-9) << " MPix/s" << std::endl;
+		}
+	}
+}
+
+void TestDecodeBlocks(ElementFormat bc_fmt)
+{
+	uint32_t const NUM_BLOCKS = 37;
+
+	std::unique_ptr<TexCompression> codec = CreateTexCodec(bc_fmt);
+
+	uint32_t const block_width = BlockWidth(bc_fmt);
+	uint32_t const block_height = BlockHeight(bc_fmt);
+	uint32_t const block_bytes = BlockBytes(bc_fmt);
+	uint32_t const elem_size = NumFormatBytes(DecodedFormat(bc_fmt));
+	uint32_t const block_row_bytes = block_width * elem_size;
+	uint32_t const out_row_pitch = NUM_BLOCKS * block_row_bytes + 12;
+
+	std::ranlux24_base gen;
+	std::uniform_int_distribution<uint32_t> dis(0, 255);
+
+	std::vector<uint8_t> blocks(NUM_BLOCKS * block_bytes);
+	std::vector<uint8_t> expected(block_height * out_row_pitch);
+	std::vector<uint8_t> batch_decoded(block_height * out_row_pitch);
+	std::vector<uint8_t> uncompressed(block_height * block_row_bytes);
+	for (uint32_t iter = 0; iter < 256; ++ iter)
+	{
+		for (auto& b : blocks)
+		{
+			b = static_cast<uint8_t>(dis(gen));
+		}
+		if ((iter & 1) && (bc_fmt != EF_BC4) && (bc_fmt != EF_BC5))
+		{
+			// Equal color endpoints, the corner case of the 3-color mode
+			uint32_t const bc1_offset = (EF_BC1 == bc_fmt) ? 0 : sizeof(BC4Block);
+			for (uint32_t i = 0; i < NUM_BLOCKS; ++ i)
+			{
+				memcpy(&blocks[i * block_bytes + bc1_offset], &blocks[i * block_bytes + bc1_offset + 2], 2);
+			}
+		}
+
+		for (uint32_t i = 0; i < NUM_BLOCKS; ++ i)
+		{
+			codec->DecodeBlock(&uncompressed[0], &blocks[i * block_bytes]);
+			for (uint32_t y = 0; y < block_height; ++ y)
+			{
+				memcpy(&expected[y * out_row_pitch + i * block_row_bytes], &uncompressed[y * block_row_bytes], block_row_bytes);
+			}
+		}
+
+		codec->DecodeBlocks(&batch_decoded[0], out_row_pitch, &blocks[0], NUM_BLOCKS);
+		for (uint32_t y = 0; y < block_height; ++ y)
+		{
+			EXPECT_EQ(0, memcmp(&expected[y * out_row_pitch], &batch_decoded[y * out_row_pitch], NUM_BLOCKS * block_row_bytes));
+		}
+	}
+}
+
+TEST(EncodeDecodeTexTest, DecodeBlocksBC1)
+{
+	TestDecodeBlocks(EF_BC1);
+}
+
+TEST(EncodeDecodeTexTest, DecodeBlocksBC2)
+{
+	TestDecodeBlocks(EF_BC2);
+}
+
+TEST(EncodeDecodeTexTest, DecodeBlocksBC3)
+{
+	TestDecodeBlocks(EF_BC3);
+}
+
+TEST(EncodeDecodeTexTest, DecodeBlocksBC4)
+{
+	TestDecodeBlocks(EF_BC4);
+}
+
+TEST(EncodeDecodeTexTest, DecodeBlocksBC5)
+{
+	TestDecodeBlocks(EF_BC5);
+}
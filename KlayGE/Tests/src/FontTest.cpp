@@ -0,0 +1,80 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Timer.hpp>
+#include <KlayGE/Context.hpp>
+#include <KlayGE/Font.hpp>
+#include <KlayGE/Renderable.hpp>
+#include <KlayGE/SceneManager.hpp>
+#include <KlayGE/SceneNode.hpp>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "KlayGETests.hpp"
+
+using namespace KlayGE;
+
+namespace
+{
+	// Renders what the fonts added to the overlay, the same way SceneManager does for a frame
+	void RenderOverlay()
+	{
+		auto& overlay_root = Context::Instance().SceneManagerInstance().OverlayRootNode();
+		if (!overlay_root.Children().empty())
+		{
+			// All the text nodes of a font share one renderable
+			overlay_root.Children().front()->GetRenderable()->Render();
+		}
+		overlay_root.ClearChildren();
+	}
+}
+
+TEST(FontTest, CJKGlyphCacheBenchmark)
+{
+	uint32_t const NUM_LINES = 100;
+	uint32_t const CHARS_PER_LINE = 100;
+	uint32_t const NUM_FRAMES = 10;
+	float const FONT_SIZE = 16;
+
+	auto font = SyncLoadFont("gkai00mp.kfont");
+	ASSERT_TRUE(font);
+
+	// 10000 distinct CJK Unified Ideographs. That's more than the atlas can hold, so every frame keeps evicting.
+	std::vector<std::wstring> lines(NUM_LINES);
+	for (uint32_t i = 0; i < NUM_LINES; ++ i)
+	{
+		for (uint32_t j = 0; j < CHARS_PER_LINE; ++ j)
+		{
+			lines[i].push_back(static_cast<wchar_t>(0x4E00 + i * CHARS_PER_LINE + j));
+		}
+	}
+
+	EXPECT_GT(font->CalcSize(lines[0], FONT_SIZE).cx(), 0);
+
+	Timer timer;
+	for (uint32_t frame = 0; frame < NUM_FRAMES; ++ frame)
+	{
+		for (uint32_t i = 0; i < NUM_LINES; ++ i)
+		{
+			font->RenderText(0, (i % 64) * FONT_SIZE, Color(1, 1, 1, 1), lines[i], FONT_SIZE);
+		}
+		RenderOverlay();
+	}
+	double const evicting_time = timer.elapsed();
+
+	// The same frame with only 1000 of them, after the first frame they all stay in the atlas
+	timer.restart();
+	for (uint32_t frame = 0; frame < NUM_FRAMES; ++ frame)
+	{
+		for (uint32_t i = 0; i < NUM_LINES / 10; ++ i)
+		{
+			font->RenderText(0, i * FONT_SIZE, Color(1, 1, 1, 1), lines[i], FONT_SIZE);
+		}
+		RenderOverlay();
+	}
+	double const cached_time = timer.elapsed();
+
+	std::cout << NUM_LINES * CHARS_PER_LINE << " distinct glyphs: " << evicting_time * 1000 / NUM_FRAMES << " ms/frame, "
+		<< NUM_LINES / 10 * CHARS_PER_LINE << " cached glyphs: " << cached_time * 1000 / NUM_FRAMES << " ms/frame"
+		<< std::endl;
+}
@@ -0,0 +1,139 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/AABBox.hpp>
+#include <KFL/AABBoxSoA.hpp>
+#include <KFL/Frustum.hpp>
+#include <KFL/Math.hpp>
+#include <KFL/Timer.hpp>
+
+#include "KlayGETests.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace KlayGE;
+
+namespace
+{
+	Frustum MakeTestFrustum()
+	{
+		float4x4 const view_proj = MathLib::look_at_lh(float3(0, 0, 0), float3(1, 0.3f, 0.2f))
+			* MathLib::perspective_fov_lh(PI / 4, 1.3f, 1.0f, 80.0f);
+
+		Frustum frustum;
+		frustum.ClipMatrix(view_proj, MathLib::inverse(view_proj));
+		return frustum;
+	}
+
+	std::vector<AABBox> MakeTestBoxes(size_t num)
+	{
+		std::ranlux24_base gen;
+		std::uniform_real_distribution<float> dis_center(-100, 100);
+		std::uniform_real_distribution<float> dis_extent(0.1f, 10);
+
+		std::vector<AABBox> aabbs;
+		aabbs.reserve(num);
+		for (size_t i = 0; i < num; ++ i)
+		{
+			float3 const center(dis_center(gen), dis_center(gen), dis_center(gen));
+			float3 const extent(dis_extent(gen), dis_extent(gen), dis_extent(gen));
+			aabbs.emplace_back(center - extent, center + extent);
+		}
+		return aabbs;
+	}
+}
+
+TEST(FrustumCullingTest, MatchesScalar)
+{
+	Frustum const frustum = MakeTestFrustum();
+	std::vector<AABBox> const aabbs = MakeTestBoxes(10007);
+
+	AABBoxSoA aabbs_soa;
+	for (auto const & aabb : aabbs)
+	{
+		aabbs_soa.push_back(aabb);
+	}
+	EXPECT_EQ(aabbs_soa.size(), aabbs.size());
+
+	std::vector<BoundOverlap> results(aabbs.size());
+	aabbs_soa.Intersect(frustum, 0, aabbs.size(), results.data());
+
+	uint32_t num_overlaps[3] = { 0, 0, 0 };
+	for (size_t i = 0; i < aabbs.size(); ++ i)
+	{
+		EXPECT_EQ(results[i], frustum.Intersect(aabbs[i]));
+		++ num_overlaps[results[i]];
+	}
+	EXPECT_GT(num_overlaps[BO_Yes], 0U);
+	EXPECT_GT(num_overlaps[BO_No], 0U);
+	EXPECT_GT(num_overlaps[BO_Partial], 0U);
+
+	// Unaligned ranges
+	for (size_t first : { 1, 2, 3, 5 })
+	{
+		size_t const num = 4097 - first;
+		aabbs_soa.Intersect(frustum, first, num, results.data());
+		for (size_t i = 0; i < num; ++ i)
+		{
+			EXPECT_EQ(results[i], frustum.Intersect(aabbs[first + i]));
+		}
+	}
+
+	// Swap-pop removal keeps the arrays consistent
+	aabbs_soa.Box(0, aabbs_soa.Box(aabbs_soa.size() - 1));
+	aabbs_soa.pop_back();
+	EXPECT_TRUE(aabbs_soa.Box(0) == aabbs.back());
+	EXPECT_EQ(aabbs_soa.size(), aabbs.size() - 1);
+}
+
+TEST(FrustumCullingTest, Benchmark)
+{
+	size_t const num_boxes = 100000;
+	int const num_iterations = 50;
+
+	Frustum const frustum = MakeTestFrustum();
+	std::vector<AABBox> const aabbs = MakeTestBoxes(num_boxes);
+
+	// The current path: one box at a time, reached through a pointer per node
+	std::vector<std::unique_ptr<AABBox>> aabb_ptrs;
+	for (auto const & aabb : aabbs)
+	{
+		aabb_ptrs.push_back(MakeUniquePtr<AABBox>(aabb));
+	}
+	std::shuffle(aabb_ptrs.begin(), aabb_ptrs.end(), std::ranlux24_base());
+
+	AABBoxSoA aabbs_soa;
+	aabbs_soa.reserve(num_boxes);
+	for (auto const & aabb_ptr : aabb_ptrs)
+	{
+		aabbs_soa.push_back(*aabb_ptr);
+	}
+
+	std::vector<BoundOverlap> scalar_results(num_boxes);
+	std::vector<BoundOverlap> soa_results(num_boxes);
+
+	Timer timer;
+	for (int iter = 0; iter < num_iterations; ++ iter)
+	{
+		for (size_t i = 0; i < num_boxes; ++ i)
+		{
+			scalar_results[i] = frustum.Intersect(*aabb_ptrs[i]);
+		}
+	}
+	double const scalar_time = timer.elapsed();
+
+	timer.restart();
+	for (int iter = 0; iter < num_iterations; ++ iter)
+	{
+		aabbs_soa.Intersect(frustum, 0, num_boxes, soa_results.data());
+	}
+	double const soa_time = timer.elapsed();
+
+	EXPECT_TRUE(scalar_results == soa_results);
+
+	double const num_tests = static_cast<double>(num_boxes) * num_iterations;
+	std::cout << "Frustum culling " << num_boxes << " AABBs, scalar: " << num_tests / (scalar_time * 1e6) << " nodes/us, SoA: "
+		<< num_tests / (soa_time * 1e6) << " nodes/us" << std::endl;
+}
@@ -8,6 +8,11 @@
 
 using namespace testing;
 
+namespace
+{
+	bool flush_scene = false;
+}
+
 namespace KlayGE
 {
 	class KlayGETestsApp : public App3DFramework
@@ -26,7 +31,7 @@ namespace KlayGE
 		virtual uint32_t DoUpdate(uint32_t pass) override
 		{
 			KFL_UNUSED(pass);
-			return URV_Finished;
+			return flush_scene ? (URV_NeedFlush | URV_Finished) : URV_Finished;
 		}
 	};
 
@@ -58,6 +63,16 @@ namespace KlayGE
 		std::shared_ptr<App3DFramework> app_;
 	};
 
+	SceneFlushScope::SceneFlushScope()
+	{
+		flush_scene = true;
+	}
+
+	SceneFlushScope::~SceneFlushScope()
+	{
+		flush_scene = false;
+	}
+
 	bool CompareBuffer(GraphicsBuffer& buff0, uint32_t buff0_offset,
 		GraphicsBuffer& buff1, uint32_t buff1_offset,
 		uint32_t num_elems, float tolerance)
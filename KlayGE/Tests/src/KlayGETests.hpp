@@ -2,6 +2,14 @@
 
 namespace KlayGE
 {
+	// The tests app doesn't flush the scene. While one of these is alive, SceneManager::Update flushes it every frame.
+	class SceneFlushScope
+	{
+	public:
+		SceneFlushScope();
+		~SceneFlushScope();
+	};
+
 	bool CompareBuffer(GraphicsBuffer& buff0, uint32_t buff0_offset,
 		GraphicsBuffer& buff1, uint32_t buff1_offset,
 		uint32_t num_elems, float tolerance);
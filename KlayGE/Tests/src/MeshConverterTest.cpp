@@ -38,6 +38,11 @@
 #include <KlayGE/DevHelper/MeshConverter.hpp>
 #include <KlayGE/DevHelper/MeshMetadata.hpp>
 
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+
 #include "KlayGETests.hpp"
 
 using namespace std;
@@ -743,6 +748,198 @@ public:
 			EXPECT_EQ(skinned_model.FrameRate(), sanity_skinned_model.FrameRate());
 		}
 	}
+
+	void RunRoundTripTest(std::string_view input_name, std::string_view metadata_name, std::string_view output_name)
+	{
+		MeshMetadata metadata(metadata_name);
+
+		MeshConverter mc;
+		auto source = mc.Load(input_name, metadata);
+		EXPECT_TRUE(source);
+
+		std::string const output_path = (std::filesystem::current_path() / std::string(output_name)).string();
+		SaveModel(*source, output_path);
+		auto target = LoadSoftwareModel(output_path);
+		EXPECT_TRUE(target);
+
+		EXPECT_EQ(target->NumMaterials(), source->NumMaterials());
+		for (uint32_t i = 0; i < source->NumMaterials(); ++ i)
+		{
+			auto mtl = target->GetMaterial(i);
+			auto source_mtl = source->GetMaterial(i);
+
+			EXPECT_EQ(mtl->name, source_mtl->name);
+			EXPECT_TRUE(mtl->albedo == source_mtl->albedo);
+			EXPECT_EQ(mtl->metalness, source_mtl->metalness);
+			EXPECT_EQ(mtl->glossiness, source_mtl->glossiness);
+			EXPECT_TRUE(mtl->emissive == source_mtl->emissive);
+			for (uint32_t slot = 0; slot < RenderMaterial::TS_NumTextureSlots; ++ slot)
+			{
+				EXPECT_EQ(mtl->tex_names[slot], source_mtl->tex_names[slot]);
+			}
+		}
+
+		// Vertex and index streams are decoded chunk by chunk, they have to match byte by byte
+		auto const & rl = checked_cast<StaticMesh*>(target->Mesh(0).get())->GetRenderLayout();
+		auto const & source_rl = checked_cast<StaticMesh*>(source->Mesh(0).get())->GetRenderLayout();
+
+		EXPECT_EQ(rl.NumVertexStreams(), source_rl.NumVertexStreams());
+		for (uint32_t i = 0; i < source_rl.NumVertexStreams(); ++ i)
+		{
+			EXPECT_TRUE(rl.VertexStreamFormat(i)[0] == source_rl.VertexStreamFormat(i)[0]);
+
+			auto& vb = *rl.GetVertexStream(i);
+			auto& source_vb = *source_rl.GetVertexStream(i);
+			EXPECT_EQ(vb.Size(), source_vb.Size());
+
+			GraphicsBuffer::Mapper mapper(vb, BA_Read_Only);
+			GraphicsBuffer::Mapper source_mapper(source_vb, BA_Read_Only);
+			EXPECT_EQ(std::memcmp(mapper.Pointer<uint8_t>(), source_mapper.Pointer<uint8_t>(), source_vb.Size()), 0);
+		}
+
+		EXPECT_EQ(rl.IndexStreamFormat(), source_rl.IndexStreamFormat());
+		{
+			auto& ib = *rl.GetIndexStream();
+			auto& source_ib = *source_rl.GetIndexStream();
+			EXPECT_EQ(ib.Size(), source_ib.Size());
+
+			GraphicsBuffer::Mapper mapper(ib, BA_Read_Only);
+			GraphicsBuffer::Mapper source_mapper(source_ib, BA_Read_Only);
+			EXPECT_EQ(std::memcmp(mapper.Pointer<uint8_t>(), source_mapper.Pointer<uint8_t>(), source_ib.Size()), 0);
+		}
+
+		EXPECT_EQ(target->NumMeshes(), source->NumMeshes());
+		for (uint32_t i = 0; i < source->NumMeshes(); ++ i)
+		{
+			auto const & mesh = *checked_cast<StaticMesh*>(target->Mesh(i).get());
+			auto const & source_mesh = *checked_cast<StaticMesh*>(source->Mesh(i).get());
+
+			EXPECT_EQ(mesh.Name(), source_mesh.Name());
+			EXPECT_EQ(mesh.MaterialID(), source_mesh.MaterialID());
+			EXPECT_TRUE(mesh.PosBound() == source_mesh.PosBound());
+			EXPECT_EQ(mesh.NumLods(), source_mesh.NumLods());
+			for (uint32_t lod = 0; lod < source_mesh.NumLods(); ++ lod)
+			{
+				EXPECT_EQ(mesh.NumVertices(lod), source_mesh.NumVertices(lod));
+				EXPECT_EQ(mesh.StartVertexLocation(lod), source_mesh.StartVertexLocation(lod));
+				EXPECT_EQ(mesh.NumIndices(lod), source_mesh.NumIndices(lod));
+				EXPECT_EQ(mesh.StartIndexLocation(lod), source_mesh.StartIndexLocation(lod));
+			}
+		}
+
+		std::vector<SceneNode*> nodes;
+		target->RootNode()->Traverse([&nodes](SceneNode& node)
+			{
+				nodes.push_back(&node);
+				return true;
+			});
+		std::vector<SceneNode*> source_nodes;
+		source->RootNode()->Traverse([&source_nodes](SceneNode& node)
+			{
+				source_nodes.push_back(&node);
+				return true;
+			});
+		EXPECT_EQ(nodes.size(), source_nodes.size());
+		for (size_t i = 0; i < std::min(nodes.size(), source_nodes.size()); ++ i)
+		{
+			EXPECT_TRUE(nodes[i]->Name() == source_nodes[i]->Name());
+			EXPECT_TRUE(nodes[i]->TransformToParent() == source_nodes[i]->TransformToParent());
+			EXPECT_EQ(nodes[i]->NumRenderables(), source_nodes[i]->NumRenderables());
+		}
+
+		EXPECT_EQ(target->IsSkinned(), source->IsSkinned());
+		if (source->IsSkinned())
+		{
+			auto& skinned_model = *checked_cast<SkinnedModel*>(target.get());
+			auto& source_skinned_model = *checked_cast<SkinnedModel*>(source.get());
+
+			EXPECT_EQ(skinned_model.NumJoints(), source_skinned_model.NumJoints());
+			for (uint32_t i = 0; i < source_skinned_model.NumJoints(); ++ i)
+			{
+				auto& joint = skinned_model.GetJoint(i);
+				auto& source_joint = source_skinned_model.GetJoint(i);
+
+				EXPECT_EQ(joint.name, source_joint.name);
+				EXPECT_EQ(joint.parent, source_joint.parent);
+				EXPECT_LT(MathLib::length(joint.inverse_origin_real - source_joint.inverse_origin_real), 1e-4f);
+				EXPECT_LT(MathLib::length(joint.inverse_origin_dual - source_joint.inverse_origin_dual), 1e-4f);
+			}
+
+			EXPECT_EQ(skinned_model.NumActions(), source_skinned_model.NumActions());
+			EXPECT_EQ(skinned_model.NumFrames(), source_skinned_model.NumFrames());
+			EXPECT_EQ(skinned_model.FrameRate(), source_skinned_model.FrameRate());
+
+			auto const & kfs = *skinned_model.GetKeyFrameSets();
+			auto const & source_kfs = *source_skinned_model.GetKeyFrameSets();
+			EXPECT_EQ(kfs.size(), source_kfs.size());
+			for (size_t i = 0; i < std::min(kfs.size(), source_kfs.size()); ++ i)
+			{
+				EXPECT_TRUE(kfs[i].frame_id == source_kfs[i].frame_id);
+			}
+		}
+	}
+
+	void RunCorruptedTest(std::string_view output_name, std::function<void(std::vector<char>&)> const & corrupt)
+	{
+		MeshMetadata metadata("tree2a.lod.kmeta");
+
+		MeshConverter mc;
+		auto source = mc.Load("tree2a_lod0.obj", metadata);
+		ASSERT_TRUE(source);
+
+		std::string const output_path = (std::filesystem::current_path() / std::string(output_name)).string();
+		SaveModel(*source, output_path);
+
+		std::vector<char> data;
+		{
+			std::ifstream ifs(output_path, std::ios_base::binary);
+			data.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+		}
+		ASSERT_GT(data.size(), 12U);
+
+		corrupt(data);
+		{
+			std::ofstream ofs(output_path, std::ios_base::binary | std::ios_base::trunc);
+			ofs.write(data.data(), data.size());
+		}
+
+		EXPECT_FALSE(LoadSoftwareModel(output_path));
+	}
+
+	// The chunk table follows the fourcc, the version and the number of chunks. Every entry is the type, the flags, the
+	// original length and the stored length.
+	static void GrowChunk(std::vector<char>& data, uint32_t chunk_type)
+	{
+		uint32_t num_chunks;
+		std::memcpy(&num_chunks, &data[8], sizeof(num_chunks));
+		num_chunks = LE2Native(num_chunks);
+
+		bool found = false;
+		for (uint32_t i = 0; i < num_chunks; ++ i)
+		{
+			char* desc = &data[12 + i * 24];
+
+			uint32_t type;
+			std::memcpy(&type, desc, sizeof(type));
+			if (LE2Native(type) == chunk_type)
+			{
+				// Flagged as compressed, so the table itself stays consistent and only the buffer size is off
+				uint32_t flags;
+				std::memcpy(&flags, desc + 4, sizeof(flags));
+				flags = Native2LE(LE2Native(flags) | 1U);
+				std::memcpy(desc + 4, &flags, sizeof(flags));
+
+				uint64_t original_len;
+				std::memcpy(&original_len, desc + 8, sizeof(original_len));
+				original_len = Native2LE(LE2Native(original_len) + 4096);
+				std::memcpy(desc + 8, &original_len, sizeof(original_len));
+
+				found = true;
+				break;
+			}
+		}
+		EXPECT_TRUE(found);
+	}
 };
 
 TEST_F(MeshConverterTest, StaticNoLod)
@@ -784,3 +981,39 @@ TEST_F(MeshConverterTest, AnimationMeshML)
 {
 	RunTest("anim.meshml", "", "anim.meshml");
 }
+
+TEST_F(MeshConverterTest, ModelBinRoundTripStatic)
+{
+	RunRoundTripTest("tree2a_lod0.obj", "tree2a.lod.kmeta", "tree2a.lod.roundtrip.model_bin");
+}
+
+TEST_F(MeshConverterTest, ModelBinRoundTripAnimation)
+{
+	RunRoundTripTest("anim.fbx", "", "anim.roundtrip.model_bin");
+}
+
+TEST_F(MeshConverterTest, ModelBinTruncated)
+{
+	RunCorruptedTest("tree2a.truncated.model_bin", [](std::vector<char>& data)
+		{
+			data.resize(data.size() / 2);
+		});
+}
+
+TEST_F(MeshConverterTest, ModelBinVertexStreamLength)
+{
+	RunCorruptedTest("tree2a.vertex_len.model_bin", [](std::vector<char>& data)
+		{
+			// MCT_VertexStream
+			GrowChunk(data, 2);
+		});
+}
+
+TEST_F(MeshConverterTest, ModelBinIndicesLength)
+{
+	RunCorruptedTest("tree2a.index_len.model_bin", [](std::vector<char>& data)
+		{
+			// MCT_Indices
+			GrowChunk(data, 3);
+		});
+}
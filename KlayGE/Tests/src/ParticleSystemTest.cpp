@@ -0,0 +1,238 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Timer.hpp>
+#include <KlayGE/App3D.hpp>
+#include <KlayGE/Camera.hpp>
+#include <KlayGE/Context.hpp>
+#include <KlayGE/ParticleSystem.hpp>
+#include <KlayGE/Renderable.hpp>
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "KlayGETests.hpp"
+
+using namespace KlayGE;
+
+namespace
+{
+	ParticleSystemPtr CreateParticleSystem(uint32_t num_particles, float frequency)
+	{
+		ParticleSystemPtr ps = MakeSharedPtr<ParticleSystem>(num_particles, true);
+		ps->Gravity(0.5f);
+		ps->Force(float3(0.1f, 0, -0.2f));
+		ps->MediaDensity(0.5f);
+
+		ParticleEmitterPtr emitter = ps->MakeEmitter("point");
+		emitter->Frequency(frequency);
+		emitter->EmitAngle(PI / 3);
+		emitter->MinPosition(float3(-1, 0, -1));
+		emitter->MaxPosition(float3(+1, 0.5f, +1));
+		emitter->MinVelocity(1);
+		emitter->MaxVelocity(2);
+		emitter->MinLife(1);
+		emitter->MaxLife(3);
+		emitter->MinSize(0.1f);
+		emitter->MaxSize(0.2f);
+		ps->AddEmitter(emitter);
+
+		ParticleUpdaterPtr updater = ps->MakeUpdater("polyline");
+		auto polyline_updater = checked_pointer_cast<PolylineParticleUpdater>(updater);
+		polyline_updater->SizeOverLife({ float2(0, 0.1f), float2(0.3f, 0.4f), float2(0.3f, 0.6f), float2(1, 1) });
+		polyline_updater->MassOverLife({ float2(0, 1), float2(0.5f, 2), float2(1, 0.5f) });
+		polyline_updater->OpacityOverLife({ float2(0, 0), float2(0.2f, 1), float2(1, 0) });
+		ps->AddUpdater(updater);
+
+		return ps;
+	}
+
+	bool NearlyEqual(float lhs, float rhs)
+	{
+		return std::abs(lhs - rhs) <= 1e-4f * std::max(1.0f, std::max(std::abs(lhs), std::abs(rhs)));
+	}
+
+	// How the curves were evaluated before the polylines were flattened into ramps. The first segment ending at or after
+	// x is interpolated, so it is extrapolated before the first point.
+	float BaselinePolyline(std::vector<float2> const & ctrl_points, float x)
+	{
+		float y = ctrl_points.back().y();
+		for (size_t i = 1; i < ctrl_points.size(); ++ i)
+		{
+			if (ctrl_points[i].x() >= x)
+			{
+				float2 const & prev = ctrl_points[i - 1];
+				float const s = (x - prev.x()) / (ctrl_points[i].x() - prev.x());
+				y = MathLib::lerp(prev.y(), ctrl_points[i].y(), s);
+				break;
+			}
+		}
+		return y;
+	}
+}
+
+TEST(ParticleSystemTest, PolylineMatchesBaseline)
+{
+	// Not a multiple of 4, so both the SIMD body and the scalar tail run
+	uint32_t const NUM_PARTICLES = 103;
+	float const ELAPSED_TIME = 1 / 60.0f;
+	float const INIT_LIFE = 2;
+
+	ParticleSystemPtr ps = CreateParticleSystem(NUM_PARTICLES, 0);
+	ParticleUpdaterPtr const & updater = ps->Updater(0);
+
+	// None of them starts from 0, and the size has a step
+	std::vector<float2> const size_over_life = { float2(0.25f, 0.2f), float2(0.5f, 0.4f), float2(0.5f, 0.7f), float2(0.9f, 1) };
+	std::vector<float2> const mass_over_life = { float2(0.1f, 1), float2(0.6f, 2), float2(1, 0.5f) };
+	std::vector<float2> const opacity_over_life = { float2(0.4f, 0.5f), float2(0.8f, 1) };
+	auto polyline_updater = checked_pointer_cast<PolylineParticleUpdater>(updater);
+	polyline_updater->SizeOverLife(size_over_life);
+	polyline_updater->MassOverLife(mass_over_life);
+	polyline_updater->OpacityOverLife(opacity_over_life);
+	updater->SnapParams();
+
+	std::vector<Particle> scalar(NUM_PARTICLES);
+	for (uint32_t i = 0; i < NUM_PARTICLES; ++ i)
+	{
+		Particle par;
+		par.pos = float3(0, 0, 0);
+		par.vel = float3(0, 0, 0);
+		par.init_life = INIT_LIFE;
+		par.life = INIT_LIFE * (1 - static_cast<float>(i) / NUM_PARTICLES);
+		par.spin = 0;
+		par.size = 0;
+		par.alpha = 0;
+		ps->SetParticle(i, par);
+
+		scalar[i] = par;
+		updater->Update(scalar[i], ELAPSED_TIME);
+	}
+
+	updater->UpdateBatch(ps->ParticleRange(0, NUM_PARTICLES), ELAPSED_TIME);
+
+	for (uint32_t i = 0; i < NUM_PARTICLES; ++ i)
+	{
+		float const life = INIT_LIFE * (1 - static_cast<float>(i) / NUM_PARTICLES);
+		float const x = (INIT_LIFE - life) / INIT_LIFE;
+		float const size = BaselinePolyline(size_over_life, x);
+		float const mass = BaselinePolyline(mass_over_life, x);
+		float const alpha = BaselinePolyline(opacity_over_life, x);
+		float const buoyancy = 4.0f / 3 * PI * MathLib::cube(size) * ps->MediaDensity() * ps->Gravity();
+		float const vel_y = ((ps->Force().y() + buoyancy) / mass - ps->Gravity()) * ELAPSED_TIME;
+
+		Particle const batch = ps->GetParticle(i);
+		EXPECT_TRUE(NearlyEqual(scalar[i].size, size)) << "Size at " << x;
+		EXPECT_TRUE(NearlyEqual(scalar[i].alpha, alpha)) << "Opacity at " << x;
+		EXPECT_TRUE(NearlyEqual(scalar[i].vel.y(), vel_y)) << "Mass at " << x;
+		EXPECT_TRUE(NearlyEqual(batch.size, size)) << "Batched size at " << x;
+		EXPECT_TRUE(NearlyEqual(batch.alpha, alpha)) << "Batched opacity at " << x;
+		EXPECT_TRUE(NearlyEqual(batch.vel.y(), vel_y)) << "Batched mass at " << x;
+	}
+}
+
+TEST(ParticleSystemTest, BatchUpdateMatchesScalar)
+{
+	// Not a multiple of 4, so both the SIMD body and the scalar tail run
+	uint32_t const NUM_PARTICLES = 10003;
+	float const ELAPSED_TIME = 1 / 60.0f;
+
+	ParticleSystemPtr ps = CreateParticleSystem(NUM_PARTICLES, 0);
+	ParticleUpdaterPtr const & updater = ps->Updater(0);
+
+	std::mt19937 gen(42);
+	std::uniform_real_distribution<float> dis(-1, 1);
+	for (uint32_t i = 0; i < NUM_PARTICLES; ++ i)
+	{
+		Particle par;
+		par.pos = float3(dis(gen), dis(gen), dis(gen));
+		par.vel = float3(dis(gen), dis(gen), dis(gen));
+		par.init_life = 2 + dis(gen);
+		// About a third of them are dead
+		par.life = par.init_life * dis(gen) * 1.5f;
+		par.spin = dis(gen);
+		par.size = 0;
+		par.alpha = 0;
+		ps->SetParticle(i, par);
+	}
+
+	updater->SnapParams();
+
+	std::vector<Particle> expected(NUM_PARTICLES);
+	for (uint32_t i = 0; i < NUM_PARTICLES; ++ i)
+	{
+		expected[i] = ps->GetParticle(i);
+		if (expected[i].life > 0)
+		{
+			updater->Update(expected[i], ELAPSED_TIME);
+		}
+	}
+
+	updater->UpdateBatch(ps->ParticleRange(0, NUM_PARTICLES), ELAPSED_TIME);
+
+	for (uint32_t i = 0; i < NUM_PARTICLES; ++ i)
+	{
+		Particle const actual = ps->GetParticle(i);
+		bool match = true;
+		for (uint32_t j = 0; j < 3; ++ j)
+		{
+			match &= NearlyEqual(actual.pos[j], expected[i].pos[j]);
+			match &= NearlyEqual(actual.vel[j], expected[i].vel[j]);
+		}
+		match &= NearlyEqual(actual.life, expected[i].life);
+		match &= NearlyEqual(actual.spin, expected[i].spin);
+		match &= NearlyEqual(actual.size, expected[i].size);
+		match &= NearlyEqual(actual.alpha, expected[i].alpha);
+		if (!match)
+		{
+			ADD_FAILURE() << "Particle " << i << " doesn't match the scalar update";
+			break;
+		}
+	}
+}
+
+TEST(ParticleSystemTest, SimulationBenchmark)
+{
+	uint32_t const NUM_PARTICLES = 100000;
+	uint32_t const NUM_FRAMES = 60;
+	float const ELAPSED_TIME = 1 / 60.0f;
+
+	ParticleSystemPtr ps = CreateParticleSystem(NUM_PARTICLES, NUM_PARTICLES / 2.0f);
+
+	Timer timer;
+	for (uint32_t frame = 0; frame < NUM_FRAMES; ++ frame)
+	{
+		ps->SubThreadUpdateFunc(ELAPSED_TIME);
+	}
+	double const update_time = timer.elapsed();
+
+	// The bound goes to the renderable on the main thread
+	ps->MainThreadUpdateFunc();
+
+	uint32_t const num_active = ps->NumActiveParticles();
+	EXPECT_GT(num_active, NUM_PARTICLES / 4);
+
+	// Farthest first, and all inside the bound
+	float4x4 const & view_mat = Context::Instance().AppInstance().ActiveCamera().ViewMatrix();
+	AABBox const & pos_bb = ps->GetRenderable()->PosBound();
+	float last_depth = std::numeric_limits<float>::max();
+	for (uint32_t i = 0; i < num_active; ++ i)
+	{
+		Particle const par = ps->GetParticle(ps->GetActiveParticleIndex(i));
+		ASSERT_GT(par.life, 0);
+
+		float4 const pos4(par.pos.x(), par.pos.y(), par.pos.z(), 1);
+		float const depth = MathLib::dot(pos4, view_mat.Col(2)) / MathLib::dot(pos4, view_mat.Col(3));
+		ASSERT_LE(depth, last_depth);
+		last_depth = depth;
+
+		for (uint32_t j = 0; j < 3; ++ j)
+		{
+			ASSERT_GE(par.pos[j], pos_bb.Min()[j]);
+			ASSERT_LE(par.pos[j], pos_bb.Max()[j]);
+		}
+	}
+
+	std::cout << NUM_PARTICLES << " particles, " << num_active << " active: "
+		<< update_time * 1000 / NUM_FRAMES << " ms/frame" << std::endl;
+}
@@ -0,0 +1,91 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KlayGE/PerfProfiler.hpp>
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "KlayGETests.hpp"
+
+using namespace KlayGE;
+
+namespace
+{
+	uint32_t CountLines(std::string const & trace, std::string const & pattern0, std::string const & pattern1 = "")
+	{
+		uint32_t count = 0;
+		std::istringstream iss(trace);
+		std::string line;
+		while (std::getline(iss, line))
+		{
+			if ((line.find(pattern0) != std::string::npos) && (line.find(pattern1) != std::string::npos))
+			{
+				++ count;
+			}
+		}
+		return count;
+	}
+}
+
+TEST(PerfProfilerTest, ChromeTrace)
+{
+	uint32_t const NUM_THREADS = 4;
+	uint32_t const NUM_ZONES = 100;
+
+	PerfProfiler& profiler = PerfProfiler::Instance();
+	bool const enabled = profiler.Enabled();
+
+	profiler.Enabled(false);
+	{
+		PerfZone zone("PerfProfilerTest::Disabled");
+	}
+
+	profiler.Enabled(true);
+	{
+		PerfZone outer("PerfProfilerTest::Outer");
+		{
+			PerfZone inner("PerfProfilerTest::Inner");
+		}
+	}
+
+	std::vector<std::thread> threads;
+	for (uint32_t i = 0; i < NUM_THREADS; ++ i)
+	{
+		threads.emplace_back([i, &profiler]
+			{
+				profiler.ThreadName("PerfProfilerTest worker " + std::to_string(i));
+				for (uint32_t j = 0; j < NUM_ZONES; ++ j)
+				{
+					PerfZone zone("PerfProfilerTest::Worker");
+				}
+			});
+	}
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+
+	profiler.Counter("PerfProfilerTest::Counter", 42);
+	profiler.MarkFrame();
+
+	std::ostringstream oss;
+	profiler.ExportToChromeTrace(oss);
+	profiler.Enabled(enabled);
+
+	std::string const trace = oss.str();
+	EXPECT_EQ(trace.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["), 0U);
+
+	EXPECT_EQ(CountLines(trace, "\"PerfProfilerTest::Disabled\""), 0U);
+
+	// One event per line
+	EXPECT_EQ(CountLines(trace, "\"ph\":\"X\"", "\"name\":\"PerfProfilerTest::Outer\""), 1U);
+	EXPECT_EQ(CountLines(trace, "\"name\":\"PerfProfilerTest::Outer\"", "\"depth\":0"), 1U);
+	EXPECT_EQ(CountLines(trace, "\"name\":\"PerfProfilerTest::Inner\"", "\"depth\":1"), 1U);
+
+	EXPECT_EQ(CountLines(trace, "\"ph\":\"M\"", "\"name\":\"PerfProfilerTest worker "), NUM_THREADS);
+	EXPECT_EQ(CountLines(trace, "\"name\":\"PerfProfilerTest::Worker\"", "\"depth\":0"), NUM_THREADS * NUM_ZONES);
+
+	EXPECT_EQ(CountLines(trace, "\"ph\":\"C\"", "\"name\":\"PerfProfilerTest::Counter\""), 1U);
+	EXPECT_GE(CountLines(trace, "\"ph\":\"i\""), 1U);
+}
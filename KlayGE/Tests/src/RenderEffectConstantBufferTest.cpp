@@ -0,0 +1,82 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KlayGE/Context.hpp>
+#include <KlayGE/GraphicsBuffer.hpp>
+#include <KlayGE/RenderEffect.hpp>
+#include <KlayGE/RenderEngine.hpp>
+#include <KlayGE/RenderFactory.hpp>
+
+#include <algorithm>
+
+#include "KlayGETests.hpp"
+
+using namespace KlayGE;
+
+namespace
+{
+	// What the GPU sees has to be what's in the CPU copy
+	bool HWBuffMatches(RenderEffectConstantBuffer const & cbuff, uint32_t size)
+	{
+		RenderFactory& rf = Context::Instance().RenderFactoryInstance();
+
+		GraphicsBufferPtr const & buffer = cbuff.HWBuff();
+		GraphicsBufferPtr buffer_cpu = rf.MakeVertexBuffer(BU_Static, EAH_CPU_Read, buffer->Size(), nullptr);
+		buffer->CopyToBuffer(*buffer_cpu);
+
+		GraphicsBuffer::Mapper mapper(*buffer_cpu, BA_Read_Only);
+		return std::equal(cbuff.VariableInBuff<uint8_t>(0), cbuff.VariableInBuff<uint8_t>(0) + size, mapper.Pointer<uint8_t>());
+	}
+}
+
+TEST(RenderEffectConstantBufferTest, PartialUpload)
+{
+	uint32_t const CBUFFER_SIZE = 4096;
+
+	RenderEngine& re = Context::Instance().RenderFactoryInstance().RenderEngineInstance();
+	bool const partial = re.DeviceCaps().partial_cbuffer_update_support;
+
+	RenderEffectConstantBuffer cbuff;
+	cbuff.Resize(CBUFFER_SIZE);
+	for (uint32_t i = 0; i < CBUFFER_SIZE / sizeof(float); ++ i)
+	{
+		*cbuff.VariableInBuff<float>(i * sizeof(float)) = static_cast<float>(i);
+	}
+
+	re.NumCBufferBytesJustUploaded();
+	re.NumCBufferBytesJustUpdated();
+
+	// A new cbuffer goes as a whole
+	cbuff.Update();
+	EXPECT_EQ(re.NumCBufferBytesJustUploaded(), CBUFFER_SIZE);
+	EXPECT_EQ(re.NumCBufferBytesJustUpdated(), CBUFFER_SIZE);
+	EXPECT_TRUE(HWBuffMatches(cbuff, CBUFFER_SIZE));
+
+	// Nothing changed, nothing to upload
+	cbuff.Update();
+	EXPECT_EQ(re.NumCBufferBytesJustUploaded(), 0U);
+
+	// One float, in one register
+	*cbuff.VariableInBuff<float>(100) = -1;
+	cbuff.Dirty(100, sizeof(float));
+	cbuff.Update();
+	EXPECT_EQ(re.NumCBufferBytesJustUploaded(), partial ? 16U : CBUFFER_SIZE);
+	EXPECT_EQ(re.NumCBufferBytesJustUpdated(), CBUFFER_SIZE);
+	EXPECT_TRUE(HWBuffMatches(cbuff, CBUFFER_SIZE));
+
+	// A float4 across two registers, a float4x4 far away, and the last float
+	*cbuff.VariableInBuff<float4>(1000) = float4(1, 2, 3, 4);
+	cbuff.Dirty(1000, sizeof(float4));
+	*cbuff.VariableInBuff<float4x4>(2048) = float4x4::Identity();
+	cbuff.Dirty(2048, sizeof(float4x4));
+	*cbuff.VariableInBuff<float>(CBUFFER_SIZE - sizeof(float)) = -2;
+	cbuff.Dirty(CBUFFER_SIZE - sizeof(float), sizeof(float));
+	cbuff.Update();
+	EXPECT_EQ(re.NumCBufferBytesJustUploaded(), partial ? 32U + 64U + 16U : CBUFFER_SIZE);
+	EXPECT_TRUE(HWBuffMatches(cbuff, CBUFFER_SIZE));
+
+	// Marking the whole cbuffer dirty still uploads everything
+	cbuff.Dirty(8, 4);
+	cbuff.Dirty(true);
+	cbuff.Update();
+	EXPECT_EQ(re.NumCBufferBytesJustUploaded(), CBUFFER_SIZE);
+	EXPECT_TRUE(HWBuffMatches(cbuff, CBUFFER_SIZE));
+}
@@ -0,0 +1,94 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Hash.hpp>
+#include <KlayGE/RenderEffect.hpp>
+
+#include <string>
+#include <vector>
+
+#include "KlayGETests.hpp"
+
+using namespace KlayGE;
+
+TEST(RenderEffectTest, NameTableCollision)
+{
+	std::vector<std::string> const names = { "a", "b", "c", "d" };
+
+	// All the names have the same hash, only comparing the names tells them apart
+	size_t const name_hash = 42;
+	RenderEffectNameTable table;
+	for (uint32_t i = 0; i < names.size(); ++ i)
+	{
+		table.Insert(name_hash, i);
+	}
+	// Enough entries to grow the table a few times
+	for (uint32_t i = 0; i < 100; ++ i)
+	{
+		table.Insert(1000 + i, static_cast<uint32_t>(names.size()) + i);
+	}
+
+	for (uint32_t i = 0; i < names.size(); ++ i)
+	{
+		EXPECT_EQ(table.Find(name_hash,
+			[&names, i](uint32_t index)
+			{
+				return (index < names.size()) && (names[index] == names[i]);
+			}), i);
+	}
+	EXPECT_EQ(table.Find(name_hash,
+		[](uint32_t index)
+		{
+			KFL_UNUSED(index);
+			return false;
+		}), RenderEffectNameTable::INVALID_INDEX);
+
+	for (uint32_t i = 0; i < 100; ++ i)
+	{
+		EXPECT_EQ(table.Find(1000 + i,
+			[](uint32_t index)
+			{
+				KFL_UNUSED(index);
+				return true;
+			}), names.size() + i);
+	}
+
+	table.Clear();
+	EXPECT_EQ(table.Find(name_hash,
+		[](uint32_t index)
+		{
+			KFL_UNUSED(index);
+			return true;
+		}), RenderEffectNameTable::INVALID_INDEX);
+}
+
+TEST(RenderEffectTest, LookupByName)
+{
+	auto effect = SyncLoadRenderEffect("RenderToTexture/RenderToTextureTest.fxml");
+	auto cloned = effect->Clone();
+
+	for (auto const * e : { effect.get(), cloned.get() })
+	{
+		for (uint32_t i = 0; i < e->NumParameters(); ++ i)
+		{
+			RenderEffectParameter* param = e->ParameterByIndex(i);
+			EXPECT_EQ(e->ParameterByName(param->Name()), param);
+		}
+		for (uint32_t i = 0; i < e->NumCBuffers(); ++ i)
+		{
+			RenderEffectConstantBuffer* cbuff = e->CBufferByIndex(i);
+			EXPECT_EQ(e->CBufferByName(cbuff->Name()), cbuff);
+		}
+		for (uint32_t i = 0; i < e->NumTechniques(); ++ i)
+		{
+			RenderTechnique* tech = e->TechniqueByIndex(i);
+			EXPECT_EQ(e->TechniqueByName(tech->Name()), tech);
+		}
+
+		EXPECT_EQ(e->ParameterByName("src_ms", CT_HASH("src_ms")), e->ParameterByName("src_ms"));
+		EXPECT_EQ(e->TechniqueByName("ResolveToTextureMS", CT_HASH("ResolveToTextureMS")), e->TechniqueByName("ResolveToTextureMS"));
+		EXPECT_TRUE(e->ParameterByName("src_ms") != nullptr);
+
+		EXPECT_TRUE(e->ParameterByName("not_a_parameter") == nullptr);
+		EXPECT_TRUE(e->CBufferByName("not_a_cbuffer") == nullptr);
+		EXPECT_TRUE(e->TechniqueByName("NotATechnique") == nullptr);
+	}
+}
@@ -0,0 +1,164 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/CXX17/filesystem.hpp>
+#include <KFL/Timer.hpp>
+#include <KlayGE/Context.hpp>
+#include <KlayGE/RenderFactory.hpp>
+#include <KlayGE/RenderMaterial.hpp>
+#include <KlayGE/ResLoader.hpp>
+#include <KlayGE/Texture.hpp>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "KlayGETests.hpp"
+
+using namespace KlayGE;
+
+namespace
+{
+	char const * const MTLML_NAME = "RenderMaterialTest.mtlml";
+
+	void ExpectSameMaterial(RenderMaterial const & lhs, RenderMaterial const & rhs)
+	{
+		EXPECT_EQ(lhs.name, rhs.name);
+		for (uint32_t i = 0; i < 4; ++ i)
+		{
+			EXPECT_FLOAT_EQ(lhs.albedo[i], rhs.albedo[i]);
+		}
+		EXPECT_FLOAT_EQ(lhs.metalness, rhs.metalness);
+		EXPECT_FLOAT_EQ(lhs.glossiness, rhs.glossiness);
+		for (uint32_t i = 0; i < 3; ++ i)
+		{
+			EXPECT_FLOAT_EQ(lhs.emissive[i], rhs.emissive[i]);
+		}
+		EXPECT_EQ(lhs.transparent, rhs.transparent);
+		EXPECT_FLOAT_EQ(lhs.alpha_test, rhs.alpha_test);
+		EXPECT_EQ(lhs.sss, rhs.sss);
+		EXPECT_EQ(lhs.two_sided, rhs.two_sided);
+		for (size_t i = 0; i < RenderMaterial::TS_NumTextureSlots; ++ i)
+		{
+			EXPECT_EQ(lhs.tex_names[i], rhs.tex_names[i]);
+		}
+		EXPECT_EQ(lhs.detail_mode, rhs.detail_mode);
+		for (uint32_t i = 0; i < 2; ++ i)
+		{
+			EXPECT_FLOAT_EQ(lhs.height_offset_scale[i], rhs.height_offset_scale[i]);
+		}
+		for (uint32_t i = 0; i < 4; ++ i)
+		{
+			EXPECT_FLOAT_EQ(lhs.tess_factors[i], rhs.tess_factors[i]);
+		}
+	}
+}
+
+TEST(RenderMaterialTest, BinaryMatchesXml)
+{
+	RenderMaterialPtr source = MakeSharedPtr<RenderMaterial>();
+	source->name = "RenderMaterialTest";
+	source->albedo = float4(0.25f, 0.5f, 0.75f, 1);
+	source->metalness = 0.5f;
+	source->glossiness = 0.75f;
+	source->emissive = float3(0.125f, 0, 0.5f);
+	source->transparent = true;
+	source->alpha_test = 0.25f;
+	source->sss = false;
+	source->two_sided = true;
+	source->tex_names[RenderMaterial::TS_Albedo] = "RenderMaterialTest_albedo.dds";
+	source->tex_names[RenderMaterial::TS_Height] = "RenderMaterialTest_height.dds";
+	source->detail_mode = RenderMaterial::SDM_SmoothTessellation;
+	source->height_offset_scale = float2(-0.25f, 0.125f);
+	source->tess_factors = float4(4, 6, 2, 8);
+
+	SaveRenderMaterial(source, MTLML_NAME);
+	ASSERT_FALSE(ResLoader::Instance().Locate(MTLML_NAME).empty());
+
+	// Starts from the XML, without a binary from the last run
+	std::string const bin_name = std::string(MTLML_NAME) + ".mtl_bin";
+	std::string const old_bin_path = ResLoader::Instance().Locate(bin_name);
+	if (!old_bin_path.empty())
+	{
+		std::filesystem::remove(old_bin_path);
+	}
+
+	RenderMaterial xml_mtl = *SyncLoadRenderMaterial(MTLML_NAME);
+	EXPECT_TRUE(xml_mtl.loaded);
+	ExpectSameMaterial(xml_mtl, *source);
+
+#if KLAYGE_IS_DEV_PLATFORM
+	// The binary is generated by the first load
+	ASSERT_FALSE(ResLoader::Instance().Locate(bin_name).empty());
+
+	RenderMaterialPtr bin_mtl = SyncLoadRenderMaterial(bin_name);
+	ASSERT_TRUE(bin_mtl);
+	EXPECT_TRUE(bin_mtl->loaded);
+	ExpectSameMaterial(*bin_mtl, xml_mtl);
+	bin_mtl.reset();
+#endif
+
+	// The material is filled in on the main thread, once the loading thread is done with it
+	RenderMaterialPtr async_mtl = ASyncLoadRenderMaterial(MTLML_NAME);
+	ASSERT_TRUE(async_mtl);
+	Timer timer;
+	while (!async_mtl->loaded && (timer.elapsed() < 10))
+	{
+		ResLoader::Instance().Update();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	ASSERT_TRUE(async_mtl->loaded);
+	ExpectSameMaterial(*async_mtl, xml_mtl);
+
+	// None of the textures exist
+	for (auto const & tex : async_mtl->textures)
+	{
+		EXPECT_FALSE(tex);
+	}
+}
+
+TEST(RenderMaterialTest, ASyncLoadQueuesTextures)
+{
+	char const * const mtlml_name = "RenderMaterialTextureTest.mtlml";
+	char const * const tex_name = "RenderMaterialTextureTest_albedo.dds";
+
+	{
+		RenderFactory& rf = Context::Instance().RenderFactoryInstance();
+
+		uint32_t const texel = 0xFF4080C0;
+		ElementInitData init_data;
+		init_data.data = &texel;
+		init_data.row_pitch = sizeof(texel);
+		init_data.slice_pitch = sizeof(texel);
+		TexturePtr tex = rf.MakeTexture2D(1, 1, 1, 1, EF_ABGR8, 1, 0, EAH_CPU_Read | EAH_CPU_Write, init_data);
+		SaveTexture(tex, tex_name);
+	}
+	ASSERT_FALSE(ResLoader::Instance().Locate(tex_name).empty());
+
+	RenderMaterialPtr source = MakeSharedPtr<RenderMaterial>();
+	source->name = "RenderMaterialTextureTest";
+	source->tex_names[RenderMaterial::TS_Albedo] = tex_name;
+	SaveRenderMaterial(source, mtlml_name);
+
+	// The texture is queued with the material, and created when the main thread picks it up
+	RenderMaterialPtr async_mtl = ASyncLoadRenderMaterial(mtlml_name);
+	ASSERT_TRUE(async_mtl);
+	TexturePtr const & albedo_tex = async_mtl->textures[RenderMaterial::TS_Albedo];
+	Timer timer;
+	while (!(async_mtl->loaded && albedo_tex && albedo_tex->HWResourceReady()) && (timer.elapsed() < 10))
+	{
+		ResLoader::Instance().Update();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	ASSERT_TRUE(async_mtl->loaded);
+	ASSERT_TRUE(albedo_tex);
+	EXPECT_TRUE(albedo_tex->HWResourceReady());
+	EXPECT_EQ(albedo_tex->Width(0), 1U);
+	EXPECT_EQ(albedo_tex->Height(0), 1U);
+
+	for (size_t i = 0; i < RenderMaterial::TS_NumTextureSlots; ++ i)
+	{
+		if (i != RenderMaterial::TS_Albedo)
+		{
+			EXPECT_FALSE(async_mtl->textures[i]);
+		}
+	}
+}
@@ -0,0 +1,300 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Math.hpp>
+#include <KFL/Timer.hpp>
+#include <KlayGE/App3D.hpp>
+#include <KlayGE/Camera.hpp>
+#include <KlayGE/Context.hpp>
+#include <KlayGE/RenderEffect.hpp>
+#include <KlayGE/RenderMaterial.hpp>
+#include <KlayGE/RenderQueue.hpp>
+#include <KlayGE/RenderableHelper.hpp>
+#include <KlayGE/SceneManager.hpp>
+#include <KlayGE/SceneNode.hpp>
+
+#include "KlayGETests.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using namespace KlayGE;
+
+namespace
+{
+	struct TestItem
+	{
+		uint32_t tech;
+		float weight;
+		bool depth_sorted;
+		float depth;
+	};
+
+	std::vector<TestItem> GenerateItems(uint32_t num_items, uint32_t num_techs)
+	{
+		std::ranlux24_base gen(0);
+		std::uniform_int_distribution<uint32_t> tech_dis(0, num_techs - 1);
+		std::uniform_real_distribution<float> depth_dis(-10, 1000);
+
+		std::vector<float> weights(num_techs);
+		for (uint32_t i = 0; i < num_techs; ++ i)
+		{
+			// A few weight levels, like opaque/alpha test/transparent, so equal weights are common
+			weights[i] = static_cast<float>(i % 4);
+		}
+
+		std::vector<TestItem> items(num_items);
+		for (auto& item : items)
+		{
+			item.tech = tech_dis(gen);
+			item.weight = weights[item.tech];
+			item.depth_sorted = (item.weight < 2);
+			item.depth = depth_dis(gen);
+		}
+		return items;
+	}
+
+	// The old path: linear search for the technique bucket, sort buckets by weight, sort every depth sorted bucket
+	std::vector<uint32_t> BucketSort(std::vector<TestItem> const & items)
+	{
+		std::vector<std::pair<uint32_t, std::vector<uint32_t>>> queue;
+		for (uint32_t i = 0; i < items.size(); ++ i)
+		{
+			bool found = false;
+			for (auto& bucket : queue)
+			{
+				if (bucket.first == items[i].tech)
+				{
+					bucket.second.push_back(i);
+					found = true;
+					break;
+				}
+			}
+			if (!found)
+			{
+				queue.emplace_back(items[i].tech, std::vector<uint32_t>(1, i));
+			}
+		}
+
+		std::stable_sort(queue.begin(), queue.end(),
+			[&items](std::pair<uint32_t, std::vector<uint32_t>> const & lhs, std::pair<uint32_t, std::vector<uint32_t>> const & rhs)
+			{
+				return items[lhs.second[0]].weight < items[rhs.second[0]].weight;
+			});
+
+		std::vector<uint32_t> ret;
+		ret.reserve(items.size());
+		for (auto& bucket : queue)
+		{
+			if (items[bucket.second[0]].depth_sorted && (bucket.second.size() > 1))
+			{
+				std::vector<std::pair<float, uint32_t>> min_depths(bucket.second.size());
+				for (size_t j = 0; j < min_depths.size(); ++ j)
+				{
+					min_depths[j] = std::make_pair(items[bucket.second[j]].depth, static_cast<uint32_t>(j));
+				}
+				std::sort(min_depths.begin(), min_depths.end());
+
+				for (auto const & md : min_depths)
+				{
+					ret.push_back(bucket.second[md.second]);
+				}
+			}
+			else
+			{
+				ret.insert(ret.end(), bucket.second.begin(), bucket.second.end());
+			}
+		}
+		return ret;
+	}
+
+	// The new path, the same as RenderQueue::Add and RenderQueue::Sort without real techniques and materials
+	std::vector<uint32_t> KeySort(std::vector<TestItem> const & items)
+	{
+		std::unordered_map<uint32_t, uint32_t> slot_map;
+		std::vector<std::pair<float, uint32_t>> slots;
+		std::vector<uint32_t> item_slots(items.size());
+		for (uint32_t i = 0; i < items.size(); ++ i)
+		{
+			auto iter = slot_map.find(items[i].tech);
+			if (iter == slot_map.end())
+			{
+				iter = slot_map.emplace(items[i].tech, static_cast<uint32_t>(slots.size())).first;
+				slots.emplace_back(items[i].weight, 0);
+			}
+			++ slots[iter->second].second;
+			item_slots[i] = iter->second;
+		}
+
+		std::vector<uint32_t> ranked(slots.size());
+		for (uint32_t i = 0; i < ranked.size(); ++ i)
+		{
+			ranked[i] = i;
+		}
+		std::stable_sort(ranked.begin(), ranked.end(),
+			[&slots](uint32_t lhs, uint32_t rhs)
+			{
+				return slots[lhs].first < slots[rhs].first;
+			});
+		std::vector<uint16_t> ranks(slots.size());
+		for (uint32_t i = 0; i < ranked.size(); ++ i)
+		{
+			ranks[ranked[i]] = static_cast<uint16_t>(i);
+		}
+
+		std::vector<uint64_t> keys(items.size());
+		std::vector<uint32_t> values(items.size());
+		for (uint32_t i = 0; i < items.size(); ++ i)
+		{
+			TestItem const & item = items[i];
+			float const depth = (item.depth_sorted && (slots[item_slots[i]].second > 1)) ? item.depth : 0.0f;
+			keys[i] = RenderQueue::MakeKey(ranks[item_slots[i]], depth, 0);
+			values[i] = i;
+		}
+
+		std::vector<uint64_t> tmp_keys;
+		std::vector<uint32_t> tmp_values;
+		RenderQueue::RadixSort(keys, values, tmp_keys, tmp_values);
+		return values;
+	}
+
+	// A box drawn with one of the two techniques that take its layout, and one of a few materials
+	class QueuedBox : public RenderableTriBox
+	{
+	public:
+		QueuedBox(OBBox const & obb, bool points, RenderMaterialPtr const & mtl)
+			: RenderableTriBox(obb, Color(1, 1, 1, 1))
+		{
+			if (points)
+			{
+				technique_ = simple_forward_tech_ = effect_->TechniqueByName("PointTec");
+			}
+			mtl_ = mtl;
+		}
+	};
+}
+
+TEST(RenderQueueTest, KeyOrder)
+{
+	float const depths[] = { -1e10f, -100.0f, -1.0f, -0.0f, 0.0f, 1e-20f, 1.0f, 100.0f, 1e10f };
+	for (size_t i = 1; i < std::size(depths); ++ i)
+	{
+		EXPECT_LE(RenderQueue::MakeKey(0, depths[i - 1], 0), RenderQueue::MakeKey(0, depths[i], 0));
+	}
+
+	// Technique rank goes first, then depth, then material
+	EXPECT_LT(RenderQueue::MakeKey(0, 1e10f, 0xFFFF), RenderQueue::MakeKey(1, -1e10f, 0));
+	EXPECT_LT(RenderQueue::MakeKey(3, 1.0f, 0xFFFF), RenderQueue::MakeKey(3, 2.0f, 0));
+	EXPECT_LT(RenderQueue::MakeKey(3, 1.0f, 1), RenderQueue::MakeKey(3, 1.0f, 2));
+}
+
+TEST(RenderQueueTest, RadixSortIsStable)
+{
+	std::ranlux24_base gen(0);
+	for (uint32_t num : { 0U, 1U, 2U, 17U, 1000U, 65537U })
+	{
+		std::vector<uint64_t> keys(num);
+		std::vector<uint32_t> values(num);
+		std::vector<std::pair<uint64_t, uint32_t>> expected(num);
+		for (uint32_t i = 0; i < num; ++ i)
+		{
+			// Few distinct values in some bytes, to exercise both the skipped and the full passes
+			keys[i] = (static_cast<uint64_t>(gen() & 0x7) << 56) | (static_cast<uint64_t>(gen()) << 16) | (gen() & 0x3);
+			values[i] = i;
+			expected[i] = std::make_pair(keys[i], i);
+		}
+		std::stable_sort(expected.begin(), expected.end(),
+			[](std::pair<uint64_t, uint32_t> const & lhs, std::pair<uint64_t, uint32_t> const & rhs)
+			{
+				return lhs.first < rhs.first;
+			});
+
+		std::vector<uint64_t> tmp_keys;
+		std::vector<uint32_t> tmp_values;
+		RenderQueue::RadixSort(keys, values, tmp_keys, tmp_values);
+
+		ASSERT_EQ(keys.size(), num);
+		for (uint32_t i = 0; i < num; ++ i)
+		{
+			EXPECT_EQ(keys[i], expected[i].first);
+			EXPECT_EQ(values[i], expected[i].second);
+		}
+	}
+}
+
+TEST(RenderQueueTest, MatchesBucketSort)
+{
+	std::vector<TestItem> const items = GenerateItems(5000, 64);
+	EXPECT_EQ(BucketSort(items), KeySort(items));
+}
+
+// Times whole frames of SceneManager, culling, queueing, sorting and drawing included. Select NullRender in KlayGE.cfg to
+// leave the GPU out of it.
+TEST(RenderQueueTest, FlushBenchmark)
+{
+	uint32_t const NUM_MATERIALS = 16;
+	uint32_t const NUM_FRAMES = 20;
+
+	SceneFlushScope flush_scope;
+
+	auto& sm = Context::Instance().SceneManagerInstance();
+	auto& root = sm.SceneRootNode();
+	auto& camera = Context::Instance().AppInstance().ActiveCamera();
+	camera.ViewParams(float3(0, 0, 0), float3(0, 0, 1));
+	camera.ProjParams(PI / 4, 1, 0.1f, 1000.0f);
+
+	std::vector<RenderMaterialPtr> materials(NUM_MATERIALS);
+	for (auto& mtl : materials)
+	{
+		mtl = MakeSharedPtr<RenderMaterial>();
+	}
+
+	std::ranlux24_base gen(0);
+	std::uniform_real_distribution<float> depth_dis(1, 500);
+	std::uniform_real_distribution<float> side_dis(-0.3f, 0.3f);
+	std::uniform_int_distribution<uint32_t> mtl_dis(0, NUM_MATERIALS - 1);
+
+	for (uint32_t num_boxes : { 1000U, 10000U })
+	{
+		// All in front of the camera, so every box goes through the queue
+		std::vector<SceneNodePtr> nodes(num_boxes);
+		for (uint32_t i = 0; i < num_boxes; ++ i)
+		{
+			float const z = depth_dis(gen);
+			OBBox const obb(MathLib::convert_to_obbox(AABBox(float3(-0.5f, -0.5f, -0.5f), float3(0.5f, 0.5f, 0.5f))));
+			auto box = MakeSharedPtr<QueuedBox>(obb, (i & 1) != 0, materials[mtl_dis(gen)]);
+			nodes[i] = MakeSharedPtr<SceneNode>(box, SceneNode::SOA_Cullable);
+			nodes[i]->TransformToParent(MathLib::translation(side_dis(gen) * z, side_dis(gen) * z, z));
+			root.AddChild(nodes[i]);
+		}
+		sm.Update();
+
+		Timer timer;
+		for (uint32_t frame = 0; frame < NUM_FRAMES; ++ frame)
+		{
+			sm.Update();
+		}
+		double const frame_time = timer.elapsed() / NUM_FRAMES;
+
+		// The rendered counters are the overlay's by now, the scene nodes keep their marks
+		uint32_t num_visible = 0;
+		for (auto const & node : nodes)
+		{
+			if (node->VisibleMark() != BO_No)
+			{
+				++ num_visible;
+			}
+		}
+		EXPECT_EQ(num_visible, num_boxes);
+
+		std::cout << num_boxes << " boxes, " << Context::Instance().Config().render_factory_name << ": "
+			<< frame_time * 1000 << " ms/frame" << std::endl;
+
+		for (auto const & node : nodes)
+		{
+			root.RemoveChild(node);
+		}
+	}
+}
@@ -1,10 +1,145 @@
 #include <KlayGE/KlayGE.hpp>
+#include <KFL/Hash.hpp>
+#include <KFL/Timer.hpp>
 #include <KlayGE/ResLoader.hpp>
 
+#include <iostream>
+#include <vector>
+
 #include "KlayGETests.hpp"
 
 using namespace KlayGE;
 
+namespace
+{
+	class SyntheticLoadingDesc : public ResLoadingDesc
+	{
+	public:
+		explicit SyntheticLoadingDesc(uint32_t id)
+			: id_(id), value_(MakeSharedPtr<uint32_t>(0))
+		{
+		}
+
+		uint64_t Type() const override
+		{
+			static uint64_t const type = CT_HASH("SyntheticLoadingDesc");
+			return type;
+		}
+
+		bool StateLess() const override
+		{
+			return true;
+		}
+
+		std::shared_ptr<void> CreateResource() override
+		{
+			return value_;
+		}
+
+		void SubThreadStage() override
+		{
+			uint32_t v = id_;
+			for (uint32_t i = 0; i < 1000; ++ i)
+			{
+				v = v * 1664525U + 1013904223U;
+			}
+			*value_ = v | 1;
+		}
+
+		void MainThreadStage() override
+		{
+		}
+
+		bool HasSubThreadStage() const override
+		{
+			return true;
+		}
+
+		uint64_t Hash() const override
+		{
+			size_t seed = 0;
+			HashCombine(seed, this->Type());
+			HashCombine(seed, id_);
+			return seed;
+		}
+
+		bool Match(ResLoadingDesc const & rhs) const override
+		{
+			if (this->Type() == rhs.Type())
+			{
+				SyntheticLoadingDesc const & sld = static_cast<SyntheticLoadingDesc const &>(rhs);
+				return (id_ == sld.id_);
+			}
+			return false;
+		}
+
+		void CopyDataFrom(ResLoadingDesc const & rhs) override
+		{
+			BOOST_ASSERT(this->Type() == rhs.Type());
+
+			SyntheticLoadingDesc const & sld = static_cast<SyntheticLoadingDesc const &>(rhs);
+			id_ = sld.id_;
+			value_ = sld.value_;
+		}
+
+		std::shared_ptr<void> CloneResourceFrom(std::shared_ptr<void> const & resource) override
+		{
+			return resource;
+		}
+
+		std::shared_ptr<void> Resource() const override
+		{
+			return value_;
+		}
+
+	private:
+		uint32_t id_;
+		std::shared_ptr<uint32_t> value_;
+	};
+
+	double LoadSyntheticDescs(uint32_t num_descs)
+	{
+		std::vector<std::shared_ptr<uint32_t>> resources(num_descs);
+
+		Timer timer;
+		for (uint32_t i = 0; i < num_descs; ++ i)
+		{
+			resources[i] = ResLoader::Instance().ASyncQueryT<uint32_t>(MakeSharedPtr<SyntheticLoadingDesc>(i),
+				static_cast<ResLoadingPriority>(i % RLP_NumPriorities));
+		}
+		for (;;)
+		{
+			ResLoader::Instance().Update();
+
+			bool all_done = true;
+			for (auto const & res : resources)
+			{
+				if (*res == 0)
+				{
+					all_done = false;
+					break;
+				}
+			}
+			if (all_done)
+			{
+				break;
+			}
+
+			std::this_thread::yield();
+		}
+		double const loading_time = timer.elapsed();
+
+		for (uint32_t i = 0; i < num_descs; ++ i)
+		{
+			auto res = ResLoader::Instance().SyncQueryT<uint32_t>(MakeSharedPtr<SyntheticLoadingDesc>(i));
+			EXPECT_EQ(res, resources[i]);
+		}
+		ResLoader::Instance().Update();
+
+		return loading_time;
+	}
+}
+
 std::string const sanity_string = "This is a test for ResLoader.";
 
 std::string ReadWholeFile(ResIdentifierPtr const & res)
@@ -31,6 +166,25 @@ TEST(ResLoaderTest, AddDelPath)
 	EXPECT_TRUE(ResLoader::Instance().Locate("Test.txt").empty());
 }
 
+TEST(ResLoaderTest, MappedData)
+{
+	ResLoader::Instance().AddPath("../../Tests/media/ResLoader");
+
+	auto res = ResLoader::Instance().Open("Test.txt");
+	EXPECT_TRUE(res);
+	auto const mapped_data = res->MappedData();
+	EXPECT_FALSE(mapped_data.empty());
+	EXPECT_EQ(std::string(mapped_data.begin(), mapped_data.end()), sanity_string);
+
+	res->seekg(5, std::ios_base::beg);
+	char ch;
+	res->read(&ch, sizeof(ch));
+	EXPECT_EQ(ch, static_cast<char>(mapped_data[5]));
+	EXPECT_EQ(ReadWholeFile(res), sanity_string);
+
+	ResLoader::Instance().DelPath("../../Tests/media/ResLoader");
+}
+
 TEST(ResLoaderTest, MountUnmountPath)
 {
 	ResLoader::Instance().Mount("ResLoaderTestData", "../../Tests/media/ResLoader");
@@ -95,3 +249,22 @@ TEST(ResLoaderTest, MountUnmountInsideEncrypt7zPath)
 	ResLoader::Instance().Unmount("ResLoaderTestData", "../../Tests/media/ResLoader/TestPassword.7z|1234/ResLoader");
 	EXPECT_TRUE(ResLoader::Instance().Locate("ResLoaderTestData/Test.txt").empty());
 }
+
+TEST(ResLoaderTest, ParallelLoadingBenchmark)
+{
+	uint32_t const num_descs = 10000;
+	uint32_t const orig_num_threads = ResLoader::Instance().NumLoadingThreads();
+
+	std::vector<uint32_t> thread_counts = { 1, orig_num_threads, std::max(std::thread::hardware_concurrency(), 1U) };
+	for (uint32_t num_threads : thread_counts)
+	{
+		ResLoader::Instance().NumLoadingThreads(num_threads);
+		EXPECT_EQ(ResLoader::Instance().NumLoadingThreads(), num_threads);
+
+		double const loading_time = LoadSyntheticDescs(num_descs);
+		std::cout << num_descs << " synthetic descs with " << num_threads << " loading thread(s): "
+			<< loading_time * 1000 << " ms" << std::endl;
+	}
+
+	ResLoader::Instance().NumLoadingThreads(orig_num_threads);
+}
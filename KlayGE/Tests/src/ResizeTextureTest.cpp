@@ -0,0 +1,199 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Math.hpp>
+#include <KFL/Timer.hpp>
+#include <KlayGE/ElementFormat.hpp>
+#include <KlayGE/Texture.hpp>
+
+#include "KlayGETests.hpp"
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace KlayGE;
+
+namespace
+{
+	std::vector<Color> RandomImage(uint32_t num_pixels, uint32_t seed)
+	{
+		std::ranlux24_base gen(seed);
+		std::uniform_real_distribution<float> dis(0, 1);
+
+		std::vector<Color> ret(num_pixels);
+		for (auto& clr : ret)
+		{
+			clr = Color(dis(gen), dis(gen), dis(gen), dis(gen));
+		}
+		return ret;
+	}
+
+	std::vector<Color> Resize32F(std::vector<Color> const & src, uint32_t src_width, uint32_t src_height, uint32_t src_depth,
+		uint32_t dst_width, uint32_t dst_height, uint32_t dst_depth, TextureResizeFilter filter)
+	{
+		std::vector<Color> dst(dst_width * dst_height * dst_depth);
+		ResizeTexture(dst.data(), dst_width * sizeof(Color), dst_width * dst_height * sizeof(Color), EF_ABGR32F,
+			dst_width, dst_height, dst_depth,
+			src.data(), src_width * sizeof(Color), src_width * src_height * sizeof(Color), EF_ABGR32F,
+			src_width, src_height, src_depth, filter);
+		return dst;
+	}
+
+	bool NearlyEqual(Color const & lhs, Color const & rhs, float tolerance)
+	{
+		for (size_t c = 0; c < 4; ++ c)
+		{
+			if (std::abs(lhs[c] - rhs[c]) > tolerance)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	TextureResizeFilter const all_filters[] = { TRF_Point, TRF_Linear, TRF_Box, TRF_Kaiser, TRF_Lanczos };
+	char const * all_filter_names[] = { "Point", "Linear", "Box", "Kaiser", "Lanczos" };
+}
+
+TEST(ResizeTextureTest, ConstantStaysConstant)
+{
+	struct Case
+	{
+		uint32_t src_width, src_height, src_depth;
+		uint32_t dst_width, dst_height, dst_depth;
+	};
+	Case const cases[] =
+	{
+		{ 64, 48, 1, 17, 100, 1 },
+		{ 300, 1, 1, 7, 1, 1 },
+		{ 8, 8, 8, 3, 5, 2 },
+		{ 5, 3, 2, 40, 30, 9 }
+	};
+
+	Color const constant(0.25f, 0.5f, 0.75f, 1);
+	for (auto const & c : cases)
+	{
+		std::vector<Color> const src(c.src_width * c.src_height * c.src_depth, constant);
+		for (auto filter : all_filters)
+		{
+			auto const dst = Resize32F(src, c.src_width, c.src_height, c.src_depth, c.dst_width, c.dst_height, c.dst_depth, filter);
+			for (auto const & clr : dst)
+			{
+				EXPECT_TRUE(NearlyEqual(clr, constant, 1e-5f));
+			}
+		}
+	}
+}
+
+TEST(ResizeTextureTest, BoxHalfIsAverage)
+{
+	uint32_t const WIDTH = 64;
+	uint32_t const HEIGHT = 48;
+
+	auto const src = RandomImage(WIDTH * HEIGHT, 1);
+	auto const dst = Resize32F(src, WIDTH, HEIGHT, 1, WIDTH / 2, HEIGHT / 2, 1, TRF_Box);
+	for (uint32_t y = 0; y < HEIGHT / 2; ++ y)
+	{
+		for (uint32_t x = 0; x < WIDTH / 2; ++ x)
+		{
+			Color const expected = (src[(y * 2 + 0) * WIDTH + x * 2 + 0] + src[(y * 2 + 0) * WIDTH + x * 2 + 1]
+				+ src[(y * 2 + 1) * WIDTH + x * 2 + 0] + src[(y * 2 + 1) * WIDTH + x * 2 + 1]) / 4;
+			EXPECT_TRUE(NearlyEqual(dst[y * WIDTH / 2 + x], expected, 1e-5f));
+		}
+	}
+}
+
+TEST(ResizeTextureTest, LinearIsBilinear)
+{
+	uint32_t const SRC_WIDTH = 37;
+	uint32_t const SRC_HEIGHT = 29;
+
+	auto const src = RandomImage(SRC_WIDTH * SRC_HEIGHT, 2);
+	for (auto const & dst_size : { uint2(64, 50), uint2(13, 11) })
+	{
+		uint32_t const dst_width = dst_size.x();
+		uint32_t const dst_height = dst_size.y();
+		auto const dst = Resize32F(src, SRC_WIDTH, SRC_HEIGHT, 1, dst_width, dst_height, 1, TRF_Linear);
+
+		for (uint32_t y = 0; y < dst_height; ++ y)
+		{
+			float const fy = static_cast<float>(y + 0.5f) / dst_height * SRC_HEIGHT;
+			uint32_t const sy0 = static_cast<uint32_t>(fy - 0.5f);
+			uint32_t const sy1 = std::min(sy0 + 1, SRC_HEIGHT - 1);
+			float const weight_y = fy - sy0 - 0.5f;
+
+			for (uint32_t x = 0; x < dst_width; ++ x)
+			{
+				float const fx = static_cast<float>(x + 0.5f) / dst_width * SRC_WIDTH;
+				uint32_t const sx0 = static_cast<uint32_t>(fx - 0.5f);
+				uint32_t const sx1 = std::min(sx0 + 1, SRC_WIDTH - 1);
+				float const weight_x = fx - sx0 - 0.5f;
+
+				Color const clr_y0 = MathLib::lerp(src[sy0 * SRC_WIDTH + sx0], src[sy0 * SRC_WIDTH + sx1], weight_x);
+				Color const clr_y1 = MathLib::lerp(src[sy1 * SRC_WIDTH + sx0], src[sy1 * SRC_WIDTH + sx1], weight_x);
+				EXPECT_TRUE(NearlyEqual(dst[y * dst_width + x], MathLib::lerp(clr_y0, clr_y1, weight_y), 1e-5f));
+			}
+		}
+	}
+}
+
+TEST(ResizeTextureTest, SameSizeConvertsFormat)
+{
+	uint32_t const WIDTH = 300;
+	uint32_t const HEIGHT = 200;
+
+	std::ranlux24_base gen(3);
+	std::vector<uint32_t> src(WIDTH * HEIGHT);
+	for (auto& texel : src)
+	{
+		texel = gen();
+	}
+
+	std::vector<Color> expected(WIDTH * HEIGHT);
+	ConvertToABGR32F(EF_ABGR8, src.data(), WIDTH * HEIGHT, expected.data());
+
+	for (auto filter : all_filters)
+	{
+		std::vector<Color> dst(WIDTH * HEIGHT);
+		ResizeTexture(dst.data(), WIDTH * sizeof(Color), WIDTH * HEIGHT * sizeof(Color), EF_ABGR32F, WIDTH, HEIGHT, 1,
+			src.data(), WIDTH * sizeof(uint32_t), WIDTH * HEIGHT * sizeof(uint32_t), EF_ABGR8, WIDTH, HEIGHT, 1, filter);
+		EXPECT_TRUE(dst == expected);
+	}
+}
+
+TEST(ResizeTextureTest, Benchmark)
+{
+	uint32_t const SRC_WIDTH = 2048;
+	uint32_t const SRC_HEIGHT = 2048;
+	uint32_t const NUM_ITERATIONS = 5;
+
+	std::ranlux24_base gen(4);
+	std::vector<uint32_t> src(SRC_WIDTH * SRC_HEIGHT);
+	for (auto& texel : src)
+	{
+		texel = gen();
+	}
+
+	for (auto const & dst_size : { uint2(SRC_WIDTH / 2, SRC_HEIGHT / 2), uint2(SRC_WIDTH * 3 / 2, SRC_HEIGHT * 3 / 2) })
+	{
+		uint32_t const dst_width = dst_size.x();
+		uint32_t const dst_height = dst_size.y();
+		std::vector<uint32_t> dst(dst_width * dst_height);
+
+		for (size_t i = 0; i < std::size(all_filters); ++ i)
+		{
+			Timer timer;
+			for (uint32_t j = 0; j < NUM_ITERATIONS; ++ j)
+			{
+				ResizeTexture(dst.data(), dst_width * sizeof(uint32_t), dst_width * dst_height * sizeof(uint32_t), EF_ABGR8,
+					dst_width, dst_height, 1,
+					src.data(), SRC_WIDTH * sizeof(uint32_t), SRC_WIDTH * SRC_HEIGHT * sizeof(uint32_t), EF_ABGR8,
+					SRC_WIDTH, SRC_HEIGHT, 1, all_filters[i]);
+			}
+			double const time = timer.elapsed() / NUM_ITERATIONS;
+
+			std::cout << SRC_WIDTH << "x" << SRC_HEIGHT << " -> " << dst_width << "x" << dst_height << ' ' << all_filter_names[i]
+				<< ": " << time * 1000 << " ms, " << SRC_WIDTH * SRC_HEIGHT / time / 1e6 << " src MPix/s, "
+				<< dst_width * dst_height / time / 1e6 << " dst MPix/s" << std::endl;
+		}
+	}
+}
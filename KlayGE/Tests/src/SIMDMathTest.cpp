@@ -1,16 +1,40 @@
 #include <KlayGE/KlayGE.hpp>
 #include <KFL/Math.hpp>
 #include <KFL/SIMDMath.hpp>
+#include <KFL/Timer.hpp>
 
 #include "KlayGETests.hpp"
 
 #include <vector>
 #include <string>
 #include <iostream>
+#include <random>
 
 using namespace std;
 using namespace KlayGE;
 
+namespace
+{
+	float4x4 RandomMatrix(std::mt19937& gen)
+	{
+		std::uniform_real_distribution<float> dis(-1, 1);
+
+		float4x4 mat;
+		for (size_t i = 0; i < mat.size(); ++ i)
+		{
+			mat[i] = dis(gen);
+		}
+		// Keeps w away from 0 for the coord transforms
+		mat(3, 3) = 4;
+		return mat;
+	}
+
+	bool NearlyEqual(float lhs, float rhs)
+	{
+		return MathLib::abs(lhs - rhs) <= 1e-4f * std::max(1.0f, std::max(MathLib::abs(lhs), MathLib::abs(rhs)));
+	}
+}
+
 TEST(SIMDMathTest, NormalizeVector2)
 {
 	SIMDVectorF4 v = SIMDMathLib::SetVector(1, 2, 0, 0);
@@ -31,3 +55,228 @@ TEST(SIMDMathTest, NormalizeVector4)
 	v = SIMDMathLib::NormalizeVector4(v);
 	EXPECT_LT(MathLib::abs(SIMDMathLib::GetX(SIMDMathLib::LengthVector4(v)) - 1.0f), 1e-3f);
 }
+
+TEST(SIMDMathTest, GetSet)
+{
+	SIMDVectorF4 v = SIMDMathLib::SetVector(1, 2, 3, 4);
+	EXPECT_EQ(SIMDMathLib::GetX(v), 1);
+	EXPECT_EQ(SIMDMathLib::GetY(v), 2);
+	EXPECT_EQ(SIMDMathLib::GetZ(v), 3);
+	EXPECT_EQ(SIMDMathLib::GetW(v), 4);
+
+	v = SIMDMathLib::SetY(v, 5);
+	v = SIMDMathLib::SetByIndex(v, 6, 3);
+	float4 f;
+	SIMDMathLib::StoreVector4(&f[0], v);
+	EXPECT_EQ(f, float4(1, 5, 3, 6));
+
+	SIMDVectorF8 v8 = SIMDMathLib::SetVector8(2);
+	float const fs[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+	v8 = -(v8 * SIMDMathLib::LoadVector8(fs) + 1.0f);
+	for (size_t i = 0; i < SIMDVectorF8::size(); ++ i)
+	{
+		EXPECT_EQ(SIMDMathLib::GetByIndex(v8, i), -(2 * fs[i] + 1));
+	}
+}
+
+TEST(SIMDMathTest, MultiplyMatrix)
+{
+	std::mt19937 gen(1);
+	for (int i = 0; i < 100; ++ i)
+	{
+		float4x4 const lhs = RandomMatrix(gen);
+		float4x4 const rhs = RandomMatrix(gen);
+		float4x4 const expected = lhs * rhs;
+		SIMDMatrixF4 const actual = SIMDMatrixF4(&lhs[0]) * SIMDMatrixF4(&rhs[0]);
+		SIMDMatrixF4 const transposed = SIMDMathLib::Transpose(actual);
+		for (size_t r = 0; r < 4; ++ r)
+		{
+			for (size_t c = 0; c < 4; ++ c)
+			{
+				EXPECT_TRUE(NearlyEqual(actual(r, c), expected(r, c)));
+				EXPECT_EQ(transposed(c, r), actual(r, c));
+			}
+		}
+	}
+}
+
+TEST(SIMDMathTest, TransformVector3)
+{
+	std::mt19937 gen(2);
+	std::uniform_real_distribution<float> dis(-1, 1);
+	for (int i = 0; i < 100; ++ i)
+	{
+		float4x4 const mat = RandomMatrix(gen);
+		float3 const v(dis(gen), dis(gen), dis(gen));
+		float3 const w(dis(gen), dis(gen), dis(gen));
+
+		float3 actual;
+		SIMDMathLib::StoreVector3(actual, SIMDMathLib::TransformNormalVector3(SIMDMathLib::LoadVector3(v), SIMDMatrixF4(&mat[0])));
+		float3 expected = MathLib::transform_normal(v, mat);
+		for (size_t j = 0; j < 3; ++ j)
+		{
+			EXPECT_TRUE(NearlyEqual(actual[j], expected[j]));
+		}
+
+		SIMDMathLib::StoreVector3(actual, SIMDMathLib::CrossVector3(SIMDMathLib::LoadVector3(v), SIMDMathLib::LoadVector3(w)));
+		expected = MathLib::cross(v, w);
+		for (size_t j = 0; j < 3; ++ j)
+		{
+			EXPECT_TRUE(NearlyEqual(actual[j], expected[j]));
+		}
+
+		EXPECT_TRUE(NearlyEqual(SIMDMathLib::GetX(SIMDMathLib::DotVector3(SIMDMathLib::LoadVector3(v), SIMDMathLib::LoadVector3(w))),
+			MathLib::dot(v, w)));
+	}
+}
+
+TEST(SIMDMathTest, MultiplyQuat)
+{
+	std::mt19937 gen(3);
+	std::uniform_real_distribution<float> dis(-1, 1);
+	for (int i = 0; i < 100; ++ i)
+	{
+		Quaternion const lhs = MathLib::normalize(Quaternion(dis(gen), dis(gen), dis(gen), dis(gen)));
+		Quaternion const rhs = MathLib::normalize(Quaternion(dis(gen), dis(gen), dis(gen), dis(gen)));
+		Quaternion const expected = MathLib::mul(lhs, rhs);
+
+		float4 actual;
+		SIMDMathLib::StoreVector4(&actual[0], SIMDMathLib::MultiplyQuat(SIMDMathLib::SetVector(lhs.x(), lhs.y(), lhs.z(), lhs.w()),
+			SIMDMathLib::SetVector(rhs.x(), rhs.y(), rhs.z(), rhs.w())));
+		for (size_t j = 0; j < 4; ++ j)
+		{
+			EXPECT_TRUE(NearlyEqual(actual[j], expected[j]));
+		}
+	}
+}
+
+TEST(SIMDMathTest, BatchTransformVector3)
+{
+	std::mt19937 gen(4);
+	std::uniform_real_distribution<float> dis(-1, 1);
+
+	float4x4 const mat = MathLib::translation(0.0f, 0.0f, 5.0f) * MathLib::perspective_fov_lh(PI / 4, 1.3f, 0.1f, 100.0f);
+	SIMDMatrixF4 const simd_mat(&mat[0]);
+
+	// Not multiples of 8, so the padded tail is covered too
+	for (size_t num : { 1, 7, 8, 9, 1003 })
+	{
+		std::vector<float3> points(num);
+		for (auto& p : points)
+		{
+			p = float3(dis(gen), dis(gen), dis(gen));
+		}
+
+		std::vector<float3> coords(num);
+		std::vector<float3> normals(num);
+		SIMDMathLib::TransformCoordVector3(coords.data(), points.data(), num, simd_mat);
+		SIMDMathLib::TransformNormalVector3(normals.data(), points.data(), num, simd_mat);
+		for (size_t i = 0; i < num; ++ i)
+		{
+			float3 const expected_coord = MathLib::transform_coord(points[i], mat);
+			float3 const expected_normal = MathLib::transform_normal(points[i], mat);
+			for (size_t j = 0; j < 3; ++ j)
+			{
+				EXPECT_TRUE(NearlyEqual(coords[i][j], expected_coord[j])) << "Point " << i << " of " << num;
+				EXPECT_TRUE(NearlyEqual(normals[i][j], expected_normal[j])) << "Point " << i << " of " << num;
+			}
+		}
+
+		// In place
+		SIMDMathLib::TransformCoordVector3(points.data(), points.data(), num, simd_mat);
+		EXPECT_TRUE(points == coords);
+	}
+}
+
+TEST(SIMDMathTest, Benchmark)
+{
+	uint32_t const NUM_MATRICES = 1024;
+	uint32_t const NUM_MATRIX_LOOPS = 1000;
+	uint32_t const NUM_POINTS = 1000000;
+	uint32_t const NUM_POINT_LOOPS = 10;
+
+	std::mt19937 gen(5);
+	std::uniform_real_distribution<float> dis(-1, 1);
+
+	std::vector<float4x4> mats(NUM_MATRICES);
+	std::vector<SIMDMatrixF4> simd_mats(NUM_MATRICES);
+	for (uint32_t i = 0; i < NUM_MATRICES; ++ i)
+	{
+		mats[i] = RandomMatrix(gen);
+		simd_mats[i] = SIMDMatrixF4(&mats[i][0]);
+	}
+
+	std::vector<float4x4> products(NUM_MATRICES);
+	Timer timer;
+	for (uint32_t loop = 0; loop < NUM_MATRIX_LOOPS; ++ loop)
+	{
+		for (uint32_t i = 0; i < NUM_MATRICES; ++ i)
+		{
+			products[i] = mats[i] * mats[(i + loop) % NUM_MATRICES];
+		}
+	}
+	double const scalar_mat_time = timer.elapsed();
+
+	std::vector<SIMDMatrixF4> simd_products(NUM_MATRICES);
+	timer.restart();
+	for (uint32_t loop = 0; loop < NUM_MATRIX_LOOPS; ++ loop)
+	{
+		for (uint32_t i = 0; i < NUM_MATRICES; ++ i)
+		{
+			simd_products[i] = simd_mats[i] * simd_mats[(i + loop) % NUM_MATRICES];
+		}
+	}
+	double const simd_mat_time = timer.elapsed();
+
+	for (uint32_t i = 0; i < NUM_MATRICES; ++ i)
+	{
+		EXPECT_TRUE(NearlyEqual(simd_products[i](1, 2), products[i](1, 2)));
+	}
+
+	// Transforming a point cloud
+	std::vector<float3> points(NUM_POINTS);
+	for (auto& p : points)
+	{
+		p = float3(dis(gen), dis(gen), dis(gen));
+	}
+	std::vector<float3> transformed(NUM_POINTS);
+
+	timer.restart();
+	for (uint32_t loop = 0; loop < NUM_POINT_LOOPS; ++ loop)
+	{
+		for (uint32_t i = 0; i < NUM_POINTS; ++ i)
+		{
+			transformed[i] = MathLib::transform_coord(points[i], mats[loop]);
+		}
+	}
+	double const scalar_point_time = timer.elapsed();
+
+	timer.restart();
+	for (uint32_t loop = 0; loop < NUM_POINT_LOOPS; ++ loop)
+	{
+		for (uint32_t i = 0; i < NUM_POINTS; ++ i)
+		{
+			SIMDMathLib::StoreVector3(transformed[i],
+				SIMDMathLib::TransformCoordVector3(SIMDMathLib::LoadVector3(points[i]), simd_mats[loop]));
+		}
+	}
+	double const simd_point_time = timer.elapsed();
+
+	timer.restart();
+	for (uint32_t loop = 0; loop < NUM_POINT_LOOPS; ++ loop)
+	{
+		SIMDMathLib::TransformCoordVector3(transformed.data(), points.data(), NUM_POINTS, simd_mats[loop]);
+	}
+	double const batch_point_time = timer.elapsed();
+
+	for (uint32_t i = 0; i < NUM_POINTS; i += NUM_POINTS / 100)
+	{
+		float3 const expected = MathLib::transform_coord(points[i], mats[NUM_POINT_LOOPS - 1]);
+		EXPECT_TRUE(NearlyEqual(transformed[i].y(), expected.y()));
+	}
+
+	std::cout << NUM_MATRICES * NUM_MATRIX_LOOPS << " matrix multiplications: MathLib " << scalar_mat_time * 1000 << " ms, SIMDMathLib "
+		<< simd_mat_time * 1000 << " ms" << std::endl;
+	std::cout << NUM_POINTS * NUM_POINT_LOOPS << " point transforms: MathLib " << scalar_point_time * 1000 << " ms, SIMDMathLib "
+		<< simd_point_time * 1000 << " ms, " << SIMDVectorF8::size() << "-wide batch " << batch_point_time * 1000 << " ms" << std::endl;
+}
@@ -0,0 +1,362 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Math.hpp>
+#include <KFL/Timer.hpp>
+#include <KlayGE/App3D.hpp>
+#include <KlayGE/Camera.hpp>
+#include <KlayGE/Context.hpp>
+#include <KlayGE/Renderable.hpp>
+#include <KlayGE/SceneManager.hpp>
+#include <KlayGE/SceneNode.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "KlayGETests.hpp"
+
+using namespace KlayGE;
+
+namespace
+{
+	// A renderable that only has a bound. It has no technique, so it never goes to the render queue.
+	class BoundOnlyRenderable : public Renderable
+	{
+	public:
+		explicit BoundOnlyRenderable(AABBox const & aabb)
+			: Renderable(L"BoundOnly")
+		{
+			pos_aabb_ = aabb;
+		}
+	};
+
+	uint32_t const TILE_SIZE = 16;
+	uint32_t const NODES_PER_TILE = 500;
+	uint32_t const NUM_TILES = 100;
+
+	uint32_t const SLOW_UPDATE_MS = 200;
+
+	// A streaming tile: a cullable group node with static props scattered inside
+	SceneNodePtr CreateTile(RenderablePtr const & prop, int32_t tile_x, std::ranlux24_base& gen)
+	{
+		std::uniform_real_distribution<float> dis_x(0, static_cast<float>(TILE_SIZE));
+		std::uniform_real_distribution<float> dis_yz(-64, 64);
+
+		auto tile = MakeSharedPtr<SceneNode>(L"Tile", SceneNode::SOA_Cullable);
+		tile->TransformToParent(MathLib::translation(static_cast<float>(tile_x * static_cast<int32_t>(TILE_SIZE)), 0.0f, 0.0f));
+		for (uint32_t i = 0; i < NODES_PER_TILE; ++ i)
+		{
+			auto node = MakeSharedPtr<SceneNode>(prop, SceneNode::SOA_Cullable);
+			node->TransformToParent(MathLib::translation(dis_x(gen), dis_yz(gen), dis_yz(gen)));
+			tile->AddChild(node);
+		}
+		return tile;
+	}
+}
+
+TEST(SceneManagerTest, StreamingBenchmark)
+{
+	uint32_t const num_moveables = 1000;
+	uint32_t const num_frames = 200;
+
+	// Culling only happens when the scene is flushed
+	SceneFlushScope flush_scope;
+
+	auto& sm = Context::Instance().SceneManagerInstance();
+	auto& root = sm.SceneRootNode();
+	auto& camera = Context::Instance().AppInstance().ActiveCamera();
+	camera.ProjParams(PI / 4, 1, 0.1f, 500.0f);
+
+	std::ranlux24_base gen;
+
+	auto prop = MakeSharedPtr<BoundOnlyRenderable>(AABBox(float3(-0.5f, -0.5f, -0.5f), float3(0.5f, 0.5f, 0.5f)));
+
+	std::deque<SceneNodePtr> tiles;
+	int32_t next_tile = 0;
+	for (; next_tile < static_cast<int32_t>(NUM_TILES); ++ next_tile)
+	{
+		tiles.push_back(CreateTile(prop, next_tile, gen));
+		root.AddChild(tiles.back());
+	}
+
+	std::uniform_real_distribution<float> dis_offset(-32, 32);
+	std::vector<SceneNodePtr> moveables(num_moveables);
+	std::vector<float3> moveable_offsets(num_moveables);
+	for (uint32_t i = 0; i < num_moveables; ++ i)
+	{
+		moveables[i] = MakeSharedPtr<SceneNode>(prop, SceneNode::SOA_Cullable | SceneNode::SOA_Moveable);
+		moveable_offsets[i] = float3(dis_offset(gen), dis_offset(gen), dis_offset(gen));
+		root.AddChild(moveables[i]);
+	}
+
+	Timer timer;
+	camera.ViewParams(float3(0, 0, 0), float3(1, 0, 0));
+	sm.Update();
+	double const build_time = timer.elapsed();
+
+	uint32_t total_rendered = 0;
+	double streaming_time = 0;
+	for (uint32_t frame = 0; frame < num_frames; ++ frame)
+	{
+		timer.restart();
+
+		// Streams one tile out behind the camera and a new one in ahead of it
+		root.RemoveChild(tiles.front());
+		tiles.pop_front();
+		tiles.push_back(CreateTile(prop, next_tile, gen));
+		root.AddChild(tiles.back());
+		++ next_tile;
+
+		float const cam_x = static_cast<float>((frame + 1) * TILE_SIZE);
+		for (uint32_t i = 0; i < num_moveables; ++ i)
+		{
+			float3 const pos = moveable_offsets[i] + float3(cam_x + 64 + 16 * sin(frame * 0.1f + i), 0, 0);
+			moveables[i]->TransformToParent(MathLib::translation(pos));
+		}
+
+		camera.ViewParams(float3(cam_x, 0, 0), float3(cam_x + 1, 0, 0));
+		sm.Update();
+
+		streaming_time += timer.elapsed();
+
+		// The rendered counters are the overlay's by now, the scene nodes keep their marks
+		root.Traverse([&total_rendered](SceneNode& node)
+			{
+				if (node.VisibleMark() != BO_No)
+				{
+					++ total_rendered;
+				}
+				return true;
+			});
+	}
+
+	EXPECT_GT(total_rendered, 0U);
+	EXPECT_LT(total_rendered, num_frames * (NUM_TILES * (NODES_PER_TILE + 1) + num_moveables + 1));
+
+	std::cout << NUM_TILES * NODES_PER_TILE << " static and " << num_moveables << " moveable nodes, build: "
+		<< build_time * 1000 << " ms, streaming " << NODES_PER_TILE << " nodes in and out per frame: "
+		<< streaming_time * 1000 / num_frames << " ms/frame" << std::endl;
+
+	sm.ClearObject();
+}
+
+TEST(SceneManagerTest, TransformPropagationBenchmark)
+{
+	uint32_t const branching = 10;
+	uint32_t const depth = 5;
+	uint32_t const num_frames = 20;
+
+	auto& sm = Context::Instance().SceneManagerInstance();
+	auto& root = sm.SceneRootNode();
+	uint32_t const orig_num_threads = sm.NumTransformThreads();
+
+	std::ranlux24_base gen;
+	std::uniform_real_distribution<float> dis(-4, 4);
+
+	auto prop = MakeSharedPtr<BoundOnlyRenderable>(AABBox(float3(-0.5f, -0.5f, -0.5f), float3(0.5f, 0.5f, 0.5f)));
+
+	// 111111 moveable nodes, 10 children per node
+	auto top = MakeSharedPtr<SceneNode>(prop, L"Top", SceneNode::SOA_Moveable);
+	std::vector<SceneNode*> level_nodes = { top.get() };
+	uint32_t num_nodes = 1;
+	for (uint32_t level = 0; level < depth; ++ level)
+	{
+		std::vector<SceneNode*> next_level_nodes;
+		for (auto* parent : level_nodes)
+		{
+			for (uint32_t i = 0; i < branching; ++ i)
+			{
+				auto node = MakeSharedPtr<SceneNode>(prop, SceneNode::SOA_Moveable);
+				node->TransformToParent(MathLib::translation(dis(gen), dis(gen), dis(gen)));
+				parent->AddChild(node);
+				next_level_nodes.push_back(node.get());
+			}
+		}
+		num_nodes += static_cast<uint32_t>(next_level_nodes.size());
+		level_nodes.swap(next_level_nodes);
+	}
+	root.AddChild(top);
+
+	std::vector<uint32_t> thread_counts = { 1, 2, 4, std::max(std::thread::hardware_concurrency(), 1U) };
+	for (uint32_t num_threads : thread_counts)
+	{
+		sm.NumTransformThreads(num_threads);
+		sm.Update();
+
+		Timer timer;
+		for (uint32_t frame = 0; frame < num_frames; ++ frame)
+		{
+			top->TransformToParent(MathLib::rotation_y(frame * 0.1f));
+			sm.Update();
+		}
+		double const update_time = timer.elapsed();
+
+		std::cout << num_nodes << " nodes with " << num_threads << " transform thread(s): "
+			<< update_time * 1000 / num_frames << " ms/frame" << std::endl;
+	}
+
+	// The world transform of a leaf is the product of the whole chain
+	auto const * leaf = level_nodes.back();
+	float4x4 expected = leaf->TransformToParent();
+	for (auto const * node = leaf->Parent(); node != nullptr; node = node->Parent())
+	{
+		expected *= node->TransformToParent();
+	}
+	for (size_t i = 0; i < 16; ++ i)
+	{
+		EXPECT_LT(MathLib::abs(leaf->TransformToWorld()[i] - expected[i]), 1e-3f);
+	}
+	EXPECT_TRUE(MathLib::intersect_point_aabb(MathLib::transform_coord(float3(0, 0, 0), expected), top->PosBoundWS()));
+
+	sm.NumTransformThreads(orig_num_threads);
+	root.RemoveChild(top);
+}
+
+TEST(SceneManagerTest, VisibleMarksCacheIsPerFrame)
+{
+	SceneFlushScope flush_scope;
+
+	auto& sm = Context::Instance().SceneManagerInstance();
+	auto& root = sm.SceneRootNode();
+
+	auto prop = MakeSharedPtr<BoundOnlyRenderable>(AABBox(float3(-0.5f, -0.5f, -0.5f), float3(0.5f, 0.5f, 0.5f)));
+	auto node = MakeSharedPtr<SceneNode>(prop, SceneNode::SOA_Cullable);
+	root.AddChild(node);
+
+	uint64_t const orig_hits = sm.NumVisibleMarksCacheHits();
+	uint64_t const orig_misses = sm.NumVisibleMarksCacheMisses();
+
+	// Same camera and visible list every frame, but marks cached in one frame must not be reused in the next
+	uint32_t const num_frames = 40;
+	for (uint32_t frame = 0; frame < num_frames; ++ frame)
+	{
+		sm.Update();
+	}
+	EXPECT_EQ(sm.NumVisibleMarksCacheHits(), orig_hits);
+	EXPECT_EQ(sm.NumVisibleMarksCacheMisses(), orig_misses + num_frames);
+
+	root.RemoveChild(node);
+}
+
+TEST(SceneManagerTest, SlowSubThreadUpdate)
+{
+	uint32_t const num_slow_updates = 3;
+
+	auto& sm = Context::Instance().SceneManagerInstance();
+	auto& root = sm.SceneRootNode();
+
+	auto prop = MakeSharedPtr<BoundOnlyRenderable>(AABBox(float3(-0.5f, -0.5f, -0.5f), float3(0.5f, 0.5f, 0.5f)));
+	auto node = MakeSharedPtr<SceneNode>(prop, SceneNode::SOA_Cullable | SceneNode::SOA_Moveable);
+	auto* node_ptr = node.get();
+
+	// A script that takes far longer than a frame, moving the node one step further each time
+	std::atomic<bool> quit(false);
+	std::atomic<uint32_t> num_updates(0);
+	node->OnSubThreadUpdate().Connect([node_ptr, &quit, &num_updates](float app_time, float elapsed_time)
+		{
+			KFL_UNUSED(app_time);
+			KFL_UNUSED(elapsed_time);
+
+			if (!quit)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(SLOW_UPDATE_MS));
+				node_ptr->TransformToParent(node_ptr->TransformToParent() * MathLib::translation(1.0f, 0.0f, 0.0f));
+				++ num_updates;
+			}
+		});
+	root.AddChild(node);
+	sm.Update();
+
+	std::thread update_thread([&sm, &quit]
+		{
+			while (!quit)
+			{
+				sm.SubThreadUpdate(0, 1.0f / 60);
+			}
+		});
+
+	uint32_t num_frames = 0;
+	double max_frame_time = 0;
+	double total_frame_time = 0;
+	Timer timer;
+	while ((num_updates < num_slow_updates) && (total_frame_time < 10))
+	{
+		timer.restart();
+		sm.Update();
+		double const frame_time = timer.elapsed();
+
+		max_frame_time = std::max(max_frame_time, frame_time);
+		total_frame_time += frame_time;
+		++ num_frames;
+	}
+
+	quit = true;
+	update_thread.join();
+
+	// The frames go on while the script runs
+	EXPECT_GE(num_updates, num_slow_updates);
+	EXPECT_LT(max_frame_time * 1000, SLOW_UPDATE_MS / 2.0);
+
+	// No step is lost, and the last one is applied at the next frame. The engine's own update thread could be in the middle
+	// of a pass, another pass waits for it.
+	sm.SubThreadUpdate(0, 1.0f / 60);
+	sm.Update();
+	EXPECT_FLOAT_EQ(node->TransformToParent()(3, 0), static_cast<float>(num_updates));
+	EXPECT_FLOAT_EQ(node->TransformToWorld()(3, 0), static_cast<float>(num_updates));
+
+	std::cout << num_updates << " sub thread updates of " << SLOW_UPDATE_MS << " ms, " << num_frames << " frames: "
+		<< total_frame_time * 1000 / num_frames << " ms/frame, max " << max_frame_time * 1000 << " ms" << std::endl;
+
+	// Waits for a pass that could still call the handler
+	root.RemoveChild(node);
+	sm.SubThreadUpdate(0, 1.0f / 60);
+}
+
+TEST(SceneManagerTest, SubThreadUpdateOtherNode)
+{
+	auto& sm = Context::Instance().SceneManagerInstance();
+	auto& root = sm.SceneRootNode();
+
+	auto prop = MakeSharedPtr<BoundOnlyRenderable>(AABBox(float3(-0.5f, -0.5f, -0.5f), float3(0.5f, 0.5f, 0.5f)));
+	auto driver = MakeSharedPtr<SceneNode>(L"Driver", 0);
+	auto target = MakeSharedPtr<SceneNode>(prop, SceneNode::SOA_Cullable | SceneNode::SOA_Moveable);
+	auto* target_ptr = target.get();
+
+	// A handler moving a node that has no handler of its own
+	std::atomic<bool> moved(false);
+	AABBox bound_ws(float3(0, 0, 0), float3(0, 0, 0));
+	driver->OnSubThreadUpdate().Connect([target_ptr, &moved, &bound_ws](float app_time, float elapsed_time)
+		{
+			KFL_UNUSED(app_time);
+			KFL_UNUSED(elapsed_time);
+
+			if (!moved)
+			{
+				target_ptr->TransformToParent(MathLib::translation(10.0f, 0.0f, 0.0f));
+				bound_ws = target_ptr->PosBoundWS();
+				moved = true;
+			}
+		});
+	root.AddChild(driver);
+	root.AddChild(target);
+	sm.Update();
+
+	sm.SubThreadUpdate(0, 1.0f / 60);
+	ASSERT_TRUE(moved);
+
+	// The handler sees its own change, bound included, but the node only changes at the next frame
+	EXPECT_FLOAT_EQ(bound_ws.Min().x(), 9.5f);
+	EXPECT_FLOAT_EQ(target->TransformToParent()(3, 0), 0.0f);
+
+	sm.Update();
+	EXPECT_FLOAT_EQ(target->TransformToParent()(3, 0), 10.0f);
+	EXPECT_FLOAT_EQ(target->PosBoundWS().Min().x(), 9.5f);
+
+	root.RemoveChild(target);
+	root.RemoveChild(driver);
+	sm.SubThreadUpdate(0, 1.0f / 60);
+}
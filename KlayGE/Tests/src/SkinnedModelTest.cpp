@@ -0,0 +1,217 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Timer.hpp>
+#include <KlayGE/Mesh.hpp>
+#include <KlayGE/SceneNode.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "KlayGETests.hpp"
+
+using namespace KlayGE;
+
+namespace
+{
+	uint32_t const NUM_KEY_FRAMES = 8;
+	uint32_t const FRAMES_PER_KEY = 10;
+
+	std::shared_ptr<std::vector<KeyFrameSet>> CreateKeyFrameSets(uint32_t num_joints, uint32_t seed)
+	{
+		std::mt19937 gen(seed);
+		std::uniform_real_distribution<float> dis(-1, 1);
+
+		auto kfs = MakeSharedPtr<std::vector<KeyFrameSet>>(num_joints);
+		for (auto& kf : *kfs)
+		{
+			for (uint32_t i = 0; i < NUM_KEY_FRAMES; ++ i)
+			{
+				Quaternion const real = MathLib::normalize(Quaternion(dis(gen), dis(gen), dis(gen), dis(gen)));
+				kf.frame_id.push_back(i * FRAMES_PER_KEY);
+				kf.bind_real.push_back(real);
+				kf.bind_dual.push_back(MathLib::quat_trans_to_udq(real, float3(dis(gen), dis(gen), dis(gen))));
+				kf.bind_scale.push_back(1 + dis(gen) * 0.1f);
+			}
+		}
+		return kfs;
+	}
+
+	SkinnedModelPtr CreateSkinnedModel(std::shared_ptr<std::vector<KeyFrameSet>> const & kfs)
+	{
+		uint32_t const num_joints = static_cast<uint32_t>(kfs->size());
+
+		// A binary tree, every parent comes before its children
+		std::vector<Joint> joints(num_joints);
+		for (uint32_t i = 0; i < num_joints; ++ i)
+		{
+			Joint& joint = joints[i];
+			joint.name = "joint" + std::to_string(i);
+			joint.bind_real = Quaternion::Identity();
+			joint.bind_dual = Quaternion(0, 0, 0, 0);
+			joint.bind_scale = 1;
+			joint.inverse_origin_real = Quaternion::Identity();
+			joint.inverse_origin_dual = Quaternion(0, 0, 0, 0);
+			joint.inverse_origin_scale = 1;
+			joint.parent = (i == 0) ? -1 : static_cast<int16_t>((i - 1) / 2);
+		}
+
+		auto model = MakeSharedPtr<SkinnedModel>(L"SkinnedModelTest", SceneNode::SOA_Cullable);
+		model->AssignJoints(joints.begin(), joints.end());
+		model->AttachKeyFrameSets(kfs);
+		model->NumFrames(NUM_KEY_FRAMES * FRAMES_PER_KEY);
+		model->FrameRate(30);
+		return model;
+	}
+
+	// The scalar evaluation before batching, with a binary search for every joint
+	void ReferenceBinds(SkinnedModel const & model, float frame, std::vector<float4>& reals, std::vector<float4>& duals)
+	{
+		auto const & kfs = *model.GetKeyFrameSets();
+		uint32_t const num_joints = model.NumJoints();
+
+		std::vector<Quaternion> pose_reals(num_joints);
+		std::vector<Quaternion> pose_duals(num_joints);
+		std::vector<float> pose_scales(num_joints);
+		reals.resize(num_joints);
+		duals.resize(num_joints);
+		for (uint32_t i = 0; i < num_joints; ++ i)
+		{
+			KeyFrameSet const & kf = kfs[i];
+
+			float const f = std::fmod(frame, static_cast<float>(kf.frame_id.back() + 1));
+			int const index = static_cast<int>(std::upper_bound(kf.frame_id.begin(), kf.frame_id.end(), f) - kf.frame_id.begin());
+			int const index0 = index - 1;
+			int const index1 = index % kf.frame_id.size();
+			float const factor = (f - kf.frame_id[index0]) / (static_cast<int>(kf.frame_id[index1]) - static_cast<int>(kf.frame_id[index0]));
+			auto dq = MathLib::sclerp(kf.bind_real[index0], kf.bind_dual[index0], kf.bind_real[index1], kf.bind_dual[index1], factor);
+			float scale = MathLib::lerp(kf.bind_scale[index0], kf.bind_scale[index1], factor);
+
+			int16_t const parent = model.GetJoint(i).parent;
+			if (parent != -1)
+			{
+				if (MathLib::dot(dq.first, pose_reals[parent]) < 0)
+				{
+					dq.first = -dq.first;
+					dq.second = -dq.second;
+				}
+
+				pose_duals[i] = MathLib::mul_dual(dq.first, dq.second * pose_scales[parent], pose_reals[parent], pose_duals[parent]);
+				pose_reals[i] = MathLib::mul_real(dq.first, pose_reals[parent]);
+				pose_scales[i] = scale * pose_scales[parent];
+			}
+			else
+			{
+				pose_reals[i] = dq.first;
+				pose_duals[i] = dq.second;
+				pose_scales[i] = scale;
+			}
+
+			// The inverse origins are identities
+			Quaternion real = pose_reals[i];
+			Quaternion dual = pose_duals[i];
+			if (MathLib::SignBit(real.w()) < 0)
+			{
+				real = -real;
+				dual = -dual;
+			}
+			reals[i] = float4(real.x(), real.y(), real.z(), real.w()) * pose_scales[i];
+			duals[i] = float4(dual.x(), dual.y(), dual.z(), dual.w());
+		}
+	}
+}
+
+TEST(SkinnedModelTest, BatchedAnimationMatchesScalar)
+{
+	uint32_t const NUM_MODELS = 16;
+	uint32_t const NUM_JOINTS = 63;
+
+	auto kfs = CreateKeyFrameSets(NUM_JOINTS, 1);
+	std::vector<SkinnedModelPtr> models;
+	std::vector<SkinnedModel*> model_ptrs;
+	for (uint32_t i = 0; i < NUM_MODELS; ++ i)
+	{
+		models.push_back(CreateSkinnedModel(kfs));
+		model_ptrs.push_back(models.back().get());
+	}
+
+	// Forward playback, a wrap around and a jump backwards, so the cursors have to search again
+	std::vector<float> const test_frames = { 0.0f, 3.5f, 9.9f, 10.0f, 27.3f, 79.5f, 85.0f, 42.0f, 1.0f };
+	std::vector<float4> expected_reals;
+	std::vector<float4> expected_duals;
+	for (float base_frame : test_frames)
+	{
+		std::vector<float> frames(NUM_MODELS);
+		for (uint32_t i = 0; i < NUM_MODELS; ++ i)
+		{
+			frames[i] = base_frame + i * 0.25f;
+		}
+		SkinnedModel::SetFrames(model_ptrs, frames);
+
+		for (uint32_t i = 0; i < NUM_MODELS; ++ i)
+		{
+			ReferenceBinds(*models[i], frames[i], expected_reals, expected_duals);
+
+			auto const & reals = models[i]->GetBindRealParts();
+			auto const & duals = models[i]->GetBindDualParts();
+			ASSERT_EQ(reals.size(), NUM_JOINTS);
+			for (uint32_t j = 0; j < NUM_JOINTS; ++ j)
+			{
+				for (uint32_t k = 0; k < 4; ++ k)
+				{
+					ASSERT_NEAR(reals[j][k], expected_reals[j][k], 1e-3f) << "Frame " << frames[i] << ", joint " << j;
+					ASSERT_NEAR(duals[j][k], expected_duals[j][k], 1e-3f) << "Frame " << frames[i] << ", joint " << j;
+				}
+			}
+		}
+	}
+}
+
+TEST(SkinnedModelTest, AnimationBenchmark)
+{
+	uint32_t const NUM_MODELS = 500;
+	uint32_t const NUM_JOINTS = 64;
+	uint32_t const NUM_FRAMES = 60;
+
+	auto kfs = CreateKeyFrameSets(NUM_JOINTS, 2);
+	std::vector<SkinnedModelPtr> models;
+	std::vector<SkinnedModel*> model_ptrs;
+	for (uint32_t i = 0; i < NUM_MODELS; ++ i)
+	{
+		models.push_back(CreateSkinnedModel(kfs));
+		model_ptrs.push_back(models.back().get());
+	}
+
+	std::vector<float> frames(NUM_MODELS);
+
+	// One model at a time on this thread
+	Timer timer;
+	for (uint32_t frame = 0; frame < NUM_FRAMES; ++ frame)
+	{
+		for (uint32_t i = 0; i < NUM_MODELS; ++ i)
+		{
+			models[i]->SetFrame(frame * 0.5f + i * 0.01f);
+		}
+	}
+	double const serial_time = timer.elapsed();
+
+	timer.restart();
+	for (uint32_t frame = 0; frame < NUM_FRAMES; ++ frame)
+	{
+		for (uint32_t i = 0; i < NUM_MODELS; ++ i)
+		{
+			frames[i] = (NUM_FRAMES + frame) * 0.5f + i * 0.01f;
+		}
+		SkinnedModel::SetFrames(model_ptrs, frames);
+	}
+	double const batched_time = timer.elapsed();
+
+	for (uint32_t i = 0; i < NUM_MODELS; ++ i)
+	{
+		EXPECT_EQ(models[i]->GetFrame(), frames[i]);
+	}
+
+	std::cout << NUM_MODELS << " models x " << NUM_JOINTS << " joints: SetFrame "
+		<< serial_time * 1000 / NUM_FRAMES << " ms/frame, SetFrames " << batched_time * 1000 / NUM_FRAMES << " ms/frame" << std::endl;
+}
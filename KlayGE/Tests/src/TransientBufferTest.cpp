@@ -0,0 +1,126 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Timer.hpp>
+#include <KlayGE/Context.hpp>
+#include <KlayGE/GraphicsBuffer.hpp>
+#include <KlayGE/RenderFactory.hpp>
+#include <KlayGE/TransientBuffer.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "KlayGETests.hpp"
+
+using namespace KlayGE;
+
+namespace
+{
+	struct Record
+	{
+		SubAlloc alloc;
+		uint32_t thread_id;
+		uint32_t seq;
+	};
+
+	// Every byte of an allocation is derived from who made it, so any overlap or lost write shows up
+	uint8_t Pattern(uint32_t thread_id, uint32_t seq, uint32_t i)
+	{
+		return static_cast<uint8_t>((thread_id * 131 + seq * 7 + i) & 0xFF);
+	}
+}
+
+TEST(TransientBufferTest, RingConcurrentAlloc)
+{
+	uint32_t const NUM_THREADS = std::max(4U, std::thread::hardware_concurrency());
+	uint32_t const ALLOCS_PER_THREAD = 2000;
+	uint32_t const NUM_FRAMES = 8;
+	uint32_t const INIT_SIZE = 4096;
+
+	// Small enough to make it grow while the threads are allocating
+	TransientBuffer tb(INIT_SIZE, TransientBuffer::BF_Vertex, TransientBuffer::AM_Ring);
+	EXPECT_EQ(tb.Mode(), TransientBuffer::AM_Ring);
+
+	RenderFactory& rf = Context::Instance().RenderFactoryInstance();
+
+	double alloc_time = 0;
+	for (uint32_t frame = 0; frame < NUM_FRAMES; ++ frame)
+	{
+		std::vector<std::vector<Record>> records(NUM_THREADS);
+
+		Timer timer;
+		std::vector<std::thread> producers;
+		for (uint32_t t = 0; t < NUM_THREADS; ++ t)
+		{
+			producers.emplace_back([&tb, &records, t, frame, ALLOCS_PER_THREAD]
+				{
+					std::mt19937 gen(t * 1000 + frame);
+					std::uniform_int_distribution<uint32_t> dis(1, 96);
+
+					std::vector<uint8_t> data;
+					for (uint32_t seq = 0; seq < ALLOCS_PER_THREAD; ++ seq)
+					{
+						data.resize(dis(gen));
+						for (uint32_t i = 0; i < data.size(); ++ i)
+						{
+							data[i] = Pattern(t, seq, i);
+						}
+
+						records[t].push_back({ tb.Alloc(static_cast<uint32_t>(data.size()), data.data()), t, seq });
+					}
+				});
+		}
+		for (auto& producer : producers)
+		{
+			producer.join();
+		}
+		alloc_time += timer.elapsed();
+
+		tb.EnsureDataReady();
+
+		// No two allocations of a frame may overlap
+		std::vector<Record> all_records;
+		for (auto const & thread_records : records)
+		{
+			all_records.insert(all_records.end(), thread_records.begin(), thread_records.end());
+		}
+		std::sort(all_records.begin(), all_records.end(),
+			[](Record const & lhs, Record const & rhs)
+			{
+				return lhs.alloc.offset_ < rhs.alloc.offset_;
+			});
+		for (size_t i = 1; i < all_records.size(); ++ i)
+		{
+			EXPECT_LE(all_records[i - 1].alloc.offset_ + all_records[i - 1].alloc.length_, all_records[i].alloc.offset_);
+		}
+
+		// And the GPU buffer has to hold exactly what each thread wrote
+		GraphicsBufferPtr const & buffer = tb.GetBuffer();
+		ASSERT_LE(all_records.back().alloc.offset_ + all_records.back().alloc.length_, buffer->Size());
+
+		GraphicsBufferPtr buffer_cpu = rf.MakeVertexBuffer(BU_Static, EAH_CPU_Read, buffer->Size(), nullptr);
+		buffer->CopyToBuffer(*buffer_cpu);
+		{
+			GraphicsBuffer::Mapper mapper(*buffer_cpu, BA_Read_Only);
+			uint8_t const * p = mapper.Pointer<uint8_t>();
+			for (auto const & record : all_records)
+			{
+				for (uint32_t i = 0; i < record.alloc.length_; ++ i)
+				{
+					if (p[record.alloc.offset_ + i] != Pattern(record.thread_id, record.seq, i))
+					{
+						ADD_FAILURE() << "Frame " << frame << ", thread " << record.thread_id << ", alloc " << record.seq
+							<< " is corrupted at byte " << i;
+						break;
+					}
+				}
+			}
+		}
+
+		tb.OnPresent();
+	}
+
+	std::cout << NUM_THREADS << " threads x " << ALLOCS_PER_THREAD << " allocs: "
+		<< alloc_time * 1000 / NUM_FRAMES << " ms/frame, ring grew to " << tb.GetBuffer()->Size() << " bytes" << std::endl;
+}
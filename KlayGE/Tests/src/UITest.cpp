@@ -0,0 +1,140 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/ResIdentifier.hpp>
+#include <KFL/Timer.hpp>
+#include <KlayGE/Context.hpp>
+#include <KlayGE/Renderable.hpp>
+#include <KlayGE/SceneManager.hpp>
+#include <KlayGE/SceneNode.hpp>
+#include <KlayGE/UI.hpp>
+
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+
+#include "KlayGETests.hpp"
+
+using namespace KlayGE;
+
+namespace
+{
+	// Renders what the UI added to the overlay, the same way SceneManager does for a frame. Returns the number of UI batches.
+	uint32_t RenderOverlay()
+	{
+		uint32_t num_ui_batches = 0;
+
+		auto& overlay_root = Context::Instance().SceneManagerInstance().OverlayRootNode();
+		std::set<Renderable*> renderables;
+		for (auto const & child : overlay_root.Children())
+		{
+			// The text nodes of a font share one renderable
+			Renderable* renderable = child->GetRenderable().get();
+			if (renderables.insert(renderable).second)
+			{
+				renderable->Render();
+				if (renderable->Name() == L"UIRect")
+				{
+					++ num_ui_batches;
+				}
+			}
+		}
+		overlay_root.ClearChildren();
+
+		return num_ui_batches;
+	}
+}
+
+TEST(UITest, RetainedGeometryBenchmark)
+{
+	uint32_t const NUM_DIALOGS = 10;
+	uint32_t const CONTROLS_PER_DIALOG = 100;
+	uint32_t const NUM_FRAMES = 100;
+
+	std::ostringstream ss;
+	ss << "<?xml version='1.0' encoding='utf-8' standalone='no'?>" << std::endl
+		<< "<ui>" << std::endl;
+	for (uint32_t i = 0; i < NUM_DIALOGS; ++ i)
+	{
+		ss << "\t<dialog id=\"Dialog" << i << "\" caption=\"Dialog " << i << "\" x=\"" << i * 20 << "\" y=\"" << i * 20
+			<< "\" width=\"800\" height=\"600\">" << std::endl;
+		for (uint32_t j = 0; j < CONTROLS_PER_DIALOG; ++ j)
+		{
+			int const x = (j % 10) * 80;
+			int const y = (j / 10) * 60;
+			switch (j % 3)
+			{
+			case 0:
+				ss << "\t\t<control type=\"button\" id=\"Ctrl" << j << "\" caption=\"Button\" x=\"" << x << "\" y=\"" << y
+					<< "\" width=\"70\" height=\"24\"/>" << std::endl;
+				break;
+
+			case 1:
+				ss << "\t\t<control type=\"check_box\" id=\"Ctrl" << j << "\" caption=\"Check\" x=\"" << x << "\" y=\"" << y
+					<< "\" width=\"70\" height=\"24\" checked=\"1\"/>" << std::endl;
+				break;
+
+			default:
+				ss << "\t\t<control type=\"static\" id=\"Ctrl" << j << "\" caption=\"Static\" x=\"" << x << "\" y=\"" << y
+					<< "\" width=\"70\" height=\"24\"/>" << std::endl;
+				break;
+			}
+		}
+		ss << "\t</dialog>" << std::endl;
+	}
+	ss << "</ui>" << std::endl;
+
+	auto& ui_mgr = UIManager::Instance();
+	ui_mgr.Load(MakeSharedPtr<ResIdentifier>("UITest.uiml", 0, MakeSharedPtr<std::istringstream>(ss.str())));
+	ASSERT_EQ(ui_mgr.GetDialogs().size(), NUM_DIALOGS);
+
+	// The first frame emits everything
+	Timer timer;
+	ui_mgr.Render();
+	uint32_t const num_batches = RenderOverlay();
+	double const first_time = timer.elapsed();
+
+	// All the controls use the default skin, which is packed into the atlas together with the untextured quads
+	EXPECT_EQ(num_batches, NUM_DIALOGS);
+
+	// Nothing changes, the cached geometry is submitted again
+	timer.restart();
+	for (uint32_t frame = 0; frame < NUM_FRAMES; ++ frame)
+	{
+		ui_mgr.Render();
+		EXPECT_EQ(RenderOverlay(), num_batches);
+	}
+	double const static_time = timer.elapsed();
+
+	// One control changes every frame, only its dialog is emitted again
+	auto const & dialog = ui_mgr.GetDialogs()[0];
+	auto const static_ctrl = dialog->Control<UIStatic>(dialog->IDFromName("Ctrl2"));
+	ASSERT_TRUE(static_ctrl);
+	timer.restart();
+	for (uint32_t frame = 0; frame < NUM_FRAMES; ++ frame)
+	{
+		static_ctrl->SetText(frame & 1 ? L"Odd" : L"Even");
+		ui_mgr.Render();
+		EXPECT_EQ(RenderOverlay(), num_batches);
+	}
+	double const one_dirty_time = timer.elapsed();
+
+	// Every dialog is emitted again, like before the geometry was retained
+	timer.restart();
+	for (uint32_t frame = 0; frame < NUM_FRAMES; ++ frame)
+	{
+		for (auto const & dlg : ui_mgr.GetDialogs())
+		{
+			dlg->Invalidate();
+		}
+		ui_mgr.Render();
+		EXPECT_EQ(RenderOverlay(), num_batches);
+	}
+	double const all_dirty_time = timer.elapsed();
+
+	std::cout << NUM_DIALOGS * CONTROLS_PER_DIALOG << " controls: first frame " << first_time * 1000 << " ms, "
+		<< "unchanged " << static_time * 1000 / NUM_FRAMES << " ms/frame, "
+		<< "1 dirty dialog " << one_dirty_time * 1000 / NUM_FRAMES << " ms/frame, "
+		<< "all dirty " << all_dirty_time * 1000 / NUM_FRAMES << " ms/frame" << std::endl;
+
+	UIManager::Destroy();
+}
@@ -151,7 +151,7 @@ int main(int argc, char* argv[])
 	filesystem::path const output_path(output_name);
 	if (output_path.extension() == ".model_bin")
 	{
-		uint32_t const MODEL_BIN_VERSION = 16;
+		uint32_t const MODEL_BIN_VERSION = 17;
 
 		ResIdentifierPtr output_file = ResLoader::Instance().Open(output_name);
 		if (output_file)
@@ -177,6 +177,9 @@ int main(int argc, char* argv[])
 					conversion = true;
 				}
 			}
+
+			// It's mapped, and the converter rewrites the same path
+			output_file.reset();
 		}
 		else
 		{
@@ -29,6 +29,7 @@
  */
 
 #include <KlayGE/KlayGE.hpp>
+#include <KFL/ErrorHandling.hpp>
 #include <KFL/Hash.hpp>
 #include <KFL/Util.hpp>
 #include <KlayGE/JudaTexture.hpp>
@@ -37,10 +38,19 @@
 #include <KFL/XMLDom.hpp>
 #include <KFL/CXX17/filesystem.hpp>
 
+#include <KFL/Timer.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
 #include <iostream>
 #include <fstream>
+#include <mutex>
 #include <vector>
 #include <regex>
+#include <thread>
 
 #include <boost/algorithm/string/case_conv.hpp>
 
@@ -130,11 +140,405 @@ MeshMetadata LoadMeshMetadata(std::string const & res_name, MeshMetadata const &
 	}
 }
 
-void Deploy(std::vector<std::string> const & res_names, std::string_view res_type,
-	RenderDeviceCaps const & caps, std::string_view platform)
+namespace
+{
+	// Part of every cache key. Bump it whenever a converter changes its output, so the stale entries are not reused.
+	uint32_t const COOK_VERSION = 1;
+
+	enum CookResult
+	{
+		CR_Cooked,
+		CR_Cached,
+		CR_UpToDate,
+		CR_Failed
+	};
+
+	char const * CookResultName(CookResult result)
+	{
+		switch (result)
+		{
+		case CR_Cooked:
+			return "cooked";
+
+		case CR_Cached:
+			return "cached";
+
+		case CR_UpToDate:
+			return "up_to_date";
+
+		case CR_Failed:
+			return "failed";
+
+		default:
+			KFL_UNREACHABLE("Invalid cook result");
+		}
+	}
+
+	struct CookItem
+	{
+		std::string res_name;
+		uint64_t key = 0;
+		CookResult result = CR_Failed;
+		double seconds = 0;
+		std::string message;
+	};
+
+	struct CookOptions
+	{
+		std::string cache_dir;
+		std::string report_name;
+		uint32_t num_jobs;
+	};
+
+	// 64-bit FNV-1a. Cache entries are addressed by this, so it needs more bits than HashRange's size_t on 32-bit hosts.
+	uint64_t HashBytes(uint64_t seed, void const * data, size_t size)
+	{
+		uint8_t const * p = static_cast<uint8_t const *>(data);
+		for (size_t i = 0; i < size; ++ i)
+		{
+			seed = (seed ^ p[i]) * 0x100000001B3ULL;
+		}
+		return seed;
+	}
+
+	uint64_t HashString(uint64_t seed, std::string_view str)
+	{
+		// The length goes in first, so "ab" + "c" and "a" + "bc" hash differently
+		uint64_t const len = str.size();
+		seed = HashBytes(seed, &len, sizeof(len));
+		return HashBytes(seed, str.data(), str.size());
+	}
+
+	bool ReadFileContent(std::string const & name, std::vector<char>& content)
+	{
+		std::ifstream ifs(name, std::ios_base::binary);
+		if (!ifs)
+		{
+			return false;
+		}
+
+		ifs.seekg(0, std::ios_base::end);
+		content.resize(static_cast<size_t>(ifs.tellg()));
+		ifs.seekg(0, std::ios_base::beg);
+		ifs.read(content.data(), content.size());
+		return static_cast<bool>(ifs);
+	}
+
+	bool HashFile(uint64_t& seed, std::string_view name)
+	{
+		std::string const path = ResLoader::Instance().Locate(name);
+		std::vector<char> content;
+		if (path.empty() || !ReadFileContent(path, content))
+		{
+			return false;
+		}
+
+		seed = HashBytes(seed, content.data(), content.size());
+		return true;
+	}
+
+	// Effects pull in other effects with <include name="..."/>, those have to be part of the key as well
+	bool HashEffectFile(uint64_t& seed, std::string const & name, std::vector<std::string>& visited)
+	{
+		if (std::find(visited.begin(), visited.end(), name) != visited.end())
+		{
+			return true;
+		}
+		visited.push_back(name);
+
+		std::string const path = ResLoader::Instance().Locate(name);
+		std::vector<char> content;
+		if (path.empty() || !ReadFileContent(path, content))
+		{
+			return false;
+		}
+		seed = HashBytes(seed, content.data(), content.size());
+
+		std::regex const include_pattern("<include\\s+name\\s*=\\s*\"([^\"]+)\"");
+		for (std::cregex_iterator iter(content.data(), content.data() + content.size(), include_pattern), end; iter != end; ++ iter)
+		{
+			if (!HashEffectFile(seed, (*iter)[1].str(), visited))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// The metadata is hashed in its saved form, so defaults and device dependent adjustments are covered too
+	template <typename Metadata>
+	uint64_t HashMetadata(uint64_t seed, Metadata const & metadata, std::string const & tmp_name)
+	{
+		metadata.Save(tmp_name);
+
+		std::vector<char> content;
+		ReadFileContent(tmp_name, content);
+		std::error_code ec;
+		filesystem::remove(tmp_name, ec);
+
+		return HashBytes(seed, content.data(), content.size());
+	}
+
+	std::string KeyString(uint64_t key)
+	{
+		char buf[17];
+		std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(key));
+		return buf;
+	}
+
+	std::string JsonEscape(std::string_view str)
+	{
+		std::string ret;
+		ret.reserve(str.size());
+		for (char ch : str)
+		{
+			switch (ch)
+			{
+			case '"':
+				ret += "\\\"";
+				break;
+
+			case '\\':
+				ret += "\\\\";
+				break;
+
+			case '\n':
+				ret += "\\n";
+				break;
+
+			default:
+				if (static_cast<uint8_t>(ch) < 0x20)
+				{
+					char buf[7];
+					std::snprintf(buf, sizeof(buf), "\\u%04x", ch);
+					ret += buf;
+				}
+				else
+				{
+					ret += ch;
+				}
+				break;
+			}
+		}
+		return ret;
+	}
+
+	// Puts a freshly cooked file into the cache. It's written under a temporary name and then renamed, so a concurrent
+	// deployer never sees a half written entry.
+	void StoreInCache(std::string const & output_name, std::string const & cache_name, std::string const & tmp_name)
+	{
+		std::error_code ec;
+		filesystem::copy_file(output_name, tmp_name, filesystem::copy_options::overwrite_existing, ec);
+		if (!ec)
+		{
+			filesystem::rename(tmp_name, cache_name, ec);
+		}
+		if (ec)
+		{
+			filesystem::remove(tmp_name, ec);
+		}
+	}
+
+	// The external tools are run from the current folder or the PATH. When the binary is in the current folder, its content
+	// goes into the key, so a rebuilt tool doesn't reuse what the old one cooked.
+	uint64_t HashTool(uint64_t seed, std::string const & tool_name)
+	{
+		seed = HashString(seed, tool_name);
+		for (auto const & name : { tool_name, tool_name + ".exe" })
+		{
+			std::error_code ec;
+			std::vector<char> content;
+			if (filesystem::is_regular_file(name, ec) && ReadFileContent(name, content))
+			{
+				return HashBytes(seed, content.data(), content.size());
+			}
+		}
+		return seed;
+	}
+
+	// The key an output was last written for is recorded in the cache, in a file named after the output's path. Sizes and
+	// times can't tell it, if the inputs go back and forth between two keys.
+	std::string OutputRecordName(filesystem::path const & cache_dir, std::string const & output_name)
+	{
+		std::error_code ec;
+		std::string const full_name = filesystem::absolute(output_name, ec).string();
+		return (cache_dir / (KeyString(HashString(0, full_name)) + ".output")).string();
+	}
+
+	bool OutputMatchesKey(filesystem::path const & cache_dir, std::string const & output_name, uint64_t key)
+	{
+		std::error_code ec;
+		if (!filesystem::exists(output_name, ec))
+		{
+			return false;
+		}
+
+		std::ifstream ifs(OutputRecordName(cache_dir, output_name));
+		std::string recorded_key;
+		return (ifs >> recorded_key) && (recorded_key == KeyString(key));
+	}
+
+	void RecordOutputKey(filesystem::path const & cache_dir, std::string const & output_name, uint64_t key)
+	{
+		std::ofstream ofs(OutputRecordName(cache_dir, output_name));
+		ofs << KeyString(key) << std::endl;
+	}
+
+	// Called before an output is rewritten, so an interrupted cook doesn't leave the old key behind
+	void ForgetOutputKey(filesystem::path const & cache_dir, std::string const & output_name)
+	{
+		std::error_code ec;
+		filesystem::remove(OutputRecordName(cache_dir, output_name), ec);
+	}
+
+	// Copies a cache entry to the output, unless the output is already the result of that entry
+	CookResult FetchFromCache(filesystem::path const & cache_dir, std::string const & cache_name,
+		std::string const & output_name, uint64_t key)
+	{
+		std::error_code ec;
+		if (OutputMatchesKey(cache_dir, output_name, key)
+			&& (filesystem::file_size(output_name, ec) == filesystem::file_size(cache_name, ec)))
+		{
+			return CR_UpToDate;
+		}
+
+		ForgetOutputKey(cache_dir, output_name);
+		filesystem::copy_file(cache_name, output_name, filesystem::copy_options::overwrite_existing, ec);
+		if (ec)
+		{
+			return CR_Failed;
+		}
+		RecordOutputKey(cache_dir, output_name, key);
+		return CR_Cached;
+	}
+
+	// Cooks all items on num_jobs threads. Items are handed out one at a time, so a few huge assets don't leave the
+	// other threads idle.
+	void RunCookJobs(std::vector<CookItem>& items, uint32_t num_jobs, std::function<void(CookItem&)> const & cook)
+	{
+		std::mutex output_mutex;
+		std::atomic<size_t> next_item(0);
+		auto const worker = [&items, &next_item, &output_mutex, &cook]
+			{
+				for (;;)
+				{
+					size_t const index = next_item.fetch_add(1);
+					if (index >= items.size())
+					{
+						break;
+					}
+
+					auto& item = items[index];
+					Timer timer;
+					try
+					{
+						cook(item);
+					}
+					catch (std::exception const & e)
+					{
+						item.result = CR_Failed;
+						item.message = e.what();
+					}
+					item.seconds = timer.elapsed();
+
+					std::lock_guard<std::mutex> lock(output_mutex);
+					std::cout << '[' << (index + 1) << '/' << items.size() << "] " << item.res_name << ": "
+						<< CookResultName(item.result);
+					if (!item.message.empty())
+					{
+						std::cout << " (" << item.message << ')';
+					}
+					std::cout << std::endl;
+				}
+			};
+
+		size_t const num_threads = std::min<size_t>(std::max(num_jobs, 1U), items.size());
+		std::vector<joiner<void>> joiners;
+		for (size_t i = 1; i < num_threads; ++ i)
+		{
+			joiners.push_back(Context::Instance().ThreadPool()(worker));
+		}
+		worker();
+		for (auto& job_joiner : joiners)
+		{
+			job_joiner();
+		}
+	}
+
+	void WriteCookReport(std::string const & report_name, std::vector<CookItem> const & items, std::string_view res_type,
+		std::string_view platform, uint32_t num_jobs, double seconds)
+	{
+		uint32_t counts[CR_Failed + 1] = { 0 };
+		for (auto const & item : items)
+		{
+			++ counts[item.result];
+		}
+
+		std::ofstream ofs(report_name);
+		ofs << "{" << std::endl;
+		ofs << "\t\"version\": " << COOK_VERSION << "," << std::endl;
+		ofs << "\t\"type\": \"" << JsonEscape(res_type) << "\"," << std::endl;
+		ofs << "\t\"platform\": \"" << JsonEscape(platform) << "\"," << std::endl;
+		ofs << "\t\"jobs\": " << num_jobs << "," << std::endl;
+		ofs << "\t\"seconds\": " << seconds << "," << std::endl;
+		for (int i = CR_Cooked; i <= CR_Failed; ++ i)
+		{
+			ofs << "\t\"" << CookResultName(static_cast<CookResult>(i)) << "\": " << counts[i] << "," << std::endl;
+		}
+		ofs << "\t\"items\": [" << std::endl;
+		for (size_t i = 0; i < items.size(); ++ i)
+		{
+			auto const & item = items[i];
+			ofs << "\t\t{ \"name\": \"" << JsonEscape(item.res_name) << "\", \"key\": \"" << KeyString(item.key)
+				<< "\", \"result\": \"" << CookResultName(item.result) << "\", \"seconds\": " << item.seconds;
+			if (!item.message.empty())
+			{
+				ofs << ", \"message\": \"" << JsonEscape(item.message) << '"';
+			}
+			ofs << " }" << ((i + 1 < items.size()) ? "," : "") << std::endl;
+		}
+		ofs << "\t]" << std::endl;
+		ofs << "}" << std::endl;
+	}
+}
+
+bool Deploy(std::vector<std::string> const & res_names, std::string_view res_type,
+	RenderDeviceCaps const & caps, std::string_view platform, CookOptions const & options)
 {
 	size_t const res_type_hash = HashRange(res_type.begin(), res_type.end());
 
+	Timer timer;
+
+	std::error_code ec;
+	filesystem::create_directories(options.cache_dir, ec);
+	filesystem::path const cache_dir(options.cache_dir);
+
+	// Converters add the folder of their input to ResLoader and remove it afterwards. With several converters running,
+	// one could remove a folder another one is still using, so all folders are added up front.
+	std::vector<std::string> added_folders;
+	for (auto const & res_name : res_names)
+	{
+		auto const folder = filesystem::path(ResLoader::Instance().Locate(res_name)).parent_path().string();
+		if (!ResLoader::Instance().IsInPath(folder))
+		{
+			ResLoader::Instance().AddPath(folder);
+			added_folders.push_back(folder);
+		}
+	}
+
+	uint64_t key_seed = 0xCBF29CE484222325ULL;
+	key_seed = HashBytes(key_seed, &COOK_VERSION, sizeof(COOK_VERSION));
+	key_seed = HashString(key_seed, res_type);
+	key_seed = HashString(key_seed, platform);
+
+	std::vector<CookItem> items(res_names.size());
+	for (size_t i = 0; i < res_names.size(); ++ i)
+	{
+		items[i].res_name = res_names[i];
+	}
+
+	bool valid_type = true;
 	if ((CT_HASH("albedo") == res_type_hash)
 		|| (CT_HASH("emissive") == res_type_hash)
 		|| (CT_HASH("glossiness") == res_type_hash)
@@ -145,42 +549,103 @@ void Deploy(std::vector<std::string> const & res_names, std::string_view res_typ
 	{
 		TexMetadata const default_metadata = DefaultTextureMetadata(res_type_hash, caps);
 
-		TexConverter tc;
-		for (size_t i = 0; i < res_names.size(); ++ i)
-		{
-			std::cout << "Converting " << res_names[i] << " to " << res_type << std::endl;
-
-			auto metadata = LoadTextureMetadata(res_names[i], default_metadata);
-			auto output_tex = tc.Load(res_names[i], metadata);
-			if (output_tex)
+		RunCookJobs(items, options.num_jobs, [&default_metadata, &cache_dir, key_seed](CookItem& item)
 			{
-				filesystem::path res_path(res_names[i]);
-				SaveTexture(output_tex, res_path.string() + ".dds");
-			}
-		}
+				auto metadata = LoadTextureMetadata(item.res_name, default_metadata);
+
+				item.key = key_seed;
+				if (!HashFile(item.key, item.res_name))
+				{
+					item.message = "Could NOT read the source";
+					return;
+				}
+				// Identical sources in different folders share the key, temporary files need a name of their own
+				std::string const tmp_name = (cache_dir / KeyString(HashString(item.key, item.res_name))).string();
+				item.key = HashMetadata(item.key, metadata, tmp_name + ".kmeta");
+
+				std::string const output_name = filesystem::path(item.res_name).string() + ".dds";
+				std::string const cache_name = (cache_dir / (KeyString(item.key) + ".dds")).string();
+				if (filesystem::exists(cache_name))
+				{
+					item.result = FetchFromCache(cache_dir, cache_name, output_name, item.key);
+					return;
+				}
+
+				TexConverter tc;
+				auto output_tex = tc.Load(item.res_name, metadata);
+				if (output_tex)
+				{
+					ForgetOutputKey(cache_dir, output_name);
+					SaveTexture(output_tex, output_name);
+					StoreInCache(output_name, cache_name, tmp_name + ".tmp");
+					RecordOutputKey(cache_dir, output_name, item.key);
+					item.result = CR_Cooked;
+				}
+				else
+				{
+					item.message = "Conversion failed";
+				}
+			});
 	}
 	else if (CT_HASH("model") == res_type_hash)
 	{
 		MeshMetadata const default_metadata;
 
-		MeshConverter mc;
-		for (size_t i = 0; i < res_names.size(); ++ i)
-		{
-			std::cout << "Converting " << res_names[i] << " to " << res_type << std::endl;
-
-			auto metadata = LoadMeshMetadata(res_names[i], default_metadata);
-			auto output_model = mc.Load(res_names[i], metadata);
-			if (output_model)
+		RunCookJobs(items, options.num_jobs, [&default_metadata, &cache_dir, key_seed](CookItem& item)
 			{
-				filesystem::path res_path(res_names[i]);
-				SaveModel(*output_model, res_path.string() + ".model_bin");
-			}
-		}
+				auto metadata = LoadMeshMetadata(item.res_name, default_metadata);
+
+				item.key = key_seed;
+				bool found = HashFile(item.key, item.res_name);
+				for (uint32_t lod = 1; found && (lod < metadata.NumLods()); ++ lod)
+				{
+					found = HashFile(item.key, metadata.LodFileName(lod));
+				}
+				for (uint32_t mtl = 0; found && (mtl < metadata.NumMaterials()); ++ mtl)
+				{
+					if (!metadata.MaterialFileName(mtl).empty())
+					{
+						found = HashFile(item.key, metadata.MaterialFileName(mtl));
+					}
+				}
+				if (!found)
+				{
+					item.message = "Could NOT read the source";
+					return;
+				}
+				std::string const tmp_name = (cache_dir / KeyString(HashString(item.key, item.res_name))).string();
+				item.key = HashMetadata(item.key, metadata, tmp_name + ".kmeta");
+
+				std::string const output_name = filesystem::path(item.res_name).string() + ".model_bin";
+				std::string const cache_name = (cache_dir / (KeyString(item.key) + ".model_bin")).string();
+				if (filesystem::exists(cache_name))
+				{
+					item.result = FetchFromCache(cache_dir, cache_name, output_name, item.key);
+					return;
+				}
+
+				MeshConverter mc;
+				auto output_model = mc.Load(item.res_name, metadata);
+				if (output_model)
+				{
+					ForgetOutputKey(cache_dir, output_name);
+					SaveModel(*output_model, output_name);
+					StoreInCache(output_name, cache_name, tmp_name + ".tmp");
+					RecordOutputKey(cache_dir, output_name, item.key);
+					item.result = CR_Cooked;
+				}
+				else
+				{
+					item.message = "Conversion failed";
+				}
+			});
 	}
-	else
+	else if ((CT_HASH("cubemap") == res_type_hash) || (CT_HASH("effect") == res_type_hash))
 	{
-		std::ofstream ofs("convert.bat");
-
+		// These are cooked by other tools, which write their outputs themselves. An empty stamp file in the cache records that
+		// the command succeeded for this key, and the command is skipped while the stamp is there and the outputs were last
+		// written for this key.
+		std::string command_args;
 		if (CT_HASH("cubemap") == res_type_hash)
 		{
 			std::string y_fmt;
@@ -201,47 +666,115 @@ void Deploy(std::vector<std::string> const & res_names, std::string_view res_typ
 			{
 				c_fmt = "BC3";
 			}
+			command_args = y_fmt + ' ' + c_fmt;
+		}
 
-			for (size_t i = 0; i < res_names.size(); ++ i)
+		bool const is_effect = (CT_HASH("effect") == res_type_hash);
+		uint64_t const tool_key_seed = HashTool(key_seed, is_effect ? "FXMLJIT" : "HDRCompressor");
+		RunCookJobs(items, options.num_jobs, [&cache_dir, &command_args, tool_key_seed, is_effect, platform](CookItem& item)
 			{
-				std::cout << "Converting " << res_names[i] << " to " << res_type << std::endl;
+				std::string command;
+				if (is_effect)
+				{
+					command = "FXMLJIT " + std::string(platform) + " \"" + item.res_name + "\"";
+				}
+				else
+				{
+					command = "HDRCompressor \"" + item.res_name + "\" " + command_args;
+				}
 
-				ofs << "@echo Processing: " << res_names[i] << std::endl;
+				item.key = HashString(tool_key_seed, command);
+				std::vector<std::string> visited;
+				if (!(is_effect ? HashEffectFile(item.key, item.res_name, visited) : HashFile(item.key, item.res_name)))
+				{
+					item.message = "Could NOT read the source";
+					return;
+				}
 
-				ofs << "@echo off" << std::endl << std::endl;
-				ofs << "HDRCompressor \"" << res_names[i] << "\" " << y_fmt << ' ' << c_fmt << std::endl;
-				ofs << "@echo on" << std::endl << std::endl;
-			}
-		}
-		else if (CT_HASH("effect") == res_type_hash)
-		{
-			for (size_t i = 0; i < res_names.size(); ++ i)
-			{
-				std::cout << "Converting " << res_names[i] << " to " << res_type << std::endl;
+				// FXMLJIT writes the .kfx next to the .fxml, HDRCompressor writes _y and _c textures to the current folder
+				filesystem::path const res_path(item.res_name);
+				std::vector<std::string> output_names;
+				if (is_effect)
+				{
+					output_names.push_back((res_path.parent_path() / (res_path.stem().string() + ".kfx")).string());
+				}
+				else
+				{
+					output_names.push_back(res_path.stem().string() + "_y" + res_path.extension().string());
+					output_names.push_back(res_path.stem().string() + "_c" + res_path.extension().string());
+				}
 
-				ofs << "@echo Processing: " << res_names[i] << std::endl;
+				std::string const stamp_name = (cache_dir / (KeyString(item.key) + ".stamp")).string();
+				if (filesystem::exists(stamp_name)
+					&& std::all_of(output_names.begin(), output_names.end(),
+						[&cache_dir, &item](std::string const & name)
+						{
+							return OutputMatchesKey(cache_dir, name, item.key);
+						}))
+				{
+					item.result = CR_UpToDate;
+					return;
+				}
 
-				ofs << "@echo off" << std::endl << std::endl;
-				ofs << "FXMLJIT " << platform << " \"" << res_names[i] << "\"" << std::endl;
-				ofs << "@echo on" << std::endl << std::endl;
-			}
-		}
-		else
-		{
-			std::cout << "Error: Unknown resource type." << std::endl;
-		}
+				for (auto const & name : output_names)
+				{
+					ForgetOutputKey(cache_dir, name);
+				}
+				int const err = std::system(command.c_str());
+				if (0 == err)
+				{
+					std::ofstream stamp(stamp_name);
+					for (auto const & name : output_names)
+					{
+						RecordOutputKey(cache_dir, name, item.key);
+					}
+					item.result = CR_Cooked;
+				}
+				else
+				{
+					item.message = command + " returned " + std::to_string(err);
+				}
+			});
+	}
+	else
+	{
+		std::cout << "Error: Unknown resource type." << std::endl;
+		valid_type = false;
+	}
+
+	for (auto const & folder : added_folders)
+	{
+		ResLoader::Instance().DelPath(folder);
+	}
 
-		ofs.close();
+	if (!valid_type)
+	{
+		return false;
+	}
 
-		if ((res_type_hash != CT_HASH("cubemap")) && (res_type_hash != CT_HASH("model")) && (res_type_hash != CT_HASH("effect")))
+	double const seconds = timer.elapsed();
+	if (!options.report_name.empty())
+	{
+		WriteCookReport(options.report_name, items, res_type, platform, options.num_jobs, seconds);
+	}
+
+	uint32_t num_failed = 0;
+	uint32_t num_skipped = 0;
+	for (auto const & item : items)
+	{
+		if (CR_Failed == item.result)
 		{
-			int err = system("convert.bat");
-			KFL_UNUSED(err);
+			++ num_failed;
+		}
+		else if (CR_Cooked != item.result)
+		{
+			++ num_skipped;
 		}
-
-		int err = system("del convert.bat");
-		KFL_UNUSED(err);
 	}
+	std::cout << "Cooked " << (items.size() - num_failed - num_skipped) << ", reused " << num_skipped << ", failed "
+		<< num_failed << " in " << seconds << " s." << std::endl;
+
+	return 0 == num_failed;
 }
 
 int main(int argc, char* argv[])
@@ -249,6 +782,7 @@ int main(int argc, char* argv[])
 	std::vector<std::string> res_names;
 	std::string res_type;
 	std::string platform;
+	CookOptions cook_options;
 
 	cxxopts::Options options("ImageConv", "KlayGE PlatformDeployer");
 	options.add_options()
@@ -256,6 +790,9 @@ int main(int argc, char* argv[])
 		("I,input-name", "Input resource name.", cxxopts::value<std::string>())
 		("T,type", "Resource type.", cxxopts::value<std::string>())
 		("P,platform", "Platform name.", cxxopts::value<std::string>())
+		("C,cache-dir", "Folder of the cook cache. Default is DeployCache.", cxxopts::value<std::string>())
+		("R,report", "Name of the cook report. Default is cook_report.json.", cxxopts::value<std::string>())
+		("j,jobs", "Number of parallel jobs. Default is the number of cores.", cxxopts::value<uint32_t>())
 		("v,version", "Version.");
 
 	int const argc_backup = argc;
@@ -269,7 +806,7 @@ int main(int argc, char* argv[])
 	}
 	if (vm.count("version") > 0)
 	{
-		cout << "KlayGE PlatformDeployer, Version 2.0.0" << endl;
+		cout << "KlayGE PlatformDeployer, Version 2.1.0" << endl;
 		Context::Destroy();
 		return 1;
 	}
@@ -348,6 +885,10 @@ int main(int argc, char* argv[])
 		platform = "d3d_11_0";
 	}
 
+	cook_options.cache_dir = (vm.count("cache-dir") > 0) ? vm["cache-dir"].as<std::string>() : "DeployCache";
+	cook_options.report_name = (vm.count("report") > 0) ? vm["report"].as<std::string>() : "cook_report.json";
+	cook_options.num_jobs = (vm.count("jobs") > 0) ? vm["jobs"].as<uint32_t>() : std::thread::hardware_concurrency();
+
 	boost::algorithm::to_lower(res_type);
 	boost::algorithm::to_lower(platform);
 
@@ -394,9 +935,9 @@ int main(int argc, char* argv[])
 	}
 
 	PlatformDefinition platform_def(platform + ".plat");
-	Deploy(res_names, res_type, platform_def.device_caps, platform);
+	bool const succeeded = Deploy(res_names, res_type, platform_def.device_caps, platform, cook_options);
 
 	Context::Destroy();
 
-	return 0;
+	return succeeded ? 0 : 1;
 }
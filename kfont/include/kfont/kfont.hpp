@@ -115,6 +115,9 @@ namespace KlayGE
 		void SetLZMADistanceData(wchar_t ch, uint8_t const * p, uint32_t size, uint32_t adv, font_info const & fi);
 		void Compact();
 
+	private:
+		int64_t LZMADistanceDataOffset(int32_t index) const;
+
 	private:
 		uint32_t char_size_;
 		int16_t dist_base_;
@@ -190,16 +190,52 @@ namespace KlayGE
 				distances_lzma_start_ = kfont_input->tellg();
 				size_t distances_lzma_size = 0;
 
-				for (uint32_t i = 0; i < header.non_empty_chars; ++ i)
+				ArrayRef<uint8_t> const mapped_data = kfont_input->MappedData();
+				if (!mapped_data.empty())
 				{
-					distances_addr_[i] = distances_lzma_size;
+					if ((distances_lzma_start_ < 0) || (static_cast<uint64_t>(distances_lzma_start_) > mapped_data.size()))
+					{
+						return false;
+					}
 
-					uint64_t len;
-					kfont_input->read(&len, sizeof(len));
-					len = LE2Native(len);
-					distances_lzma_size += static_cast<size_t>(len);
+					// Walk the length prefixes in place instead of seeking the stream for every char. A truncated file fails
+					// the load instead of reading past the mapping.
+					uint8_t const * p = mapped_data.data() + distances_lzma_start_;
+					uint8_t const * const end = mapped_data.end();
+					for (uint32_t i = 0; i < header.non_empty_chars; ++ i)
+					{
+						distances_addr_[i] = distances_lzma_size;
+
+						uint64_t len;
+						if (static_cast<size_t>(end - p) < sizeof(len))
+						{
+							return false;
+						}
+						std::memcpy(&len, p, sizeof(len));
+						len = LE2Native(len);
+						p += sizeof(len);
+						if (len > static_cast<uint64_t>(end - p))
+						{
+							return false;
+						}
+						distances_lzma_size += static_cast<size_t>(len);
+
+						p += len;
+					}
+				}
+				else
+				{
+					for (uint32_t i = 0; i < header.non_empty_chars; ++ i)
+					{
+						distances_addr_[i] = distances_lzma_size;
+
+						uint64_t len;
+						kfont_input->read(&len, sizeof(len));
+						len = LE2Native(len);
+						distances_lzma_size += static_cast<size_t>(len);
 
-					kfont_input->seekg(len, std::ios_base::cur);
+						kfont_input->seekg(len, std::ios_base::cur);
+					}
 				}
 
 				distances_addr_[header.non_empty_chars] = distances_lzma_size;
@@ -346,14 +382,26 @@ namespace KlayGE
 		uint32_t size;
 		this->GetLZMADistanceData(nullptr, size, index);
 
-		std::vector<uint8_t> in_data(size);
-		this->GetLZMADistanceData(&in_data[0], size, index);
+		std::vector<uint8_t> in_data;
+		uint8_t const * lzma_data;
+		ArrayRef<uint8_t> const mapped_data = kfont_input_ ? kfont_input_->MappedData() : ArrayRef<uint8_t>();
+		if (!mapped_data.empty())
+		{
+			// Decode straight from the mapped file. It also avoids racing on the stream position.
+			lzma_data = mapped_data.data() + this->LZMADistanceDataOffset(index);
+		}
+		else
+		{
+			in_data.resize(size);
+			this->GetLZMADistanceData(&in_data[0], size, index);
+			lzma_data = in_data.data();
+		}
 
 		SizeT s_out_len = static_cast<SizeT>(decoded.size());
 
-		SizeT s_src_len = static_cast<SizeT>(in_data.size() - LZMA_PROPS_SIZE);
-		LZMALoader::Instance().LzmaUncompress(static_cast<Byte*>(&decoded[0]), &s_out_len, &in_data[LZMA_PROPS_SIZE], &s_src_len,
-			&in_data[0], LZMA_PROPS_SIZE);
+		SizeT s_src_len = static_cast<SizeT>(size - LZMA_PROPS_SIZE);
+		LZMALoader::Instance().LzmaUncompress(static_cast<Byte*>(&decoded[0]), &s_out_len, lzma_data + LZMA_PROPS_SIZE, &s_src_len,
+			lzma_data, LZMA_PROPS_SIZE);
 
 		uint8_t const * char_data = &decoded[0];
 		for (uint32_t y = 0; y < char_size_; ++ y)
@@ -371,9 +419,16 @@ namespace KlayGE
 		{
 			if (kfont_input_)
 			{
-				kfont_input_->seekg(distances_lzma_start_ + (index + 1) * sizeof(uint64_t) + distances_addr_[index],
-					std::ios_base::beg);
-				kfont_input_->read(p, size);
+				ArrayRef<uint8_t> const mapped_data = kfont_input_->MappedData();
+				if (!mapped_data.empty())
+				{
+					std::memcpy(p, mapped_data.data() + this->LZMADistanceDataOffset(index), size);
+				}
+				else
+				{
+					kfont_input_->seekg(this->LZMADistanceDataOffset(index), std::ios_base::beg);
+					kfont_input_->read(p, size);
+				}
 			}
 			else
 			{
@@ -382,6 +437,11 @@ namespace KlayGE
 		}
 	}
 
+	int64_t KFont::LZMADistanceDataOffset(int32_t index) const
+	{
+		return distances_lzma_start_ + (index + 1) * sizeof(uint64_t) + distances_addr_[index];
+	}
+
 	void KFont::CharSize(uint32_t size)
 	{
 		char_size_ = size;